@@ -64,6 +64,8 @@ extern std::string BioFVM_URL;
 #include "BioFVM_microenvironment.h"
 #include "BioFVM_solvers.h"
 #include "BioFVM_basic_agent.h" 
+#include "BioFVM_MPI.h" 
+#include "BioFVM_trace.h" 
 
 
 #endif
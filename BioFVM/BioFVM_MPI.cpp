@@ -0,0 +1,401 @@
+/*
+#############################################################################
+# If you use BioFVM in your project, please cite BioFVM and the version     #
+# number, such as below:                                                    #
+#                                                                           #
+# We solved the diffusion equations using BioFVM (Version 1.1.7) [1]        #
+#                                                                           #
+# [1] A. Ghaffarizadeh, S.H. Friedman, and P. Macklin, BioFVM: an efficient #
+#    parallelized diffusive transport solver for 3-D biological simulations,#
+#    Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730 #
+#                                                                           #
+#############################################################################
+#                                                                           #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)   #
+#                                                                           #
+# Copyright (c) 2015-2017, Paul Macklin and the BioFVM Project              #
+# All rights reserved.                                                      #
+#                                                                           #
+# Redistribution and use in source and binary forms, with or without        #
+# modification, are permitted provided that the following conditions are    #
+# met:                                                                      #
+#                                                                           #
+# 1. Redistributions of source code must retain the above copyright notice, #
+# this list of conditions and the following disclaimer.                     #
+#                                                                           #
+# 2. Redistributions in binary form must reproduce the above copyright      #
+# notice, this list of conditions and the following disclaimer in the       #
+# documentation and/or other materials provided with the distribution.      #
+#                                                                           #
+# 3. Neither the name of the copyright holder nor the names of its          #
+# contributors may be used to endorse or promote products derived from this #
+# software without specific prior written permission.                       #
+#                                                                           #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       #
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED #
+# TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A           #
+# PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER #
+# OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,  #
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,       #
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR        #
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    #
+# LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      #
+# NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              #
+#                                                                           #
+#############################################################################
+*/
+
+#include "BioFVM_MPI.h"
+#include "BioFVM_matlab.h"
+#include "BioFVM_basic_agent.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+namespace BioFVM{
+
+Domain_Decomposition domain_decomposition; 
+
+Domain_Decomposition::Domain_Decomposition()
+{
+	rank = 0; 
+	size = 1; 
+	active = false; 
+
+	axis = 2; 
+	global_layers = 0; 
+	first_layer = 0; 
+	last_layer = -1; 
+	global_start = 0.0; 
+	global_end = 0.0; 
+	spacing = 1.0; 
+	lower_bound = 0.0; 
+	upper_bound = 0.0; 
+	lower_neighbor = -1; 
+	upper_neighbor = -1; 
+
+	global_bounding_box.assign( 6 , 0.0 ); 
+	global_coordinates.resize( 0 ); 
+	global_voxels = 0; 
+	first_voxel = 0; 
+	return; 
+}
+
+void Domain_Decomposition::initialize( int* argc , char*** argv )
+{
+#ifdef BIOFVM_MPI
+	// only the master thread calls MPI (outside the OpenMP regions)
+	int provided; 
+	MPI_Init_thread( argc , argv , MPI_THREAD_FUNNELED , &provided ); 
+	communicator = MPI_COMM_WORLD; 
+	MPI_Comm_rank( communicator , &rank ); 
+	MPI_Comm_size( communicator , &size ); 
+	active = ( size > 1 ); 
+
+	if( provided < MPI_THREAD_FUNNELED && rank == 0 )
+	{ std::cout << "Warning: the MPI library does not support MPI_THREAD_FUNNELED." << std::endl; }
+
+	// agent IDs: rank, rank + size, rank + 2*size, ...
+	max_basic_agent_ID = rank; 
+	basic_agent_ID_stride = size; 
+
+	if( rank > 0 )
+	{ std::cout.setstate( std::ios::failbit ); }
+	else
+	{ std::cout << "MPI: " << size << " rank(s)" << std::endl; }
+#endif
+	return; 
+}
+
+void Domain_Decomposition::finalize( void )
+{
+#ifdef BIOFVM_MPI
+	std::cout.clear(); 
+	MPI_Finalize(); 
+#endif
+	return; 
+}
+
+void Domain_Decomposition::layers_of_rank( int r , int& first , int& last )
+{
+	first = ( r * global_layers ) / size; 
+	last = ( (r+1) * global_layers ) / size - 1; 
+	return; 
+}
+
+bool Domain_Decomposition::decompose( std::vector<double>& bounding_box , double spacing_along_axis , int axis_index )
+{
+	global_bounding_box = bounding_box; 
+	axis = axis_index; 
+	spacing = spacing_along_axis; 
+	global_start = bounding_box[axis]; 
+	global_end = bounding_box[axis+3]; 
+	global_layers = (int) ceil( 1e-16 + (global_end-global_start)/spacing ); 
+
+	global_coordinates.resize( global_layers ); 
+	for( int i=0; i < global_layers ; i++ )
+	{ global_coordinates[i] = global_start + (i+0.5)*spacing; }
+
+	if( global_layers < 2*size )
+	{
+		std::cout << "Error: " << global_layers << " voxel layers are too few for " << size
+			<< " MPI ranks (each needs at least 2)." << std::endl; 
+		return false; 
+	}
+
+	layers_of_rank( rank , first_layer , last_layer ); 
+	lower_bound = global_start + first_layer*spacing; 
+	upper_bound = global_start + (last_layer+1)*spacing; 
+	if( last_layer == global_layers-1 )
+	{ upper_bound = global_end; }
+
+	lower_neighbor = ( rank > 0 ) ? rank-1 : -1; 
+	upper_neighbor = ( rank < size-1 ) ? rank+1 : -1; 
+	return true; 
+}
+
+void Domain_Decomposition::set_layer_coordinates( Cartesian_Mesh& mesh , double start , double step , int first )
+{
+	std::vector<double>* coordinates = &mesh.z_coordinates; 
+	if( axis == 1 )
+	{ coordinates = &mesh.y_coordinates; }
+	for( int i=0; i < coordinates->size() ; i++ )
+	{ (*coordinates)[i] = start + (first+i+0.5)*step; }
+
+	if( mesh.implicit_voxels == false )
+	{
+		int layer_size = mesh.x_coordinates.size(); 
+		if( axis == 2 )
+		{ layer_size *= mesh.y_coordinates.size(); }
+		for( int n=0; n < mesh.voxels.size() ; n++ )
+		{
+			int layer = n / layer_size; 
+			mesh.voxels[n].center[axis] = (*coordinates)[layer]; 
+		}
+	}
+	return; 
+}
+
+bool Domain_Decomposition::owns( std::vector<double>& position )
+{
+	if( active == false )
+	{ return true; }
+	if( position[axis] < lower_bound && lower_neighbor >= 0 )
+	{ return false; }
+	if( position[axis] >= upper_bound && upper_neighbor >= 0 )
+	{ return false; }
+	return true; 
+}
+
+bool Domain_Decomposition::is_position_in_domain( std::vector<double>& position )
+{
+	if( active == false )
+	{ return false; }
+	for( int i=0; i < 3 ; i++ )
+	{
+		if( position[i] < global_bounding_box[i] || position[i] > global_bounding_box[i+3] )
+		{ return false; }
+	}
+	return true; 
+}
+
+double Domain_Decomposition::global_maximum( double value )
+{
+	double out = value; 
+#ifdef BIOFVM_MPI
+	if( active )
+	{ MPI_Allreduce( &value , &out , 1 , MPI_DOUBLE , MPI_MAX , communicator ); }
+#endif
+	return out; 
+}
+
+int Domain_Decomposition::global_maximum( int value )
+{
+	int out = value; 
+#ifdef BIOFVM_MPI
+	if( active )
+	{ MPI_Allreduce( &value , &out , 1 , MPI_INT , MPI_MAX , communicator ); }
+#endif
+	return out; 
+}
+
+int Domain_Decomposition::global_sum( int value )
+{
+	int out = value; 
+#ifdef BIOFVM_MPI
+	if( active )
+	{ MPI_Allreduce( &value , &out , 1 , MPI_INT , MPI_SUM , communicator ); }
+#endif
+	return out; 
+}
+
+void Domain_Decomposition::broadcast( std::vector<double>& values )
+{
+#ifdef BIOFVM_MPI
+	if( active == false )
+	{ return; }
+	int n = values.size(); 
+	MPI_Bcast( &n , 1 , MPI_INT , 0 , communicator ); 
+	values.resize( n ); 
+	if( n > 0 )
+	{ MPI_Bcast( values.data() , n , MPI_DOUBLE , 0 , communicator ); }
+#endif
+	return; 
+}
+
+void Domain_Decomposition::send( std::vector<double>& values , int destination , int tag )
+{
+#ifdef BIOFVM_MPI
+	MPI_Send( values.data() , values.size() , MPI_DOUBLE , destination , tag , communicator ); 
+#endif
+	return; 
+}
+
+void Domain_Decomposition::receive( std::vector<double>& values , int source , int tag )
+{
+#ifdef BIOFVM_MPI
+	MPI_Recv( values.data() , values.size() , MPI_DOUBLE , source , tag , communicator , MPI_STATUS_IGNORE ); 
+#endif
+	return; 
+}
+
+void Domain_Decomposition::exchange_with_neighbors( std::vector<double>& to_lower , std::vector<double>& to_upper ,
+	std::vector<double>& from_lower , std::vector<double>& from_upper , int tag )
+{
+	from_lower.resize( 0 ); 
+	from_upper.resize( 0 ); 
+#ifdef BIOFVM_MPI
+	if( active == false )
+	{ return; }
+	int lower = ( lower_neighbor >= 0 ) ? lower_neighbor : MPI_PROC_NULL; 
+	int upper = ( upper_neighbor >= 0 ) ? upper_neighbor : MPI_PROC_NULL; 
+
+	// upward: to the upper neighbor, from the lower one
+	int size_out = to_upper.size(); 
+	int size_in = 0; 
+	MPI_Sendrecv( &size_out , 1 , MPI_INT , upper , tag , &size_in , 1 , MPI_INT , lower , tag ,
+		communicator , MPI_STATUS_IGNORE ); 
+	from_lower.resize( size_in ); 
+	MPI_Sendrecv( to_upper.data() , size_out , MPI_DOUBLE , upper , tag , from_lower.data() , size_in , MPI_DOUBLE , lower , tag ,
+		communicator , MPI_STATUS_IGNORE ); 
+
+	// downward
+	size_out = to_lower.size(); 
+	size_in = 0; 
+	MPI_Sendrecv( &size_out , 1 , MPI_INT , lower , tag , &size_in , 1 , MPI_INT , upper , tag ,
+		communicator , MPI_STATUS_IGNORE ); 
+	from_upper.resize( size_in ); 
+	MPI_Sendrecv( to_lower.data() , size_out , MPI_DOUBLE , lower , tag , from_upper.data() , size_in , MPI_DOUBLE , upper , tag ,
+		communicator , MPI_STATUS_IGNORE ); 
+#endif
+	return; 
+}
+
+static bool append_columns( std::string filename , std::vector<double>& columns )
+{
+	FILE* fp = fopen( filename.c_str() , "ab" ); 
+	if( fp == NULL )
+	{ return false; }
+	fwrite( (char*) columns.data() , sizeof(double) , columns.size() , fp ); 
+	fclose( fp ); 
+	return true; 
+}
+
+bool Domain_Decomposition::write_matlab_columns( std::string filename , std::string variable_name , unsigned int rows , std::vector<double>& columns )
+{
+	long long local_columns = ( rows > 0 ) ? columns.size() / rows : 0; 
+	long long total_columns = local_columns; 
+#ifdef BIOFVM_MPI
+	long long first_column = 0; 
+	if( active )
+	{
+		MPI_Exscan( &local_columns , &first_column , 1 , MPI_LONG_LONG , MPI_SUM , communicator ); 
+		if( rank == 0 )
+		{ first_column = 0; }
+		MPI_Allreduce( &local_columns , &total_columns , 1 , MPI_LONG_LONG , MPI_SUM , communicator ); 
+	}
+#endif
+
+	// rank 0 writes the header (and truncates the file), then every rank writes its columns
+	long long header_size = -1; 
+	if( rank == 0 )
+	{
+		FILE* fp = write_matlab_header( rows , total_columns , filename , variable_name ); 
+		if( fp != NULL )
+		{
+			header_size = ftell( fp ); 
+			fclose( fp ); 
+		}
+	}
+#ifdef BIOFVM_MPI
+	if( active )
+	{ MPI_Bcast( &header_size , 1 , MPI_LONG_LONG , 0 , communicator ); }
+#endif
+	if( header_size < 0 )
+	{
+		std::cout << "Error: could not write " << filename << "." << std::endl; 
+		return false; 
+	}
+
+#ifdef BIOFVM_MPI
+	if( active == false )
+	{ return append_columns( filename , columns ); }
+	MPI_File file; 
+	if( MPI_File_open( communicator , (char*) filename.c_str() , MPI_MODE_WRONLY , MPI_INFO_NULL , &file ) != MPI_SUCCESS )
+	{
+		std::cout << "Error: could not open " << filename << " for collective writing." << std::endl; 
+		return false; 
+	}
+	// in pieces, as the counts are ints
+	const long long piece = 1 << 26; 
+	MPI_Offset offset = header_size + first_column * rows * sizeof(double); 
+	for( long long start=0; start < (long long) columns.size() ; start += piece )
+	{
+		int count = std::min( piece , (long long) columns.size() - start ); 
+		MPI_File_write_at( file , offset + start*sizeof(double) , columns.data() + start , count , MPI_DOUBLE , MPI_STATUS_IGNORE ); 
+	}
+	MPI_File_close( &file ); 
+	return true; 
+#else
+	return append_columns( filename , columns ); 
+#endif
+}
+
+FILE* Domain_Decomposition::open_matlab_columns( void )
+{
+	FILE* fp = tmpfile(); 
+	if( fp == NULL )
+	{ std::cout << "Error: could not open a scratch file for the .mat columns." << std::endl; }
+	return fp; 
+}
+
+bool Domain_Decomposition::close_matlab_columns( FILE* fp , std::string filename , std::string variable_name , unsigned int rows )
+{
+	std::vector<double> columns( ftell( fp ) / sizeof(double) ); 
+	rewind( fp ); 
+	size_t read = fread( (char*) columns.data() , sizeof(double) , columns.size() , fp ); 
+	fclose( fp ); 
+	columns.resize( read ); 
+	return write_matlab_columns( filename , variable_name , rows , columns ); 
+}
+
+void Domain_Decomposition::write_mesh_to_matlab( Cartesian_Mesh& mesh , std::string filename )
+{
+	std::vector<double> columns( 4*mesh.number_of_voxels() ); 
+	#pragma omp parallel for
+	for( int n=0; n < mesh.number_of_voxels() ; n++ )
+	{
+		std::vector<double> center = mesh.voxel_center( n ); 
+		columns[4*n] = center[0]; 
+		columns[4*n+1] = center[1]; 
+		columns[4*n+2] = center[2]; 
+		columns[4*n+3] = mesh.voxel_volume( n ); 
+	}
+	write_matlab_columns( filename , "mesh" , 4 , columns ); 
+	return; 
+}
+
+}; 
@@ -0,0 +1,163 @@
+/*
+#############################################################################
+# If you use BioFVM in your project, please cite BioFVM and the version     #
+# number, such as below:                                                    #
+#                                                                           #
+# We solved the diffusion equations using BioFVM (Version 1.1.7) [1]        #
+#                                                                           #
+# [1] A. Ghaffarizadeh, S.H. Friedman, and P. Macklin, BioFVM: an efficient #
+#    parallelized diffusive transport solver for 3-D biological simulations,#
+#    Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730 #
+#                                                                           #
+#############################################################################
+#                                                                           #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)   #
+#                                                                           #
+# Copyright (c) 2015-2017, Paul Macklin and the BioFVM Project              #
+# All rights reserved.                                                      #
+#                                                                           #
+# Redistribution and use in source and binary forms, with or without        #
+# modification, are permitted provided that the following conditions are    #
+# met:                                                                      #
+#                                                                           #
+# 1. Redistributions of source code must retain the above copyright notice, #
+# this list of conditions and the following disclaimer.                     #
+#                                                                           #
+# 2. Redistributions in binary form must reproduce the above copyright      #
+# notice, this list of conditions and the following disclaimer in the       #
+# documentation and/or other materials provided with the distribution.      #
+#                                                                           #
+# 3. Neither the name of the copyright holder nor the names of its          #
+# contributors may be used to endorse or promote products derived from this #
+# software without specific prior written permission.                       #
+#                                                                           #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       #
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED #
+# TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A           #
+# PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER #
+# OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,  #
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,       #
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR        #
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    #
+# LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      #
+# NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              #
+#                                                                           #
+#############################################################################
+*/
+
+#ifndef __BioFVM_MPI_h__
+#define __BioFVM_MPI_h__
+
+#include <vector>
+#include <string>
+#include <cstdio>
+
+#include "BioFVM_mesh.h"
+
+#ifdef BIOFVM_MPI
+#include <mpi.h>
+#endif
+
+namespace BioFVM{
+
+/*
+ Distributed-memory runs with MPI (build with "make MPI=1", which compiles with
+ mpicxx and defines BIOFVM_MPI). The domain is cut into slabs of whole voxel
+ layers along its outermost axis (z in 3-D, y in 2-D), one slab per rank, and
+ each rank keeps:
+
+	the microenvironment voxels of its slab. The Thomas sweeps along the cut
+		axis are pipelined through the ranks (see Microenvironment::
+		thomas_solve_distributed), so the densities are the same as on one rank.
+	the cells whose centers are in its slab, and a copy of the neighboring
+		ranks' cells within one mechanics voxel of it during the velocity
+		update (see core/PhysiCell_MPI.h).
+
+ Snapshots are written collectively: one .mat file for the whole domain, with
+ the voxels in the usual order and the cells in rank order. Only rank 0 writes
+ the XML files and prints to std::cout. (The XML forms of the voxels and the
+ densities, without the .mat files, only list rank 0's slab.)
+
+ Without BIOFVM_MPI, or on one rank, the decomposition is inactive, and
+ nothing changes.
+*/
+
+class Domain_Decomposition
+{
+ private:
+#ifdef BIOFVM_MPI
+	MPI_Comm communicator; 
+#endif
+ public:
+	int rank; 
+	int size; 
+	bool active; // more than one rank
+
+	// set by decompose()
+	int axis; // 2 (z) in 3-D, 1 (y) in 2-D
+	int global_layers; // voxel layers along the axis, over all ranks
+	int first_layer; // this rank's layers are [first_layer,last_layer]
+	int last_layer; 
+	double global_start; // the domain, along the axis
+	double global_end; 
+	double spacing; 
+	double lower_bound; // this rank's slab, along the axis
+	double upper_bound; 
+	int lower_neighbor; // -1 at the edge of the domain
+	int upper_neighbor; 
+
+	std::vector<double> global_bounding_box; 
+	std::vector<double> global_coordinates; // voxel centers along the axis, over all ranks
+	int global_voxels; 
+	int first_voxel; // global index of this rank's first voxel
+
+	Domain_Decomposition(); 
+
+	// call these first and last in main(), on every rank
+	void initialize( int* argc , char*** argv ); 
+	void finalize( void ); 
+
+	// the layers of rank r (at least 2 per rank)
+	void layers_of_rank( int r , int& first , int& last ); 
+	// cuts the domain (bounding box ordered as in General_Mesh) along axis.
+	// false if the slabs would be too thin.
+	bool decompose( std::vector<double>& bounding_box , double spacing_along_axis , int axis_index ); 
+	// after a mesh of layers [first,first+n) is resized, sets its coordinates along
+	// the axis from the global layer numbers, as on one rank
+	void set_layer_coordinates( Cartesian_Mesh& mesh , double start , double step , int first ); 
+
+	// the rank that keeps a cell at this position: the slab it is in, with the
+	// positions outside the domain kept by the ranks at the edges
+	bool owns( std::vector<double>& position ); 
+	bool is_position_in_domain( std::vector<double>& position ); 
+
+	double global_maximum( double value ); 
+	int global_sum( int value ); 
+	int global_maximum( int value ); 
+
+	// rank 0's values, on every rank
+	void broadcast( std::vector<double>& values ); 
+	// point-to-point, with the sizes known on both sides
+	void send( std::vector<double>& values , int destination , int tag ); 
+	void receive( std::vector<double>& values , int source , int tag ); 
+	// with both slab neighbors at once (the sizes are exchanged first)
+	void exchange_with_neighbors( std::vector<double>& to_lower , std::vector<double>& to_upper ,
+		std::vector<double>& from_lower , std::vector<double>& from_upper , int tag ); 
+
+	// a .mat file of rows x (columns over all ranks), from this rank's columns
+	// (column-major), which follow those of the lower ranks
+	bool write_matlab_columns( std::string filename , std::string variable_name , unsigned int rows , std::vector<double>& columns ); 
+	// the same, for code that fwrite()s its columns: write them to the scratch
+	// stream from open_matlab_columns(), then close it with close_matlab_columns()
+	FILE* open_matlab_columns( void ); 
+	bool close_matlab_columns( FILE* fp , std::string filename , std::string variable_name , unsigned int rows ); 
+	// the voxel centers and volumes, as in Cartesian_Mesh::write_to_matlab
+	void write_mesh_to_matlab( Cartesian_Mesh& mesh , std::string filename ); 
+}; 
+
+extern Domain_Decomposition domain_decomposition; 
+
+}; 
+
+#endif
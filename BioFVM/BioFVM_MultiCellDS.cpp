@@ -50,6 +50,8 @@
 // #include "BioFVM_strings.h" 
 #include "BioFVM_MultiCellDS.h"
 
+#include <atomic>
+
 namespace BioFVM{
 std::string BioFVM_Version = "1.1.7";
 std::string BioFVM_URL = "http://BioFVM.MathCancer.org"; 
@@ -83,6 +85,53 @@ bool save_mesh_as_matlab = true;
 bool save_density_data_as_matlab = true;
 bool save_cells_as_custom_matlab = true; 
 bool save_cell_data = true; 
+
+/* 
+ pugixml allocates all its memory through these, so that the bytes held by the 
+ documents can be reported. Each block starts with its size, padded so that the 
+ rest stays aligned as from malloc. They are installed before main(), ahead of 
+ any parsing: the global documents allocate nothing until they are loaded. 
+*/ 
+
+std::atomic<long long> pugixml_bytes( 0 ); 
+std::atomic<long long> pugixml_peak( 0 ); 
+const size_t pugixml_header_size = 16; 
+
+void* pugixml_counting_allocate( size_t size )
+{
+	char* block = (char*) malloc( size + pugixml_header_size ); 
+	if( block == NULL )
+	{ return NULL; }
+	*( (size_t*) block ) = size; 
+	long long in_use = pugixml_bytes.fetch_add( size ) + size; 
+	long long peak = pugixml_peak.load(); 
+	while( in_use > peak && !pugixml_peak.compare_exchange_weak( peak , in_use ) )
+	{ }
+	return block + pugixml_header_size; 
+}
+
+void pugixml_counting_deallocate( void* ptr )
+{
+	if( ptr == NULL )
+	{ return; }
+	char* block = (char*) ptr - pugixml_header_size; 
+	pugixml_bytes.fetch_sub( *( (size_t*) block ) ); 
+	free( block ); 
+	return; 
+}
+
+struct Pugixml_Allocator_Installer
+{
+	Pugixml_Allocator_Installer()
+	{ pugi::set_memory_management_functions( pugixml_counting_allocate , pugixml_counting_deallocate ); }
+}; 
+Pugixml_Allocator_Installer pugixml_allocator_installer; 
+
+long long pugixml_bytes_in_use( void )
+{ return pugixml_bytes.load(); }
+
+long long pugixml_peak_bytes( void )
+{ return pugixml_peak.load(); }
 		
 Person_Metadata::Person_Metadata()
 {
@@ -551,14 +600,26 @@ void add_BioFVM_substrates_to_open_xml_pugi( pugi::xml_document& xml_dom , std::
 		attrib.set_value( M.mesh.regular_mesh ); 		
 		attrib = node.append_attribute( "units" ); 
 		attrib.set_value( M.mesh.units.c_str() );
+		// an MPI run describes the whole domain, not this rank's slab (see BioFVM_MPI.h) 
+		std::vector<double> bounding_box = M.mesh.bounding_box; 
+		std::vector<double> y_coordinates = M.mesh.y_coordinates; 
+		std::vector<double> z_coordinates = M.mesh.z_coordinates; 
+		if( M.decomposed )
+		{
+			bounding_box = domain_decomposition.global_bounding_box; 
+			if( domain_decomposition.axis == 1 )
+			{ y_coordinates = domain_decomposition.global_coordinates; }
+			else
+			{ z_coordinates = domain_decomposition.global_coordinates; }
+		}
 		// add the bounding box 
 		node = node.append_child( "bounding_box" ); 
 		attrib = node.append_attribute( "type" ); 
 		attrib.set_value( "axis-aligned" ); 
 		attrib = node.append_attribute( "units" ); 
 		attrib.set_value( M.mesh.units.c_str() ); 
-		sprintf( buffer , "%f %f %f %f %f %f" , M.mesh.bounding_box[0] , M.mesh.bounding_box[1] , M.mesh.bounding_box[2] , 
-		M.mesh.bounding_box[3] , M.mesh.bounding_box[4] , M.mesh.bounding_box[5] ); 
+		sprintf( buffer , "%f %f %f %f %f %f" , bounding_box[0] , bounding_box[1] , bounding_box[2] , 
+		bounding_box[3] , bounding_box[4] , bounding_box[5] ); 
 		node.append_child( pugi::node_pcdata ).set_value( buffer ); 
 		node = node.parent(); 		
 		// if Cartesian, add the x, y, and z coordinates 
@@ -576,9 +637,9 @@ void add_BioFVM_substrates_to_open_xml_pugi( pugi::xml_document& xml_dom , std::
 			
 			node = node.parent();
 			position = 0; 
-			for( unsigned int k=0 ; k < M.mesh.y_coordinates.size()-1 ; k++ )
-			{ position += sprintf( temp+position, "%f " , M.mesh.y_coordinates[k] ); }
-			sprintf( temp+position , "%f" , M.mesh.y_coordinates[ M.mesh.y_coordinates.size()-1] ); 
+			for( unsigned int k=0 ; k < y_coordinates.size()-1 ; k++ )
+			{ position += sprintf( temp+position, "%f " , y_coordinates[k] ); }
+			sprintf( temp+position , "%f" , y_coordinates[ y_coordinates.size()-1] ); 
 			node = node.append_child( "y_coordinates" ); 
 			node.append_child( pugi::node_pcdata ).set_value( temp ); 
 			attrib = node.append_attribute("delimiter");
@@ -586,9 +647,9 @@ void add_BioFVM_substrates_to_open_xml_pugi( pugi::xml_document& xml_dom , std::
 			
 			node = node.parent();
 			position = 0; 
-			for( unsigned int k=0 ; k < M.mesh.z_coordinates.size()-1 ; k++ )
-			{ position += sprintf( temp+position, "%f " , M.mesh.z_coordinates[k] ); }
-			sprintf( temp+position , "%f" , M.mesh.z_coordinates[ M.mesh.z_coordinates.size()-1] ); 
+			for( unsigned int k=0 ; k < z_coordinates.size()-1 ; k++ )
+			{ position += sprintf( temp+position, "%f " , z_coordinates[k] ); }
+			sprintf( temp+position , "%f" , z_coordinates[ z_coordinates.size()-1] ); 
 			node = node.append_child( "z_coordinates" ); 
 			node.append_child( pugi::node_pcdata ).set_value( temp ); 
 			attrib = node.append_attribute("delimiter");
@@ -602,24 +663,25 @@ void add_BioFVM_substrates_to_open_xml_pugi( pugi::xml_document& xml_dom , std::
 			attrib = node.append_attribute("type");
 			attrib.set_value( "xml" ); 
 			char temp [1024]; 
-			for( unsigned int k=0; k < M.mesh.voxels.size() ; k++ )
+			for( unsigned int k=0; k < M.mesh.number_of_voxels() ; k++ )
 			{
+				Voxel& voxel = M.mesh.voxel( k ); 
 				node = node.append_child( "voxel" );
 				
 				attrib = node.append_attribute( "ID" ); 
-				attrib.set_value( M.mesh.voxels[k].mesh_index ); 
+				attrib.set_value( voxel.mesh_index ); 
 				attrib = node.append_attribute( "type" ); 
 				attrib.set_value( "cube" ); // allowed: cube or unknown 
 
 				node = node.append_child( "center" );
 				attrib = node.append_attribute( "delimiter" );
 				attrib.set_value( " " );
-				sprintf( temp , "%f %f %f" , M.mesh.voxels[k].center[0] , M.mesh.voxels[k].center[1], M.mesh.voxels[k].center[2] );
+				sprintf( temp , "%f %f %f" , voxel.center[0] , voxel.center[1], voxel.center[2] );
 				node.append_child( pugi::node_pcdata ).set_value( temp ); 
 				node = node.parent(); 
 				
 				node = node.append_child( "volume" );
-				sprintf( temp , "%f" , M.mesh.voxels[k].volume );
+				sprintf( temp , "%f" , voxel.volume );
 				node.append_child( pugi::node_pcdata ).set_value( temp ); 
 				node = node.parent(); 
 
@@ -635,7 +697,10 @@ void add_BioFVM_substrates_to_open_xml_pugi( pugi::xml_document& xml_dom , std::
 	
 			char filename [1024]; 
 			sprintf( filename , "%s_mesh%d.mat" , filename_base.c_str() , 0 ); 
-			M.mesh.write_to_matlab( filename ); 
+			if( M.decomposed )
+			{ domain_decomposition.write_mesh_to_matlab( M.mesh , filename ); }
+			else
+			{ M.mesh.write_to_matlab( filename ); }
 			
 			node = node.append_child( "filename" ); 
 			
@@ -710,12 +775,12 @@ void add_BioFVM_substrates_to_open_xml_pugi( pugi::xml_document& xml_dom , std::
 			
 			char* buffer; 
 			buffer = new char [data_size]; 
-			for( unsigned int j=0 ; j < M.mesh.voxels.size() ; j++ )
+			for( unsigned int j=0 ; j < M.mesh.number_of_voxels() ; j++ )
 			{
 				vector_to_list( M.density_vector(j) , buffer , ' ' ); 
 				node = node.append_child( "data_vector"); 
 				attrib = node.append_attribute( "voxel_ID" ); 
-				attrib.set_value( M.mesh.voxels[j].mesh_index ); 
+				attrib.set_value( M.mesh.voxel(j).mesh_index ); 
 				attrib = node.append_attribute( "delimiter" ); 
 				attrib.set_value( " " ); 
 				
@@ -771,7 +836,7 @@ void add_BioFVM_substrates_to_open_xml_pugi( pugi::xml_document& xml_dom , std::
 		char* buffer; 
 		buffer = new char [data_size]; 
 		node = node.child( "data_vector" );
-		for( unsigned int j=0 ; j < M.mesh.voxels.size() ; j++ )
+		for( unsigned int j=0 ; j < M.mesh.number_of_voxels() ; j++ )
 		{
 			vector_to_list( M.density_vector(j) , buffer , ' ' ); 
 			node = node.first_child(); 
@@ -912,6 +977,29 @@ void add_BioFVM_agents_to_open_xml_pugi( pugi::xml_document& xml_dom, std::strin
 		// order: ID,x,y,z,volume,radius, 
 		int number_of_data_entries = all_basic_agents.size(); 
 		int size_of_each_datum = 1 + 3 + 1 + 3*M.number_of_densities(); // ID, x,y,z, volume,  src,sink,saturation (multiple) 
+		
+		if( M.decomposed )
+		{
+			// the same columns, from every rank, into one file 
+			std::vector<double> columns; 
+			columns.reserve( number_of_data_entries * size_of_each_datum ); 
+			for( int i=0; i < number_of_data_entries ; i++ )
+			{
+				columns.push_back( (double) all_basic_agents[i]->ID ); 
+				columns.push_back( all_basic_agents[i]->position[0] ); 
+				columns.push_back( all_basic_agents[i]->position[1] ); 
+				columns.push_back( all_basic_agents[i]->position[2] ); 
+				columns.push_back( all_basic_agents[i]->get_total_volume() ); 
+				for( unsigned int j=0; j < M.number_of_densities() ; j++ ) 
+				{
+					columns.push_back( all_basic_agents[i]->get_total_volume() * (*all_basic_agents[i]->secretion_rates)[j] ); 
+					columns.push_back( all_basic_agents[i]->get_total_volume() * (*all_basic_agents[i]->uptake_rates)[j] ); 
+					columns.push_back( (*all_basic_agents[i]->saturation_densities)[j] ); 
+				}
+			}
+			domain_decomposition.write_matlab_columns( filename , "basic_agents" , size_of_each_datum , columns ); 
+			return; 
+		}
 
 		FILE* fp = write_matlab_header( size_of_each_datum, number_of_data_entries,  filename, "basic_agents" );  
 
@@ -1059,7 +1147,8 @@ void save_BioFVM_to_MultiCellDS_xml_pugi( std::string filename_base , Microenvir
 		
 	char filename[1024]; 
 	sprintf( filename , "%s.xml" , filename_base.c_str() ); 
-	biofvm_doc.save_file( filename );
+	if( domain_decomposition.rank == 0 )
+	{ biofvm_doc.save_file( filename ); }
 	
 	std::cout << "done!" << std::endl; 
 	
@@ -1073,6 +1162,15 @@ void read_BioFVM_to_MultiCellDS_xml_pugi( std::string filename_base , Microenvir
 
 /* partly-implemented code snippets -- not to be used as of February 2016 */
 
+// the .mat file of a node of type "matlab": in a <filename> child (as written by 
+// add_BioFVM_substrates_to_open_xml_pugi), or else the text of the node itself 
+static const char* matlab_filename( pugi::xml_node& node )
+{
+	if( node.child( "filename" ) )
+	{ return node.child( "filename" ).text().get(); }
+	return node.text().get(); 
+}
+
 // not yet supported 
 void read_microenvironment_from_MultiCellDS_xml( Microenvironment& M_destination , std::string filename )
 {
@@ -1084,6 +1182,28 @@ void read_microenvironment_from_MultiCellDS_xml( Microenvironment& M_destination
 	read_microenvironment_from_MultiCellDS_xml( M_destination , doc ); 
 }
 
+// meshes read voxel by voxel are stored: say so if the destination was implicit 
+static void warn_if_leaving_implicit_mesh( Microenvironment& M_destination )
+{
+	if( M_destination.mesh.implicit_voxels )
+	{
+		std::cout << "Warning: the MultiCellDS mesh is not regular Cartesian, so its voxels are stored " 
+			<< "(the implicit mesh mode is turned off)." << std::endl; 
+	}
+	return; 
+}
+
+// the voxel by voxel reads below write mesh.voxels[] directly 
+static void check_stored_voxels( Microenvironment& M_destination , unsigned int voxel_count )
+{
+	if( M_destination.mesh.implicit_voxels || M_destination.mesh.voxels.size() != voxel_count )
+	{
+		std::cout << "Error: could not store the " << voxel_count << " voxels of the MultiCellDS mesh!" << std::endl; 
+		exit(-1); 
+	}
+	return; 
+}
+
 // not yet supported 
 void read_microenvironment_from_MultiCellDS_xml( Microenvironment& M_destination , pugi::xml_document& xml_dom )
 {
@@ -1225,11 +1345,16 @@ void read_microenvironment_from_MultiCellDS_xml( Microenvironment& M_destination
 				// determine the number of voxels 
 				unsigned int rows; 
 				unsigned int columns; 
-				FILE* fp = read_matlab_header( &rows, &columns, node.text().get() ); 
+				FILE* fp = read_matlab_header( &rows, &columns, matlab_filename( node ) ); 
+				if( fp == NULL )
+				{ exit(-1); }
 				unsigned int voxel_count = columns; 
 				
-				// resize the appropriate data structure 
+				// resize the appropriate data structure (this leaves implicit mode, 
+				// which only applies to regular Cartesian meshes) 
+				warn_if_leaving_implicit_mesh( M_destination ); 
 				M_destination.resize_voxels( voxel_count );	
+				check_stored_voxels( M_destination , voxel_count ); 
 
 				// read the data directly into the voxels  
 				for( unsigned int j=0; j < columns ; j++ )
@@ -1262,8 +1387,10 @@ void read_microenvironment_from_MultiCellDS_xml( Microenvironment& M_destination
 					node = node.next_sibling( "voxel" ); 
 				}
 				
-				// now, resize the data structures 
+				// now, resize the data structures (this leaves implicit mode, as above) 
+				warn_if_leaving_implicit_mesh( M_destination ); 
 				M_destination.resize_voxels( voxel_count ); 
+				check_stored_voxels( M_destination , voxel_count ); 
 				
 				// now, go back and read in the data 
 				node = root; // microenvironment; 
@@ -1344,10 +1471,24 @@ void read_microenvironment_from_MultiCellDS_xml( Microenvironment& M_destination
 		{  
 			unsigned int rows; 
 			unsigned int columns; 
-			FILE* fp = read_matlab_header( &rows, &columns, node.text().get() ); 			
+			FILE* fp = read_matlab_header( &rows, &columns, matlab_filename( node ) ); 			
+			if( fp == NULL )
+			{ exit(-1); }
+			if( columns != M_destination.mesh.number_of_voxels() )
+			{
+				std::cout << "Error: the density data have " << columns << " voxels, but the mesh has " 
+					<< M_destination.mesh.number_of_voxels() << "!" << std::endl; 
+				exit(-1); 
+			}
 			unsigned int start_row = 0; 
 			if( rows > M_destination.number_of_densities() )
 			{ start_row = 4; }
+			if( rows - start_row != M_destination.number_of_densities() )
+			{
+				std::cout << "Error: the density data have " << rows - start_row << " substrates, but " 
+					<< M_destination.number_of_densities() << " were read!" << std::endl; 
+				exit(-1); 
+			}
 			
 
 			// read the data directly into the microenvironment 
@@ -1360,7 +1501,10 @@ void read_microenvironment_from_MultiCellDS_xml( Microenvironment& M_destination
 
 				// now, read the actual data 
 				for( unsigned int i=start_row; i < rows ; i++ )
-				{ result = fread( (char*) &( M_destination.density_vector(j)[i-start_row] ) , sizeof(double) , 1 , fp ); }
+				{
+					result = fread( (char*) &temp , sizeof(double) , 1 , fp ); // stored as double 
+					M_destination.density_vector(j)[i-start_row] = temp; 
+				}
 			} 
 			
 			fclose( fp );
@@ -1369,7 +1513,7 @@ void read_microenvironment_from_MultiCellDS_xml( Microenvironment& M_destination
 		{
 			// attempt to read it in as XML data, voxel by voxel 
 			node = node.child( "density_vector" ); 
-			for( unsigned int j=0 ; j < M_destination.mesh.voxels.size() ; j++ )
+			for( unsigned int j=0 ; j < M_destination.mesh.number_of_voxels() ; j++ )
 			{
 				csv_to_vector( node.first_child().value() , M_destination.density_vector(j)  ); 
 				if( node.next_sibling( "density_vector" ) ) 
@@ -179,6 +179,11 @@ void set_save_biofvm_data_as_matlab( bool newvalue ); // default: true
 void set_save_biofvm_cell_data( bool newvalue ); // default: true
 void set_save_biofvm_cell_data_as_custom_matlab( bool newvalue ); // default: true
 
+/* memory of the pugixml documents (the settings, and the snapshots as they are built) */ 
+
+long long pugixml_bytes_in_use( void ); 
+long long pugixml_peak_bytes( void ); 
+
 /* writing parts of BioFVM to a MultiCellDS file */ 
 
 void add_BioFVM_substrates_to_open_xml_pugi( pugi::xml_document& xml_dom , std::string filename_base , Microenvironment& M ); 
@@ -49,17 +49,19 @@
 #include "BioFVM_basic_agent.h"
 #include "BioFVM_agent_container.h"
 #include "BioFVM_vector.h" 
+#include "BioFVM_MPI.h" 
 
 namespace BioFVM{
 
 std::vector<Basic_Agent*> all_basic_agents(0); 
+int max_basic_agent_ID = 0; 
+int basic_agent_ID_stride = 1; 
 
 Basic_Agent::Basic_Agent()
 {
-	//give the agent a unique ID  
-	static int max_basic_agent_ID = 0; 
-	ID = max_basic_agent_ID; // 
-	max_basic_agent_ID++; 
+	//give the agent a unique ID (agents may be built in parallel) 
+	#pragma omp atomic capture 
+	{ ID = max_basic_agent_ID; max_basic_agent_ID += basic_agent_ID_stride; }
 	// initialize position and velocity
 	is_active=true;
 	
@@ -116,7 +118,10 @@ void Basic_Agent::update_voxel_index()
 	if( !get_microenvironment()->mesh.is_position_valid(position[0],position[1],position[2]))
 	{	
 		current_voxel_index=-1;
-		is_active=false;
+		// in an MPI run, an agent that left this rank's slab for another one stays 
+		// active: it moves to that rank after the position update (see BioFVM_MPI.h) 
+		if( domain_decomposition.active == false || !domain_decomposition.is_position_in_domain( position ) )
+		{ is_active=false; }
 		return;
 	}
 	current_voxel_index= microenvironment->nearest_voxel_index( position );
@@ -139,7 +144,7 @@ void Basic_Agent::set_internal_uptake_constants( double dt )
 	}
 */
 	
-	double internal_constant_to_discretize_the_delta_approximation = dt * volume / ( (microenvironment->voxels(current_voxel_index)).volume ) ; // needs a fix 
+	double internal_constant_to_discretize_the_delta_approximation = dt * volume / ( microenvironment->mesh.voxel_volume( current_voxel_index ) ) ; // needs a fix 
 	
 	// temp1 = dt*(V_cell/V_voxel)*S*T 
 	cell_source_sink_solver_temp1.assign( (*secretion_rates).size() , 0.0 ); 
@@ -154,11 +159,35 @@ void Basic_Agent::set_internal_uptake_constants( double dt )
 	axpy( &(cell_source_sink_solver_temp2) , internal_constant_to_discretize_the_delta_approximation , *secretion_rates );
 	axpy( &(cell_source_sink_solver_temp2) , internal_constant_to_discretize_the_delta_approximation , *uptake_rates );	
 	
+	// quasi-steady substrates take the sources and sinks in their own solve 
+	for( unsigned int i=0; i < microenvironment->diffusion_solver_types.size() && i < cell_source_sink_solver_temp1.size() ; i++ )
+	{
+		if( microenvironment->diffusion_solver_types[i] == "steady" )
+		{
+			cell_source_sink_solver_temp1[i] = 0.0; 
+			cell_source_sink_solver_temp2[i] = 1.0; 
+		}
+	}
+	
 	volume_is_changed = false; 
 	
 	return; 
 }
 
+void Basic_Agent::get_source_and_sink_rates( int substrate_index , double& source , double& sink )
+{
+	source = 0.0; 
+	sink = 0.0; 
+	if( !is_active || current_voxel_index < 0 )
+	{ return; }
+	
+	// same delta approximation as in set_internal_uptake_constants 
+	double volume_fraction = volume / ( microenvironment->mesh.voxel_volume( current_voxel_index ) ); 
+	source = volume_fraction * (*secretion_rates)[substrate_index] * (*saturation_densities)[substrate_index]; 
+	sink = volume_fraction * ( (*secretion_rates)[substrate_index] + (*uptake_rates)[substrate_index] ); 
+	return; 
+}
+
 void Basic_Agent::register_microenvironment( Microenvironment* microenvironment_in )
 {
 	microenvironment = microenvironment_in; 	
@@ -190,7 +219,7 @@ void Basic_Agent::release_internalized_substrates( void )
 	// density_ext += fraction * total_internal / vol_volume 
 	
 	// std::cout << "\t\t\t" << (*pS)(current_voxel_index) << "\t\t\t" << std::endl; 
-	*internalized_substrates /=  pS->voxels(current_voxel_index).volume; // turn to density 
+	*internalized_substrates /=  pS->mesh.voxel_volume( current_voxel_index ); // turn to density 
 	*internalized_substrates *= *fraction_released_at_death;  // what fraction is released? 
 	
 	// release this amount into the environment 
@@ -256,7 +285,7 @@ int Basic_Agent::get_current_voxel_index( void )
 	return current_voxel_index;
 }
 
-std::vector<double>& Basic_Agent::nearest_density_vector( void ) 
+std::vector<real_t>& Basic_Agent::nearest_density_vector( void ) 
 {  
 	return microenvironment->nearest_density_vector( current_voxel_index ); 
 }
@@ -305,7 +334,7 @@ void Basic_Agent::simulate_secretion_and_uptake( Microenvironment* pS, double dt
 		total_extracellular_substrate_change *= (*pS)(current_voxel_index); // (1-c2)*rho 
 		total_extracellular_substrate_change += cell_source_sink_solver_temp1; // (1-c2)*rho+c1 
 		total_extracellular_substrate_change /= cell_source_sink_solver_temp2; // ((1-c2)*rho+c1)/c2
-		total_extracellular_substrate_change *= pS->voxels(current_voxel_index).volume; // W*((1-c2)*rho+c1)/c2 
+		total_extracellular_substrate_change *= pS->mesh.voxel_volume( current_voxel_index ); // W*((1-c2)*rho+c1)/c2 
 		
 		*internalized_substrates -= total_extracellular_substrate_change; // opposite of net extracellular change 	
 	}
@@ -91,6 +91,8 @@ class Basic_Agent
 	void release_internalized_substrates( void ); 
 
 	void set_internal_uptake_constants( double dt ); // any time you update the cell volume or rates, should call this function. 
+	// rates of change this agent adds to its voxel: source - sink*density (for steady-state solves) 
+	void get_source_and_sink_rates( int substrate_index , double& source , double& sink ); 
 
 	void register_microenvironment( Microenvironment* );
 	Microenvironment* get_microenvironment( void ); 
@@ -114,8 +116,8 @@ class Basic_Agent
 
 	int get_current_voxel_index( void ); 
 	// directly access the substrate vector at the nearest voxel at the indicated microenvironment 
-	std::vector<double>& nearest_density_vector( int microenvironment_index ); // not implemented!
-	std::vector<double>& nearest_density_vector( void );
+	std::vector<real_t>& nearest_density_vector( int microenvironment_index ); // not implemented!
+	std::vector<real_t>& nearest_density_vector( void );
 	
 	// directly access the gradient of substrate n nearest to the cell 
 	std::vector<double>& nearest_gradient( int substrate_index );
@@ -124,6 +126,8 @@ class Basic_Agent
 };
 
 extern std::vector<Basic_Agent*> all_basic_agents; 
+extern int max_basic_agent_ID; // next unused agent ID 
+extern int basic_agent_ID_stride; // 1, or the number of MPI ranks (each rank takes every size-th ID) 
 
 Basic_Agent* create_basic_agent( void );
 void delete_basic_agent( int ); 
@@ -48,6 +48,7 @@
 
 #include "BioFVM_vector.h" 
 #include "BioFVM_mesh.h" 
+#include "BioFVM_utilities.h" 
 
 namespace BioFVM{
 	
@@ -289,6 +290,22 @@ void General_Mesh::display_information( std::ostream& os )
 	return; 
 }
 
+long long General_Mesh::memory_footprint( void )
+{
+	long long out = sizeof( General_Mesh ) + heap_bytes( bounding_box ) + heap_bytes( units ); 
+	out += heap_bytes( voxels ); 
+	for( unsigned int i=0; i < voxels.size() ; i++ )
+	{ out += heap_bytes( voxels[i].center ); }
+	out += heap_bytes( voxel_faces ); 
+	for( unsigned int i=0; i < voxel_faces.size() ; i++ )
+	{
+		out += heap_bytes( voxel_faces[i].center ) + heap_bytes( voxel_faces[i].outward_normal ) 
+			+ heap_bytes( voxel_faces[i].inward_normal ); 
+	}
+	out += heap_bytes( connected_voxel_indices ); 
+	return out; 
+}
+
 void General_Mesh::write_to_matlab( std::string filename )
 { 
 	unsigned int number_of_data_entries = voxels.size();
@@ -408,6 +425,9 @@ Cartesian_Mesh::Cartesian_Mesh()
 	voxels[0].center[0] = x_coordinates[0]; 
 	voxels[0].center[1] = y_coordinates[0]; 
 	voxels[0].center[2] = z_coordinates[0]; 
+	
+	implicit_voxels = false; 
+	dirichlet_voxels.assign( voxels.size() , false ); 
 }
 
 void Cartesian_Mesh::create_voxel_faces( void )
@@ -480,6 +500,7 @@ Cartesian_Mesh::Cartesian_Mesh( int xnodes, int ynodes, int znodes )
 	uniform_mesh = true; 
 	regular_mesh = true; 
 	use_voxel_faces = false; 
+	implicit_voxels = false; 
  
 	for( unsigned int i=0; i < x_coordinates.size() ; i++ )
 	{ x_coordinates[i] = i*dx; }
@@ -501,6 +522,7 @@ Cartesian_Mesh::Cartesian_Mesh( int xnodes, int ynodes, int znodes )
 	units = "none"; 
 	
 	voxels.assign( x_coordinates.size() * y_coordinates.size() * z_coordinates.size() , template_voxel ); 
+	dirichlet_voxels.assign( voxels.size() , false ); 
 
 	// initializing and connecting voxels 
  
@@ -618,6 +640,185 @@ std::vector<unsigned int> Cartesian_Mesh::cartesian_indices( unsigned int n )
 	return out; 
 }
 
+void Cartesian_Mesh::release_voxel_storage( void )
+{
+	// swap with empty containers to actually return the memory 
+	std::vector<Voxel>().swap( voxels ); 
+	std::vector<Voxel_Face>().swap( voxel_faces ); 
+	std::vector< std::vector<int> >().swap( connected_voxel_indices ); 
+	std::vector< std::vector<int> >().swap( moore_connected_voxel_indices ); 
+	return; 
+}
+
+unsigned int Cartesian_Mesh::number_of_voxels( void )
+{
+	if( implicit_voxels )
+	{ return x_coordinates.size() * y_coordinates.size() * z_coordinates.size(); }
+	return voxels.size(); 
+}
+
+std::vector<double> Cartesian_Mesh::voxel_center( unsigned int n )
+{
+	if( implicit_voxels == false )
+	{ return voxels[n].center; }
+	
+	unsigned int nx = x_coordinates.size(); 
+	unsigned int nxy = nx * y_coordinates.size(); 
+	unsigned int k = n / nxy; 
+	unsigned int j = ( n - k*nxy ) / nx; 
+	unsigned int i = n - k*nxy - j*nx; 
+	
+	std::vector<double> center( 3 ); 
+	center[0] = x_coordinates[i]; 
+	center[1] = y_coordinates[j]; 
+	center[2] = z_coordinates[k]; 
+	return center; 
+}
+
+double Cartesian_Mesh::voxel_volume( unsigned int n )
+{
+	if( implicit_voxels )
+	{ return dV; }
+	return voxels[n].volume; 
+}
+
+bool Cartesian_Mesh::is_Dirichlet( unsigned int n )
+{
+	if( implicit_voxels )
+	{ return dirichlet_voxels[n]; }
+	return voxels[n].is_Dirichlet; 
+}
+
+void Cartesian_Mesh::set_Dirichlet( unsigned int n , bool value )
+{
+	if( implicit_voxels )
+	{ dirichlet_voxels[n] = value; }
+	else
+	{ voxels[n].is_Dirichlet = value; }
+	return; 
+}
+
+int Cartesian_Mesh::connected_voxels( unsigned int n , int* neighbors )
+{
+	if( implicit_voxels == false )
+	{
+		int count = connected_voxel_indices[n].size(); 
+		for( int m=0; m < count ; m++ )
+		{ neighbors[m] = connected_voxel_indices[n][m]; }
+		return count; 
+	}
+	
+	unsigned int nx = x_coordinates.size(); 
+	unsigned int ny = y_coordinates.size(); 
+	unsigned int nxy = nx * ny; 
+	unsigned int k = n / nxy; 
+	unsigned int j = ( n - k*nxy ) / nx; 
+	unsigned int i = n - k*nxy - j*nx; 
+	
+	// the order in which resize() connects them: x, then y, then z 
+	int count = 0; 
+	if( i > 0 ){ neighbors[count++] = n - 1; }
+	if( i+1 < nx ){ neighbors[count++] = n + 1; }
+	if( j > 0 ){ neighbors[count++] = n - nx; }
+	if( j+1 < ny ){ neighbors[count++] = n + nx; }
+	if( k > 0 ){ neighbors[count++] = n - nxy; }
+	if( k+1 < z_coordinates.size() ){ neighbors[count++] = n + nxy; }
+	return count; 
+}
+
+int Cartesian_Mesh::moore_neighborhood( unsigned int n , int* neighbors )
+{
+	if( z_coordinates.size() == 1 )
+	{ return moore_neighborhood<2>( n , neighbors ); }
+	return moore_neighborhood<3>( n , neighbors ); 
+}
+
+template <int dimension> 
+int Cartesian_Mesh::moore_neighborhood( unsigned int n , int* neighbors )
+{
+	if( implicit_voxels == false )
+	{
+		int count = moore_connected_voxel_indices[n].size(); 
+		for( int m=0; m < count ; m++ )
+		{ neighbors[m] = moore_connected_voxel_indices[n][m]; }
+		return count; 
+	}
+	
+	int nx = x_coordinates.size(); 
+	int ny = y_coordinates.size(); 
+	int nz = z_coordinates.size(); 
+	int k = n / (nx*ny); 
+	int j = ( n - k*nx*ny ) / nx; 
+	int i = n - k*nx*ny - j*nx; 
+	
+	// same order as create_moore_neighborhood 
+	int count = 0; 
+	for( int ii=-1; ii <= 1 ; ii++ )
+	{
+		if( i+ii < 0 || i+ii >= nx ){ continue; }
+		for( int jj=-1; jj <= 1 ; jj++ )
+		{
+			if( j+jj < 0 || j+jj >= ny ){ continue; }
+			if( dimension == 2 )
+			{
+				if( ii == 0 && jj == 0 ){ continue; }
+				neighbors[count++] = n + jj*nx + ii; 
+				continue; 
+			}
+			for( int kk=-1; kk <= 1 ; kk++ )
+			{
+				if( k+kk < 0 || k+kk >= nz || ( ii == 0 && jj == 0 && kk == 0 ) ){ continue; }
+				neighbors[count++] = ( (k+kk)*ny + j+jj )*nx + i+ii; 
+			}
+		}
+	}
+	return count; 
+}
+
+template int Cartesian_Mesh::moore_neighborhood<2>( unsigned int n , int* neighbors ); 
+template int Cartesian_Mesh::moore_neighborhood<3>( unsigned int n , int* neighbors ); 
+
+Voxel& Cartesian_Mesh::voxel( unsigned int n )
+{
+	if( implicit_voxels == false )
+	{ return voxels[n]; }
+	
+	static thread_local Voxel scratch; 
+	scratch.mesh_index = n; 
+	scratch.volume = dV; 
+	scratch.center = voxel_center( n ); 
+	scratch.is_Dirichlet = dirichlet_voxels[n]; 
+	return scratch; 
+}
+
+void Cartesian_Mesh::write_to_matlab( std::string filename )
+{
+	if( implicit_voxels == false )
+	{ return General_Mesh::write_to_matlab( filename ); }
+	
+	unsigned int number_of_data_entries = number_of_voxels();
+	unsigned int size_of_each_datum = 3 + 1; // x,y,z, volume 
+
+	FILE* fp = write_matlab_header( size_of_each_datum, number_of_data_entries,  filename, "mesh" );  
+
+	// storing data as cols 
+	for( unsigned int k=0; k < z_coordinates.size() ; k++ )
+	{
+		for( unsigned int j=0; j < y_coordinates.size() ; j++ )
+		{
+			for( unsigned int i=0; i < x_coordinates.size() ; i++ )
+			{
+				fwrite( (char*) &( x_coordinates[i] ) , sizeof(double) , 1 , fp ); 
+				fwrite( (char*) &( y_coordinates[j] ) , sizeof(double) , 1 , fp ); 
+				fwrite( (char*) &( z_coordinates[k] ) , sizeof(double) , 1 , fp ); 
+				fwrite( (char*) &dV , sizeof(double) , 1 , fp ); 
+			}
+		}
+	}
+
+	fclose( fp ); 
+}
+
 void Cartesian_Mesh::resize( double x_start, double x_end, double y_start, double y_end, double z_start, double z_end , int x_nodes, int y_nodes, int z_nodes )
 {
 	x_coordinates.assign( x_nodes , 0.0 ); 
@@ -666,6 +867,15 @@ void Cartesian_Mesh::resize( double x_start, double x_end, double y_start, doubl
 	dS_yz = dy*dz; 
 	dS_xz = dx*dz; 
 
+	// in implicit mode nothing is stored per voxel: centers, volumes and 
+	// neighbors come from (i,j,k) 
+	dirichlet_voxels.assign( x_coordinates.size() * y_coordinates.size() * z_coordinates.size() , false ); 
+	if( implicit_voxels )
+	{
+		release_voxel_storage(); 
+		return; 
+	}
+	
 	Voxel template_voxel;
 	template_voxel.volume = dV; 
 
@@ -788,6 +998,15 @@ void Cartesian_Mesh::resize( double x_start, double x_end, double y_start, doubl
 	dS_yz = dy*dz; 
 	dS_xz = dx*dz; 
 	
+	// in implicit mode nothing is stored per voxel: centers, volumes and 
+	// neighbors come from (i,j,k) 
+	dirichlet_voxels.assign( x_coordinates.size() * y_coordinates.size() * z_coordinates.size() , false ); 
+	if( implicit_voxels )
+	{
+		release_voxel_storage(); 
+		return; 
+	}
+	
 	Voxel template_voxel;
 	template_voxel.volume = dV; 
 
@@ -877,11 +1096,18 @@ void Cartesian_Mesh::resize( int x_nodes, int y_nodes, int z_nodes )
 void Cartesian_Mesh::resize_uniform( double x_start, double x_end, double y_start, double y_end, double z_start, double z_end , double dx_new )
 { return resize( x_start, x_end, y_start, y_end, z_start, z_end , dx_new, dx_new , dx_new ); }
 
+int Cartesian_Mesh::nearest_voxel_index( std::vector<double>& position )
+{
+	if( z_coordinates.size() == 1 )
+	{ return nearest_voxel_index<2>( position ); }
+	return nearest_voxel_index<3>( position ); 
+}
+
+template <int dimension> 
 int Cartesian_Mesh::nearest_voxel_index( std::vector<double>& position )
 {
 	unsigned int i = (unsigned int) floor( (position[0]-bounding_box[0])/dx ); 
 	unsigned int j = (unsigned int) floor( (position[1]-bounding_box[1])/dy ); 
-	unsigned int k = (unsigned int) floor( (position[2]-bounding_box[2])/dz ); 
 
 	//  add some bounds checking -- truncate to inside the computational domain   
 
@@ -891,12 +1117,20 @@ int Cartesian_Mesh::nearest_voxel_index( std::vector<double>& position )
 	if( j >= y_coordinates.size() ){ j = y_coordinates.size()-1; }
 	if( j < 0 ){ j = 0; }
 
+	// a single z layer: no k to compute 
+	if( dimension == 2 )
+	{ return j*x_coordinates.size() + i; }
+
+	unsigned int k = (unsigned int) floor( (position[2]-bounding_box[2])/dz ); 
 	if( k >= z_coordinates.size() ){ k = z_coordinates.size()-1; }
 	if( k < 0 ){ k = 0; }
 
 	return ( k*y_coordinates.size() + j )*x_coordinates.size() + i; 
 }
 
+template int Cartesian_Mesh::nearest_voxel_index<2>( std::vector<double>& position ); 
+template int Cartesian_Mesh::nearest_voxel_index<3>( std::vector<double>& position ); 
+
 std::vector<unsigned int> Cartesian_Mesh::nearest_cartesian_indices( std::vector<double>& position )
 {
 	std::vector<unsigned int> out; 
@@ -920,7 +1154,7 @@ std::vector<unsigned int> Cartesian_Mesh::nearest_cartesian_indices( std::vector
 }
 
 Voxel& Cartesian_Mesh::nearest_voxel( std::vector<double>& position )
-{ return voxels[ nearest_voxel_index( position ) ]; }
+{ return voxel( nearest_voxel_index( position ) ); }
 
 void Cartesian_Mesh::display_information( std::ostream& os )
 {
@@ -945,7 +1179,7 @@ void Cartesian_Mesh::display_information( std::ostream& os )
 			<< ", dz = " << dz << " " << units ; 
 	}
 	os << std::endl 
-	<< "   voxels: " << voxels.size() << std::endl
+	<< "   voxels: " << number_of_voxels() << ( implicit_voxels ? " (implicit)" : "" ) << std::endl
 	<< "   voxel faces: " << voxel_faces.size() << std::endl
 	<< "   volume: " << ( bounding_box[3]-bounding_box[0] )*( bounding_box[4]-bounding_box[1] )*( bounding_box[5]-bounding_box[2] ) 
 		<< " cubic " << units << std::endl; 	
@@ -953,6 +1187,15 @@ void Cartesian_Mesh::display_information( std::ostream& os )
 	return; 
 }
 
+long long Cartesian_Mesh::memory_footprint( void )
+{
+	long long out = General_Mesh::memory_footprint() - sizeof( General_Mesh ) + sizeof( Cartesian_Mesh ); 
+	out += heap_bytes( x_coordinates ) + heap_bytes( y_coordinates ) + heap_bytes( z_coordinates ); 
+	out += heap_bytes( moore_connected_voxel_indices ); 
+	out += heap_bytes( dirichlet_voxels ); 
+	return out; 
+}
+
 void Cartesian_Mesh::read_from_matlab( std::string filename )
 {
 	unsigned int size_of_each_datum; 
@@ -968,6 +1211,7 @@ void Cartesian_Mesh::read_from_matlab( std::string filename )
 	uniform_mesh = false; 
 	regular_mesh = true; 
 	use_voxel_faces = false; 
+	implicit_voxels = false; 
 
 	// resize the internal data structure 
 
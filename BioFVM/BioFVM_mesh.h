@@ -158,6 +158,8 @@ class General_Mesh
 	std::string units; 
 	
 	void display_information( std::ostream& os); 
+	// bytes of the object and the memory it holds 
+	long long memory_footprint( void ); 
 	
 	void write_to_matlab( std::string filename ); 
 	void read_from_matlab( std::string filename ); 
@@ -166,6 +168,7 @@ class General_Mesh
 class Cartesian_Mesh : public General_Mesh
 {
  private:
+	void release_voxel_storage( void ); 
  
  public:
 	std::vector<double> x_coordinates; 
@@ -176,6 +179,30 @@ class Cartesian_Mesh : public General_Mesh
 	unsigned int voxel_index( unsigned int i, unsigned int j, unsigned int k ); 
 	std::vector<unsigned int> cartesian_indices( unsigned int n ); 
 	
+	/*! Implicit (matrix-free) mode for regular meshes. Set implicit_voxels before resize: 
+	    no Voxel objects, connected_voxel_indices or moore_connected_voxel_indices are 
+	    stored. Centers, volumes and neighbor stencils are computed from (i,j,k), and the 
+	    Dirichlet flags are kept in the dirichlet_voxels bitset. Use the accessors below 
+	    (they work in both modes) instead of reading voxels[n] directly. */ 
+	bool implicit_voxels; 
+	std::vector<bool> dirichlet_voxels; 
+	
+	unsigned int number_of_voxels( void ); 
+	std::vector<double> voxel_center( unsigned int n ); 
+	double voxel_volume( unsigned int n ); 
+	bool is_Dirichlet( unsigned int n ); 
+	void set_Dirichlet( unsigned int n , bool value ); 
+	// fill neighbors (up to 6 face neighbors, or up to 26 Moore neighbors) in the same 
+	// order as connected_voxel_indices[n] and moore_connected_voxel_indices[n]; return the count 
+	int connected_voxels( unsigned int n , int* neighbors ); 
+	int moore_neighborhood( unsigned int n , int* neighbors ); 
+	// the same, specialized at compile time for dimension 2 (up to 8 Moore neighbors, 
+	// requires a single z layer) or 3; the untemplated form picks one from the mesh 
+	template <int dimension> int moore_neighborhood( unsigned int n , int* neighbors ); 
+	// voxels[n], or (in implicit mode) a per-thread copy built on the fly that is 
+	// overwritten by the next call on that thread 
+	Voxel& voxel( unsigned int n ); 
+	
 	double dx;
 	double dy;
 	double dz; 
@@ -199,12 +226,15 @@ class Cartesian_Mesh : public General_Mesh
 	void resize_uniform( double x_start, double x_end, double y_start, double y_end, double z_start, double z_end , double dx ); 
 	
 	int nearest_voxel_index( std::vector<double>& position );   
+	template <int dimension> int nearest_voxel_index( std::vector<double>& position ); // dimension 2: k = 0 
 	int nearest_voxel_face_index( std::vector<double>& position );  
 	std::vector<unsigned int> nearest_cartesian_indices( std::vector<double>& position ); 
 	Voxel& nearest_voxel( std::vector<double>& position ); 
 	
 	void display_information( std::ostream& os ); 
+	long long memory_footprint( void ); 
 	
+	void write_to_matlab( std::string filename ); 
 	void read_from_matlab( std::string filename ); 
 };
 
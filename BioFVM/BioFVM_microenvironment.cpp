@@ -52,6 +52,9 @@
 #include <cmath>
 
 #include "BioFVM_basic_agent.h"
+#include "BioFVM_MPI.h"
+#include "BioFVM_trace.h"
+#include "BioFVM_utilities.h"
 
 namespace BioFVM{
 
@@ -60,6 +63,10 @@ extern std::string BioFVM_URL;
 
 Microenvironment* default_microenvironment = NULL; 
 
+// v at the storage precision of the densities (see real_t) 
+std::vector<real_t> density_storage( const std::vector<double>& v )
+{ return std::vector<real_t>( v.begin() , v.end() ); }
+
 void set_default_microenvironment( Microenvironment* M )
 { default_microenvironment = M; }
 Microenvironment* get_default_microenvironment( void )
@@ -114,6 +121,14 @@ Microenvironment::Microenvironment()
 	bulk_source_sink_solver_setup_done = false; 
 	thomas_setup_done = false; 
 	diffusion_solver_setup_done = false; 
+	thomas_coefficients_stale = true; 
+	
+	diffusion_step_tolerance = 0.01; 
+	max_diffusion_step_multiple = 64; 
+	steady_state_tolerance = 1e-6; 
+	steady_state_max_cycles = 50; 
+	
+	decomposed = false; 
 
 	diffusion_decay_solver = empty_diffusion_solver;
 	diffusion_decay_solver = diffusion_decay_solver__constant_coefficients_LOD_3D; 
@@ -123,17 +138,17 @@ Microenvironment::Microenvironment()
 	one.resize( 1 , 1.0 ); 
 	zero.resize( 1 , 0.0 );
 	
-	temporary_density_vectors1.resize( mesh.voxels.size() , zero ); 
-	temporary_density_vectors2.resize( mesh.voxels.size() , zero ); 
+	temporary_density_vectors1.resize( mesh.number_of_voxels() , density_storage( zero ) ); 
+	temporary_density_vectors2.resize( mesh.number_of_voxels() , density_storage( zero ) ); 
 	p_density_vectors = &temporary_density_vectors1;
 
-	gradient_vectors.resize( mesh.voxels.size() ); 
-	for( unsigned int k=0 ; k < mesh.voxels.size() ; k++ )
+	gradient_vectors.resize( mesh.number_of_voxels() ); 
+	for( unsigned int k=0 ; k < mesh.number_of_voxels() ; k++ )
 	{
 		gradient_vectors[k].resize( 1 ); 
 		(gradient_vectors[k])[0].resize( 3, 0.0 );
 	}
-	gradient_vector_computed.resize( mesh.voxels.size() , false ); 
+	gradient_vector_computed.resize( mesh.number_of_voxels() , false ); 
 
 	bulk_supply_rate_function = zero_function; 
 	bulk_supply_target_densities_function = zero_function; 
@@ -157,7 +172,7 @@ Microenvironment::Microenvironment()
 	
 	dirichlet_node_map.assign( mesh.voxels.size() , -1 ); 
 */
-	dirichlet_value_vectors.assign( mesh.voxels.size(), one ); 
+	dirichlet_value_vectors.assign( mesh.number_of_voxels(), density_storage( one ) ); 
 	dirichlet_activation_vector.assign( 1 , true ); 
 	
 	if(default_microenvironment==NULL)
@@ -176,13 +191,13 @@ Microenvironment::Microenvironment(std::string name)
 
 void Microenvironment::add_dirichlet_node( int voxel_index, std::vector<double>& value )
 {
-	mesh.voxels[voxel_index].is_Dirichlet=true;
+	mesh.set_Dirichlet( voxel_index , true ); 
 	/*
 	dirichlet_indices.push_back( voxel_index );
 	dirichlet_value_vectors.push_back( value ); 
 	*/
 	
-	dirichlet_value_vectors[voxel_index] = value; // .assign( mesh.voxels.size(), one ); 
+	dirichlet_value_vectors[voxel_index].assign( value.begin() , value.end() ); // .assign( mesh.voxels.size(), one ); 
 	
 	return; 
 }
@@ -211,22 +226,22 @@ void Microenvironment::update_dirichlet_node( int voxel_index , std::vector<doub
 	dirichlet_value_vectors[n] = new_value; 
 	*/
 	
-	mesh.voxels[voxel_index].is_Dirichlet = true; 
-	dirichlet_value_vectors[voxel_index] = new_value; 
+	mesh.set_Dirichlet( voxel_index , true ); 
+	dirichlet_value_vectors[voxel_index].assign( new_value.begin() , new_value.end() ); 
 	
 	return; 
 }
 
 void Microenvironment::update_dirichlet_node( int voxel_index , int substrate_index , double new_value )
 {
-	mesh.voxels[voxel_index].is_Dirichlet = true; 
+	mesh.set_Dirichlet( voxel_index , true ); 
 	dirichlet_value_vectors[voxel_index][substrate_index] = new_value; 
 	return; 
 }
 
 void Microenvironment::remove_dirichlet_node( int voxel_index )
 {
-	mesh.voxels[voxel_index].is_Dirichlet = false; 
+	mesh.set_Dirichlet( voxel_index , false ); 
 	
 /*	
 	if( mesh.voxels[voxel_index].is_Dirichlet == false )
@@ -256,9 +271,9 @@ void Microenvironment::remove_dirichlet_node( int voxel_index )
 	return; 
 }
 
-bool& Microenvironment::is_dirichlet_node( int voxel_index )
+bool Microenvironment::is_dirichlet_node( int voxel_index )
 {
-	return mesh.voxels[voxel_index].is_Dirichlet; 
+	return mesh.is_Dirichlet( voxel_index ); 
 }
 
 void Microenvironment::set_substrate_dirichlet_activation( int substrate_index , bool new_value )
@@ -281,13 +296,13 @@ void Microenvironment::apply_dirichlet_conditions( void )
 	*/
 
 	#pragma omp parallel for 
-	for( unsigned int i=0 ; i < mesh.voxels.size() ;i++ )
+	for( unsigned int i=0 ; i < mesh.number_of_voxels() ;i++ )
 	{
 		/*
-		if( mesh.voxels[i].is_Dirichlet == true )
+		if( mesh.is_Dirichlet( i ) == true )
 		{ density_vector(i) = dirichlet_value_vectors[i]; }
 		*/
-		if( mesh.voxels[i].is_Dirichlet == true )
+		if( mesh.is_Dirichlet( i ) == true )
 		{
 			for( unsigned int j=0; j < dirichlet_value_vectors[i].size(); j++ )
 			{
@@ -311,13 +326,14 @@ void Microenvironment::resize_voxels( int new_number_of_voxes )
 		return; 
 	}
 	
+	mesh.implicit_voxels = false; 
 	mesh.voxels.resize( new_number_of_voxes ); 
 	
-	temporary_density_vectors1.resize( mesh.voxels.size() , zero ); 
-	temporary_density_vectors2.resize( mesh.voxels.size() , zero ); 
+	temporary_density_vectors1.resize( mesh.number_of_voxels() , density_storage( zero ) ); 
+	temporary_density_vectors2.resize( mesh.number_of_voxels() , density_storage( zero ) ); 
 		
-	gradient_vectors.resize( mesh.voxels.size() ); 
-	for( unsigned int k=0 ; k < mesh.voxels.size() ; k++ )
+	gradient_vectors.resize( mesh.number_of_voxels() ); 
+	for( unsigned int k=0 ; k < mesh.number_of_voxels() ; k++ )
 	{
 		gradient_vectors[k].resize( number_of_densities() ); 
 		for( unsigned int i=0 ; i < number_of_densities() ; i++ )
@@ -325,9 +341,9 @@ void Microenvironment::resize_voxels( int new_number_of_voxes )
 			(gradient_vectors[k])[i].resize( 3, 0.0 );
 		}
 	}
-	gradient_vector_computed.resize( mesh.voxels.size() , false ); 	
+	gradient_vector_computed.resize( mesh.number_of_voxels() , false ); 	
 	
-	dirichlet_value_vectors.assign( mesh.voxels.size(), one ); 
+	dirichlet_value_vectors.assign( mesh.number_of_voxels(), density_storage( one ) ); 
 	
 	return; 
 }
@@ -337,11 +353,11 @@ void Microenvironment::resize_space( int x_nodes, int y_nodes, int z_nodes )
 {
 	mesh.resize( x_nodes, y_nodes , z_nodes ); 
 
-	temporary_density_vectors1.assign( mesh.voxels.size() , zero ); 
-	temporary_density_vectors2.assign( mesh.voxels.size() , zero ); 
+	temporary_density_vectors1.assign( mesh.number_of_voxels() , density_storage( zero ) ); 
+	temporary_density_vectors2.assign( mesh.number_of_voxels() , density_storage( zero ) ); 
 		
-	gradient_vectors.resize( mesh.voxels.size() ); 
-	for( unsigned int k=0 ; k < mesh.voxels.size() ; k++ )
+	gradient_vectors.resize( mesh.number_of_voxels() ); 
+	for( unsigned int k=0 ; k < mesh.number_of_voxels() ; k++ )
 	{
 		gradient_vectors[k].resize( number_of_densities() ); 
 		for( unsigned int i=0 ; i < number_of_densities() ; i++ )
@@ -349,9 +365,9 @@ void Microenvironment::resize_space( int x_nodes, int y_nodes, int z_nodes )
 			(gradient_vectors[k])[i].resize( 3, 0.0 );
 		}
 	}
-	gradient_vector_computed.resize( mesh.voxels.size() , false ); 	
+	gradient_vector_computed.resize( mesh.number_of_voxels() , false ); 	
 	
-	dirichlet_value_vectors.assign( mesh.voxels.size(), one ); 
+	dirichlet_value_vectors.assign( mesh.number_of_voxels(), density_storage( one ) ); 
 
 	return;  
 }
@@ -360,11 +376,11 @@ void Microenvironment::resize_space( double x_start, double x_end, double y_star
 {
 	mesh.resize( x_start, x_end, y_start, y_end, z_start, z_end, x_nodes, y_nodes , z_nodes  ); 
 
-	temporary_density_vectors1.assign( mesh.voxels.size() , zero ); 
-	temporary_density_vectors2.assign( mesh.voxels.size() , zero ); 
+	temporary_density_vectors1.assign( mesh.number_of_voxels() , density_storage( zero ) ); 
+	temporary_density_vectors2.assign( mesh.number_of_voxels() , density_storage( zero ) ); 
 	
-	gradient_vectors.resize( mesh.voxels.size() ); 
-	for( unsigned int k=0 ; k < mesh.voxels.size() ; k++ )
+	gradient_vectors.resize( mesh.number_of_voxels() ); 
+	for( unsigned int k=0 ; k < mesh.number_of_voxels() ; k++ )
 	{
 		gradient_vectors[k].resize( number_of_densities() ); 
 		for( unsigned int i=0 ; i < number_of_densities() ; i++ )
@@ -372,9 +388,9 @@ void Microenvironment::resize_space( double x_start, double x_end, double y_star
 			(gradient_vectors[k])[i].resize( 3, 0.0 );
 		}
 	}
-	gradient_vector_computed.resize( mesh.voxels.size() , false ); 	
+	gradient_vector_computed.resize( mesh.number_of_voxels() , false ); 	
 
-	dirichlet_value_vectors.assign( mesh.voxels.size(), one ); 
+	dirichlet_value_vectors.assign( mesh.number_of_voxels(), density_storage( one ) ); 
 	
 	return;  
 }
@@ -383,11 +399,11 @@ void Microenvironment::resize_space( double x_start, double x_end, double y_star
 {
 	mesh.resize( x_start, x_end, y_start, y_end, z_start, z_end,  dx_new , dy_new , dz_new ); 
 
-	temporary_density_vectors1.assign( mesh.voxels.size() , zero ); 
-	temporary_density_vectors2.assign( mesh.voxels.size() , zero ); 
+	temporary_density_vectors1.assign( mesh.number_of_voxels() , density_storage( zero ) ); 
+	temporary_density_vectors2.assign( mesh.number_of_voxels() , density_storage( zero ) ); 
 	
-	gradient_vectors.resize( mesh.voxels.size() ); 
-	for( unsigned int k=0 ; k < mesh.voxels.size() ; k++ )
+	gradient_vectors.resize( mesh.number_of_voxels() ); 
+	for( unsigned int k=0 ; k < mesh.number_of_voxels() ; k++ )
 	{
 		gradient_vectors[k].resize( number_of_densities() ); 
 		for( unsigned int i=0 ; i < number_of_densities() ; i++ )
@@ -395,9 +411,9 @@ void Microenvironment::resize_space( double x_start, double x_end, double y_star
 			(gradient_vectors[k])[i].resize( 3, 0.0 );
 		}
 	}
-	gradient_vector_computed.resize( mesh.voxels.size() , false ); 	
+	gradient_vector_computed.resize( mesh.number_of_voxels() , false ); 	
 	
-	dirichlet_value_vectors.assign( mesh.voxels.size(), one ); 
+	dirichlet_value_vectors.assign( mesh.number_of_voxels(), density_storage( one ) ); 
 	
 	return;  
 }
@@ -407,15 +423,53 @@ void Microenvironment::resize_space_uniform( double x_start, double x_end, doubl
  return resize_space( x_start, x_end, y_start, y_end, z_start, z_end , dx_new , dx_new, dx_new ); 
 }
 
+int Microenvironment::number_of_voxel_partitions( void )
+{
+	if( mesh.z_coordinates.size() > 1 )
+	{ return mesh.z_coordinates.size(); }
+	return mesh.y_coordinates.size(); 
+}
+
+int Microenvironment::voxel_partition_length( void )
+{
+	if( mesh.z_coordinates.size() > 1 )
+	{ return mesh.x_coordinates.size() * mesh.y_coordinates.size(); }
+	return mesh.x_coordinates.size(); 
+}
+
+void Microenvironment::first_touch_voxel_data( void )
+{
+	int partitions = number_of_voxel_partitions(); 
+	int length = voxel_partition_length(); 
+	if( partitions * length != mesh.number_of_voxels() )
+	{ return; } // not a Cartesian mesh 
+	
+	// copying each vector from the owning thread moves its storage into 
+	// that thread's memory (malloc arenas are per thread, and pages are 
+	// placed on first touch) 
+	#pragma omp parallel for 
+	for( int p=0; p < partitions ; p++ )
+	{
+		for( int n=p*length; n < (p+1)*length ; n++ )
+		{
+			std::vector<real_t>( temporary_density_vectors1[n] ).swap( temporary_density_vectors1[n] ); 
+			std::vector<real_t>( temporary_density_vectors2[n] ).swap( temporary_density_vectors2[n] ); 
+			std::vector<real_t>( dirichlet_value_vectors[n] ).swap( dirichlet_value_vectors[n] ); 
+			std::vector<gradient>( gradient_vectors[n] ).swap( gradient_vectors[n] ); 
+		}
+	}
+	return; 
+}
+
 void Microenvironment::resize_densities( int new_size )
 {
 	zero.assign( new_size, 0.0 ); 
 	one.assign( new_size , 1.0 );
 
-	temporary_density_vectors1.assign( mesh.voxels.size() , zero );
-	temporary_density_vectors2.assign( mesh.voxels.size() , zero );
+	temporary_density_vectors1.assign( mesh.number_of_voxels() , density_storage( zero ) );
+	temporary_density_vectors2.assign( mesh.number_of_voxels() , density_storage( zero ) );
 
-	for( unsigned int k=0 ; k < mesh.voxels.size() ; k++ )
+	for( unsigned int k=0 ; k < mesh.number_of_voxels() ; k++ )
 	{
 		gradient_vectors[k].resize( number_of_densities() ); 
 		for( unsigned int i=0 ; i < number_of_densities() ; i++ )
@@ -423,7 +477,7 @@ void Microenvironment::resize_densities( int new_size )
 			(gradient_vectors[k])[i].resize( 3, 0.0 );
 		}
 	}
-	gradient_vector_computed.resize( mesh.voxels.size() , false ); 	
+	gradient_vector_computed.resize( mesh.number_of_voxels() , false ); 	
 	
 	diffusion_coefficients.assign( new_size , 0.0 ); 
 	decay_rates.assign( new_size , 0.0 ); 
@@ -437,7 +491,7 @@ void Microenvironment::resize_densities( int new_size )
 	one_third = one; 
 	one_third /= 3.0; 
 	
-	dirichlet_value_vectors.assign( mesh.voxels.size(), one ); 
+	dirichlet_value_vectors.assign( mesh.number_of_voxels(), density_storage( one ) ); 
 	dirichlet_activation_vector.assign( new_size, true ); 
 
 	default_microenvironment_options.Dirichlet_condition_vector.assign( new_size , 1.0 );  
@@ -473,7 +527,7 @@ void Microenvironment::add_density( void )
 	}
 
 	// resize the gradient data structures 
-	for( unsigned int k=0 ; k < mesh.voxels.size() ; k++ )
+	for( unsigned int k=0 ; k < mesh.number_of_voxels() ; k++ )
 	{
 		gradient_vectors[k].resize( number_of_densities() ); 
 		for( unsigned int i=0 ; i < number_of_densities() ; i++ )
@@ -482,7 +536,7 @@ void Microenvironment::add_density( void )
 		}
 	}
 
-	gradient_vector_computed.resize( mesh.voxels.size() , false ); 	
+	gradient_vector_computed.resize( mesh.number_of_voxels() , false ); 	
 	
 	one_half = one; 
 	one_half *= 0.5; 
@@ -490,7 +544,7 @@ void Microenvironment::add_density( void )
 	one_third = one; 
 	one_third /= 3.0; 
 	
-	dirichlet_value_vectors.assign( mesh.voxels.size(), one ); 
+	dirichlet_value_vectors.assign( mesh.number_of_voxels(), density_storage( one ) ); 
 	dirichlet_activation_vector.assign( number_of_densities(), true ); 
 	
 	// Fixes in PhysiCell preview November 2017
@@ -527,7 +581,7 @@ void Microenvironment::add_density( std::string name , std::string units )
 	}
 
 	// resize the gradient data structures, 
-	for( unsigned int k=0 ; k < mesh.voxels.size() ; k++ )
+	for( unsigned int k=0 ; k < mesh.number_of_voxels() ; k++ )
 	{
 		gradient_vectors[k].resize( number_of_densities() ); 
 		for( unsigned int i=0 ; i < number_of_densities() ; i++ )
@@ -535,7 +589,7 @@ void Microenvironment::add_density( std::string name , std::string units )
 			(gradient_vectors[k])[i].resize( 3, 0.0 );
 		}
 	}
-	gradient_vector_computed.resize( mesh.voxels.size() , false ); 	
+	gradient_vector_computed.resize( mesh.number_of_voxels() , false ); 	
 
 	one_half = one; 
 	one_half *= 0.5; 
@@ -543,7 +597,7 @@ void Microenvironment::add_density( std::string name , std::string units )
 	one_third = one; 
 	one_third /= 3.0; 
 	
-	dirichlet_value_vectors.assign( mesh.voxels.size(), one ); 
+	dirichlet_value_vectors.assign( mesh.number_of_voxels(), density_storage( one ) ); 
 	dirichlet_activation_vector.assign( number_of_densities(), true ); 
 	
 	// fix in PhysiCell preview November 2017 
@@ -580,7 +634,7 @@ void Microenvironment::add_density( std::string name , std::string units, double
 	}
 
 	// resize the gradient data structures 
-	for( unsigned int k=0 ; k < mesh.voxels.size() ; k++ )
+	for( unsigned int k=0 ; k < mesh.number_of_voxels() ; k++ )
 	{
 		gradient_vectors[k].resize( number_of_densities() ); 
 		for( unsigned int i=0 ; i < number_of_densities() ; i++ )
@@ -588,7 +642,7 @@ void Microenvironment::add_density( std::string name , std::string units, double
 			(gradient_vectors[k])[i].resize( 3, 0.0 );
 		}
 	}
-	gradient_vector_computed.resize( mesh.voxels.size() , false ); 	
+	gradient_vector_computed.resize( mesh.number_of_voxels() , false ); 	
 
 	one_half = one; 
 	one_half *= 0.5; 
@@ -596,7 +650,7 @@ void Microenvironment::add_density( std::string name , std::string units, double
 	one_third = one; 
 	one_third /= 3.0; 
 	
-	dirichlet_value_vectors.assign( mesh.voxels.size(), one ); 
+	dirichlet_value_vectors.assign( mesh.number_of_voxels(), density_storage( one ) ); 
 	dirichlet_activation_vector.assign( number_of_densities(), true ); 
 	
 	// fix in PhysiCell preview November 2017 
@@ -653,7 +707,7 @@ int Microenvironment::nearest_voxel_index( std::vector<double>& position )
 { return mesh.nearest_voxel_index( position ); }
 
 Voxel& Microenvironment::voxels( int voxel_index )
-{ return mesh.voxels[voxel_index]; }
+{ return mesh.voxel( voxel_index ); }
 
 std::vector<unsigned int> Microenvironment::nearest_cartesian_indices( std::vector<double>& position )
 { return mesh.nearest_cartesian_indices( position ); }
@@ -661,32 +715,33 @@ std::vector<unsigned int> Microenvironment::nearest_cartesian_indices( std::vect
 Voxel& Microenvironment::nearest_voxel( std::vector<double>& position )
 { return mesh.nearest_voxel( position ); }
 
-std::vector<double>& Microenvironment::nearest_density_vector( std::vector<double>& position )
+std::vector<real_t>& Microenvironment::nearest_density_vector( std::vector<double>& position )
 { return (*p_density_vectors)[ mesh.nearest_voxel_index( position ) ]; }
 
-std::vector<double>& Microenvironment::nearest_density_vector( int voxel_index )
+std::vector<real_t>& Microenvironment::nearest_density_vector( int voxel_index )
 { return (*p_density_vectors)[ voxel_index ]; }
 
-std::vector<double>& Microenvironment::operator()( int i, int j, int k )
+std::vector<real_t>& Microenvironment::operator()( int i, int j, int k )
 { return (*p_density_vectors)[ voxel_index(i,j,k) ]; }
 
-std::vector<double>& Microenvironment::operator()( int i, int j )
+std::vector<real_t>& Microenvironment::operator()( int i, int j )
 { return (*p_density_vectors)[ voxel_index(i,j,0) ]; }
 
-std::vector<double>& Microenvironment::operator()( int n )
+std::vector<real_t>& Microenvironment::operator()( int n )
 { return (*p_density_vectors)[ n ]; }
 
-std::vector<double>& Microenvironment::density_vector( int i, int j, int k )
+std::vector<real_t>& Microenvironment::density_vector( int i, int j, int k )
 { return (*p_density_vectors)[ voxel_index(i,j,k) ]; }
 
-std::vector<double>& Microenvironment::density_vector( int i, int j )
+std::vector<real_t>& Microenvironment::density_vector( int i, int j )
 { return (*p_density_vectors)[ voxel_index(i,j,0) ]; }
 
-std::vector<double>& Microenvironment::density_vector( int n )
+std::vector<real_t>& Microenvironment::density_vector( int n )
 { return (*p_density_vectors)[ n ]; }
 
 void Microenvironment::simulate_diffusion_decay( double dt )
 {
+	BIOFVM_TRACE_SCOPE( "simulate_diffusion_decay" ); 
 	if( diffusion_decay_solver )
 	{ diffusion_decay_solver( *this, dt ); }
 	else
@@ -698,6 +753,163 @@ void Microenvironment::simulate_diffusion_decay( double dt )
 	return; 
 }
 
+void Microenvironment::set_substrate_time_stepping( int substrate_index , int step_multiple , bool adaptive , std::string solver_type )
+{
+	if( substrate_index < 0 || substrate_index >= number_of_densities() )
+	{
+		std::cout << "Error: substrate index " << substrate_index << " is out of range in " << __FUNCTION__ << "." << std::endl; 
+		return; 
+	}
+	if( solver_type != "LOD" && solver_type != "decay_only" && solver_type != "steady" )
+	{
+		std::cout << "Warning: unknown substrate solver type " << solver_type << " for " << density_names[substrate_index] 
+			<< ". Using LOD." << std::endl; 
+		solver_type = "LOD"; 
+	}
+	if( solver_type == "steady" && domain_decomposition.active )
+	{
+		std::cout << "Error: the steady solver type is not supported in MPI runs (" << density_names[substrate_index] 
+			<< "). Using LOD." << std::endl; 
+		solver_type = "LOD"; 
+	}
+	if( step_multiple < 1 )
+	{ step_multiple = 1; }
+	
+	diffusion_step_multiples.resize( number_of_densities() , 1 ); 
+	adaptive_diffusion_steps.resize( number_of_densities() , false ); 
+	diffusion_solver_types.resize( number_of_densities() , "LOD" ); 
+	
+	diffusion_step_multiples[substrate_index] = step_multiple; 
+	adaptive_diffusion_steps[substrate_index] = adaptive; 
+	diffusion_solver_types[substrate_index] = solver_type; 
+	thomas_coefficients_stale = true; 
+	return; 
+}
+
+bool Microenvironment::plan_substrate_solves( double dt )
+{
+	int n = number_of_densities(); 
+	if( diffusion_steps_since_solve.size() != n )
+	{
+		diffusion_step_multiples.resize( n , 1 ); 
+		adaptive_diffusion_steps.resize( n , false ); 
+		diffusion_solver_types.resize( n , "LOD" ); 
+		
+		// so that every substrate is solved on the first step 
+		diffusion_steps_since_solve.resize( n ); 
+		for( int i=0; i < n; i++ )
+		{ diffusion_steps_since_solve[i] = diffusion_step_multiples[i]-1; }
+		thomas_dt.assign( n , 0.0 ); 
+		diffusion_change_samples.resize( n ); 
+	}
+	
+	substrate_solve_dt.assign( n , 0.0 ); 
+	solved_substrates.clear(); 
+	for( int i=0; i < n; i++ )
+	{
+		diffusion_steps_since_solve[i]++; 
+		if( diffusion_steps_since_solve[i] >= diffusion_step_multiples[i] )
+		{
+			substrate_solve_dt[i] = diffusion_steps_since_solve[i] * dt; 
+			diffusion_steps_since_solve[i] = 0; 
+			solved_substrates.push_back( i ); 
+			
+			if( thomas_dt[i] != substrate_solve_dt[i] )
+			{
+				thomas_dt[i] = substrate_solve_dt[i]; 
+				thomas_coefficients_stale = true; 
+			}
+		}
+	}
+	
+	// quasi-steady substrates have their own solve (see LOD_solve_substrate_subset) 
+	for( int i=0; i < n; i++ )
+	{
+		if( diffusion_solver_types[i] == "steady" )
+		{ return false; }
+	}
+	
+	return solved_substrates.size() == n; 
+}
+
+void Microenvironment::apply_substrate_solver_types( void )
+{
+	for( int i=0; i < diffusion_solver_types.size(); i++ )
+	{
+		if( diffusion_solver_types[i] == "decay_only" )
+		{ thomas_constant1[i] = 0.0; }
+	}
+	return; 
+}
+
+int Microenvironment::first_adaptive_sample( int& stride )
+{
+	// every stride-th voxel of the whole domain, so that an MPI run samples the same voxels 
+	int voxels = number_of_voxels(); 
+	if( decomposed )
+	{ voxels = domain_decomposition.global_voxels; }
+	stride = voxels / 4096; 
+	if( stride < 1 )
+	{ stride = 1; }
+	
+	if( decomposed == false )
+	{ return 0; }
+	return ( stride - domain_decomposition.first_voxel % stride ) % stride; 
+}
+
+void Microenvironment::sample_adaptive_substrates( void )
+{
+	int stride; 
+	int first = first_adaptive_sample( stride ); 
+	
+	for( int m=0; m < solved_substrates.size(); m++ )
+	{
+		int i = solved_substrates[m]; 
+		if( adaptive_diffusion_steps[i] == false )
+		{ continue; }
+		
+		diffusion_change_samples[i].clear(); 
+		for( int n=first; n < number_of_voxels(); n += stride )
+		{ diffusion_change_samples[i].push_back( (*p_density_vectors)[n][i] ); }
+	}
+	return; 
+}
+
+void Microenvironment::update_adaptive_step_multiples( void )
+{
+	int stride; 
+	int first = first_adaptive_sample( stride ); 
+	
+	for( int m=0; m < solved_substrates.size(); m++ )
+	{
+		int i = solved_substrates[m]; 
+		if( adaptive_diffusion_steps[i] == false )
+		{ continue; }
+		
+		// largest change over the solve, relative to the largest value 
+		double max_change = 0.0; 
+		double max_value = 0.0; 
+		for( int s=0; s < diffusion_change_samples[i].size(); s++ )
+		{
+			double value = (*p_density_vectors)[first+s*stride][i]; 
+			double change = fabs( value - diffusion_change_samples[i][s] ); 
+			if( change > max_change )
+			{ max_change = change; }
+			if( fabs( value ) > max_value )
+			{ max_value = fabs( value ); }
+		}
+		max_change = domain_decomposition.global_maximum( max_change ); 
+		max_value = domain_decomposition.global_maximum( max_value ); 
+		double relative_change = max_change / ( max_value + 1e-16 ); 
+		
+		if( relative_change > diffusion_step_tolerance && diffusion_step_multiples[i] > 1 )
+		{ diffusion_step_multiples[i] /= 2; }
+		else if( relative_change < 0.25 * diffusion_step_tolerance && 2*diffusion_step_multiples[i] <= max_diffusion_step_multiple )
+		{ diffusion_step_multiples[i] *= 2; }
+	}
+	return; 
+}
+
 void Microenvironment::auto_choose_diffusion_decay_solver( void )
 {
 	// set the safest choice 
@@ -735,40 +947,95 @@ void Microenvironment::display_information( std::ostream& os )
 		else
 		{ os << "false"; }
 		os << ")" << std::endl; 
+		if( i < diffusion_step_multiples.size() && 
+			( diffusion_step_multiples[i] != 1 || adaptive_diffusion_steps[i] || diffusion_solver_types[i] != "LOD" ) )
+		{
+			os << "     solver: " << diffusion_solver_types[i] << ", every " << diffusion_step_multiples[i] << " diffusion step(s)"; 
+			if( adaptive_diffusion_steps[i] )
+			{ os << " (adaptive)"; }
+			os << std::endl; 
+		}
 	}
 	os << std::endl; 
 	
 	return; 
 }
+
+long long Microenvironment::density_memory_footprint( void )
+{
+	return heap_bytes( temporary_density_vectors1 ) + heap_bytes( temporary_density_vectors2 ) 
+		+ heap_bytes( dirichlet_value_vectors ) + heap_bytes( dirichlet_activation_vector ); 
+}
+
+long long Microenvironment::gradient_memory_footprint( void )
+{ return heap_bytes( gradient_vectors ) + heap_bytes( gradient_vector_computed ); }
+
+long long Microenvironment::solver_memory_footprint( void )
+{
+	long long out = heap_bytes( bulk_source_sink_solver_temp1 ) + heap_bytes( bulk_source_sink_solver_temp2 ) 
+		+ heap_bytes( bulk_source_sink_solver_temp3 ) + heap_bytes( supply_target_densities_times_supply_rates ) 
+		+ heap_bytes( supply_rates ) + heap_bytes( uptake_rates ); 
+	out += heap_bytes( thomas_temp1 ) + heap_bytes( thomas_temp2 ) 
+		+ heap_bytes( thomas_denomx ) + heap_bytes( thomas_cx ) 
+		+ heap_bytes( thomas_denomy ) + heap_bytes( thomas_cy ) 
+		+ heap_bytes( thomas_denomz ) + heap_bytes( thomas_cz ) 
+		+ heap_bytes( thomas_pipeline ) + heap_bytes( diffusion_change_samples ); 
+	return out; 
+}
 	
 unsigned int Microenvironment::number_of_densities( void )
 { return (*p_density_vectors)[0].size(); }
 
 unsigned int Microenvironment::number_of_voxels( void )
-{ return mesh.voxels.size(); }
+{ return mesh.number_of_voxels(); }
 
 unsigned int Microenvironment::number_of_voxel_faces( void )
 { return mesh.voxel_faces.size(); } 
 
 void Microenvironment::write_to_matlab( std::string filename )
 {
-	int number_of_data_entries = mesh.voxels.size();
+	int number_of_data_entries = mesh.number_of_voxels();
 	int size_of_each_datum = 3 + 1 + (*p_density_vectors)[0].size(); 
+	
+	if( decomposed )
+	{
+		// every rank writes its slab's columns into the one file 
+		std::vector<double> columns( number_of_data_entries * size_of_each_datum ); 
+		#pragma omp parallel for 
+		for( int i=0; i < number_of_data_entries ; i++ )
+		{
+			std::vector<double> center = mesh.voxel_center( i ); 
+			double* column = &( columns[i*size_of_each_datum] ); 
+			column[0] = center[0]; 
+			column[1] = center[1]; 
+			column[2] = center[2]; 
+			column[3] = mesh.voxel_volume( i ); 
+			for( unsigned int j=0 ; j < (*p_density_vectors)[i].size() ; j++)
+			{ column[4+j] = ((*p_density_vectors)[i])[j]; }
+		}
+		domain_decomposition.write_matlab_columns( filename , "multiscale_microenvironment" , size_of_each_datum , columns ); 
+		return; 
+	}
 
 	FILE* fp = write_matlab_header( size_of_each_datum, number_of_data_entries,  filename, "multiscale_microenvironment" );  
 
 	// storing data as cols 
 	for( int i=0; i < number_of_data_entries ; i++ )
 	{
-		fwrite( (char*) &( mesh.voxels[i].center[0] ) , sizeof(double) , 1 , fp ); 
-		fwrite( (char*) &( mesh.voxels[i].center[1] ) , sizeof(double) , 1 , fp );   
-		fwrite( (char*) &( mesh.voxels[i].center[2] ) , sizeof(double) , 1 , fp ); 
-		fwrite( (char*) &( mesh.voxels[i].volume ) , sizeof(double) , 1 , fp ); 
+		std::vector<double> center = mesh.voxel_center( i ); 
+		double volume = mesh.voxel_volume( i ); 
+		fwrite( (char*) &( center[0] ) , sizeof(double) , 1 , fp ); 
+		fwrite( (char*) &( center[1] ) , sizeof(double) , 1 , fp );   
+		fwrite( (char*) &( center[2] ) , sizeof(double) , 1 , fp ); 
+		fwrite( (char*) &volume , sizeof(double) , 1 , fp ); 
 
 		// densities  
 
 		for( unsigned int j=0 ; j < (*p_density_vectors)[i].size() ; j++)
-		{ fwrite( (char*) &( ((*p_density_vectors)[i])[j] ) , sizeof(double) , 1 , fp ); }
+		{
+			double value = ((*p_density_vectors)[i])[j]; // the file is double either way 
+			fwrite( (char*) &value , sizeof(double) , 1 , fp ); 
+		}
 	}
 
 	fclose( fp ); 
@@ -781,15 +1048,15 @@ void Microenvironment::simulate_bulk_sources_and_sinks( double dt )
 {
 	if( !bulk_source_sink_solver_setup_done )
 	{
-		bulk_source_sink_solver_temp1.resize( mesh.voxels.size() , zero );
-		bulk_source_sink_solver_temp2.resize( mesh.voxels.size() , zero );
-		bulk_source_sink_solver_temp3.resize( mesh.voxels.size() , zero );
+		bulk_source_sink_solver_temp1.resize( mesh.number_of_voxels() , zero );
+		bulk_source_sink_solver_temp2.resize( mesh.number_of_voxels() , zero );
+		bulk_source_sink_solver_temp3.resize( mesh.number_of_voxels() , zero );
 		
 		bulk_source_sink_solver_setup_done = true; 
 	}
 	
 	#pragma omp parallel for
-	for( unsigned int i=0; i < mesh.voxels.size() ; i++ )
+	for( unsigned int i=0; i < mesh.number_of_voxels() ; i++ )
 	{
 		bulk_supply_rate_function( this,i, &bulk_source_sink_solver_temp1[i] ); // temp1 = S
 		bulk_supply_target_densities_function( this,i, &bulk_source_sink_solver_temp2[i]); // temp2 = T
@@ -810,10 +1077,14 @@ void Microenvironment::simulate_bulk_sources_and_sinks( double dt )
 
 void Microenvironment::simulate_cell_sources_and_sinks( std::vector<Basic_Agent*>& basic_agent_list , double dt )
 {
-	#pragma omp parallel for
-	for( unsigned int i=0 ; i < basic_agent_list.size() ; i++ )
-	{		
-		basic_agent_list[i]->simulate_secretion_and_uptake( this , dt ); 
+	#pragma omp parallel 
+	{
+		BIOFVM_TRACE_SCOPE( "cell sources and sinks" ); 
+		#pragma omp for nowait 
+		for( unsigned int i=0 ; i < basic_agent_list.size() ; i++ )
+		{		
+			basic_agent_list[i]->simulate_secretion_and_uptake( this , dt ); 
+		}
 	}
 	
 	return; 
@@ -999,7 +1270,11 @@ void Microenvironment::compute_all_gradient_vectors( void )
 	
 	// don't bother computing z component if there is no z-directoin 
 	if( mesh.z_coordinates.size() == 1 )
-	{ return; }
+	{
+		if( decomposed )
+		{ compute_slab_boundary_gradients(); }
+		return; 
+	}
 
 	#pragma omp parallel for 
 	for( unsigned int j=0; j < mesh.y_coordinates.size() ; j++ )
@@ -1045,10 +1320,74 @@ void Microenvironment::compute_all_gradient_vectors( void )
 			
 		}
 	}
+	
+	if( decomposed )
+	{ compute_slab_boundary_gradients(); }
 
 	return; 
 }
 
+void Microenvironment::compute_slab_boundary_gradients( void )
+{
+	// the first and last layers of the slab were given one-sided differences 
+	// above; use the neighboring ranks' layers for central differences instead 
+	int axis = domain_decomposition.axis; 
+	int layer_size = mesh.x_coordinates.size(); 
+	if( axis == 2 )
+	{ layer_size *= mesh.y_coordinates.size(); }
+	int layers = number_of_voxels() / layer_size; 
+	int densities = number_of_densities(); 
+	
+	std::vector<double> to_lower; 
+	std::vector<double> to_upper; 
+	std::vector<double> from_lower; 
+	std::vector<double> from_upper; 
+	for( int m=0; m < layer_size ; m++ )
+	{
+		for( int q=0; q < densities ; q++ )
+		{
+			if( domain_decomposition.lower_neighbor >= 0 )
+			{ to_lower.push_back( (*p_density_vectors)[m][q] ); }
+			if( domain_decomposition.upper_neighbor >= 0 )
+			{ to_upper.push_back( (*p_density_vectors)[(layers-1)*layer_size+m][q] ); }
+		}
+	}
+	domain_decomposition.exchange_with_neighbors( to_lower , to_upper , from_lower , from_upper , 103 ); 
+	
+	double two_d = domain_decomposition.spacing; 
+	two_d *= 2.0; 
+	
+	if( from_lower.size() == layer_size*densities )
+	{
+		#pragma omp parallel for 
+		for( int m=0; m < layer_size ; m++ )
+		{
+			int n = m; 
+			for( int q=0; q < densities ; q++ )
+			{
+				gradient_vectors[n][q][axis] = (*p_density_vectors)[n+layer_size][q]; 
+				gradient_vectors[n][q][axis] -= from_lower[m*densities+q]; 
+				gradient_vectors[n][q][axis] /= two_d; 
+			}
+		}
+	}
+	if( from_upper.size() == layer_size*densities )
+	{
+		#pragma omp parallel for 
+		for( int m=0; m < layer_size ; m++ )
+		{
+			int n = (layers-1)*layer_size + m; 
+			for( int q=0; q < densities ; q++ )
+			{
+				gradient_vectors[n][q][axis] = from_upper[m*densities+q]; 
+				gradient_vectors[n][q][axis] -= (*p_density_vectors)[n-layer_size][q]; 
+				gradient_vectors[n][q][axis] /= two_d; 
+			}
+		}
+	}
+	return; 
+}
+
 void Microenvironment::compute_gradient_vector( int n )
 {
 	static double two_dx = mesh.dx; 
@@ -1116,14 +1455,14 @@ void Microenvironment::compute_gradient_vector( int n )
 
 void Microenvironment::reset_all_gradient_vectors( void )
 {
-	for( unsigned int k=0 ; k < mesh.voxels.size() ; k++ )
+	for( unsigned int k=0 ; k < mesh.number_of_voxels() ; k++ )
 	{
 		for( unsigned int i=0 ; i < number_of_densities() ; i++ )
 		{
 			(gradient_vectors[k])[i].resize( 3, 0.0 );
 		}
 	}
-	gradient_vector_computed.assign( mesh.voxels.size() , false ); 	
+	gradient_vector_computed.assign( mesh.number_of_voxels() , false ); 	
 }
 
 
@@ -1174,6 +1513,8 @@ Microenvironment_Options::Microenvironment_Options()
 	
 	track_internalized_substrates_in_each_agent = false; 
 	
+	implicit_mesh = false; 
+	
 	return; 
 }
 
@@ -1207,10 +1548,52 @@ void initialize_microenvironment( void )
 		default_microenvironment_options.Z_range[0] = -default_microenvironment_options.dz/2.0; 
 		default_microenvironment_options.Z_range[1] = default_microenvironment_options.dz/2.0;
 	}
-	microenvironment.resize_space( default_microenvironment_options.X_range[0], default_microenvironment_options.X_range[1] , 
-		default_microenvironment_options.Y_range[0], default_microenvironment_options.Y_range[1], 
-		default_microenvironment_options.Z_range[0], default_microenvironment_options.Z_range[1], 
-		default_microenvironment_options.dx,default_microenvironment_options.dy,default_microenvironment_options.dz );
+	microenvironment.mesh.implicit_voxels = default_microenvironment_options.implicit_mesh; 
+	if( domain_decomposition.active == false )
+	{
+		microenvironment.resize_space( default_microenvironment_options.X_range[0], default_microenvironment_options.X_range[1] , 
+			default_microenvironment_options.Y_range[0], default_microenvironment_options.Y_range[1], 
+			default_microenvironment_options.Z_range[0], default_microenvironment_options.Z_range[1], 
+			default_microenvironment_options.dx,default_microenvironment_options.dy,default_microenvironment_options.dz );
+	}
+	else
+	{
+		// MPI: this rank's slab of the domain (see BioFVM_MPI.h) 
+		std::vector<double> bounding_box( 6 ); 
+		bounding_box[0] = default_microenvironment_options.X_range[0]; 
+		bounding_box[1] = default_microenvironment_options.Y_range[0]; 
+		bounding_box[2] = default_microenvironment_options.Z_range[0]; 
+		bounding_box[3] = default_microenvironment_options.X_range[1]; 
+		bounding_box[4] = default_microenvironment_options.Y_range[1]; 
+		bounding_box[5] = default_microenvironment_options.Z_range[1]; 
+		
+		int axis = 2; 
+		double spacing = default_microenvironment_options.dz; 
+		if( default_microenvironment_options.simulate_2D == true )
+		{
+			axis = 1; 
+			spacing = default_microenvironment_options.dy; 
+		}
+		if( domain_decomposition.decompose( bounding_box , spacing , axis ) == false )
+		{ exit(-1); }
+		
+		// end the range half a layer early, so that the layer count can't round up 
+		std::vector<double> range = bounding_box; 
+		int layers = domain_decomposition.last_layer - domain_decomposition.first_layer + 1; 
+		range[axis] = domain_decomposition.lower_bound; 
+		range[axis+3] = domain_decomposition.lower_bound + ( layers - 0.5 )*spacing; 
+		microenvironment.resize_space( range[0], range[3], range[1], range[4], range[2], range[5], 
+			default_microenvironment_options.dx,default_microenvironment_options.dy,default_microenvironment_options.dz );
+		microenvironment.mesh.bounding_box[axis] = domain_decomposition.lower_bound; 
+		microenvironment.mesh.bounding_box[axis+3] = domain_decomposition.upper_bound; 
+		domain_decomposition.set_layer_coordinates( microenvironment.mesh , domain_decomposition.global_start , 
+			spacing , domain_decomposition.first_layer ); 
+		
+		int layer_size = microenvironment.number_of_voxels() / layers; 
+		domain_decomposition.global_voxels = domain_decomposition.global_layers * layer_size; 
+		domain_decomposition.first_voxel = domain_decomposition.first_layer * layer_size; 
+		microenvironment.decomposed = true; 
+	}
 		
 	// set units
 	microenvironment.spatial_units = default_microenvironment_options.spatial_units;
@@ -1231,9 +1614,37 @@ void initialize_microenvironment( void )
 	}
 	
 	for( unsigned int n=0; n < microenvironment.number_of_voxels() ; n++ )
-	{ microenvironment.density_vector(n) = default_microenvironment_options.initial_condition_vector; }
+	{ microenvironment.density_vector(n) = density_storage( default_microenvironment_options.initial_condition_vector ); }
 	
-	if( default_microenvironment_options.outer_Dirichlet_conditions == true ) 
+	if( default_microenvironment_options.outer_Dirichlet_conditions == true && microenvironment.decomposed ) 
+	{
+		// only on the faces of the whole domain, not on those between the slabs 
+		int I = microenvironment.mesh.x_coordinates.size()-1;
+		int J = microenvironment.mesh.y_coordinates.size()-1;
+		int K = microenvironment.mesh.z_coordinates.size()-1; 
+		int first = domain_decomposition.first_layer; 
+		int last_global = domain_decomposition.global_layers-1; 
+		for( int k=0 ; k <= K ; k++ )
+		{
+			for( int j=0 ; j <= J ; j++ )
+			{
+				for( int i=0 ; i <= I ; i++ )
+				{
+					bool face = ( i == 0 || i == I ); 
+					if( domain_decomposition.axis == 1 )
+					{ face = face || first+j == 0 || first+j == last_global; }
+					else
+					{
+						face = face || j == 0 || j == J; 
+						face = face || first+k == 0 || first+k == last_global; 
+					}
+					if( face )
+					{ microenvironment.add_dirichlet_node( microenvironment.voxel_index(i,j,k) , default_microenvironment_options.Dirichlet_condition_vector ); }
+				}
+			}
+		}
+	}
+	else if( default_microenvironment_options.outer_Dirichlet_conditions == true ) 
 	{
 		
 		for( unsigned int k=0 ; k < microenvironment.mesh.z_coordinates.size() ; k++ )
@@ -1274,6 +1685,8 @@ void initialize_microenvironment( void )
 		microenvironment.set_substrate_dirichlet_activation( i , default_microenvironment_options.Dirichlet_activation_vector[i] ); 
 	}
 	
+	microenvironment.first_touch_voxel_data(); 
+	
 	microenvironment.display_information( std::cout );
 	return;
 }
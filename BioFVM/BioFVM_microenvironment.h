@@ -52,6 +52,7 @@
 #include "BioFVM_mesh.h"
 #include "BioFVM_agent_container.h"
 #include "BioFVM_MultiCellDS.h"
+#include "BioFVM_vector.h"
 
 namespace BioFVM{
 
@@ -68,9 +69,9 @@ class Microenvironment
 	friend std::ostream& operator<<(std::ostream& os, const Microenvironment& S);  
 
 	/*! For internal use and accelerations in solvers */ 
-	std::vector< std::vector<double> > temporary_density_vectors1; 
+	std::vector< std::vector<real_t> > temporary_density_vectors1; 
 	/*! For internal use and accelerations in solvers */ 
-	std::vector< std::vector<double> > temporary_density_vectors2; 
+	std::vector< std::vector<real_t> > temporary_density_vectors2; 
 	
 	/*! for internal use in bulk source/sink solvers */
 	std::vector< std::vector<double> > bulk_source_sink_solver_temp1; 
@@ -80,7 +81,7 @@ class Microenvironment
 
 	
 	/*! stores pointer to current density solutions. Access via operator() functions. */ 
-	std::vector< std::vector<double> >* p_density_vectors; 
+	std::vector< std::vector<real_t> >* p_density_vectors; 
 	
 	std::vector< std::vector<gradient> > gradient_vectors; 
 	std::vector<bool> gradient_vector_computed; 
@@ -118,6 +119,29 @@ class Microenvironment
 	std::vector< std::vector<double> > thomas_cz;
 	bool diffusion_solver_setup_done; 
 	
+	// per-substrate time stepping (LOD solvers) 
+	std::vector<int> diffusion_steps_since_solve; 
+	std::vector<double> substrate_solve_dt; // this step; 0 if the substrate is not solved 
+	std::vector<int> solved_substrates; // this step 
+	std::vector<double> thomas_dt; // the time step of each substrate's Thomas coefficients 
+	bool thomas_coefficients_stale; 
+	std::vector< std::vector<double> > diffusion_change_samples; // adaptive substrates, before the solve 
+	
+	bool plan_substrate_solves( double dt ); // true if all substrates are solved this step 
+	void apply_substrate_solver_types( void ); // zeroes the diffusion of "decay_only" substrates in the Thomas constants 
+	void thomas_solve_line( int n , int jump , int count , std::vector< std::vector<double> >& denominators , 
+		std::vector< std::vector<double> >& c , std::vector<int>& substrates , std::vector<double>& line ); 
+	template <int dimension> void LOD_solve_substrate_subset( void ); 
+	// the sweeps along the axis cut by an MPI domain decomposition (see BioFVM_MPI.h) 
+	std::vector<double> thomas_pipeline; 
+	void thomas_solve_distributed( int jump , std::vector< std::vector<double> >& denominators , 
+		std::vector< std::vector<double> >& c , std::vector<int>& substrates ); 
+	void compute_slab_boundary_gradients( void ); 
+	int first_adaptive_sample( int& stride ); 
+	void solve_steady_state_substrate( int substrate_index ); // multigrid, see BioFVM_solvers.cpp 
+	void sample_adaptive_substrates( void ); 
+	void update_adaptive_step_multiples( void ); 
+	
 	// on "resize density" type operations, need to extend all of these 
 	
 	/*
@@ -125,7 +149,7 @@ class Microenvironment
 	std::vector< std::vector<double> > dirichlet_value_vectors; 
 	std::vector<bool> dirichlet_node_map; 
 	*/
-	std::vector< std::vector<double> > dirichlet_value_vectors; 
+	std::vector< std::vector<real_t> > dirichlet_value_vectors; 
 	std::vector<bool> dirichlet_activation_vector; 	
  public:
 	
@@ -149,6 +173,29 @@ class Microenvironment
 	std::vector< std::vector<double> > uptake_rates; 
 	void update_rates( void ); 
 	
+	// per-substrate time stepping for the LOD solvers. Substrate i is solved once 
+	// every diffusion_step_multiples[i] calls to simulate_diffusion_decay, over the 
+	// elapsed time. Cell sources and sinks still act on the densities every step, 
+	// so they accumulate between solves. An adaptive substrate doubles its multiple 
+	// (up to max_diffusion_step_multiple) while a solve changes it by less than a 
+	// quarter of diffusion_step_tolerance (relative to its largest value), and 
+	// halves it when the change exceeds the tolerance. Solver types: "LOD" 
+	// (default), "decay_only" (no diffusion), and "steady": each solve replaces 
+	// the substrate with its quasi-steady state for the current cell sources and 
+	// sinks (found to steady_state_tolerance), and cells do not secrete or take 
+	// up the substrate between solves. 
+	std::vector<int> diffusion_step_multiples; 
+	std::vector<bool> adaptive_diffusion_steps; 
+	std::vector<std::string> diffusion_solver_types; 
+	double diffusion_step_tolerance; 
+	int max_diffusion_step_multiple; 
+	double steady_state_tolerance; 
+	int steady_state_max_cycles; 
+	void set_substrate_time_stepping( int substrate_index , int step_multiple , bool adaptive , std::string solver_type ); 
+	
+	// true if this rank only holds a slab of the mesh (an MPI run, see BioFVM_MPI.h) 
+	bool decomposed; 
+	
 	Microenvironment(); 
 	Microenvironment(std::string name);
 	
@@ -191,15 +238,15 @@ class Microenvironment
 	std::vector<unsigned int> nearest_cartesian_indices( std::vector<double>& position ); 
 	Voxel& nearest_voxel( std::vector<double>& position ); 
 	Voxel& voxels( int voxel_index );
-	std::vector<double>& nearest_density_vector( std::vector<double>& position );  
-	std::vector<double>& nearest_density_vector( int voxel_index );  
+	std::vector<real_t>& nearest_density_vector( std::vector<double>& position );  
+	std::vector<real_t>& nearest_density_vector( int voxel_index );  
 
 	/*! access the density vector at  [ X(i),Y(j),Z(k) ] */
-	std::vector<double>& operator()( int i, int j, int k ); 
+	std::vector<real_t>& operator()( int i, int j, int k ); 
 	/*! access the density vector at  [ X(i),Y(j),0 ]  -- helpful for 2-D problems */
-	std::vector<double>& operator()( int i, int j );  
+	std::vector<real_t>& operator()( int i, int j );  
 	/*! access the density vector at [x,y,z](n) */
-	std::vector<double>& operator()( int n );  
+	std::vector<real_t>& operator()( int n );  
 	
 	std::vector<gradient>& gradient_vector(int i, int j, int k); 
 	std::vector<gradient>& gradient_vector(int i, int j ); 
@@ -212,11 +259,11 @@ class Microenvironment
 	void reset_all_gradient_vectors( void ); 
 	
 	/*! access the density vector at  [ X(i),Y(j),Z(k) ] */
-	std::vector<double>& density_vector( int i, int j, int k ); 
+	std::vector<real_t>& density_vector( int i, int j, int k ); 
 	/*! access the density vector at  [ X(i),Y(j),0 ]  -- helpful for 2-D problems */
-	std::vector<double>& density_vector( int i, int j ); 
+	std::vector<real_t>& density_vector( int i, int j ); 
 	/*! access the density vector at [x,y,z](n) */
-	std::vector<double>& density_vector( int n ); 
+	std::vector<real_t>& density_vector( int n ); 
 
 	/*! advance the diffusion-decay solver by dt time */
 	void simulate_diffusion_decay( double dt ); 
@@ -231,6 +278,22 @@ class Microenvironment
 	
 	void display_information( std::ostream& os ); 
 	
+	/*! bytes held by the densities (both buffers, and the Dirichlet values), 
+	    the gradients, and the solvers' coefficients and scratch space. The 
+	    mesh is mesh.memory_footprint(). */
+	long long density_memory_footprint( void ); 
+	long long gradient_memory_footprint( void ); 
+	long long solver_memory_footprint( void ); 
+	
+	/*! reallocate the per-voxel data from the threads that own it in the 
+	    solvers' parallel loops (z-slabs in 3-D, y-rows in 2-D), so that on 
+	    NUMA systems each page lands on the node of the thread that sweeps it */
+	void first_touch_voxel_data( void ); 
+	/*! the solvers' loop partitioning: voxels [ n*length, (n+1)*length ) 
+	    make up partition n */
+	int number_of_voxel_partitions( void ); 
+	int voxel_partition_length( void ); 
+	
 	void add_dirichlet_node( int voxel_index, std::vector<double>& value ); 
 	void update_dirichlet_node( int voxel_index , std::vector<double>& new_value ); 
 	void update_dirichlet_node( int voxel_index , int substrate_index , double new_value );
@@ -240,13 +303,14 @@ class Microenvironment
 	void set_substrate_dirichlet_activation( int substrate_index , bool new_value ); 
 	double get_substrate_dirichlet_activation( int substrate_index ); 
 	
-	bool& is_dirichlet_node( int voxel_index ); 
+	bool is_dirichlet_node( int voxel_index ); 
 
 	friend void diffusion_decay_solver__constant_coefficients_explicit( Microenvironment& S, double dt ); 
 	friend void diffusion_decay_solver__constant_coefficients_explicit_uniform_mesh( Microenvironment& S, double dt ); 
 
 	friend void diffusion_decay_solver__constant_coefficients_LOD_3D( Microenvironment& S, double dt ); 
 	friend void diffusion_decay_solver__constant_coefficients_LOD_2D( Microenvironment& S, double dt ); 
+	template <int dimension> friend void diffusion_decay_solver__constant_coefficients_LOD( Microenvironment& S, double dt ); 
 	
 	friend void diffusion_decay_explicit_uniform_rates( Microenvironment& M, double dt );
 	
@@ -278,6 +342,7 @@ void zero_function( std::vector<double>& position, std::vector<double>& input ,
 void one_function( std::vector<double>& position, std::vector<double>& input , std::vector<double>* destination );
 
 void zero_function( Microenvironment* pMicroenvironment, int voxel_index, std::vector<double>* write_destination );
+std::vector<real_t> density_storage( const std::vector<double>& v ); // v as a density vector (see real_t) 
 void one_function( Microenvironment* pMicroenvironment, int voxel_index, std::vector<double>* write_destination );
 
 void set_default_microenvironment( Microenvironment* M );
@@ -315,6 +380,9 @@ class Microenvironment_Options
 	bool use_oxygen_as_first_field;
 	
 	bool track_internalized_substrates_in_each_agent; 	
+	
+	// compute voxel centers, volumes and neighbors on the fly (see Cartesian_Mesh::implicit_voxels) 
+	bool implicit_mesh; 
 };
 
 extern Microenvironment_Options default_microenvironment_options; 
@@ -48,8 +48,13 @@
 
 #include "BioFVM_solvers.h" 
 #include "BioFVM_vector.h" 
+#include "BioFVM_basic_agent.h" 
+#include "BioFVM_MPI.h" 
+#include "BioFVM_trace.h" 
 
 #include <iostream>
+#include <cmath>
+#include <algorithm>
 #include <omp.h>
 
 namespace BioFVM{
@@ -93,29 +98,42 @@ void diffusion_decay_solver__constant_coefficients_explicit_uniform_mesh( Microe
 	return; 
 }
 
-void diffusion_decay_solver__constant_coefficients_LOD_3D( Microenvironment& M, double dt )
-{
-	if( M.mesh.regular_mesh == false || M.mesh.Cartesian_mesh == false )
-	{
-		std::cout << "Error: This algorithm is written for regular Cartesian meshes. Try: other solvers!" << std::endl << std::endl; 
-	return; 
-	}
+/* 
+ The 2-D and 3-D LOD solvers share this body, with the dimension fixed at compile 
+ time: the 2-D instantiation builds no z coefficients and has no z sweep, and its 
+ sweeps are parallel over the rows (y) instead of the z slabs. 
+*/ 
 
+template <int dimension> 
+void diffusion_decay_solver__constant_coefficients_LOD( Microenvironment& M, double dt )
+{
+	// which substrates are solved this step, and over what time (see 
+	// Microenvironment::diffusion_step_multiples) 
+	bool all_substrates_solved = M.plan_substrate_solves( dt ); 
+	
 	// define constants and pre-computed quantities 
 	
-	if( !M.diffusion_solver_setup_done )
+	// the coefficients along the axis cut by an MPI decomposition span all its layers 
+	int ny = M.mesh.y_coordinates.size(); 
+	int nz = M.mesh.z_coordinates.size(); 
+	if( M.decomposed && dimension == 2 )
+	{ ny = domain_decomposition.global_layers; }
+	if( M.decomposed && dimension == 3 )
+	{ nz = domain_decomposition.global_layers; }
+	
+	if( !M.diffusion_solver_setup_done || M.thomas_coefficients_stale )
 	{
-		std::cout << std::endl << "Using method " << __FUNCTION__ << " (implicit 3-D LOD with Thomas Algorithm) ... " 
-		<< std::endl << std::endl;  
-		
 		M.thomas_denomx.resize( M.mesh.x_coordinates.size() , M.zero );
 		M.thomas_cx.resize( M.mesh.x_coordinates.size() , M.zero );
 
-		M.thomas_denomy.resize( M.mesh.y_coordinates.size() , M.zero );
-		M.thomas_cy.resize( M.mesh.y_coordinates.size() , M.zero );
+		M.thomas_denomy.resize( ny , M.zero );
+		M.thomas_cy.resize( ny , M.zero );
 		
-		M.thomas_denomz.resize( M.mesh.z_coordinates.size() , M.zero );
-		M.thomas_cz.resize( M.mesh.z_coordinates.size() , M.zero );
+		if( dimension == 3 )
+		{
+			M.thomas_denomz.resize( nz , M.zero );
+			M.thomas_cz.resize( nz , M.zero );
+		}
 
 		M.thomas_i_jump = 1; 
 		M.thomas_j_jump = M.mesh.x_coordinates.size(); 
@@ -123,19 +141,25 @@ void diffusion_decay_solver__constant_coefficients_LOD_3D( Microenvironment& M,
 
 		M.thomas_constant1 =  M.diffusion_coefficients; // dt*D/dx^2 
 		M.thomas_constant1a = M.zero; // -dt*D/dx^2; 
-		M.thomas_constant2 =  M.decay_rates; // (1/3)* dt*lambda 
+		M.thomas_constant2 =  M.decay_rates; // (1/dimension)* dt*lambda 
 		M.thomas_constant3 = M.one; // 1 + 2*constant1 + constant2; 
 		M.thomas_constant3a = M.one; // 1 + constant1 + constant2; 		
 			
-		M.thomas_constant1 *= dt; 
+		// each substrate's own time step 
+		M.thomas_constant1 *= M.thomas_dt; 
 		M.thomas_constant1 /= M.mesh.dx; 
 		M.thomas_constant1 /= M.mesh.dx; 
+		M.apply_substrate_solver_types(); 
 
 		M.thomas_constant1a = M.thomas_constant1; 
 		M.thomas_constant1a *= -1.0; 
 
-		M.thomas_constant2 *= dt; 
-		M.thomas_constant2 /= 3.0; // for the LOD splitting of the source 
+		// for the LOD splitting of the source 
+		M.thomas_constant2 *= M.thomas_dt; 
+		if( dimension == 3 )
+		{ M.thomas_constant2 /= 3.0; }
+		else
+		{ M.thomas_constant2 *= 0.5; }
 
 		M.thomas_constant3 += M.thomas_constant1; 
 		M.thomas_constant3 += M.thomas_constant1; 
@@ -160,138 +184,154 @@ void diffusion_decay_solver__constant_coefficients_LOD_3D( Microenvironment& M,
 			M.thomas_cx[i] /= M.thomas_denomx[i]; // the value at  size-1 is not actually used  
 		}
 
-		M.thomas_cy.assign( M.mesh.y_coordinates.size() , M.thomas_constant1a ); 
-		M.thomas_denomy.assign( M.mesh.y_coordinates.size()  , M.thomas_constant3 ); 
+		M.thomas_cy.assign( ny , M.thomas_constant1a ); 
+		M.thomas_denomy.assign( ny  , M.thomas_constant3 ); 
 		M.thomas_denomy[0] = M.thomas_constant3a; 
-		M.thomas_denomy[ M.mesh.y_coordinates.size()-1 ] = M.thomas_constant3a; 
-		if( M.mesh.y_coordinates.size() == 1 )
+		M.thomas_denomy[ ny-1 ] = M.thomas_constant3a; 
+		if( ny == 1 )
 		{ M.thomas_denomy[0] = M.one; M.thomas_denomy[0] += M.thomas_constant2; } 
 
 		M.thomas_cy[0] /= M.thomas_denomy[0]; 
-		for( unsigned int i=1 ; i <= M.mesh.y_coordinates.size()-1 ; i++ )
+		for( unsigned int i=1 ; i <= ny-1 ; i++ )
 		{ 
 			axpy( &M.thomas_denomy[i] , M.thomas_constant1 , M.thomas_cy[i-1] ); 
 			M.thomas_cy[i] /= M.thomas_denomy[i]; // the value at  size-1 is not actually used  
 		}
 
-		M.thomas_cz.assign( M.mesh.z_coordinates.size() , M.thomas_constant1a ); 
-		M.thomas_denomz.assign( M.mesh.z_coordinates.size()  , M.thomas_constant3 ); 
-		M.thomas_denomz[0] = M.thomas_constant3a; 
-		M.thomas_denomz[ M.mesh.z_coordinates.size()-1 ] = M.thomas_constant3a; 
-		if( M.mesh.z_coordinates.size() == 1 )
-		{ M.thomas_denomz[0] = M.one; M.thomas_denomz[0] += M.thomas_constant2; } 
-
-		M.thomas_cz[0] /= M.thomas_denomz[0]; 
-		for( unsigned int i=1 ; i <= M.mesh.z_coordinates.size()-1 ; i++ )
-		{ 
-			axpy( &M.thomas_denomz[i] , M.thomas_constant1 , M.thomas_cz[i-1] ); 
-			M.thomas_cz[i] /= M.thomas_denomz[i]; // the value at  size-1 is not actually used  
-		}	
+		if( dimension == 3 )
+		{
+			M.thomas_cz.assign( nz , M.thomas_constant1a ); 
+			M.thomas_denomz.assign( nz  , M.thomas_constant3 ); 
+			M.thomas_denomz[0] = M.thomas_constant3a; 
+			M.thomas_denomz[ nz-1 ] = M.thomas_constant3a; 
+			if( nz == 1 )
+			{ M.thomas_denomz[0] = M.one; M.thomas_denomz[0] += M.thomas_constant2; } 
+
+			M.thomas_cz[0] /= M.thomas_denomz[0]; 
+			for( unsigned int i=1 ; i <= nz-1 ; i++ )
+			{ 
+				axpy( &M.thomas_denomz[i] , M.thomas_constant1 , M.thomas_cz[i-1] ); 
+				M.thomas_cz[i] /= M.thomas_denomz[i]; // the value at  size-1 is not actually used  
+			}	
+		}
 
 		M.diffusion_solver_setup_done = true; 
+		M.thomas_coefficients_stale = false; 
+	}
+	
+	M.sample_adaptive_substrates(); 
+	if( all_substrates_solved == false )
+	{
+		M.LOD_solve_substrate_subset<dimension>(); 
+		M.update_adaptive_step_multiples(); 
+		return; 
 	}
 
 	// x-diffusion 
 	
 	M.apply_dirichlet_conditions();
-	#pragma omp parallel for 
-	for( unsigned int k=0; k < M.mesh.z_coordinates.size() ; k++ )
+	if( dimension == 2 )
 	{
-		for( unsigned int j=0; j < M.mesh.y_coordinates.size() ; j++ )
+		#pragma omp parallel 
 		{
-			// Thomas solver, x-direction
-
-			// remaining part of forward elimination, using pre-computed quantities 
-			int n = M.voxel_index(0,j,k);
-			(*M.p_density_vectors)[n] /= M.thomas_denomx[0]; 
-
-			for( unsigned int i=1; i < M.mesh.x_coordinates.size() ; i++ )
+			BIOFVM_TRACE_SCOPE( "LOD x sweep" ); 
+			#pragma omp for nowait 
+			for( unsigned int j=0; j < M.mesh.y_coordinates.size() ; j++ )
 			{
-				n = M.voxel_index(i,j,k); 
-				axpy( &(*M.p_density_vectors)[n] , M.thomas_constant1 , (*M.p_density_vectors)[n-M.thomas_i_jump] ); 
-				(*M.p_density_vectors)[n] /= M.thomas_denomx[i]; 
+				std::vector<double> line; 
+				// Thomas solver, x-direction
+				M.thomas_solve_line( M.voxel_index(0,j,0) , M.thomas_i_jump , M.mesh.x_coordinates.size() , 
+					M.thomas_denomx , M.thomas_cx , M.solved_substrates , line ); 
 			}
-
-			for( int i = M.mesh.x_coordinates.size()-2 ; i >= 0 ; i-- )
+		}
+	}
+	else
+	{
+		#pragma omp parallel 
+		{
+			BIOFVM_TRACE_SCOPE( "LOD x sweep" ); 
+			#pragma omp for nowait 
+			for( unsigned int k=0; k < M.mesh.z_coordinates.size() ; k++ )
 			{
-				n = M.voxel_index(i,j,k); 
-				naxpy( &(*M.p_density_vectors)[n] , M.thomas_cx[i] , (*M.p_density_vectors)[n+M.thomas_i_jump] ); 
+				std::vector<double> line; 
+				for( unsigned int j=0; j < M.mesh.y_coordinates.size() ; j++ )
+				{
+					// Thomas solver, x-direction
+					M.thomas_solve_line( M.voxel_index(0,j,k) , M.thomas_i_jump , M.mesh.x_coordinates.size() , 
+						M.thomas_denomx , M.thomas_cx , M.solved_substrates , line ); 
+				}
 			}
-
 		}
 	}
 
 	// y-diffusion 
 
 	M.apply_dirichlet_conditions();
-	#pragma omp parallel for 
-	for( unsigned int k=0; k < M.mesh.z_coordinates.size() ; k++ )
+	if( dimension == 2 && M.decomposed )
+	{ M.thomas_solve_distributed( M.thomas_j_jump , M.thomas_denomy , M.thomas_cy , M.solved_substrates ); }
+	else if( dimension == 2 )
 	{
-		for( unsigned int i=0; i < M.mesh.x_coordinates.size() ; i++ )
+		#pragma omp parallel 
 		{
-   // Thomas solver, y-direction
-
-	// remaining part of forward elimination, using pre-computed quantities 
-
-	int n = M.voxel_index(i,0,k);
-	(*M.p_density_vectors)[n] /= M.thomas_denomy[0]; 
-
-	for( unsigned int j=1; j < M.mesh.y_coordinates.size() ; j++ )
-	{
-		n = M.voxel_index(i,j,k); 
-		axpy( &(*M.p_density_vectors)[n] , M.thomas_constant1 , (*M.p_density_vectors)[n-M.thomas_j_jump] ); 
-		(*M.p_density_vectors)[n] /= M.thomas_denomy[j]; 
+			BIOFVM_TRACE_SCOPE( "LOD y sweep" ); 
+			#pragma omp for nowait 
+			for( unsigned int i=0; i < M.mesh.x_coordinates.size() ; i++ )
+			{
+				std::vector<double> line; 
+				// Thomas solver, y-direction
+				M.thomas_solve_line( M.voxel_index(i,0,0) , M.thomas_j_jump , M.mesh.y_coordinates.size() , 
+					M.thomas_denomy , M.thomas_cy , M.solved_substrates , line ); 
+			}
+		}
 	}
-
-	// back substitution 
-	// n = voxel_index( mesh.x_coordinates.size()-2 ,j,k); 
-
-	for( int j = M.mesh.y_coordinates.size()-2 ; j >= 0 ; j-- )
+	else
 	{
-		n = M.voxel_index(i,j,k); 
-		naxpy( &(*M.p_density_vectors)[n] , M.thomas_cy[j] , (*M.p_density_vectors)[n+M.thomas_j_jump] ); 
+		#pragma omp parallel 
+		{
+			BIOFVM_TRACE_SCOPE( "LOD y sweep" ); 
+			#pragma omp for nowait 
+			for( unsigned int k=0; k < M.mesh.z_coordinates.size() ; k++ )
+			{
+				std::vector<double> line; 
+				for( unsigned int i=0; i < M.mesh.x_coordinates.size() ; i++ )
+				{
+					// Thomas solver, y-direction
+					M.thomas_solve_line( M.voxel_index(i,0,k) , M.thomas_j_jump , M.mesh.y_coordinates.size() , 
+						M.thomas_denomy , M.thomas_cy , M.solved_substrates , line ); 
+				}
+			}
+		}
 	}
 
-  }
- }
+	// z-diffusion 
 
- // z-diffusion 
-
-	M.apply_dirichlet_conditions();
- #pragma omp parallel for 
- for( unsigned int j=0; j < M.mesh.y_coordinates.size() ; j++ )
- {
-	 
-  for( unsigned int i=0; i < M.mesh.x_coordinates.size() ; i++ )
-  {
-   // Thomas solver, y-direction
-
-	// remaining part of forward elimination, using pre-computed quantities 
-
-	int n = M.voxel_index(i,j,0);
-	(*M.p_density_vectors)[n] /= M.thomas_denomz[0]; 
-
-	// should be an empty loop if mesh.z_coordinates.size() < 2  
-	for( unsigned int k=1; k < M.mesh.z_coordinates.size() ; k++ )
+	if( dimension == 3 && M.decomposed )
 	{
-		n = M.voxel_index(i,j,k); 
-		axpy( &(*M.p_density_vectors)[n] , M.thomas_constant1 , (*M.p_density_vectors)[n-M.thomas_k_jump] ); 
-		(*M.p_density_vectors)[n] /= M.thomas_denomz[k]; 
+		M.apply_dirichlet_conditions();
+		M.thomas_solve_distributed( M.thomas_k_jump , M.thomas_denomz , M.thomas_cz , M.solved_substrates ); 
 	}
-
-	// back substitution 
-
-	// should be an empty loop if mesh.z_coordinates.size() < 2 
-	for( int k = M.mesh.z_coordinates.size()-2 ; k >= 0 ; k-- )
+	else if( dimension == 3 )
 	{
-		n = M.voxel_index(i,j,k); 
-		naxpy( &(*M.p_density_vectors)[n] , M.thomas_cz[k] , (*M.p_density_vectors)[n+M.thomas_k_jump] ); 
-		// n -= i_jump; 
+		M.apply_dirichlet_conditions();
+		#pragma omp parallel 
+		{
+			BIOFVM_TRACE_SCOPE( "LOD z sweep" ); 
+			#pragma omp for nowait 
+			for( unsigned int j=0; j < M.mesh.y_coordinates.size() ; j++ )
+			{
+				std::vector<double> line; 
+				for( unsigned int i=0; i < M.mesh.x_coordinates.size() ; i++ )
+				{
+					// Thomas solver, z-direction
+					M.thomas_solve_line( M.voxel_index(i,j,0) , M.thomas_k_jump , M.mesh.z_coordinates.size() , 
+						M.thomas_denomz , M.thomas_cz , M.solved_substrates , line ); 
+				}
+			}
+		}
 	}
-  }
- }
  
 	M.apply_dirichlet_conditions();
+	M.update_adaptive_step_multiples(); 
 	
 	// reset gradient vectors 
 //	M.reset_all_gradient_vectors(); 
@@ -299,6 +339,26 @@ void diffusion_decay_solver__constant_coefficients_LOD_3D( Microenvironment& M,
 	return; 
 }
 
+template void diffusion_decay_solver__constant_coefficients_LOD<2>( Microenvironment& M, double dt ); 
+template void diffusion_decay_solver__constant_coefficients_LOD<3>( Microenvironment& M, double dt ); 
+
+void diffusion_decay_solver__constant_coefficients_LOD_3D( Microenvironment& M, double dt )
+{
+	if( M.mesh.regular_mesh == false || M.mesh.Cartesian_mesh == false )
+	{
+		std::cout << "Error: This algorithm is written for regular Cartesian meshes. Try: other solvers!" << std::endl << std::endl; 
+	return; 
+	}
+	
+	if( !M.diffusion_solver_setup_done )
+	{
+		std::cout << std::endl << "Using method " << __FUNCTION__ << " (implicit 3-D LOD with Thomas Algorithm) ... " 
+		<< std::endl << std::endl;  
+	}
+	
+	return diffusion_decay_solver__constant_coefficients_LOD<3>( M , dt ); 
+}
+
 void diffusion_decay_solver__constant_coefficients_LOD_2D( Microenvironment& M, double dt )
 {
 	if( M.mesh.regular_mesh == false )
@@ -307,147 +367,602 @@ void diffusion_decay_solver__constant_coefficients_LOD_2D( Microenvironment& M,
 		return; 
 	}
 	
-	// constants for the linear solver (Thomas algorithm) 
-	
 	if( !M.diffusion_solver_setup_done )
 	{
 		std::cout << std::endl << "Using method " << __FUNCTION__ << " (2D LOD with Thomas Algorithm) ... " << std::endl << std::endl;  
-		
-		M.thomas_denomx.resize( M.mesh.x_coordinates.size() , M.zero );
-		M.thomas_cx.resize( M.mesh.x_coordinates.size() , M.zero );
+	}
+	
+	return diffusion_decay_solver__constant_coefficients_LOD<2>( M , dt ); 
+}
 
-		M.thomas_denomy.resize( M.mesh.y_coordinates.size() , M.zero );
-		M.thomas_cy.resize( M.mesh.y_coordinates.size() , M.zero );
-		
-		// define constants and pre-computed quantities 
+/* 
+ One Thomas solve along a line of count voxels (the first at n, then every jump), 
+ for the listed substrates. The recurrences run in double precision on line, and 
+ the densities are only read and written once per sweep, so single-precision 
+ storage (see real_t) is rounded once per direction. 
+*/ 
 
-		M.thomas_i_jump = 1; 
-		M.thomas_j_jump = M.mesh.x_coordinates.size(); 
+void Microenvironment::thomas_solve_line( int n , int jump , int count , std::vector< std::vector<double> >& denominators , 
+	std::vector< std::vector<double> >& c , std::vector<int>& substrates , std::vector<double>& line )
+{
+	std::vector< std::vector<real_t> >& d = *p_density_vectors; 
+	int size = number_of_densities(); 
+	line.resize( count*size ); 
+	
+	// forward elimination, using pre-computed quantities 
+	for( int m=0; m < substrates.size() ; m++ )
+	{
+		int s = substrates[m]; 
+		line[s] = d[n][s]; 
+		line[s] /= denominators[0][s]; 
+	}
+	for( int i=1; i < count ; i++ )
+	{
+		std::vector<real_t>& density = d[ n + i*jump ]; 
+		for( int m=0; m < substrates.size() ; m++ )
+		{
+			int s = substrates[m]; 
+			line[i*size+s] = density[s]; 
+			line[i*size+s] += thomas_constant1[s] * line[(i-1)*size+s]; 
+			line[i*size+s] /= denominators[i][s]; 
+		}
+	}
+	
+	// back substitution 
+	for( int i=count-2; i >= 0 ; i-- )
+	{
+		for( int m=0; m < substrates.size() ; m++ )
+		{
+			int s = substrates[m]; 
+			line[i*size+s] -= c[i][s] * line[(i+1)*size+s]; 
+		}
+	}
+	
+	for( int i=0; i < count ; i++ )
+	{
+		std::vector<real_t>& density = d[ n + i*jump ]; 
+		for( int m=0; m < substrates.size() ; m++ )
+		{
+			int s = substrates[m]; 
+			density[s] = line[i*size+s]; 
+		}
+	}
+	return; 
+}
 
-		M.thomas_constant1 =  M.diffusion_coefficients; //   dt*D/dx^2 
-		M.thomas_constant1a = M.zero; // -dt*D/dx^2; 
-		M.thomas_constant2 =  M.decay_rates; // (1/2)*dt*lambda 
-		M.thomas_constant3 = M.one; // 1 + 2*constant1 + constant2; 
-		M.thomas_constant3a = M.one; // 1 + constant1 + constant2; 
+/* 
+ The Thomas solves along the axis cut by an MPI decomposition (see BioFVM_MPI.h), 
+ for all the lines of the slab at once (line q starts at voxel q, then every jump). 
+ The forward elimination needs the last row of the rank below, and the back 
+ substitution the first row of the rank above, so the lines are split into blocks 
+ that are passed up (and then down) the ranks as a pipeline. The arithmetic is 
+ that of thomas_solve_line, so the densities match those of a single rank. 
+*/ 
+
+void Microenvironment::thomas_solve_distributed( int jump , std::vector< std::vector<double> >& denominators , 
+	std::vector< std::vector<double> >& c , std::vector<int>& substrates )
+{
+	// including the waits for the neighboring ranks 
+	BIOFVM_TRACE_SCOPE( "LOD distributed sweep" ); 
+	std::vector< std::vector<real_t> >& d = *p_density_vectors; 
+	int size = number_of_densities(); 
+	int count = number_of_voxels() / jump; 
+	int first = domain_decomposition.first_layer; 
+	int lower = domain_decomposition.lower_neighbor; 
+	int upper = domain_decomposition.upper_neighbor; 
+	
+	std::vector<double>& line = thomas_pipeline; 
+	line.resize( number_of_voxels()*size ); 
+	std::vector<double> carry; 
+	
+	// about 4 blocks per rank keeps the pipeline full 
+	int blocks = std::min( jump , 4*domain_decomposition.size ); 
+	int block_size = ( jump + blocks - 1 ) / blocks; 
+	
+	// forward elimination 
+	for( int q0=0; q0 < jump ; q0 += block_size )
+	{
+		int q1 = std::min( q0 + block_size , jump ); 
+		carry.resize( (q1-q0)*size ); 
+		if( lower >= 0 )
+		{ domain_decomposition.receive( carry , lower , 101 ); }
 		
-		M.thomas_constant1 *= dt; 
-		M.thomas_constant1 /= M.mesh.dx; 
-		M.thomas_constant1 /= M.mesh.dx; 
-
-		M.thomas_constant1a = M.thomas_constant1; 
-		M.thomas_constant1a *= -1.0; 
-
-		M.thomas_constant2 *= dt; 
-		M.thomas_constant2 *= 0.5; // for splitting via LOD
-
-		M.thomas_constant3 += M.thomas_constant1; 
-		M.thomas_constant3 += M.thomas_constant1; 
-		M.thomas_constant3 += M.thomas_constant2; 
-
-		M.thomas_constant3a += M.thomas_constant1; 
-		M.thomas_constant3a += M.thomas_constant2; 
+		#pragma omp parallel for 
+		for( int q=q0; q < q1 ; q++ )
+		{
+			for( int i=0; i < count ; i++ )
+			{
+				int n = q + i*jump; 
+				for( int m=0; m < substrates.size() ; m++ )
+				{
+					int s = substrates[m]; 
+					line[n*size+s] = d[n][s]; 
+					if( i == 0 && lower < 0 )
+					{ line[n*size+s] /= denominators[0][s]; continue; }
+					
+					double previous = ( i == 0 ) ? carry[(q-q0)*size+s] : line[(n-jump)*size+s]; 
+					line[n*size+s] += thomas_constant1[s] * previous; 
+					line[n*size+s] /= denominators[first+i][s]; 
+				}
+			}
+		}
 		
-		// Thomas solver coefficients 
-
-		M.thomas_cx.assign( M.mesh.x_coordinates.size() , M.thomas_constant1a ); 
-		M.thomas_denomx.assign( M.mesh.x_coordinates.size()  , M.thomas_constant3 ); 
-		M.thomas_denomx[0] = M.thomas_constant3a; 
-		M.thomas_denomx[ M.mesh.x_coordinates.size()-1 ] = M.thomas_constant3a; 
-		if( M.mesh.x_coordinates.size() == 1 )
-		{ M.thomas_denomx[0] = M.one; M.thomas_denomx[0] += M.thomas_constant2; } 
-
-		M.thomas_cx[0] /= M.thomas_denomx[0]; 
-		for( unsigned int i=1 ; i <= M.mesh.x_coordinates.size()-1 ; i++ )
-		{ 
-			axpy( &M.thomas_denomx[i] , M.thomas_constant1 , M.thomas_cx[i-1] ); 
-			M.thomas_cx[i] /= M.thomas_denomx[i]; // the value at  size-1 is not actually used  
+		if( upper >= 0 )
+		{
+			for( int q=q0; q < q1 ; q++ )
+			{
+				int n = q + (count-1)*jump; 
+				for( int s=0; s < size ; s++ )
+				{ carry[(q-q0)*size+s] = line[n*size+s]; }
+			}
+			domain_decomposition.send( carry , upper , 101 ); 
+		}
+	}
+	
+	// back substitution 
+	for( int q0=0; q0 < jump ; q0 += block_size )
+	{
+		int q1 = std::min( q0 + block_size , jump ); 
+		carry.resize( (q1-q0)*size ); 
+		if( upper >= 0 )
+		{ domain_decomposition.receive( carry , upper , 102 ); }
+		
+		#pragma omp parallel for 
+		for( int q=q0; q < q1 ; q++ )
+		{
+			for( int i=count-1; i >= 0 ; i-- )
+			{
+				int n = q + i*jump; 
+				for( int m=0; m < substrates.size() ; m++ )
+				{
+					int s = substrates[m]; 
+					if( i < count-1 )
+					{ line[n*size+s] -= c[first+i][s] * line[(n+jump)*size+s]; }
+					else if( upper >= 0 )
+					{ line[n*size+s] -= c[first+i][s] * carry[(q-q0)*size+s]; }
+					d[n][s] = line[n*size+s]; 
+				}
+			}
 		}
+		
+		if( lower >= 0 )
+		{
+			for( int q=q0; q < q1 ; q++ )
+			{
+				for( int s=0; s < size ; s++ )
+				{ carry[(q-q0)*size+s] = line[q*size+s]; }
+			}
+			domain_decomposition.send( carry , lower , 102 ); 
+		}
+	}
+	return; 
+}
 
-		M.thomas_cy.assign( M.mesh.y_coordinates.size() , M.thomas_constant1a ); 
-		M.thomas_denomy.assign( M.mesh.y_coordinates.size()  , M.thomas_constant3 ); 
-		M.thomas_denomy[0] = M.thomas_constant3a; 
-		M.thomas_denomy[ M.mesh.y_coordinates.size()-1 ] = M.thomas_constant3a; 
-		if( M.mesh.y_coordinates.size() == 1 )
-		{ M.thomas_denomy[0] = M.one; M.thomas_denomy[0] += M.thomas_constant2; } 
+/* 
+ The LOD sweeps for the substrates that are due on this step, when the others 
+ are sub-cycled (see Microenvironment::diffusion_step_multiples). These are the 
+ same sweeps as in the LOD solvers, restricted to those substrates (vector 
+ components). 
+*/
 
-		M.thomas_cy[0] /= M.thomas_denomy[0]; 
-		for( unsigned int i=1 ; i <= M.mesh.y_coordinates.size()-1 ; i++ )
-		{ 
-			axpy( &M.thomas_denomy[i] , M.thomas_constant1 , M.thomas_cy[i-1] ); 
-			M.thomas_cy[i] /= M.thomas_denomy[i]; // the value at  size-1 is not actually used  
+template <int dimension> 
+void Microenvironment::LOD_solve_substrate_subset( void )
+{
+	BIOFVM_TRACE_SCOPE( "LOD substrate subset" ); 
+	std::vector< std::vector<real_t> >& d = *p_density_vectors; 
+	int nx = mesh.x_coordinates.size(); 
+	int ny = mesh.y_coordinates.size(); 
+	int nz = mesh.z_coordinates.size(); 
+	
+	std::vector<int> diffusing; 
+	for( int m=0; m < solved_substrates.size(); m++ )
+	{
+		int s = solved_substrates[m]; 
+		if( diffusion_solver_types[s] == "steady" )
+		{ solve_steady_state_substrate( s ); continue; }
+		if( diffusion_solver_types[s] != "decay_only" )
+		{ diffusing.push_back( s ); continue; }
+		
+		// no diffusion: the LOD splits reduce to one decay factor per direction 
+		double factor = 1.0 / pow( 1.0 + thomas_constant2[s] , dimension ); 
+		#pragma omp parallel for 
+		for( int n=0; n < d.size(); n++ )
+		{ d[n][s] *= factor; }
+	}
+	
+	// x-diffusion (in 2-D, parallel over the rows, as in the LOD solver) 
+	apply_dirichlet_conditions(); 
+	if( dimension == 2 )
+	{
+		#pragma omp parallel for 
+		for( int j=0; j < ny ; j++ )
+		{
+			std::vector<double> line; 
+			thomas_solve_line( voxel_index(0,j,0) , thomas_i_jump , nx , thomas_denomx , thomas_cx , diffusing , line ); 
+		}
+	}
+	else
+	{
+		#pragma omp parallel for 
+		for( int k=0; k < nz ; k++ )
+		{
+			std::vector<double> line; 
+			for( int j=0; j < ny ; j++ )
+			{ thomas_solve_line( voxel_index(0,j,k) , thomas_i_jump , nx , thomas_denomx , thomas_cx , diffusing , line ); }
 		}
-
-		M.diffusion_solver_setup_done = true; 
 	}
-
-	// set the pointer
 	
-	M.apply_dirichlet_conditions();
-
-	// x-diffusion 
-	#pragma omp parallel for 
-	for( unsigned int j=0; j < M.mesh.y_coordinates.size() ; j++ )
+	// y-diffusion 
+	apply_dirichlet_conditions(); 
+	if( dimension == 2 && decomposed )
+	{ thomas_solve_distributed( thomas_j_jump , thomas_denomy , thomas_cy , diffusing ); }
+	else if( dimension == 2 )
+	{
+		#pragma omp parallel for 
+		for( int i=0; i < nx ; i++ )
+		{
+			std::vector<double> line; 
+			thomas_solve_line( voxel_index(i,0,0) , thomas_j_jump , ny , thomas_denomy , thomas_cy , diffusing , line ); 
+		}
+	}
+	else
 	{
-		// Thomas solver, x-direction
+		#pragma omp parallel for 
+		for( int k=0; k < nz ; k++ )
+		{
+			std::vector<double> line; 
+			for( int i=0; i < nx ; i++ )
+			{ thomas_solve_line( voxel_index(i,0,k) , thomas_j_jump , ny , thomas_denomy , thomas_cy , diffusing , line ); }
+		}
+	}
+	
+	if( dimension == 3 && decomposed )
+	{
+		// z-diffusion 
+		apply_dirichlet_conditions(); 
+		thomas_solve_distributed( thomas_k_jump , thomas_denomz , thomas_cz , diffusing ); 
+	}
+	else if( dimension == 3 )
+	{
+		// z-diffusion 
+		apply_dirichlet_conditions(); 
+		#pragma omp parallel for 
+		for( int j=0; j < ny ; j++ )
+		{
+			std::vector<double> line; 
+			for( int i=0; i < nx ; i++ )
+			{ thomas_solve_line( voxel_index(i,j,0) , thomas_k_jump , nz , thomas_denomz , thomas_cz , diffusing , line ); }
+		}
+	}
+	
+	apply_dirichlet_conditions(); 
+	return; 
+}
 
-		// remaining part of forward elimination, using pre-computed quantities 
-		unsigned int n = M.voxel_index(0,j,0);
-		(*M.p_density_vectors)[n] /= M.thomas_denomx[0]; 
+/* 
+ Quasi-steady substrates (diffusion_solver_types "steady"). Each solve finds 
+ 
+	D*laplacian(p) - lambda*p + sum over cells of ( S*T - (S+U)*p ) = 0 
+ 
+ on the voxels, with the Dirichlet nodes fixed and no flux through the outer 
+ faces (the same discretization as the LOD sweeps), by cell-centered geometric 
+ multigrid V-cycles warm-started from the current densities. Coarse levels merge 
+ 2 voxels in each direction that has more than 2, and re-discretize at twice the 
+ spacing. A coarse voxel is fixed (zero correction) if any of its voxels is. 
+*/ 
+
+class Steady_State_Level
+{
+ public:
+	int nx, ny, nz; 
+	double wx, wy, wz; // D/dx^2, D/dy^2, D/dz^2 
+	std::vector<double> reaction; // decay rate plus cell sinks 
+	std::vector<double> rhs; 
+	std::vector<double> u; 
+	std::vector<char> fixed; 
+	
+	int index( int i, int j, int k )
+	{ return ( k*ny + j )*nx + i; }
+	
+	// returns the diagonal, and the off-diagonal sum (with sign) in neighbor_sum 
+	double row( int i, int j, int k, double& neighbor_sum )
+	{
+		int n = index(i,j,k); 
+		double diagonal = reaction[n]; 
+		neighbor_sum = 0.0; 
+		if( i > 0 ) { diagonal += wx; neighbor_sum += wx*u[n-1]; }
+		if( i < nx-1 ) { diagonal += wx; neighbor_sum += wx*u[n+1]; }
+		if( j > 0 ) { diagonal += wy; neighbor_sum += wy*u[n-nx]; }
+		if( j < ny-1 ) { diagonal += wy; neighbor_sum += wy*u[n+nx]; }
+		if( k > 0 ) { diagonal += wz; neighbor_sum += wz*u[n-nx*ny]; }
+		if( k < nz-1 ) { diagonal += wz; neighbor_sum += wz*u[n+nx*ny]; }
+		return diagonal; 
+	}
+};
 
-		n += M.thomas_i_jump; 
-		for( unsigned int i=1; i < M.mesh.x_coordinates.size() ; i++ )
+// red-black Gauss-Seidel 
+void steady_state_smooth( Steady_State_Level& L , int sweeps )
+{
+	for( int sweep=0; sweep < 2*sweeps ; sweep++ )
+	{
+		int color = sweep % 2; 
+		#pragma omp parallel for 
+		for( int k=0; k < L.nz ; k++ )
 		{
-			axpy( &(*M.p_density_vectors)[n] , M.thomas_constant1 , (*M.p_density_vectors)[n-M.thomas_i_jump] ); 
-			(*M.p_density_vectors)[n] /= M.thomas_denomx[i]; 
-			n += M.thomas_i_jump; 
+			for( int j=0; j < L.ny ; j++ )
+			{
+				for( int i=( j+k+color ) % 2; i < L.nx ; i += 2 )
+				{
+					int n = L.index(i,j,k); 
+					if( L.fixed[n] )
+					{ continue; }
+					double neighbor_sum; 
+					double diagonal = L.row(i,j,k,neighbor_sum); 
+					if( diagonal > 0.0 )
+					{ L.u[n] = ( L.rhs[n] + neighbor_sum ) / diagonal; }
+				}
+			}
 		}
+	}
+	return; 
+}
 
-		// back substitution 
-		n = M.voxel_index( M.mesh.x_coordinates.size()-2 ,j,0); 
-
-		for( int i = M.mesh.x_coordinates.size()-2 ; i >= 0 ; i-- )
+// residual = rhs - A*u (0 on fixed voxels); returns the largest |residual/diagonal| 
+double steady_state_residual( Steady_State_Level& L , std::vector<double>& residual )
+{
+	residual.assign( L.u.size() , 0.0 ); 
+	double max_scaled = 0.0; 
+	#pragma omp parallel for reduction(max:max_scaled) 
+	for( int k=0; k < L.nz ; k++ )
+	{
+		for( int j=0; j < L.ny ; j++ )
 		{
-			naxpy( &(*M.p_density_vectors)[n] , M.thomas_cx[i] , (*M.p_density_vectors)[n+M.thomas_i_jump] ); 
-			n -= M.thomas_i_jump; 
+			for( int i=0; i < L.nx ; i++ )
+			{
+				int n = L.index(i,j,k); 
+				if( L.fixed[n] )
+				{ continue; }
+				double neighbor_sum; 
+				double diagonal = L.row(i,j,k,neighbor_sum); 
+				residual[n] = L.rhs[n] + neighbor_sum - diagonal*L.u[n]; 
+				if( diagonal > 0.0 && fabs( residual[n] ) / diagonal > max_scaled )
+				{ max_scaled = fabs( residual[n] ) / diagonal; }
+			}
 		}
 	}
+	return max_scaled; 
+}
 
-	// y-diffusion 
+// coarse voxels along a direction with n fine voxels 
+int coarse_size( int n )
+{
+	if( n > 2 )
+	{ return ( n+1 ) / 2; }
+	return n; 
+}
 
-	M.apply_dirichlet_conditions();
-	#pragma omp parallel for 
-	for( unsigned int i=0; i < M.mesh.x_coordinates.size() ; i++ )
+void steady_state_coarsen( Steady_State_Level& fine , Steady_State_Level& coarse )
+{
+	coarse.nx = coarse_size( fine.nx ); 
+	coarse.ny = coarse_size( fine.ny ); 
+	coarse.nz = coarse_size( fine.nz ); 
+	coarse.wx = fine.wx * ( coarse.nx < fine.nx ? 0.25 : 1.0 ); 
+	coarse.wy = fine.wy * ( coarse.ny < fine.ny ? 0.25 : 1.0 ); 
+	coarse.wz = fine.wz * ( coarse.nz < fine.nz ? 0.25 : 1.0 ); 
+	
+	int size = coarse.nx * coarse.ny * coarse.nz; 
+	coarse.reaction.assign( size , 0.0 ); 
+	coarse.rhs.assign( size , 0.0 ); 
+	coarse.u.assign( size , 0.0 ); 
+	coarse.fixed.assign( size , 0 ); 
+	
+	std::vector<int> count( size , 0 ); 
+	for( int k=0; k < fine.nz ; k++ )
 	{
-		// Thomas solver, y-direction
+		for( int j=0; j < fine.ny ; j++ )
+		{
+			for( int i=0; i < fine.nx ; i++ )
+			{
+				int n = fine.index(i,j,k); 
+				int N = coarse.index( coarse.nx < fine.nx ? i/2 : i , 
+					coarse.ny < fine.ny ? j/2 : j , coarse.nz < fine.nz ? k/2 : k ); 
+				coarse.reaction[N] += fine.reaction[n]; 
+				count[N]++; 
+				if( fine.fixed[n] )
+				{ coarse.fixed[N] = 1; }
+			}
+		}
+	}
+	for( int N=0; N < size ; N++ )
+	{ coarse.reaction[N] /= count[N]; }
+	return; 
+}
 
-		// remaining part of forward elimination, using pre-computed quantities 
+// coarse.rhs = average of the fine residual over each coarse voxel 
+void steady_state_restrict( Steady_State_Level& fine , std::vector<double>& residual , Steady_State_Level& coarse )
+{
+	coarse.rhs.assign( coarse.rhs.size() , 0.0 ); 
+	std::vector<int> count( coarse.rhs.size() , 0 ); 
+	for( int k=0; k < fine.nz ; k++ )
+	{
+		for( int j=0; j < fine.ny ; j++ )
+		{
+			for( int i=0; i < fine.nx ; i++ )
+			{
+				int N = coarse.index( coarse.nx < fine.nx ? i/2 : i , 
+					coarse.ny < fine.ny ? j/2 : j , coarse.nz < fine.nz ? k/2 : k ); 
+				coarse.rhs[N] += residual[ fine.index(i,j,k) ]; 
+				count[N]++; 
+			}
+		}
+	}
+	for( int N=0; N < coarse.rhs.size() ; N++ )
+	{
+		if( coarse.fixed[N] )
+		{ coarse.rhs[N] = 0.0; }
+		else
+		{ coarse.rhs[N] /= count[N]; }
+	}
+	coarse.u.assign( coarse.u.size() , 0.0 ); 
+	return; 
+}
 
-		int n = M.voxel_index(i,0,0);
-		(*M.p_density_vectors)[n] /= M.thomas_denomy[0]; 
+// the coarse voxels a fine voxel interpolates from in one direction (weights 3/4 and 1/4) 
+void interpolation_stencil( int i , int n_fine , int n_coarse , int& I0 , int& I1 , double& w0 )
+{
+	if( n_coarse == n_fine )
+	{ I0 = i; I1 = i; w0 = 1.0; return; }
+	I0 = i/2; 
+	I1 = ( i % 2 == 0 ) ? I0-1 : I0+1; 
+	w0 = 0.75; 
+	if( I1 < 0 || I1 >= n_coarse )
+	{ I1 = I0; }
+	return; 
+}
 
-		n += M.thomas_j_jump; 
-		for( unsigned int j=1; j < M.mesh.y_coordinates.size() ; j++ )
+// fine.u += (trilinear) interpolation of coarse.u, on free fine voxels 
+void steady_state_prolong( Steady_State_Level& coarse , Steady_State_Level& fine )
+{
+	#pragma omp parallel for 
+	for( int k=0; k < fine.nz ; k++ )
+	{
+		int K[2]; double wk[2]; 
+		interpolation_stencil( k , fine.nz , coarse.nz , K[0] , K[1] , wk[0] ); 
+		wk[1] = 1.0 - wk[0]; 
+		for( int j=0; j < fine.ny ; j++ )
 		{
-			axpy( &(*M.p_density_vectors)[n] , M.thomas_constant1 , (*M.p_density_vectors)[n-M.thomas_j_jump] ); 
-			(*M.p_density_vectors)[n] /= M.thomas_denomy[j]; 
-			n += M.thomas_j_jump; 
+			int J[2]; double wj[2]; 
+			interpolation_stencil( j , fine.ny , coarse.ny , J[0] , J[1] , wj[0] ); 
+			wj[1] = 1.0 - wj[0]; 
+			for( int i=0; i < fine.nx ; i++ )
+			{
+				int n = fine.index(i,j,k); 
+				if( fine.fixed[n] )
+				{ continue; }
+				int I[2]; double wi[2]; 
+				interpolation_stencil( i , fine.nx , coarse.nx , I[0] , I[1] , wi[0] ); 
+				wi[1] = 1.0 - wi[0]; 
+				
+				double correction = 0.0; 
+				for( int c=0; c < 2 ; c++ )
+				{
+					for( int b=0; b < 2 ; b++ )
+					{
+						for( int a=0; a < 2 ; a++ )
+						{ correction += wk[c]*wj[b]*wi[a] * coarse.u[ coarse.index(I[a],J[b],K[c]) ]; }
+					}
+				}
+				fine.u[n] += correction; 
+			}
 		}
+	}
+	return; 
+}
 
-		// back substitution 
-		n = M.voxel_index( i,M.mesh.y_coordinates.size()-2, 0); 
+void steady_state_V_cycle( std::vector<Steady_State_Level>& levels , int level , std::vector< std::vector<double> >& residuals )
+{
+	Steady_State_Level& L = levels[level]; 
+	if( level == levels.size()-1 )
+	{
+		steady_state_smooth( L , 50 ); 
+		return; 
+	}
+	
+	steady_state_smooth( L , 2 ); 
+	steady_state_residual( L , residuals[level] ); 
+	steady_state_restrict( L , residuals[level] , levels[level+1] ); 
+	steady_state_V_cycle( levels , level+1 , residuals ); 
+	steady_state_prolong( levels[level+1] , L ); 
+	steady_state_smooth( L , 2 ); 
+	return; 
+}
 
-		for( int j = M.mesh.y_coordinates.size()-2 ; j >= 0 ; j-- )
+void Microenvironment::solve_steady_state_substrate( int s )
+{
+	BIOFVM_TRACE_SCOPE( "steady-state solve" ); 
+	if( mesh.regular_mesh == false )
+	{
+		std::cout << "Error: steady-state solves are written for regular Cartesian meshes." << std::endl; 
+		return; 
+	}
+	
+	// the multigrid hierarchy: geometry and Dirichlet nodes, then coefficients 
+	std::vector<Steady_State_Level> levels( 1 ); 
+	Steady_State_Level& L = levels[0]; 
+	L.nx = mesh.x_coordinates.size(); 
+	L.ny = mesh.y_coordinates.size(); 
+	L.nz = mesh.z_coordinates.size(); 
+	L.wx = diffusion_coefficients[s] / ( mesh.dx * mesh.dx ); 
+	L.wy = diffusion_coefficients[s] / ( mesh.dy * mesh.dy ); 
+	L.wz = diffusion_coefficients[s] / ( mesh.dz * mesh.dz ); 
+	
+	int size = number_of_voxels(); 
+	L.reaction.assign( size , decay_rates[s] ); 
+	L.rhs.assign( size , 0.0 ); 
+	L.u.resize( size ); 
+	L.fixed.assign( size , 0 ); 
+	for( int n=0; n < size ; n++ )
+	{
+		L.u[n] = (*p_density_vectors)[n][s]; 
+		if( mesh.is_Dirichlet( n ) == true && dirichlet_activation_vector[s] == true )
 		{
-			naxpy( &(*M.p_density_vectors)[n] , M.thomas_cy[j] , (*M.p_density_vectors)[n+M.thomas_j_jump] ); 
-			n -= M.thomas_j_jump; 
+			L.fixed[n] = 1; 
+			L.u[n] = dirichlet_value_vectors[n][s]; 
 		}
 	}
-
-	M.apply_dirichlet_conditions();
 	
-	// reset gradient vectors 
-//	M.reset_all_gradient_vectors(); 
+	// cell sources and sinks 
+	for( int a=0; a < all_basic_agents.size() ; a++ )
+	{
+		Basic_Agent* pA = all_basic_agents[a]; 
+		if( pA->get_microenvironment() != this )
+		{ continue; }
+		double source, sink; 
+		pA->get_source_and_sink_rates( s , source , sink ); 
+		if( source == 0.0 && sink == 0.0 )
+		{ continue; }
+		int n = pA->get_current_voxel_index(); 
+		L.rhs[n] += source; 
+		L.reaction[n] += sink; 
+	}
+	
+	while( levels.back().nx > 2 || levels.back().ny > 2 || levels.back().nz > 2 )
+	{
+		levels.push_back( Steady_State_Level() ); 
+		steady_state_coarsen( levels[ levels.size()-2 ] , levels.back() ); 
+	}
+	std::vector< std::vector<double> > residuals( levels.size() ); 
+	
+	// V-cycles until the residual, in density units, is small next to the densities 
+	double scale = 0.0; 
+	for( int n=0; n < size ; n++ )
+	{
+		if( fabs( levels[0].u[n] ) > scale )
+		{ scale = fabs( levels[0].u[n] ); }
+	}
+	double error = steady_state_residual( levels[0] , residuals[0] ); 
+	int cycles = 0; 
+	while( error > steady_state_tolerance * ( scale + 1e-16 ) && cycles < steady_state_max_cycles )
+	{
+		steady_state_V_cycle( levels , 0 , residuals ); 
+		cycles++; 
+		
+		scale = 0.0; 
+		for( int n=0; n < size ; n++ )
+		{
+			if( fabs( levels[0].u[n] ) > scale )
+			{ scale = fabs( levels[0].u[n] ); }
+		}
+		error = steady_state_residual( levels[0] , residuals[0] ); 
+	}
+	if( error > steady_state_tolerance * ( scale + 1e-16 ) )
+	{
+		std::cout << "Warning: the steady-state solve for " << density_names[s] << " did not converge in " 
+			<< cycles << " V-cycles (relative residual " << error / ( scale + 1e-16 ) << ")." << std::endl; 
+	}
 	
+	for( int n=0; n < size ; n++ )
+	{ (*p_density_vectors)[n][s] = levels[0].u[n]; }
 	return; 
 }
 
@@ -478,12 +993,12 @@ void diffusion_decay_explicit_uniform_rates( Microenvironment& M, double dt )
 
 	// double buffering to reduce memory copy / allocation overhead 
 
-	static vector< vector<double> >* pNew = &(M.temporary_density_vectors1);
-	static vector< vector<double> >* pOld = &(M.temporary_density_vectors2);
+	static vector< vector<real_t> >* pNew = &(M.temporary_density_vectors1);
+	static vector< vector<real_t> >* pOld = &(M.temporary_density_vectors2);
 
 	// swap the buffers 
 
-	vector< vector<double> >* pTemp = pNew; 
+	vector< vector<real_t> >* pTemp = pNew; 
 	pNew = pOld; 
 	pOld = pTemp; 
 	M.p_density_vectors = pNew; 
@@ -499,20 +1014,21 @@ void diffusion_decay_explicit_uniform_rates( Microenvironment& M, double dt )
 	#pragma omp parallel for
 	for( unsigned int i=0; i < (*(M.p_density_vectors)).size() ; i++ )
 	{
-		unsigned int number_of_neighbors = M.mesh.connected_voxel_indices[i].size(); 
+		int neighbors[6]; 
+		unsigned int number_of_neighbors = M.mesh.connected_voxels( i , neighbors ); 
 
 		double d1 = -1.0 * number_of_neighbors; 
 
-		(*pNew)[i] = (*pOld)[i];  
-		(*pNew)[i] *= constant4; 
-
-		for( unsigned int j=0; j < number_of_neighbors ; j++ )
+		// accumulate in double (the densities may be stored in single precision) 
+		for( unsigned int s=0; s < constant2.size() ; s++ )
 		{
-			axpy( &(*pNew)[i], constant2, (*pOld)[  M.mesh.connected_voxel_indices[i][j] ] ); 
+			double value = (*pOld)[i][s]; 
+			value *= constant4[s]; 
+			for( unsigned int j=0; j < number_of_neighbors ; j++ )
+			{ value += constant2[s] * (*pOld)[ neighbors[j] ][s]; }
+			value += ( constant2[s] * d1 ) * (*pOld)[i][s]; 
+			(*pNew)[i][s] = value; 
 		}
-		vector<double> temp = constant2; 
-		temp *= d1; 
-		axpy( &(*pNew)[i] , temp , (*pOld)[i] ); 
 	}
 	
 	// reset gradient vectors 
@@ -58,6 +58,8 @@ namespace BioFVM{
 void diffusion_decay_solver__constant_coefficients_LOD_3D( Microenvironment& M, double dt ); // done
 // /*! diffusion-decay solver: 2D LOD implicit (stable method). D and r uniform */  
 void diffusion_decay_solver__constant_coefficients_LOD_2D( Microenvironment& M, double dt ); // done
+// /*! the LOD body shared by the two above, for dimension 2 or 3 (no z work in 2D) */  
+template <int dimension> void diffusion_decay_solver__constant_coefficients_LOD( Microenvironment& M, double dt ); 
 
 /*! This solves for constant diffusion coefficients on a general mesh using the 
     explicit stepping for the diffusion operator, and implicit stepping for all 
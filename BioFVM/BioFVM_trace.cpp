@@ -0,0 +1,195 @@
+/*
+#############################################################################
+# If you use BioFVM in your project, please cite BioFVM and the version     #
+# number, such as below:                                                    #
+#                                                                           #
+# We solved the diffusion equations using BioFVM (Version 1.1.7) [1]        #
+#                                                                           #
+# [1] A. Ghaffarizadeh, S.H. Friedman, and P. Macklin, BioFVM: an efficient #
+#    parallelized diffusive transport solver for 3-D biological simulations,#
+#    Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730 #
+#                                                                           #
+#############################################################################
+#                                                                           #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)   #
+#                                                                           #
+# Copyright (c) 2015-2017, Paul Macklin and the BioFVM Project              #
+# All rights reserved.                                                      #
+#                                                                           #
+# Redistribution and use in source and binary forms, with or without        #
+# modification, are permitted provided that the following conditions are    #
+# met:                                                                      #
+#                                                                           #
+# 1. Redistributions of source code must retain the above copyright notice, #
+# this list of conditions and the following disclaimer.                     #
+#                                                                           #
+# 2. Redistributions in binary form must reproduce the above copyright      #
+# notice, this list of conditions and the following disclaimer in the       #
+# documentation and/or other materials provided with the distribution.      #
+#                                                                           #
+# 3. Neither the name of the copyright holder nor the names of its          #
+# contributors may be used to endorse or promote products derived from this #
+# software without specific prior written permission.                       #
+#                                                                           #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       #
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED #
+# TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A           #
+# PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER #
+# OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,  #
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,       #
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR        #
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    #
+# LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      #
+# NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              #
+#                                                                           #
+#############################################################################
+*/
+
+#include "BioFVM_trace.h"
+#include "BioFVM_MPI.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <chrono>
+#include <mutex>
+#include <algorithm>
+
+namespace BioFVM{
+
+static std::chrono::steady_clock::time_point trace_origin = std::chrono::steady_clock::now(); 
+
+// every thread that has recorded, in order; the buffers live until the end of 
+// the program, so a trace written after a thread ends still has its intervals 
+static std::mutex trace_buffers_mutex; 
+static std::vector<Trace_Buffer*> trace_buffers; 
+static thread_local Trace_Buffer* this_thread_trace_buffer = NULL; 
+
+long long trace_clock( void )
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>( 
+		std::chrono::steady_clock::now() - trace_origin ).count(); 
+}
+
+Trace_Buffer::Trace_Buffer( int thread_index )
+{
+	thread = thread_index; 
+	events.resize( trace_buffer_capacity ); 
+	head = 0; 
+	written = 0; 
+	return; 
+}
+
+void Trace_Buffer::record( const char* name , long long start , long long end )
+{
+	long long n = head.load( std::memory_order_relaxed ); 
+	Trace_Event& event = events[ n % trace_buffer_capacity ]; 
+	strncpy( event.name , name , trace_name_length-1 ); 
+	event.name[trace_name_length-1] = '\0'; 
+	event.start = start; 
+	event.duration = end - start; 
+	head.store( n+1 , std::memory_order_release ); 
+	return; 
+}
+
+static Trace_Buffer* get_this_thread_trace_buffer( void )
+{
+	if( this_thread_trace_buffer == NULL )
+	{
+		std::lock_guard<std::mutex> lock( trace_buffers_mutex ); 
+		this_thread_trace_buffer = new Trace_Buffer( trace_buffers.size() ); 
+		trace_buffers.push_back( this_thread_trace_buffer ); 
+	}
+	return this_thread_trace_buffer; 
+}
+
+Trace_Scope::Trace_Scope( const char* region_name )
+{
+	name = region_name; 
+	start = trace_clock(); 
+	return; 
+}
+
+Trace_Scope::Trace_Scope( const std::string& region_name )
+{
+	name = region_name.c_str(); 
+	start = trace_clock(); 
+	return; 
+}
+
+Trace_Scope::~Trace_Scope()
+{
+	get_this_thread_trace_buffer()->record( name , start , trace_clock() ); 
+}
+
+#ifdef BIOFVM_TRACE
+static void write_trace_name( std::ostream& os , const char* name )
+{
+	os << "\""; 
+	for( const char* c = name; *c != '\0' ; c++ )
+	{
+		if( *c == '"' || *c == '\\' )
+		{ os << "\\"; }
+		if( (unsigned char) *c >= 32 )
+		{ os << *c; }
+	}
+	os << "\""; 
+	return; 
+}
+#endif
+
+bool write_trace( std::string filename )
+{
+#ifndef BIOFVM_TRACE
+	return false; 
+#else
+	// one trace per rank 
+	if( domain_decomposition.active )
+	{ filename = filename.substr( 0 , filename.rfind( ".json" ) ) + "_rank" + std::to_string( domain_decomposition.rank ) + ".json"; }
+	
+	std::ofstream file( filename.c_str() ); 
+	if( !file )
+	{
+		std::cout << "Error: could not write the trace " << filename << "." << std::endl; 
+		return false; 
+	}
+	
+	int process = domain_decomposition.rank; 
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl; 
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << process << ",\"tid\":0,\"args\":{\"name\":\"rank " << process << "\"}}"; 
+	
+	std::lock_guard<std::mutex> lock( trace_buffers_mutex ); 
+	std::vector<Trace_Event> events; 
+	for( int b=0; b < trace_buffers.size() ; b++ )
+	{
+		Trace_Buffer& buffer = *trace_buffers[b]; 
+		file << "," << std::endl << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << process << ",\"tid\":" << buffer.thread 
+			<< ",\"args\":{\"name\":\"thread " << buffer.thread << "\"}}"; 
+		
+		// the buffer's thread may still be recording: copy, then drop what it 
+		// overwrote meanwhile 
+		long long end = buffer.head.load( std::memory_order_acquire ); 
+		long long begin = std::max( buffer.written , end - trace_buffer_capacity ); 
+		events.clear(); 
+		for( long long n=begin; n < end ; n++ )
+		{ events.push_back( buffer.events[ n % trace_buffer_capacity ] ); }
+		long long overwritten = buffer.head.load( std::memory_order_acquire ) - trace_buffer_capacity; 
+		buffer.written = end; 
+		
+		for( long long n=std::max( begin , overwritten ); n < end ; n++ )
+		{
+			Trace_Event& event = events[ n - begin ]; 
+			file << "," << std::endl << "{\"name\":"; 
+			write_trace_name( file , event.name ); 
+			file << ",\"ph\":\"X\",\"pid\":" << process << ",\"tid\":" << buffer.thread 
+				<< ",\"ts\":" << event.start / 1000 << "." << event.start % 1000 / 100 << event.start % 100 / 10 << event.start % 10 
+				<< ",\"dur\":" << event.duration / 1000 << "." << event.duration % 1000 / 100 << event.duration % 100 / 10 << event.duration % 10 << "}"; 
+		}
+	}
+	file << std::endl << "]}" << std::endl; 
+	return true; 
+#endif
+}
+
+};
@@ -0,0 +1,125 @@
+/*
+#############################################################################
+# If you use BioFVM in your project, please cite BioFVM and the version     #
+# number, such as below:                                                    #
+#                                                                           #
+# We solved the diffusion equations using BioFVM (Version 1.1.7) [1]        #
+#                                                                           #
+# [1] A. Ghaffarizadeh, S.H. Friedman, and P. Macklin, BioFVM: an efficient #
+#    parallelized diffusive transport solver for 3-D biological simulations,#
+#    Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730 #
+#                                                                           #
+#############################################################################
+#                                                                           #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)   #
+#                                                                           #
+# Copyright (c) 2015-2017, Paul Macklin and the BioFVM Project              #
+# All rights reserved.                                                      #
+#                                                                           #
+# Redistribution and use in source and binary forms, with or without        #
+# modification, are permitted provided that the following conditions are    #
+# met:                                                                      #
+#                                                                           #
+# 1. Redistributions of source code must retain the above copyright notice, #
+# this list of conditions and the following disclaimer.                     #
+#                                                                           #
+# 2. Redistributions in binary form must reproduce the above copyright      #
+# notice, this list of conditions and the following disclaimer in the       #
+# documentation and/or other materials provided with the distribution.      #
+#                                                                           #
+# 3. Neither the name of the copyright holder nor the names of its          #
+# contributors may be used to endorse or promote products derived from this #
+# software without specific prior written permission.                       #
+#                                                                           #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       #
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED #
+# TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A           #
+# PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER #
+# OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,  #
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,       #
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR        #
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    #
+# LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      #
+# NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              #
+#                                                                           #
+#############################################################################
+*/
+
+#ifndef __BioFVM_trace_h__
+#define __BioFVM_trace_h__
+
+#include <string>
+#include <vector>
+#include <atomic>
+
+namespace BioFVM{
+
+/*
+ Per-thread timelines of the parallel regions, for finding the regions that 
+ stall and the threads that wait at their barriers. Build with "make TRACE=1" 
+ (which defines BIOFVM_TRACE); otherwise the BIOFVM_TRACE_SCOPE markers compile 
+ to nothing. 
+ 
+ BIOFVM_TRACE_SCOPE( name ) records the interval from the marker to the end of 
+ its block on the calling thread. In a parallel region, each thread records its 
+ own interval, which ends when its share of the work does (before the barrier). 
+ Each thread writes to its own ring buffer of the last trace_buffer_capacity 
+ intervals, without locks. 
+ 
+ write_trace() writes the intervals recorded since the last call as a Chrome 
+ trace (JSON; open it in chrome://tracing or ui.perfetto.dev), one row per 
+ thread. PhysiCell writes one next to each saved output. 
+*/
+
+#ifdef BIOFVM_TRACE
+#define BIOFVM_TRACE_JOIN2( a , b ) a##b
+#define BIOFVM_TRACE_JOIN( a , b ) BIOFVM_TRACE_JOIN2( a , b )
+#define BIOFVM_TRACE_SCOPE( name ) BioFVM::Trace_Scope BIOFVM_TRACE_JOIN( trace_scope_ , __LINE__ )( name )
+#else
+#define BIOFVM_TRACE_SCOPE( name )
+#endif
+
+static const int trace_buffer_capacity = 65536; // intervals per thread 
+static const int trace_name_length = 48; // longer names are cut 
+
+class Trace_Event
+{
+ public:
+	char name[trace_name_length]; 
+	long long start; // ns since the start of the program 
+	long long duration; // ns 
+};
+
+class Trace_Buffer
+{
+ public:
+	int thread; // in the order the threads first recorded 
+	std::vector<Trace_Event> events; 
+	std::atomic<long long> head; // intervals written, ever; only its thread writes 
+	long long written; // intervals already in a trace file 
+	
+	Trace_Buffer( int thread_index ); 
+	void record( const char* name , long long start , long long end ); 
+};
+
+class Trace_Scope
+{
+ private:
+	const char* name; 
+	long long start; 
+ public:
+	Trace_Scope( const char* region_name ); 
+	Trace_Scope( const std::string& region_name ); // the string must outlive the scope 
+	~Trace_Scope(); 
+};
+
+long long trace_clock( void ); // ns since the start of the program 
+
+// false if BIOFVM_TRACE is not defined, or the file cannot be written. 
+// (Intervals overwritten in the ring buffers since the last call are lost.) 
+bool write_trace( std::string filename ); 
+
+};
+
+#endif
@@ -49,6 +49,12 @@
 #include "BioFVM.h"
 #include "BioFVM_utilities.h"
 
+#include <cstdio>
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
 namespace BioFVM{
 /*
 std::string BioFVM_Version; 
@@ -174,4 +180,48 @@ double compute_variance( std::vector<double>& values )
 	return compute_variance( values , mean ); 
 }	
 
+long long current_RSS_bytes( void )
+{
+	long long out = 0; 
+#ifdef __linux__
+	// the second field is the resident pages 
+	FILE* fp = fopen( "/proc/self/statm" , "r" ); 
+	if( fp == NULL )
+	{ return 0; }
+	long long total_pages = 0; 
+	long long resident_pages = 0; 
+	if( fscanf( fp , "%lld %lld" , &total_pages , &resident_pages ) == 2 )
+	{ out = resident_pages * sysconf( _SC_PAGESIZE ); }
+	fclose( fp ); 
+#endif
+	return out; 
+}
+
+long long peak_RSS_bytes( void )
+{
+#ifdef _WIN32
+	return 0; 
+#else
+	struct rusage usage; 
+	if( getrusage( RUSAGE_SELF , &usage ) != 0 )
+	{ return 0; }
+#ifdef __APPLE__
+	return usage.ru_maxrss; // bytes 
+#else
+	return usage.ru_maxrss * 1024LL; // kilobytes 
+#endif
+#endif
+}
+
+long long heap_bytes( const std::vector<bool>& v )
+{ return ( v.capacity() + 7 ) / 8; }
+
+long long heap_bytes( const std::string& s )
+{
+	// short strings are kept in the object (15 characters in libstdc++) 
+	if( s.capacity() <= 15 )
+	{ return 0; }
+	return s.capacity() + 1; 
+}
+
 };
\ No newline at end of file
@@ -55,6 +55,8 @@
 #include <string>
 #include <chrono>
 #include <random>
+#include <vector>
+#include <unordered_map>
 
 namespace BioFVM{
 
@@ -80,7 +82,43 @@ double uniform_random( void );
 double compute_mean( std::vector<double>& values );
 double compute_variance( std::vector<double>& values, double mean ); 
 double compute_variance( std::vector<double>& values ); 
-	
+
+// resident set size of the process, now and at its peak (0 if unknown) 
+long long current_RSS_bytes( void ); 
+long long peak_RSS_bytes( void ); 
+
+// the heap memory a container holds (its capacity, and that of the containers 
+// in it), for the memory_footprint() accounting 
+template <class T> 
+long long heap_bytes( const std::vector<T>& v )
+{ return v.capacity() * sizeof(T); }
+
+template <class T> 
+long long heap_bytes( const std::vector< std::vector<T> >& v )
+{
+	long long out = v.capacity() * sizeof( std::vector<T> ); 
+	for( unsigned int i=0; i < v.size() ; i++ )
+	{ out += heap_bytes( v[i] ); }
+	return out; 
+}
+
+long long heap_bytes( const std::vector<bool>& v ); 
+long long heap_bytes( const std::string& s ); 
+
+// buckets and nodes, as in libstdc++ 
+template <class K, class V> 
+long long heap_bytes( const std::unordered_map<K,V>& m )
+{ return m.bucket_count() * sizeof(void*) + m.size() * ( sizeof( std::pair<const K,V> ) + 2*sizeof(void*) ); }
+
+template <class V> 
+long long heap_bytes( const std::unordered_map<std::string,V>& m )
+{
+	long long out = m.bucket_count() * sizeof(void*) + m.size() * ( sizeof( std::pair<const std::string,V> ) + 2*sizeof(void*) ); 
+	for( auto& entry : m )
+	{ out += heap_bytes( entry.first ); }
+	return out; 
+}
+
 };
  
 #endif 
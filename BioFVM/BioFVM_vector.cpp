@@ -484,4 +484,65 @@ void vector3_to_list( const std::vector<double>& vect , char*& buffer , char del
 	return; 
 }
 
+#ifdef BIOFVM_SINGLE_PRECISION
+
+void operator+=( std::vector<float>& v1, const std::vector<double>& v2 )
+{
+	for( unsigned int i=0; i < v1.size() ; i++ )
+	{ v1[i] = (double) v1[i] + v2[i]; }
+	return; 
+}
+
+void operator/=( std::vector<float>& v1, const std::vector<double>& v2 )
+{
+	for( unsigned int i=0; i < v1.size() ; i++ )
+	{ v1[i] = (double) v1[i] / v2[i]; }
+	return; 
+}
+
+void operator*=( std::vector<double>& v1, const std::vector<float>& v2 )
+{
+	for( unsigned int i=0; i < v1.size() ; i++ )
+	{ v1[i] *= v2[i]; }
+	return; 
+}
+
+std::ostream& operator<<(std::ostream& os, const std::vector<float>& v )
+{
+	for( unsigned int i=0; i < v.size(); i++ )
+	{ os << v[i] << " " ; }
+	return os; 
+}
+
+void axpy( std::vector<float>* y, double& a , std::vector<double>& x )
+{
+	for( unsigned int i=0; i < (*y).size() ; i++ )
+	{ (*y)[i] = (double) (*y)[i] + a * x[i]; }
+	return; 
+}
+
+void axpy( std::vector<double>* y, double& a , std::vector<float>& x )
+{
+	for( unsigned int i=0; i < (*y).size() ; i++ )
+	{ (*y)[i] += a * x[i]; }
+	return; 
+}
+
+void csv_to_vector( const char* buffer , std::vector<float>& vect )
+{
+	std::vector<double> temp; 
+	csv_to_vector( buffer , temp ); 
+	vect.assign( temp.begin() , temp.end() ); 
+	return; 
+}
+
+void vector_to_list( const std::vector<float>& vect , char*& buffer , char delim )
+{
+	std::vector<double> temp( vect.begin() , vect.end() ); 
+	vector_to_list( temp , buffer , delim ); 
+	return; 
+}
+
+#endif
+
 };
@@ -57,6 +57,19 @@
 
 namespace BioFVM{
 
+/* 
+ storage precision of the microenvironment densities. Build with 
+ -DBIOFVM_SINGLE_PRECISION (make PRECISION=single) to store them as float. 
+ Rates, coefficients, and gradients stay double, and the solvers do their 
+ arithmetic in double. 
+*/ 
+
+#ifdef BIOFVM_SINGLE_PRECISION
+typedef float real_t; 
+#else
+typedef double real_t; 
+#endif
+
 /* faster operator overloading. multiplication and division are element-wise (Hadamard) */ 
 
 std::vector<double> operator-( const std::vector<double>& v1 , const std::vector<double>& v2 );
@@ -139,6 +152,23 @@ void vector_to_list( const std::vector<double>& vect , char*& buffer , char deli
 
 void vector3_to_list( const std::vector<double>& vect , char*& buffer , char delim ); 
 
+#ifdef BIOFVM_SINGLE_PRECISION
+/* mixed-precision versions for the (float) density vectors */ 
+
+void operator+=( std::vector<float>& v1, const std::vector<double>& v2 ); 
+void operator/=( std::vector<float>& v1, const std::vector<double>& v2 ); 
+void operator*=( std::vector<double>& v1, const std::vector<float>& v2 ); 
+
+std::ostream& operator<<(std::ostream& os, const std::vector<float>& v ); 
+
+// y = y + a*x 
+void axpy( std::vector<float>* y, double& a , std::vector<double>& x );
+void axpy( std::vector<double>* y, double& a , std::vector<float>& x );
+
+void csv_to_vector( const char* buffer , std::vector<float>& vect ); 
+void vector_to_list( const std::vector<float>& vect , char*& buffer , char delim );
+#endif
+
 };
 
 #endif
@@ -80,6 +80,14 @@ static std::string PhysiCell_DOI = "10.1371/journal.pcbi.1005991";
 #include "PhysiCell_standard_models.h"
 #include "PhysiCell_cell.h"
 #include "PhysiCell_cell_container.h"
+#include "PhysiCell_simulation.h"
+#include "PhysiCell_scheduler.h"
+#include "PhysiCell_task_graph.h"
+#include "PhysiCell_phenotype_batches.h"
+#include "PhysiCell_hardware_counters.h"
+#include "PhysiCell_load_balancing.h"
+#include "PhysiCell_NUMA.h"
+#include "PhysiCell_MPI.h"
 // #include "PhysiCell_digital_cell_line.h" // to be deprecated! 
 #include "PhysiCell_utilities.h"
 #include "PhysiCell_constants.h"
@@ -0,0 +1,371 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "./PhysiCell_MPI.h"
+#include "./PhysiCell_cell.h"
+#include "./PhysiCell_cell_container.h"
+
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+namespace PhysiCell{
+
+Cell_Exchange cell_exchange; 
+
+Cell_Exchange::Cell_Exchange()
+{
+	container = NULL; 
+	voxel_size = 1.0; 
+	start = 0.0; 
+	global_layers = 0; 
+	ghosts_in_use = 0; 
+	return; 
+}
+
+int Cell_Exchange::layer_of( double coordinate )
+{
+	return (int) floor( ( coordinate - start ) / voxel_size ); 
+}
+
+void Cell_Exchange::initialize( Cell_Container* pContainer , double mechanics_voxel_size )
+{
+	container = pContainer; 
+	voxel_size = mechanics_voxel_size; 
+	
+	int axis = domain_decomposition.axis; 
+	std::vector<double> box = domain_decomposition.global_bounding_box; 
+	start = box[axis]; 
+	global_layers = (int) ceil( 1e-16 + ( box[axis+3] - box[axis] )/voxel_size ); 
+	
+	// each rank holds the layers its slab touches, and one more toward each neighbor 
+	first_layers.resize( domain_decomposition.size ); 
+	last_layers.resize( domain_decomposition.size ); 
+	for( int r=0; r < domain_decomposition.size ; r++ )
+	{
+		int first; 
+		int last; 
+		domain_decomposition.layers_of_rank( r , first , last ); 
+		double lower = domain_decomposition.global_start + first*domain_decomposition.spacing; 
+		double upper = domain_decomposition.global_start + (last+1)*domain_decomposition.spacing; 
+		if( last == domain_decomposition.global_layers-1 )
+		{ upper = domain_decomposition.global_end; }
+		
+		if( upper - lower < 2.0*voxel_size )
+		{
+			std::cout << "Error: the MPI slabs (" << upper - lower << " thick for rank " << r 
+				<< ") must be at least two mechanics voxels (" << voxel_size << ") thick. Use fewer ranks." << std::endl; 
+			exit(-1); 
+		}
+		
+		first_layers[r] = std::max( 0 , layer_of( lower ) - 1 ); 
+		last_layers[r] = std::min( global_layers-1 , layer_of( upper ) + 1 ); 
+		if( r == 0 )
+		{ first_layers[r] = 0; }
+		if( r == domain_decomposition.size-1 )
+		{ last_layers[r] = global_layers-1; }
+	}
+	
+	// this rank's part of the global grid (ending the range half a layer early, 
+	// so that the layer count can't round up) 
+	int rank = domain_decomposition.rank; 
+	int layers = last_layers[rank] - first_layers[rank] + 1; 
+	std::vector<double> range = box; 
+	range[axis] = start + first_layers[rank]*voxel_size; 
+	range[axis+3] = range[axis] + ( layers - 0.5 )*voxel_size; 
+	
+	// in 2-D, keep a single z layer, as the 2-D mechanics kernels assume 
+	double z_size = voxel_size; 
+	if( default_microenvironment_options.simulate_2D == true )
+	{ z_size = std::max( voxel_size , box[5] - box[2] ); }
+	container->initialize( range[0], range[3], range[1], range[4], range[2], range[5], voxel_size, voxel_size, z_size ); 
+	
+	Cartesian_Mesh& mesh = container->underlying_mesh; 
+	domain_decomposition.set_layer_coordinates( mesh , start , voxel_size , first_layers[rank] ); 
+	mesh.bounding_box[axis+3] = start + ( last_layers[rank] + 1 )*voxel_size; 
+	if( last_layers[rank] == global_layers-1 )
+	{ mesh.bounding_box[axis+3] = box[axis+3]; }
+	return; 
+}
+
+void Cell_Exchange::select_batch_in_slab( std::vector< std::vector<double> >& positions , Cell_Batch_Overrides& overrides , 
+	std::vector< std::vector<double> >& slab_positions , Cell_Batch_Overrides& slab_overrides , std::vector<int>& IDs )
+{
+	// rank 0's batch: the counts, then the positions, volumes, and custom values 
+	std::vector<double> batch; 
+	if( domain_decomposition.rank == 0 )
+	{
+		int columns = overrides.custom_data_names.size(); 
+		batch.push_back( positions.size() ); 
+		batch.push_back( overrides.volumes.size() ); 
+		batch.push_back( overrides.custom_data_values.size() ); 
+		for( int k=0; k < positions.size() ; k++ )
+		{ batch.insert( batch.end() , positions[k].begin() , positions[k].begin()+3 ); }
+		batch.insert( batch.end() , overrides.volumes.begin() , overrides.volumes.end() ); 
+		for( int k=0; k < overrides.custom_data_values.size() ; k++ )
+		{
+			std::vector<double> row = overrides.custom_data_values[k]; 
+			row.resize( columns , 0.0 ); 
+			batch.insert( batch.end() , row.begin() , row.end() ); 
+		}
+	}
+	domain_decomposition.broadcast( batch ); 
+	
+	int number_of_cells = (int) batch[0]; 
+	int number_of_volumes = (int) batch[1]; 
+	int number_of_rows = (int) batch[2]; 
+	int columns = overrides.custom_data_names.size(); 
+	if( ( number_of_volumes > 0 && number_of_volumes != number_of_cells ) || 
+		( columns > 0 && number_of_rows != number_of_cells ) )
+	{
+		std::cout << "Error: create_cells received " << number_of_volumes << " volumes and " << number_of_rows 
+			<< " rows of custom data for " << number_of_cells << " positions!" << std::endl; 
+		exit(-1); 
+	}
+	double* volumes = &( batch[3 + 3*number_of_cells] ); 
+	double* values = volumes + number_of_volumes; 
+	
+	// the IDs continue from the largest counter of any rank, as on one rank 
+	int first_ID = domain_decomposition.global_maximum( BioFVM::max_basic_agent_ID - domain_decomposition.rank ); 
+	
+	slab_positions.clear(); 
+	IDs.clear(); 
+	slab_overrides.custom_data_names = overrides.custom_data_names; 
+	for( int k=0; k < number_of_cells ; k++ )
+	{
+		std::vector<double> position( batch.begin() + 3 + 3*k , batch.begin() + 6 + 3*k ); 
+		if( domain_decomposition.owns( position ) == false )
+		{ continue; }
+		
+		slab_positions.push_back( position ); 
+		IDs.push_back( first_ID + k ); 
+		if( number_of_volumes > 0 )
+		{ slab_overrides.volumes.push_back( volumes[k] ); }
+		if( columns > 0 )
+		{ slab_overrides.custom_data_values.push_back( std::vector<double>( values + k*columns , values + (k+1)*columns ) ); }
+	}
+	
+	// this rank's next ID: the first one after the batch in its sequence (rank, rank + size, ...) 
+	int next_ID = first_ID + number_of_cells; 
+	next_ID += ( domain_decomposition.rank - next_ID % domain_decomposition.size + domain_decomposition.size ) % domain_decomposition.size; 
+	BioFVM::max_basic_agent_ID = next_ID; 
+	return; 
+}
+
+void Cell_Exchange::pack_ghost( Cell* pCell , std::vector<double>& buffer )
+{
+	// what add_potentials reads, and the custom data (for custom rules) 
+	buffer.push_back( pCell->ID ); 
+	buffer.push_back( pCell->type ); 
+	buffer.insert( buffer.end() , pCell->position.begin() , pCell->position.end() ); 
+	buffer.push_back( pCell->phenotype.geometry.radius ); 
+	buffer.push_back( pCell->phenotype.geometry.nuclear_radius ); 
+	Mechanics& m = pCell->phenotype.mechanics; 
+	buffer.push_back( m.cell_cell_adhesion_strength ); 
+	buffer.push_back( m.cell_BM_adhesion_strength ); 
+	buffer.push_back( m.cell_cell_repulsion_strength ); 
+	buffer.push_back( m.cell_BM_repulsion_strength ); 
+	buffer.push_back( m.relative_maximum_adhesion_distance ); 
+	buffer.push_back( pCell->custom_data.variables.size() ); 
+	for( int i=0; i < pCell->custom_data.variables.size() ; i++ )
+	{ buffer.push_back( pCell->custom_data.variables[i].value ); }
+	return; 
+}
+
+void Cell_Exchange::add_ghosts( std::vector<double>& buffer )
+{
+	int n = 0; 
+	while( n < buffer.size() )
+	{
+		if( ghosts_in_use == ghost_pool.size() )
+		{
+			// ghosts don't use up IDs 
+			int next_ID = BioFVM::max_basic_agent_ID; 
+			ghost_pool.push_back( new Cell( cell_defaults ) ); 
+			BioFVM::max_basic_agent_ID = next_ID; 
+		}
+		Cell* pGhost = ghost_pool[ghosts_in_use]; 
+		
+		pGhost->ID = (int) buffer[n++]; 
+		pGhost->type = (int) buffer[n++]; 
+		for( int i=0; i < 3 ; i++ )
+		{ pGhost->position[i] = buffer[n++]; }
+		pGhost->phenotype.geometry.radius = buffer[n++]; 
+		pGhost->phenotype.geometry.nuclear_radius = buffer[n++]; 
+		Mechanics& m = pGhost->phenotype.mechanics; 
+		m.cell_cell_adhesion_strength = buffer[n++]; 
+		m.cell_BM_adhesion_strength = buffer[n++]; 
+		m.cell_cell_repulsion_strength = buffer[n++]; 
+		m.cell_BM_repulsion_strength = buffer[n++]; 
+		m.relative_maximum_adhesion_distance = buffer[n++]; 
+		int variables = (int) buffer[n++]; 
+		pGhost->custom_data.variables.resize( variables ); 
+		for( int i=0; i < variables ; i++ )
+		{ pGhost->custom_data.variables[i].value = buffer[n++]; }
+		
+		Cartesian_Mesh& mesh = container->underlying_mesh; 
+		if( mesh.is_position_valid( pGhost->position[0] , pGhost->position[1] , pGhost->position[2] ) == false )
+		{ continue; }
+		
+		pGhost->container = container; 
+		pGhost->current_mechanics_voxel_index = mesh.nearest_voxel_index( pGhost->position ); 
+		container->register_agent( pGhost ); 
+		
+		// as set_total_volume would do for the cell on its own rank 
+		double distance = pGhost->phenotype.geometry.radius * m.relative_maximum_adhesion_distance; 
+		double& max_distance = container->max_cell_interactive_distance_in_voxel[ pGhost->current_mechanics_voxel_index ]; 
+		if( max_distance < distance )
+		{ max_distance = distance; }
+		
+		ghosts_in_use++; 
+	}
+	return; 
+}
+
+void Cell_Exchange::exchange_ghost_cells( void )
+{
+	int axis = domain_decomposition.axis; 
+	int lower = domain_decomposition.lower_neighbor; 
+	int upper = domain_decomposition.upper_neighbor; 
+	
+	std::vector<double> to_lower; 
+	std::vector<double> to_upper; 
+	for( int i=0; i < (*all_cells).size() ; i++ )
+	{
+		Cell* pCell = (*all_cells)[i]; 
+		if( pCell->is_out_of_domain )
+		{ continue; }
+		int layer = layer_of( pCell->position[axis] ); 
+		if( lower >= 0 && layer >= first_layers[lower] && layer <= last_layers[lower] )
+		{ pack_ghost( pCell , to_lower ); }
+		if( upper >= 0 && layer >= first_layers[upper] && layer <= last_layers[upper] )
+		{ pack_ghost( pCell , to_upper ); }
+	}
+	
+	std::vector<double> from_lower; 
+	std::vector<double> from_upper; 
+	domain_decomposition.exchange_with_neighbors( to_lower , to_upper , from_lower , from_upper , 201 ); 
+	
+	ghosts_in_use = 0; 
+	add_ghosts( from_lower ); 
+	add_ghosts( from_upper ); 
+	return; 
+}
+
+void Cell_Exchange::remove_ghost_cells( void )
+{
+	// in reverse order, so each is at the end of its voxel's list, and the 
+	// order of the other cells there is kept 
+	for( int i=ghosts_in_use-1; i >= 0 ; i-- )
+	{
+		Cell* pGhost = ghost_pool[i]; 
+		container->remove_agent_from_voxel( pGhost , pGhost->current_mechanics_voxel_index ); 
+	}
+	ghosts_in_use = 0; 
+	return; 
+}
+
+void Cell_Exchange::migrate_cells( void )
+{
+	int axis = domain_decomposition.axis; 
+	
+	std::vector<double> to_lower; 
+	std::vector<double> to_upper; 
+	// from the end, so that the cell moved into a freed slot was already checked 
+	for( int i=(*all_cells).size()-1; i >= 0 ; i-- )
+	{
+		Cell* pCell = (*all_cells)[i]; 
+		if( pCell->is_out_of_domain || domain_decomposition.owns( pCell->position ) )
+		{ continue; }
+		
+		if( pCell->position[axis] < domain_decomposition.lower_bound )
+		{ pCell->pack( to_lower ); }
+		else
+		{ pCell->pack( to_upper ); }
+		
+		// as delete_cell, but the cell keeps its internalized substrates 
+		container->remove_agent( pCell ); 
+		(*all_cells)[ (*all_cells).size()-1 ]->index = i; 
+		(*all_cells)[i] = (*all_cells)[ (*all_cells).size()-1 ]; 
+		(*all_cells).pop_back(); 
+		delete pCell; 
+	}
+	
+	std::vector<double> from_lower; 
+	std::vector<double> from_upper; 
+	domain_decomposition.exchange_with_neighbors( to_lower , to_upper , from_lower , from_upper , 202 ); 
+	
+	int n = 0; 
+	while( n < from_lower.size() )
+	{ unpack_cell( from_lower , n ); }
+	n = 0; 
+	while( n < from_upper.size() )
+	{ unpack_cell( from_upper , n ); }
+	return; 
+}
+
+};
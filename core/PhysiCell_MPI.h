@@ -0,0 +1,136 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __PhysiCell_MPI_h__
+#define __PhysiCell_MPI_h__
+
+#include <vector>
+#include <string>
+
+#include "../BioFVM/BioFVM.h"
+
+namespace PhysiCell{
+
+class Cell; 
+class Cell_Container; 
+class Cell_Batch_Overrides; 
+
+/* 
+ The cells of an MPI run (see BioFVM/BioFVM_MPI.h). Each rank keeps the cells 
+ whose centers are in its slab. Its mechanics grid is the part of the global 
+ grid that covers the slab, plus one voxel layer on each side that borders 
+ another rank. During the velocity update those layers hold copies ("ghosts") 
+ of the neighboring ranks' cells, with what add_potentials reads; after the 
+ position update (and after divisions), the cells that have left the slab 
+ are sent to the rank that now owns them. 
+ 
+ So a cell may move at most one mechanics voxel per mechanics step, and each 
+ slab must be at least two mechanics voxels thick. The cells keep their IDs, 
+ but they are rebuilt from their type's Cell_Definition, with its cycle model 
+ and functions (see Cell::pack), so register each definition at set-up 
+ (register_cell_definition). 
+*/
+
+class Cell_Exchange
+{
+ private:
+	Cell_Container* container; 
+	double voxel_size; 
+	double start; // of the global mechanics grid along the decomposition axis 
+	int global_layers; 
+	// the mechanics layers (global numbers) held by each rank 
+	std::vector<int> first_layers; 
+	std::vector<int> last_layers; 
+	
+	std::vector<Cell*> ghost_pool; 
+	int ghosts_in_use; 
+	
+	int layer_of( double coordinate ); 
+	void pack_ghost( Cell* pCell , std::vector<double>& buffer ); 
+	void add_ghosts( std::vector<double>& buffer ); 
+	
+ public:
+	Cell_Exchange(); 
+	
+	// sets up the container's mechanics grid for this rank's slab 
+	void initialize( Cell_Container* pContainer , double mechanics_voxel_size ); 
+	
+	// for create_cells: rank 0's batch, restricted to this rank's slab, with the 
+	// IDs the cells would have on one rank 
+	void select_batch_in_slab( std::vector< std::vector<double> >& positions , Cell_Batch_Overrides& overrides , 
+		std::vector< std::vector<double> >& slab_positions , Cell_Batch_Overrides& slab_overrides , std::vector<int>& IDs ); 
+	
+	void exchange_ghost_cells( void ); 
+	void remove_ghost_cells( void ); 
+	void migrate_cells( void ); 
+}; 
+
+extern Cell_Exchange cell_exchange; 
+
+};
+
+#endif
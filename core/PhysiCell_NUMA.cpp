@@ -0,0 +1,403 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "./PhysiCell_NUMA.h"
+#include "./PhysiCell_cell.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <omp.h>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+namespace PhysiCell{
+
+#ifdef __linux__
+// from <numaif.h>, so we don't depend on libnuma 
+static const int move_pages_flag_move = 2; // MPOL_MF_MOVE 
+
+// the CPUs the process could run on before any thread was pinned 
+static std::vector<int> process_cpus; 
+
+static std::vector<int> get_process_cpus( void )
+{
+	if( process_cpus.size() == 0 )
+	{
+		cpu_set_t available; 
+		if( sched_getaffinity( 0 , sizeof(cpu_set_t) , &available ) == 0 )
+		{
+			for( int c=0 ; c < CPU_SETSIZE ; c++ )
+			{
+				if( CPU_ISSET( c , &available ) )
+				{ process_cpus.push_back( c ); }
+			}
+		}
+	}
+	return process_cpus; 
+}
+
+// parses a cpulist such as "0-3,8-11" 
+static std::vector<int> read_cpulist( std::string filename )
+{
+	std::vector<int> cpus; 
+	std::ifstream file( filename.c_str() ); 
+	std::string list; 
+	if( !file || !std::getline( file , list ) )
+	{ return cpus; }
+	
+	std::stringstream stream( list ); 
+	std::string range; 
+	while( std::getline( stream , range , ',' ) )
+	{
+		int first = -1; 
+		int last = -1; 
+		int count = sscanf( range.c_str() , "%d-%d" , &first , &last ); 
+		if( count == 1 )
+		{ last = first; }
+		for( int c=first; c >= 0 && c <= last ; c++ )
+		{ cpus.push_back( c ); }
+	}
+	return cpus; 
+}
+
+static int NUMA_node_of_page( void* page )
+{
+	void* pages[1] = { page }; 
+	int status[1] = { -1 }; 
+	if( syscall( SYS_move_pages , 0 , 1 , pages , NULL , status , 0 ) != 0 )
+	{ return -1; }
+	return status[0]; 
+}
+
+static long page_size( void )
+{ return sysconf( _SC_PAGESIZE ); }
+
+static void* page_of( void* address )
+{ return (void*) ( (unsigned long) address & ~( (unsigned long) page_size() - 1 ) ); }
+#endif
+
+int number_of_NUMA_nodes( void )
+{
+	int nodes = 0; 
+#ifdef __linux__
+	while( true )
+	{
+		std::ifstream file( "/sys/devices/system/node/node" + std::to_string( nodes ) + "/cpulist" ); 
+		if( !file )
+		{ break; }
+		nodes++; 
+	}
+#endif
+	return ( nodes > 0 ) ? nodes : 1; 
+}
+
+int NUMA_node_of_cpu( int cpu )
+{
+#ifdef __linux__
+	int nodes = number_of_NUMA_nodes(); 
+	for( int node=0; node < nodes ; node++ )
+	{
+		std::vector<int> cpus = read_cpulist( "/sys/devices/system/node/node" + std::to_string( node ) + "/cpulist" ); 
+		for( int i=0; i < cpus.size() ; i++ )
+		{
+			if( cpus[i] == cpu )
+			{ return node; }
+		}
+	}
+#endif
+	return 0; 
+}
+
+bool pin_OpenMP_threads( std::string mode )
+{
+	if( mode == "none" || mode == "" )
+	{ return true; }
+	if( mode != "compact" && mode != "scatter" )
+	{
+		std::cout << "Error: unknown thread pinning \"" << mode << "\" (use none, compact, or scatter)" << std::endl; 
+		return false; 
+	}
+	
+#ifdef __linux__
+	std::vector<int> cpus = get_process_cpus(); 
+	if( cpus.size() == 0 )
+	{ return false; }
+	
+	std::vector<int> order = cpus; 
+	if( mode == "scatter" )
+	{
+		// deal the CPUs out across the nodes: node 0, node 1, ..., node 0, ... 
+		int nodes = number_of_NUMA_nodes(); 
+		std::vector< std::vector<int> > by_node( nodes ); 
+		for( int i=0; i < cpus.size() ; i++ )
+		{ by_node[ NUMA_node_of_cpu( cpus[i] ) ].push_back( cpus[i] ); }
+		
+		order.clear(); 
+		for( int round=0; order.size() < cpus.size() ; round++ )
+		{
+			for( int node=0; node < nodes ; node++ )
+			{
+				if( round < by_node[node].size() )
+				{ order.push_back( by_node[node][round] ); }
+			}
+		}
+	}
+	
+	bool success = true; 
+	#pragma omp parallel 
+	{
+		cpu_set_t mine; 
+		CPU_ZERO( &mine ); 
+		CPU_SET( order[ omp_get_thread_num() % order.size() ] , &mine ); 
+		if( sched_setaffinity( 0 , sizeof(cpu_set_t) , &mine ) != 0 )
+		{
+			#pragma omp atomic write 
+			success = false; 
+		}
+	}
+	return success; 
+#else
+	std::cout << "Warning: thread pinning is not supported on this platform." << std::endl; 
+	return true; 
+#endif
+}
+
+std::vector<int> NUMA_nodes_of_OpenMP_threads( void )
+{
+	std::vector<int> nodes( omp_get_max_threads() , 0 ); 
+#ifdef __linux__
+	#pragma omp parallel 
+	{
+		int cpu = sched_getcpu(); 
+		nodes[ omp_get_thread_num() ] = ( cpu >= 0 ) ? NUMA_node_of_cpu( cpu ) : 0; 
+	}
+#endif
+	return nodes; 
+}
+
+void display_thread_placement( std::ostream& os )
+{
+	int threads = omp_get_max_threads(); 
+	std::vector<int> cpus( threads , -1 ); 
+#ifdef __linux__
+	#pragma omp parallel 
+	{ cpus[ omp_get_thread_num() ] = sched_getcpu(); }
+#endif
+	
+	os << "OpenMP threads: " << threads << " on " << number_of_NUMA_nodes() << " NUMA node(s)" << std::endl; 
+	for( int i=0; i < threads ; i++ )
+	{
+		os << "\tthread " << i << ": CPU " << cpus[i]; 
+		if( cpus[i] >= 0 )
+		{ os << " (node " << NUMA_node_of_cpu( cpus[i] ) << ")"; }
+		os << std::endl; 
+	}
+	return; 
+}
+
+int NUMA_node_of_address( void* address )
+{
+#ifdef __linux__
+	return NUMA_node_of_page( page_of( address ) ); 
+#else
+	return -1; 
+#endif
+}
+
+// thread i of n owns cells [ i*N/n , (i+1)*N/n ) 
+static int first_cell_of_thread( int thread , int threads , int number_of_cells )
+{ return (int) ( ( (long) thread * number_of_cells ) / threads ); }
+
+#ifdef __linux__
+// the pages of [data, data+bytes), for node 
+static void add_pages( std::vector<void*>& pages , std::vector<int>& nodes , const void* data , size_t bytes , int node )
+{
+	if( data == NULL || bytes == 0 )
+	{ return; }
+	long size = page_size(); 
+	char* last = (char*) data + bytes; 
+	for( char* page = (char*) page_of( (void*) data ); page < last ; page += size )
+	{
+		pages.push_back( page ); 
+		nodes.push_back( node ); 
+	}
+	return; 
+}
+
+template <class T> static void add_pages( std::vector<void*>& pages , std::vector<int>& nodes , std::vector<T>& data , int node )
+{ add_pages( pages , nodes , data.data() , data.capacity() * sizeof(T) , node ); }
+
+// the Cell object and the heap arrays the per-step loops use (the kinematics, the 
+// neighbor list, the secretion and internalization, the death and cycle rates, and 
+// the custom data). Strings, the cycle and death models, the custom vector 
+// variables, BioFVM's protected secretion scratch arrays and the rest of the 
+// phenotype stay where they were allocated. 
+static void add_cell_pages( std::vector<void*>& pages , std::vector<int>& nodes , Cell* pCell , int node )
+{
+	add_pages( pages , nodes , pCell , sizeof(Cell) , node ); 
+	
+	add_pages( pages , nodes , pCell->position , node ); 
+	add_pages( pages , nodes , pCell->velocity , node ); 
+	add_pages( pages , nodes , pCell->displacement , node ); 
+	add_pages( pages , nodes , pCell->state.neighbors , node ); 
+	add_pages( pages , nodes , pCell->state.orientation , node ); 
+	
+	Phenotype& phenotype = pCell->phenotype; 
+	add_pages( pages , nodes , phenotype.secretion.secretion_rates , node ); 
+	add_pages( pages , nodes , phenotype.secretion.uptake_rates , node ); 
+	add_pages( pages , nodes , phenotype.secretion.saturation_densities , node ); 
+	add_pages( pages , nodes , phenotype.molecular.internalized_total_substrates , node ); 
+	add_pages( pages , nodes , phenotype.death.rates , node ); 
+	add_pages( pages , nodes , phenotype.cycle.data.transition_rates , node ); 
+	for( unsigned int i=0; i < phenotype.cycle.data.transition_rates.size() ; i++ )
+	{ add_pages( pages , nodes , phenotype.cycle.data.transition_rates[i] , node ); }
+	
+	add_pages( pages , nodes , pCell->custom_data.variables , node ); 
+	return; 
+}
+#endif
+
+bool place_cells_on_thread_nodes( std::vector<Cell*>& cells )
+{
+#ifdef __linux__
+	if( number_of_NUMA_nodes() < 2 )
+	{ return true; }
+	
+	std::vector<int> thread_nodes = NUMA_nodes_of_OpenMP_threads(); 
+	int threads = thread_nodes.size(); 
+	
+	std::vector<void*> pages; 
+	std::vector<int> nodes; 
+	for( int t=0; t < threads ; t++ )
+	{
+		int end = first_cell_of_thread( t+1 , threads , cells.size() ); 
+		for( int i=first_cell_of_thread( t , threads , cells.size() ); i < end ; i++ )
+		{ add_cell_pages( pages , nodes , cells[i] , thread_nodes[t] ); }
+	}
+	if( pages.size() == 0 )
+	{ return true; }
+	
+	// pages shared by two owners go to whichever comes last 
+	std::vector<int> status( pages.size() , 0 ); 
+	return syscall( SYS_move_pages , 0 , pages.size() , pages.data() , nodes.data() , status.data() , move_pages_flag_move ) >= 0; 
+#else
+	return false; 
+#endif
+}
+
+double fraction_of_voxel_data_on_thread_nodes( BioFVM::Microenvironment& M )
+{
+	int partitions = M.number_of_voxel_partitions(); 
+	int length = M.voxel_partition_length(); 
+	if( partitions * length != M.number_of_voxels() )
+	{ return 0.0; }
+	
+	int matches = 0; 
+	int total = 0; 
+	#pragma omp parallel for reduction(+:matches,total) 
+	for( int p=0; p < partitions ; p++ )
+	{
+#ifdef __linux__
+		int node = NUMA_node_of_cpu( sched_getcpu() ); 
+		for( int n=p*length; n < (p+1)*length ; n++ )
+		{
+			if( NUMA_node_of_address( M.density_vector(n).data() ) == node )
+			{ matches++; }
+			total++; 
+		}
+#endif
+	}
+	return ( total > 0 ) ? (double) matches / (double) total : 0.0; 
+}
+
+double fraction_of_cells_on_thread_nodes( std::vector<Cell*>& cells )
+{
+	int matches = 0; 
+	int total = 0; 
+#ifdef __linux__
+	std::vector<int> thread_nodes = NUMA_nodes_of_OpenMP_threads(); 
+	int threads = thread_nodes.size(); 
+	for( int t=0; t < threads ; t++ )
+	{
+		int end = first_cell_of_thread( t+1 , threads , cells.size() ); 
+		for( int i=first_cell_of_thread( t , threads , cells.size() ); i < end ; i++ )
+		{
+			if( NUMA_node_of_address( cells[i] ) == thread_nodes[t] )
+			{ matches++; }
+			total++; 
+		}
+	}
+#endif
+	return ( total > 0 ) ? (double) matches / (double) total : 0.0; 
+}
+
+};
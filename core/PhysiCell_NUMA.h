@@ -0,0 +1,122 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __PhysiCell_NUMA_h__
+#define __PhysiCell_NUMA_h__
+
+#include <vector>
+#include <string>
+#include <iostream>
+
+#include "../BioFVM/BioFVM.h"
+
+namespace PhysiCell{
+
+class Cell; 
+
+/* 
+ NUMA placement helpers (Linux; elsewhere they do nothing). 
+ 
+ The OpenMP threads can be pinned to the CPUs the process may run on: 
+	"none":    leave placement to the OS (or to OMP_PROC_BIND / OMP_PLACES) 
+	"compact": thread i on the i-th CPU, so threads fill one node first 
+	"scatter": threads dealt round-robin across the NUMA nodes 
+ 
+ The substrate data is first-touched by its owning threads in 
+ initialize_microenvironment (see Microenvironment::first_touch_voxel_data). 
+ Cells are owned by the thread that sweeps their block of all_cells (block 
+ i of equal size for thread i); place_cells_on_thread_nodes moves the pages 
+ of each Cell object, and of the heap arrays its per-step loops use 
+ (kinematics, neighbors, secretion, internalized substrates, death and cycle 
+ rates, custom data), to its owner's node. Its strings, cycle and death 
+ models, custom vector variables, BioFVM secretion scratch arrays and the 
+ rest of its phenotype stay where they were allocated. Small arrays share pages with other cells' data (the 
+ heap packs them together), and a shared page goes to its last owner. 
+*/
+
+int number_of_NUMA_nodes( void ); 
+int NUMA_node_of_cpu( int cpu ); 
+
+bool pin_OpenMP_threads( std::string mode ); 
+void display_thread_placement( std::ostream& os ); 
+
+// node of each OpenMP thread of the current team size, from where it is running now 
+std::vector<int> NUMA_nodes_of_OpenMP_threads( void ); 
+
+// -1 if unknown 
+int NUMA_node_of_address( void* address ); 
+
+bool place_cells_on_thread_nodes( std::vector<Cell*>& cells ); 
+
+// fraction of the voxel density pages that are on their owning thread's node 
+double fraction_of_voxel_data_on_thread_nodes( BioFVM::Microenvironment& M ); 
+// fraction of the Cell objects that are on their owning thread's node 
+double fraction_of_cells_on_thread_nodes( std::vector<Cell*>& cells ); 
+
+};
+
+#endif
@@ -69,6 +69,7 @@
 #include "PhysiCell_cell_container.h"
 #include "PhysiCell_utilities.h"
 #include "PhysiCell_constants.h"
+#include "PhysiCell_MPI.h"
 #include "../BioFVM/BioFVM_vector.h" 
 #include<limits.h>
 
@@ -153,6 +154,39 @@ Cell_Definition::Cell_Definition( Cell_Definition& cd )
 	return; 
 }
 
+std::vector<Cell_Definition*> cell_definitions_by_index; 
+
+void register_cell_definition( Cell_Definition& cd )
+{
+	for( int i=0; i < cell_definitions_by_index.size() ; i++ )
+	{
+		if( cell_definitions_by_index[i] == &cd )
+		{ return; }
+	}
+	cell_definitions_by_index.push_back( &cd ); 
+	return; 
+}
+
+Cell_Definition* find_cell_definition( int type )
+{
+	for( int i=0; i < cell_definitions_by_index.size() ; i++ )
+	{
+		if( cell_definitions_by_index[i]->type == type )
+		{ return cell_definitions_by_index[i]; }
+	}
+	return NULL; 
+}
+
+Cell_Definition* find_cell_definition( std::string name )
+{
+	for( int i=0; i < cell_definitions_by_index.size() ; i++ )
+	{
+		if( cell_definitions_by_index[i]->name == name )
+		{ return cell_definitions_by_index[i]; }
+	}
+	return NULL; 
+}
+
 Cell_Definition& Cell_Definition::operator=( const Cell_Definition& cd )
 {
 	// set the microenvironment pointer 
@@ -255,6 +289,12 @@ void Cell::advance_bundled_phenotype_functions( double dt_ )
 		set_total_volume( phenotype.volume.total ); 
 	}
 	
+	advance_geometry_death_and_cycle( dt_ ); 
+	return; 
+}
+
+void Cell::advance_geometry_death_and_cycle( double dt_ )
+{
 	// update geometry
 	phenotype.geometry.update( this, phenotype, dt_ );
 	
@@ -329,6 +369,48 @@ Cell::Cell()
 	return; 
 }
 
+Cell::Cell( Cell_Definition& cd )
+{
+	// copy straight from the definition, rather than from cell_defaults 
+	// followed by a second copy as in create_cell( cd ). 
+	
+	type = cd.type; 
+	type_name = cd.name; 
+	
+	custom_data = cd.custom_data; 
+	parameters = cd.parameters; 
+	functions = cd.functions; 
+	
+	phenotype = cd.phenotype; 
+	
+	phenotype.molecular.sync_to_cell( this ); 
+	
+	// (Basic_Agent() registered the default microenvironment) 
+	
+	current_mechanics_voxel_index=-1;
+	
+	updated_current_mechanics_voxel_index = 0;
+	
+	is_movable = true;
+	is_out_of_domain = false;
+	displacement.resize(3,0.0); 
+	
+	// no assign_orientation() here: it draws random numbers, so 
+	// create_cells() calls it serially to keep runs reproducible. 
+	container = NULL;
+	
+	return; 
+}
+
+Cell_Batch_Overrides::Cell_Batch_Overrides()
+{
+	volumes.resize( 0 ); 
+	custom_data_names.resize( 0 ); 
+	custom_data_values.resize( 0 ); 
+	
+	return; 
+}
+
 void Cell::flag_for_division( void )
 {
 	get_container()->flag_cell_for_division( this );
@@ -387,6 +469,15 @@ void Cell::assign_orientation()
 	return; 
 }
 
+// the pi/pe/pf strategy variables are only defined by the wjy models; 
+// find_variable_index maps unknown names to 0, so check the name itself 
+
+static bool has_strategy_variables( Custom_Cell_Data& custom_data )
+{
+	int pi_index = custom_data.find_variable_index("pi");
+	return (int) custom_data.variables.size() > pi_index && custom_data.variables[pi_index].name == "pi"; 
+}
+
 Cell* Cell::divide( )
 {
 	// phenotype.flagged_for_division = false; 
@@ -397,44 +488,47 @@ Cell* Cell::divide( )
 	child->copy_function_pointers(this);
 	child->parameters = parameters;
 
-	// update pi pe.
-	int pi_index = custom_data.find_variable_index("pi");
-	int pe_index = custom_data.find_variable_index("pe");
-	int pf_index = custom_data.find_variable_index("pf");
-	int pi_ini_index = custom_data.find_variable_index("pi_ini");
-	int pe_ini_index = custom_data.find_variable_index("pe_ini");
-	child->custom_data[pi_index] = child->custom_data[pi_ini_index] * (1 + 0.05 * NormalRandom(0, 1)); 
-	child->custom_data[pe_index] = child->custom_data[pe_ini_index] * (1 + 0.05 * NormalRandom(0, 1)); 
-	child->custom_data[pf_index] = 1 - child->custom_data[pi_index] - child->custom_data[pe_index];
-
-	double pi = custom_data[pi_index];
-	double pe = custom_data[pe_index];
-        double pi_copy_inre = 1.0;
-        double pe_copy_inre = 1.0;
-        pi *= pi_copy_inre;
-        pe *= pe_copy_inre;
-	if (pi > 0.95) {
-		pi = 0.95*(1 - fabs(NormalRandom(0, 1) / 10));
-	}
-	if (pe > 0.95) {
-		pe = 0.95*(1 - fabs(NormalRandom(0, 1) / 10));
-	}
-	if (pi < 0.1) {
-		pi = 0.1*(1+fabs(NormalRandom(0, 1) / 10));
-	}
-	if (pe < 0.1) {
-		pe =0.1*(1+ fabs(NormalRandom(0, 1) / 10));
-	}
-	if (pi + pe > 0.9) {
-		double pi_new = pi / (pi + pe)*0.9*(1- fabs(NormalRandom(0, 1) / 10));
-		double pe_new = pe *pi_new/pi;
-		pi = pi_new;
-		pe = pe_new;
-	}
+	// update pi pe. (only for models that define the strategy variables) 
+	if( has_strategy_variables( custom_data ) )
+	{
+		int pi_index = custom_data.find_variable_index("pi");
+		int pe_index = custom_data.find_variable_index("pe");
+		int pf_index = custom_data.find_variable_index("pf");
+		int pi_ini_index = custom_data.find_variable_index("pi_ini");
+		int pe_ini_index = custom_data.find_variable_index("pe_ini");
+		child->custom_data[pi_index] = child->custom_data[pi_ini_index] * (1 + 0.05 * NormalRandom(0, 1)); 
+		child->custom_data[pe_index] = child->custom_data[pe_ini_index] * (1 + 0.05 * NormalRandom(0, 1)); 
+		child->custom_data[pf_index] = 1 - child->custom_data[pi_index] - child->custom_data[pe_index];
+
+		double pi = custom_data[pi_index];
+		double pe = custom_data[pe_index];
+		double pi_copy_inre = 1.0;
+		double pe_copy_inre = 1.0;
+		pi *= pi_copy_inre;
+		pe *= pe_copy_inre;
+		if (pi > 0.95) {
+			pi = 0.95*(1 - fabs(NormalRandom(0, 1) / 10));
+		}
+		if (pe > 0.95) {
+			pe = 0.95*(1 - fabs(NormalRandom(0, 1) / 10));
+		}
+		if (pi < 0.1) {
+			pi = 0.1*(1+fabs(NormalRandom(0, 1) / 10));
+		}
+		if (pe < 0.1) {
+			pe =0.1*(1+ fabs(NormalRandom(0, 1) / 10));
+		}
+		if (pi + pe > 0.9) {
+			double pi_new = pi / (pi + pe)*0.9*(1- fabs(NormalRandom(0, 1) / 10));
+			double pe_new = pe *pi_new/pi;
+			pi = pi_new;
+			pe = pe_new;
+		}
 
-	custom_data[pi_index] = pi;
-	custom_data[pe_index] = pe;
-	custom_data[pf_index] = 1 - pi - pe;
+		custom_data[pi_index] = pi;
+		custom_data[pe_index] = pe;
+		custom_data[pf_index] = 1 - pi - pe;
+	}
 
 
 	// evenly divide internalized substrates 
@@ -534,6 +628,18 @@ bool Cell::assign_position(double x, double y, double z)
 	return true;
 }
 
+long long Cell::memory_footprint( void )
+{
+	// the secretion and internalization vectors of the Basic_Agent are the phenotype's 
+	long long out = sizeof( Cell ) + heap_bytes( type_name ) + heap_bytes( displacement ); 
+	out += heap_bytes( position ) + heap_bytes( velocity ) + heap_bytes( previous_velocity ) 
+		+ heap_bytes( cell_source_sink_solver_temp1 ) + heap_bytes( cell_source_sink_solver_temp2 ) 
+		+ heap_bytes( total_extracellular_substrate_change ); 
+	out += heap_bytes( state.neighbors ) + heap_bytes( state.orientation ); 
+	out += custom_data.memory_footprint() + phenotype.memory_footprint() + functions.cycle_model.memory_footprint(); 
+	return out; 
+}
+
 void Cell::set_total_volume(double volume)
 {
 	Basic_Agent::set_total_volume(volume);
@@ -613,43 +719,70 @@ void Cell::update_position( double dt )
 	// 
 	// Basic_Agent::update_position(dt);
 		
-	// use Adams-Bashforth 
-	static double d1; 
-	static double d2; 
-	static bool constants_defined = false; 
-	if( constants_defined == false )
+	double next_position[3]; 
+	compute_next_position( dt , next_position ); 
+	commit_position( next_position ); 
+	return; 
+}
+
+void Cell::compute_next_position( double dt , double* next_position )
+{
+	if( default_microenvironment_options.simulate_2D == true )
+	{ return compute_next_position<2>( dt , next_position ); }
+	return compute_next_position<3>( dt , next_position ); 
+}
+
+template <int dimension> 
+void Cell::compute_next_position( double dt , double* next_position )
+{
+	// use Adams-Bashforth (coefficients follow dt, rather than the first dt seen) 
+	double d1 = 1.5 * dt; 
+	double d2 = -0.5 * dt; 
+	
+	// new AUgust 2017 (in 2-D, the cell stays in its z plane) 
+	if( dimension == 2 )
+	{ velocity[2] = 0.0; }
+	
+	std::vector<double> new_position(position); 
+	for( int i=0 ; i < dimension ; i++ )
 	{
-		d1 = dt; 
-		d1 *= 1.5; 
-		d2 = dt; 
-		d2 *= -0.5; 
-		constants_defined = true; 
+		new_position[i] += d1 * velocity[i]; 
+		new_position[i] += d2 * previous_velocity[i]; 
 	}
 	
-	// new AUgust 2017
-	if( default_microenvironment_options.simulate_2D == true )
-	{ velocity[2] = 0.0; }
+	next_position[0] = new_position[0]; 
+	next_position[1] = new_position[1]; 
+	next_position[2] = new_position[2]; 
 	
-	std::vector<double> old_position(position); 
-	axpy( &position , d1 , velocity );  
-	axpy( &position , d2 , previous_velocity );  
-	// overwrite previous_velocity for future use 
-	// if(sqrt(dist(old_position, position))>3* phenotype.geometry.radius)
-		// std::cout<<sqrt(dist(old_position, position))<<"old_position: "<<old_position<<", new position: "<< position<<", velocity: "<<velocity<<", previous_velocity: "<< previous_velocity<<std::endl;
+	// only this cell reads updated_current_mechanics_voxel_index (in update_voxel_in_container)
+	if(get_container()->underlying_mesh.is_position_valid(new_position[0],new_position[1],new_position[2]))
+	{
+		updated_current_mechanics_voxel_index=get_container()->underlying_mesh.nearest_voxel_index<dimension>( new_position );
+	}
+	else
+	{
+		updated_current_mechanics_voxel_index=-1;
+	}
+	return; 
+}
+
+template void Cell::compute_next_position<2>( double dt , double* next_position ); 
+template void Cell::compute_next_position<3>( double dt , double* next_position ); 
+
+void Cell::commit_position( const double* next_position )
+{
+	position[0] = next_position[0]; 
+	position[1] = next_position[1]; 
+	position[2] = next_position[2]; 
 	
+	// overwrite previous_velocity for future use 
 	previous_velocity = velocity; 
 	
 	velocity[0]=0; velocity[1]=0; velocity[2]=0;
 	// #pragma omp critical
 	//{update_voxel_in_container();}
-	if(get_container()->underlying_mesh.is_position_valid(position[0],position[1],position[2]))
-	{
-		updated_current_mechanics_voxel_index=get_container()->underlying_mesh.nearest_voxel_index( position );
-	}
-	else
+	if( updated_current_mechanics_voxel_index == -1 )
 	{
-		updated_current_mechanics_voxel_index=-1;
-		
 		is_out_of_domain = true; 
 		is_active = false; 
 		is_movable = false; 
@@ -727,6 +860,14 @@ void Cell::copy_function_pointers(Cell* copy_me)
 	return; 
 }
 
+void Cell::add_potentials(Cell* other_agent)
+{
+	if( default_microenvironment_options.simulate_2D == true )
+	{ return add_potentials<2>( other_agent ); }
+	return add_potentials<3>( other_agent ); 
+}
+
+template <int dimension> 
 void Cell::add_potentials(Cell* other_agent)
 {
 	if( this->ID == other_agent->ID )
@@ -737,11 +878,13 @@ void Cell::add_potentials(Cell* other_agent)
 	// 9.820170012151277; // 12 * ( 1 - sqrt(2*pi/sqrt(3)))^2
 
 	double distance = 0; 
-	for( int i = 0 ; i < 3 ; i++ ) 
+	for( int i = 0 ; i < dimension ; i++ ) 
 	{ 
 		displacement[i] = position[i] - (*other_agent).position[i]; 
 		distance += displacement[i] * displacement[i]; 
 	}
+	if( dimension == 2 )
+	{ displacement[2] = 0.0; }
 	// Make sure that the distance is not zero
 	
 	distance = std::max(sqrt(distance), 0.00001); 
@@ -812,11 +955,15 @@ void Cell::add_potentials(Cell* other_agent)
 	// {
 	//	velocity[i] += displacement[i] * temp_r; 
 	// }
-	axpy( &velocity , temp_r , displacement ); 
+	for( int i = 0 ; i < dimension ; i++ ) 
+	{ velocity[i] += temp_r * displacement[i]; }
 	
 	return;
 }
 
+template void Cell::add_potentials<2>(Cell* other_agent); 
+template void Cell::add_potentials<3>(Cell* other_agent); 
+
 Cell* create_cell( void )
 {
 	Cell* pNew; 
@@ -825,13 +972,16 @@ Cell* create_cell( void )
 	(*all_cells).push_back( pNew ); 
 	pNew->index=(*all_cells).size()-1;
 	
-	// change pi pe.
+	// change pi pe. (only for models that define the strategy variables) 
 	int pi_index = pNew->custom_data.find_variable_index("pi");
 	int pe_index = pNew->custom_data.find_variable_index("pe");
 	int pf_index = pNew->custom_data.find_variable_index("pf");
-	pNew->custom_data[pi_index] *= 1 + 0.05 * NormalRandom(0, 1); 
-	pNew->custom_data[pe_index] *= 1 + 0.05 * NormalRandom(0, 1); 
-	pNew->custom_data[pf_index] = 1 - pNew->custom_data[pi_index] - pNew->custom_data[pe_index];
+	if( has_strategy_variables( pNew->custom_data ) )
+	{
+		pNew->custom_data[pi_index] *= 1 + 0.05 * NormalRandom(0, 1); 
+		pNew->custom_data[pe_index] *= 1 + 0.05 * NormalRandom(0, 1); 
+		pNew->custom_data[pf_index] = 1 - pNew->custom_data[pi_index] - pNew->custom_data[pe_index];
+	}
 
 	// new usability enhancements in May 2017 
 	
@@ -870,6 +1020,131 @@ Cell* create_cell( Cell_Definition& cd )
 	return pNew; 
 }
 
+std::vector<Cell*> create_cells( Cell_Definition& cd , std::vector< std::vector<double> >& positions )
+{
+	Cell_Batch_Overrides no_overrides; 
+	return create_cells( cd , positions , no_overrides ); 
+}
+
+std::vector<Cell*> create_cells( Cell_Definition& cd , std::vector< std::vector<double> >& positions , Cell_Batch_Overrides& overrides )
+{
+	// MPI: every rank takes rank 0's batch, and builds the cells in its slab, 
+	// with the IDs they would have on one rank (see core/PhysiCell_MPI.h) 
+	bool distributed = domain_decomposition.active; 
+	std::vector< std::vector<double> > slab_positions; 
+	Cell_Batch_Overrides slab_overrides; 
+	std::vector<int> slab_IDs; 
+	if( distributed )
+	{ cell_exchange.select_batch_in_slab( positions , overrides , slab_positions , slab_overrides , slab_IDs ); }
+	std::vector< std::vector<double> >& batch_positions = distributed ? slab_positions : positions; 
+	Cell_Batch_Overrides& batch_overrides = distributed ? slab_overrides : overrides; 
+	
+	int number_of_cells = batch_positions.size(); 
+	std::vector<Cell*> output( number_of_cells , NULL ); 
+	if( number_of_cells == 0 )
+	{ return output; }
+	
+	// check the overrides before doing any work 
+	
+	if( batch_overrides.volumes.size() > 0 && (int) batch_overrides.volumes.size() != number_of_cells )
+	{
+		std::cout << "Error: create_cells received " << batch_overrides.volumes.size() << " volumes for " 
+			<< number_of_cells << " positions!" << std::endl; 
+		exit(-1); 
+	}
+	
+	std::vector<int> custom_indices( batch_overrides.custom_data_names.size() , -1 ); 
+	for( int j=0 ; j < (int) custom_indices.size() ; j++ )
+	{
+		// find_variable_index returns 0 for unknown names, so check the name it found 
+		custom_indices[j] = cd.custom_data.find_variable_index( batch_overrides.custom_data_names[j] ); 
+		if( custom_indices[j] >= (int) cd.custom_data.variables.size() || 
+			cd.custom_data.variables[ custom_indices[j] ].name != batch_overrides.custom_data_names[j] )
+		{
+			std::cout << "Error: create_cells could not find custom variable " 
+				<< batch_overrides.custom_data_names[j] << " in cell definition " << cd.name << "!" << std::endl; 
+			exit(-1); 
+		}
+	}
+	if( custom_indices.size() > 0 && (int) batch_overrides.custom_data_values.size() != number_of_cells )
+	{
+		std::cout << "Error: create_cells received " << batch_overrides.custom_data_values.size() 
+			<< " rows of custom data for " << number_of_cells << " positions!" << std::endl; 
+		exit(-1); 
+	}
+	
+	Cell_Container* pContainer = (Cell_Container*) BioFVM::get_default_microenvironment()->agent_container; 
+	int first_ID = BioFVM::max_basic_agent_ID; 
+	
+	// build and place the cells in parallel. Nothing in here touches 
+	// shared state except the (atomic) agent ID counter. 
+	
+	#pragma omp parallel for 
+	for( int k=0 ; k < number_of_cells ; k++ )
+	{
+		Cell* pNew = new Cell( cd ); 
+		pNew->container = pContainer; 
+		
+		pNew->position[0] = batch_positions[k][0]; 
+		pNew->position[1] = batch_positions[k][1]; 
+		pNew->position[2] = batch_positions[k][2]; 
+		
+		pNew->update_voxel_index(); 
+		pNew->current_mechanics_voxel_index = pContainer->underlying_mesh.nearest_voxel_index( pNew->position ); 
+		
+		if( !pContainer->underlying_mesh.is_position_valid( pNew->position[0], pNew->position[1], pNew->position[2] ) )
+		{
+			pNew->is_out_of_domain = true; 
+			pNew->is_active = false; 
+			pNew->is_movable = false; 
+		}
+		
+		for( int j=0 ; j < (int) custom_indices.size() ; j++ )
+		{ pNew->custom_data[ custom_indices[j] ] = batch_overrides.custom_data_values[k][j]; }
+		
+		output[k] = pNew; 
+	}
+	
+	// serial pass in input order: IDs, all_cells, and anything that 
+	// draws random numbers or writes to the container 
+	
+	(*all_cells).reserve( (*all_cells).size() + number_of_cells ); 
+	for( int k=0 ; k < number_of_cells ; k++ )
+	{
+		Cell* pNew = output[k]; 
+		pNew->ID = distributed ? slab_IDs[k] : first_ID + k; 
+		
+		(*all_cells).push_back( pNew ); 
+		pNew->index = (*all_cells).size()-1; 
+		
+		pNew->assign_orientation(); 
+		
+		if( batch_overrides.volumes.size() > 0 )
+		{ pNew->set_total_volume( batch_overrides.volumes[k] ); }
+	}
+	// (with MPI, select_batch_in_slab already set the counter to this rank's 
+	// next ID after the batch; undo the constructors' increments) 
+	if( distributed )
+	{ BioFVM::max_basic_agent_ID = first_ID; }
+	
+	// one grid rebuild: size each touched voxel once, then fill 
+	
+	std::vector<int> cells_per_voxel( pContainer->agent_grid.size() , 0 ); 
+	for( int k=0 ; k < number_of_cells ; k++ )
+	{ cells_per_voxel[ output[k]->current_mechanics_voxel_index ]++; }
+	
+	for( int n=0 ; n < (int) cells_per_voxel.size() ; n++ )
+	{
+		if( cells_per_voxel[n] > 0 )
+		{ pContainer->agent_grid[n].reserve( pContainer->agent_grid[n].size() + cells_per_voxel[n] ); }
+	}
+	
+	for( int k=0 ; k < number_of_cells ; k++ )
+	{ pContainer->register_agent( output[k] ); }
+	
+	return output; 
+}
+
 void Cell::convert_to_cell_definition( Cell_Definition& cd )
 {
 	
@@ -919,13 +1194,288 @@ void delete_cell( Cell* pDelete )
 	return; 
 }
 
+static void pack_vector( std::vector<double>& buffer , std::vector<double>& values )
+{
+	buffer.push_back( values.size() ); 
+	buffer.insert( buffer.end() , values.begin() , values.end() ); 
+	return; 
+}
+
+static void unpack_vector( std::vector<double>& buffer , int& position , std::vector<double>& values )
+{
+	int size = (int) buffer[position++]; 
+	values.assign( buffer.begin() + position , buffer.begin() + position + size ); 
+	position += size; 
+	return; 
+}
+
+// 0: NULL, 1: the definition's function, 2: another function (which can't be sent) 
+template <class Function> 
+static double function_flag( Function function , Function definition_function )
+{
+	if( function == NULL )
+	{ return 0; }
+	if( function == definition_function )
+	{ return 1; }
+	return 2; 
+}
+
+template <class Function> 
+static void set_function( Function& function , Function definition_function , double flag )
+{
+	function = definition_function; 
+	if( flag == 0 )
+	{ function = NULL; }
+	if( flag == 2 )
+	{
+		static bool warned = false; 
+		if( !warned )
+		{
+			std::cout << "Warning: a cell moved to another MPI rank with a function that is not its " 
+				<< "Cell_Definition's. Using the Cell_Definition's function." << std::endl; 
+			warned = true; 
+		}
+	}
+	return; 
+}
+
+void Cell::pack( std::vector<double>& buffer )
+{
+	Cell_Definition* pCD = find_cell_definition( type ); 
+	if( pCD == NULL )
+	{ pCD = &cell_defaults; }
+	
+	buffer.push_back( ID ); 
+	buffer.push_back( type ); 
+	buffer.insert( buffer.end() , position.begin() , position.end() ); 
+	buffer.insert( buffer.end() , velocity.begin() , velocity.end() ); 
+	buffer.insert( buffer.end() , previous_velocity.begin() , previous_velocity.end() ); 
+	buffer.push_back( is_active ); 
+	buffer.push_back( is_movable ); 
+	buffer.push_back( get_total_volume() ); 
+	
+	pack_vector( buffer , state.orientation ); 
+	buffer.push_back( state.simple_pressure ); 
+	
+	// cycle and death 
+	buffer.push_back( phenotype.death.dead ); 
+	buffer.push_back( phenotype.death.current_death_model_index ); 
+	pack_vector( buffer , phenotype.death.rates ); 
+	buffer.push_back( phenotype.cycle.data.current_phase_index ); 
+	buffer.push_back( phenotype.cycle.data.elapsed_time_in_phase ); 
+	buffer.push_back( phenotype.cycle.data.transition_rates.size() ); 
+	for( int i=0; i < phenotype.cycle.data.transition_rates.size() ; i++ )
+	{ pack_vector( buffer , phenotype.cycle.data.transition_rates[i] ); }
+	
+	Volume& v = phenotype.volume; 
+	double volume[22] = { v.total, v.solid, v.fluid, v.fluid_fraction, v.nuclear, v.nuclear_fluid, v.nuclear_solid, 
+		v.cytoplasmic, v.cytoplasmic_fluid, v.cytoplasmic_solid, v.calcified_fraction, v.cytoplasmic_to_nuclear_ratio, 
+		v.rupture_volume, v.cytoplasmic_biomass_change_rate, v.nuclear_biomass_change_rate, v.fluid_change_rate, 
+		v.calcification_rate, v.target_solid_cytoplasmic, v.target_solid_nuclear, v.target_fluid_fraction, 
+		v.target_cytoplasmic_to_nuclear_ratio, v.relative_rupture_volume }; 
+	buffer.insert( buffer.end() , volume , volume+22 ); 
+	
+	Geometry& g = phenotype.geometry; 
+	double geometry[4] = { g.radius, g.nuclear_radius, g.surface_area, g.polarity }; 
+	buffer.insert( buffer.end() , geometry , geometry+4 ); 
+	
+	Mechanics& m = phenotype.mechanics; 
+	double mechanics[5] = { m.cell_cell_adhesion_strength, m.cell_BM_adhesion_strength, m.cell_cell_repulsion_strength, 
+		m.cell_BM_repulsion_strength, m.relative_maximum_adhesion_distance }; 
+	buffer.insert( buffer.end() , mechanics , mechanics+5 ); 
+	
+	Motility& mo = phenotype.motility; 
+	buffer.push_back( mo.is_motile ); 
+	buffer.push_back( mo.persistence_time ); 
+	buffer.push_back( mo.migration_speed ); 
+	pack_vector( buffer , mo.migration_bias_direction ); 
+	buffer.push_back( mo.migration_bias ); 
+	buffer.push_back( mo.restrict_to_2D ); 
+	pack_vector( buffer , mo.motility_vector ); 
+	
+	pack_vector( buffer , phenotype.secretion.secretion_rates ); 
+	pack_vector( buffer , phenotype.secretion.uptake_rates ); 
+	pack_vector( buffer , phenotype.secretion.saturation_densities ); 
+	pack_vector( buffer , phenotype.molecular.internalized_total_substrates ); 
+	pack_vector( buffer , phenotype.molecular.fraction_released_at_death ); 
+	pack_vector( buffer , phenotype.molecular.fraction_transferred_when_ingested ); 
+	
+	Cell_Parameters& p = parameters; 
+	double cell_parameters[10] = { p.o2_hypoxic_threshold, p.o2_hypoxic_response, p.o2_hypoxic_saturation, 
+		p.o2_proliferation_saturation, p.o2_proliferation_threshold, p.o2_reference, p.o2_necrosis_threshold, 
+		p.o2_necrosis_max, p.max_necrosis_rate, (double) p.necrosis_type }; 
+	buffer.insert( buffer.end() , cell_parameters , cell_parameters+10 ); 
+	
+	buffer.push_back( custom_data.variables.size() ); 
+	for( int i=0; i < custom_data.variables.size() ; i++ )
+	{ buffer.push_back( custom_data.variables[i].value ); }
+	buffer.push_back( custom_data.vector_variables.size() ); 
+	for( int i=0; i < custom_data.vector_variables.size() ; i++ )
+	{ pack_vector( buffer , custom_data.vector_variables[i].value ); }
+	
+	Cell_Functions& f = functions; 
+	Cell_Functions& df = pCD->functions; 
+	buffer.push_back( function_flag( f.volume_update_function , df.volume_update_function ) ); 
+	buffer.push_back( function_flag( f.update_migration_bias , df.update_migration_bias ) ); 
+	buffer.push_back( function_flag( f.custom_cell_rule , df.custom_cell_rule ) ); 
+	buffer.push_back( function_flag( f.update_phenotype , df.update_phenotype ) ); 
+	buffer.push_back( function_flag( f.update_velocity , df.update_velocity ) ); 
+	buffer.push_back( function_flag( f.add_cell_basement_membrane_interactions , df.add_cell_basement_membrane_interactions ) ); 
+	buffer.push_back( function_flag( f.calculate_distance_to_membrane , df.calculate_distance_to_membrane ) ); 
+	buffer.push_back( function_flag( f.set_orientation , df.set_orientation ) ); 
+	buffer.push_back( function_flag( f.contact_function , df.contact_function ) ); 
+	return; 
+}
+
+Cell* unpack_cell( std::vector<double>& buffer , int& position )
+{
+	std::vector<double>& b = buffer; 
+	int& n = position; 
+	int ID = (int) b[n++]; 
+	int type = (int) b[n++]; 
+	
+	Cell_Definition* pCD = find_cell_definition( type ); 
+	if( pCD == NULL )
+	{
+		std::cout << "Warning: no Cell_Definition of type " << type << " for a cell from another MPI rank. " 
+			<< "Using cell_defaults." << std::endl; 
+		pCD = &cell_defaults; 
+	}
+	
+	// the cell keeps its ID, so don't use up one here 
+	int next_ID = BioFVM::max_basic_agent_ID; 
+	Cell* pCell = new Cell( *pCD ); 
+	BioFVM::max_basic_agent_ID = next_ID; 
+	
+	pCell->ID = ID; 
+	for( int i=0; i < 3 ; i++ )
+	{ pCell->position[i] = b[n++]; }
+	for( int i=0; i < 3 ; i++ )
+	{ pCell->velocity[i] = b[n++]; }
+	for( int i=0; i < 3 ; i++ )
+	{ pCell->previous_velocity[i] = b[n++]; }
+	bool is_active = b[n++]; 
+	pCell->is_movable = b[n++]; 
+	double total_volume = b[n++]; 
+	
+	unpack_vector( b , n , pCell->state.orientation ); 
+	pCell->state.simple_pressure = b[n++]; 
+	
+	Phenotype& phenotype = pCell->phenotype; 
+	phenotype.death.dead = b[n++]; 
+	phenotype.death.current_death_model_index = (int) b[n++]; 
+	unpack_vector( b , n , phenotype.death.rates ); 
+	if( phenotype.death.dead )
+	{ phenotype.cycle.sync_to_cycle_model( phenotype.death.current_model() ); }
+	phenotype.cycle.data.current_phase_index = (int) b[n++]; 
+	phenotype.cycle.data.elapsed_time_in_phase = b[n++]; 
+	int rows = (int) b[n++]; 
+	phenotype.cycle.data.transition_rates.resize( rows ); 
+	for( int i=0; i < rows ; i++ )
+	{ unpack_vector( b , n , phenotype.cycle.data.transition_rates[i] ); }
+	
+	Volume& v = phenotype.volume; 
+	double* volume[22] = { &v.total, &v.solid, &v.fluid, &v.fluid_fraction, &v.nuclear, &v.nuclear_fluid, &v.nuclear_solid, 
+		&v.cytoplasmic, &v.cytoplasmic_fluid, &v.cytoplasmic_solid, &v.calcified_fraction, &v.cytoplasmic_to_nuclear_ratio, 
+		&v.rupture_volume, &v.cytoplasmic_biomass_change_rate, &v.nuclear_biomass_change_rate, &v.fluid_change_rate, 
+		&v.calcification_rate, &v.target_solid_cytoplasmic, &v.target_solid_nuclear, &v.target_fluid_fraction, 
+		&v.target_cytoplasmic_to_nuclear_ratio, &v.relative_rupture_volume }; 
+	for( int i=0; i < 22 ; i++ )
+	{ *volume[i] = b[n++]; }
+	
+	Geometry& g = phenotype.geometry; 
+	double* geometry[4] = { &g.radius, &g.nuclear_radius, &g.surface_area, &g.polarity }; 
+	for( int i=0; i < 4 ; i++ )
+	{ *geometry[i] = b[n++]; }
+	
+	Mechanics& m = phenotype.mechanics; 
+	double* mechanics[5] = { &m.cell_cell_adhesion_strength, &m.cell_BM_adhesion_strength, &m.cell_cell_repulsion_strength, 
+		&m.cell_BM_repulsion_strength, &m.relative_maximum_adhesion_distance }; 
+	for( int i=0; i < 5 ; i++ )
+	{ *mechanics[i] = b[n++]; }
+	
+	Motility& mo = phenotype.motility; 
+	mo.is_motile = b[n++]; 
+	mo.persistence_time = b[n++]; 
+	mo.migration_speed = b[n++]; 
+	unpack_vector( b , n , mo.migration_bias_direction ); 
+	mo.migration_bias = b[n++]; 
+	mo.restrict_to_2D = b[n++]; 
+	unpack_vector( b , n , mo.motility_vector ); 
+	
+	unpack_vector( b , n , phenotype.secretion.secretion_rates ); 
+	unpack_vector( b , n , phenotype.secretion.uptake_rates ); 
+	unpack_vector( b , n , phenotype.secretion.saturation_densities ); 
+	unpack_vector( b , n , phenotype.molecular.internalized_total_substrates ); 
+	unpack_vector( b , n , phenotype.molecular.fraction_released_at_death ); 
+	unpack_vector( b , n , phenotype.molecular.fraction_transferred_when_ingested ); 
+	
+	Cell_Parameters& p = pCell->parameters; 
+	double* cell_parameters[9] = { &p.o2_hypoxic_threshold, &p.o2_hypoxic_response, &p.o2_hypoxic_saturation, 
+		&p.o2_proliferation_saturation, &p.o2_proliferation_threshold, &p.o2_reference, &p.o2_necrosis_threshold, 
+		&p.o2_necrosis_max, &p.max_necrosis_rate }; 
+	for( int i=0; i < 9 ; i++ )
+	{ *cell_parameters[i] = b[n++]; }
+	p.necrosis_type = (int) b[n++]; 
+	
+	int variables = (int) b[n++]; 
+	for( int i=0; i < variables ; i++ )
+	{ pCell->custom_data.variables[i].value = b[n++]; }
+	variables = (int) b[n++]; 
+	for( int i=0; i < variables ; i++ )
+	{ unpack_vector( b , n , pCell->custom_data.vector_variables[i].value ); }
+	
+	Cell_Functions& f = pCell->functions; 
+	Cell_Functions& df = pCD->functions; 
+	set_function( f.volume_update_function , df.volume_update_function , b[n++] ); 
+	set_function( f.update_migration_bias , df.update_migration_bias , b[n++] ); 
+	set_function( f.custom_cell_rule , df.custom_cell_rule , b[n++] ); 
+	set_function( f.update_phenotype , df.update_phenotype , b[n++] ); 
+	set_function( f.update_velocity , df.update_velocity , b[n++] ); 
+	set_function( f.add_cell_basement_membrane_interactions , df.add_cell_basement_membrane_interactions , b[n++] ); 
+	set_function( f.calculate_distance_to_membrane , df.calculate_distance_to_membrane , b[n++] ); 
+	set_function( f.set_orientation , df.set_orientation , b[n++] ); 
+	set_function( f.contact_function , df.contact_function , b[n++] ); 
+	
+	// (the Basic_Agent already points at the molecular vectors, which were 
+	// filled in place) 
+	
+	Cell_Container* pContainer = (Cell_Container*) BioFVM::get_default_microenvironment()->agent_container; 
+	pCell->container = pContainer; 
+	pCell->current_mechanics_voxel_index = pContainer->underlying_mesh.nearest_voxel_index( pCell->position ); 
+	pContainer->register_agent( pCell ); 
+	pCell->update_voxel_index(); 
+	pCell->is_active = is_active; 
+	pCell->Basic_Agent::set_total_volume( total_volume ); 
+	
+	(*all_cells).push_back( pCell ); 
+	pCell->index = (*all_cells).size()-1; 
+	return pCell; 
+}
+
 bool is_neighbor_voxel(Cell* pCell, std::vector<double> my_voxel_center, std::vector<double> other_voxel_center, int other_voxel_index)
+{
+	if( default_microenvironment_options.simulate_2D == true )
+	{ return is_neighbor_voxel<2>( pCell, my_voxel_center, other_voxel_center, other_voxel_index ); }
+	return is_neighbor_voxel<3>( pCell, my_voxel_center, other_voxel_center, other_voxel_index ); 
+}
+
+template <int dimension> 
+bool is_neighbor_voxel(Cell* pCell, const std::vector<double>& my_voxel_center, const std::vector<double>& other_voxel_center, int other_voxel_index)
 {
 	double max_interactive_distance = pCell->phenotype.mechanics.relative_maximum_adhesion_distance * pCell->phenotype.geometry.radius 
 		+ pCell->get_container()->max_cell_interactive_distance_in_voxel[other_voxel_index];
 	
 	int comparing_dimension = -1, comparing_dimension2 = -1;
-	if(my_voxel_center[0] == other_voxel_center[0] && my_voxel_center[1] == other_voxel_center[1])
+	if( dimension == 2 )
+	{
+		// in a single z layer, the voxels share a side if they share x or y, and a corner otherwise 
+		if(my_voxel_center[0] == other_voxel_center[0])
+		{ comparing_dimension = 1; }
+		else if(my_voxel_center[1] == other_voxel_center[1])
+		{ comparing_dimension = 0; }
+	}
+	else if(my_voxel_center[0] == other_voxel_center[0] && my_voxel_center[1] == other_voxel_center[1])
 	{
 		comparing_dimension = 2;
 	}
@@ -947,7 +1497,11 @@ bool is_neighbor_voxel(Cell* pCell, std::vector<double> my_voxel_center, std::ve
 	}
 	comparing_dimension=-1;
 	
-	if(my_voxel_center[0] == other_voxel_center[0])
+	if( dimension == 2 )
+	{
+		comparing_dimension = 0; comparing_dimension2 = 1;
+	}
+	else if(my_voxel_center[0] == other_voxel_center[0])
 	{
 		comparing_dimension = 1; comparing_dimension2 = 2;
 	}
@@ -977,6 +1531,9 @@ bool is_neighbor_voxel(Cell* pCell, std::vector<double> my_voxel_center, std::ve
 	return true;
 }
 
+template bool is_neighbor_voxel<2>(Cell* pCell, const std::vector<double>& my_voxel_center, const std::vector<double>& other_voxel_center, int other_voxel_index); 
+template bool is_neighbor_voxel<3>(Cell* pCell, const std::vector<double>& my_voxel_center, const std::vector<double>& other_voxel_center, int other_voxel_index); 
+
 std::vector<Cell*>& Cell::cells_in_my_container( void )
 {
 	return get_container()->agent_grid[get_current_mechanics_voxel_index()];
@@ -1037,7 +1594,7 @@ void Cell::ingest_cell( Cell* pCell_to_eat )
 		*(pCell_to_eat->fraction_transferred_when_ingested); // 
 	
 	*internalized_substrates += *(pCell_to_eat->internalized_substrates); 
-	static int n_substrates = internalized_substrates->size(); 
+	int n_substrates = internalized_substrates->size(); 
 	pCell_to_eat->internalized_substrates->assign( n_substrates , 0.0 ); 	
 	
 	// trigger removal from the simulation 
@@ -131,6 +131,16 @@ class Cell_Definition
 
 extern Cell_Definition cell_defaults; 
 
+// the Cell_Definitions of the model, in the order they were registered at set-up 
+// (initialize_default_cell_definition registers cell_defaults; register any others 
+// once they are set up). Copies and temporaries are not registered. 
+extern std::vector<Cell_Definition*> cell_definitions_by_index; 
+void register_cell_definition( Cell_Definition& cd ); 
+// the first one of this type (NULL if none), e.g., to rebuild a cell sent by another MPI rank 
+Cell_Definition* find_cell_definition( int type ); 
+// by name (NULL if none): definitions may share a type, but not a name 
+Cell_Definition* find_cell_definition( std::string name ); 
+
 class Cell_State
 {
  public:
@@ -142,6 +152,22 @@ class Cell_State
 	Cell_State(); 
 };
 
+// optional per-cell values for create_cells(). Leave a vector empty to 
+// use the Cell_Definition's value for every cell. 
+class Cell_Batch_Overrides
+{
+ public:
+	std::vector<double> volumes; // one total volume per cell 
+	
+	std::vector<std::string> custom_data_names; // custom data variables to override 
+	std::vector< std::vector<double> > custom_data_values; // one row per cell, one column per name 
+	
+	Cell_Batch_Overrides(); 
+};
+
+class Cell; 
+std::vector<Cell*> create_cells( Cell_Definition& cd , std::vector< std::vector<double> >& positions , Cell_Batch_Overrides& overrides ); 
+
 class Cell : public Basic_Agent 
 {
  private: 
@@ -161,8 +187,11 @@ class Cell : public Basic_Agent
 	
 	void update_motility_vector( double dt_ );
 	void advance_bundled_phenotype_functions( double dt_ ); 
+	// its last stages, after the custom phenotype and volume updates 
+	void advance_geometry_death_and_cycle( double dt_ ); 
 	
 	void add_potentials(Cell*);       // Add repulsive and adhesive forces.
+	template <int dimension> void add_potentials(Cell*); // the same for dimension 2 (no z terms) or 3 
 	void set_previous_velocity(double xV, double yV, double zV);
 	int get_current_mechanics_voxel_index();
 	void turn_off_reactions(double); 		  // Turn off all the reactions of the cell
@@ -180,6 +209,15 @@ class Cell : public Basic_Agent
 	void die( void );
 	void step(double dt);
 	Cell();
+	Cell( Cell_Definition& cd ); // thread-safe: no RNG calls and no container registration 
+	
+	friend std::vector<Cell*> create_cells( Cell_Definition& cd , std::vector< std::vector<double> >& positions , Cell_Batch_Overrides& overrides ); 
+	
+	// MPI (see core/PhysiCell_MPI.h): appends the cell's state to buffer, and 
+	// rebuilds a cell (from its type's Cell_Definition) from it 
+	void pack( std::vector<double>& buffer ); 
+	friend Cell* unpack_cell( std::vector<double>& buffer , int& position ); 
+	friend class Cell_Exchange; 
 	
 	bool assign_position(std::vector<double> new_position);
 	bool assign_position(double, double, double);
@@ -187,8 +225,18 @@ class Cell : public Basic_Agent
 	
 	double& get_total_volume(void); // NEW
 	
+	// bytes of the cell and the memory it holds, including its copies of the 
+	// cycle model and its custom data 
+	long long memory_footprint( void ); 
+	
 	// mechanics 
 	void update_position( double dt ); //
+	// double-buffered form of update_position, for passes that update positions while 
+	// neighbors still read them: compute_next_position writes the new position into 
+	// next_position (3 doubles) without moving the cell, and commit_position moves it 
+	void compute_next_position( double dt , double* next_position ); 
+	template <int dimension> void compute_next_position( double dt , double* next_position ); 
+	void commit_position( const double* next_position ); 
 	std::vector<double> displacement; // this should be moved to state, or made private  
 
 	
@@ -217,13 +265,22 @@ class Cell : public Basic_Agent
 Cell* create_cell( void );  
 Cell* create_cell( Cell_Definition& cd );  
 
+// bulk creation: builds one cell per position in parallel, then adds them 
+// to all_cells and the mechanics grid in a single pass 
+std::vector<Cell*> create_cells( Cell_Definition& cd , std::vector< std::vector<double> >& positions ); 
+
 
 void delete_cell( int ); 
 void delete_cell( Cell* ); 
+// the cell at position in buffer (which moves past it), added to all_cells and its container 
+Cell* unpack_cell( std::vector<double>& buffer , int& position ); 
 void save_all_cells_to_matlab( std::string filename ); 
 
 //function to check if a neighbor voxel contains any cell that can interact with me
 bool is_neighbor_voxel(Cell* pCell, std::vector<double> myVoxelCenter, std::vector<double> otherVoxelCenter, int otherVoxelIndex);  
+// the same, specialized for dimension 2 (voxel centers differ only in x and y) or 3 
+template <int dimension> 
+bool is_neighbor_voxel(Cell* pCell, const std::vector<double>& myVoxelCenter, const std::vector<double>& otherVoxelCenter, int otherVoxelIndex); 
 
 };
 
@@ -65,10 +65,15 @@
 ###############################################################################
 */
 
+#include <algorithm>
+#include <map>
 #include "../BioFVM/BioFVM_agent_container.h"
 #include "PhysiCell_constants.h"
 #include "../BioFVM/BioFVM_vector.h"
 #include "PhysiCell_cell.h"
+#include "PhysiCell_cell_container.h"
+#include "PhysiCell_phenotype_batches.h"
+#include "PhysiCell_MPI.h"
 
 using namespace BioFVM;
 
@@ -76,13 +81,29 @@ namespace PhysiCell{
 
 std::vector<Cell*> *all_cells;
 
+Cell_Update_Options cell_update_options; 
+
+Cell_Update_Options::Cell_Update_Options()
+{
+	fused = false; 
+	spatial_sort = false; 
+	batched_phenotype = false; 
+	return; 
+}
+
 Cell_Container::Cell_Container()
+	: phenotype_loop( "phenotype" ), velocity_loop( "velocities" ), position_loop( "positions" )
 {
 	all_cells = (std::vector<Cell*> *) &all_basic_agents;	
 	boundary_condition_for_pushed_out_agents= PhysiCell_constants::default_boundary_condition_for_pushed_out_agents;
 	std::vector<Cell*> cells_ready_to_divide;
 	std::vector<Cell*> cells_ready_to_die;
 	
+	num_divisions_in_current_step = 0; 
+	num_deaths_in_current_step = 0; 
+	total_divisions = 0; 
+	total_deaths = 0; 
+	
 	return; 
 }	
 	
@@ -101,8 +122,8 @@ void Cell_Container::initialize(double x_start, double x_end, double y_start, do
 	std::vector<Cell*> cells_ready_to_die;
 
 	underlying_mesh.resize(x_start, x_end, y_start, y_end, z_start, z_end , dx, dy, dz);
-	agent_grid.resize(underlying_mesh.voxels.size());
-	max_cell_interactive_distance_in_voxel.resize(underlying_mesh.voxels.size(), 0.0);
+	agent_grid.resize(underlying_mesh.number_of_voxels());
+	max_cell_interactive_distance_in_voxel.resize(underlying_mesh.number_of_voxels(), 0.0);
 	agents_in_outer_voxels.resize(6);
 	
 	return; 
@@ -243,108 +264,322 @@ void Cell_Container::update_all_cells(double t, double phenotype_dt_ , double me
 
 void Cell_Container::update_all_cells(double t, double phenotype_dt_ , double mechanics_dt_ , double diffusion_dt_ )
 {
-	// secretions and uptakes. Syncing with BioFVM is automated. 
+	update_all_cells( get_default_simulation() , t , phenotype_dt_ , mechanics_dt_ , diffusion_dt_ ); 
+	return; 
+}
 
-	#pragma omp parallel for 
-	for( int i=0; i < (*all_cells).size(); i++ )
+void Cell_Container::update_all_cells( Simulation& simulation, double t, double phenotype_dt_ , double mechanics_dt_ , double diffusion_dt_ )
+{
+	// the stages, one after the other in the order they were added 
+	Task_Graph graph; 
+	graph.deterministic = true; 
+	add_update_tasks( graph, simulation, t, phenotype_dt_, mechanics_dt_, diffusion_dt_ ); 
+	graph.run(); 
+	return; 
+}
+
+/* 
+ Resources used by the stages: 
+	densities: the substrate densities (written by the diffusion solver) 
+	gradients: the substrate gradients 
+	secretion: each cell's BioFVM secretion / uptake constants (the secretion 
+	           stage also writes densities: uptake and secretion at each cell's voxel) 
+	cells:     cell state, positions, and the cell list and container 
+ Phenotype functions are treated as reading densities only; gradients are 
+ for the mechanics stage (e.g., chemotaxis in update_velocity). 
+*/
+
+// the phenotype time step of a cell: its type's own step, if it has one 
+static double phenotype_step( Cell* pCell , const std::map<int,double>& steps_by_type , double default_step )
+{
+	if( steps_by_type.empty() )
+	{ return default_step; }
+	auto search = steps_by_type.find( pCell->type ); 
+	if( search == steps_by_type.end() )
+	{ return default_step; }
+	return search->second; 
+}
+
+void Cell_Container::set_phenotype_dt_for_type( int type , double dt )
+{
+	phenotype_dt_by_type[ type ] = dt; 
+	return; 
+}
+
+long long Cell_Container::memory_footprint( void )
+{
+	long long out = sizeof( Cell_Container ) + heap_bytes( cells_ready_to_divide ) + heap_bytes( cells_ready_to_die ) 
+		+ heap_bytes( velocity_cost_estimates ) + heap_bytes( next_positions ) + heap_bytes( position_is_updated ) 
+		+ heap_bytes( max_cell_interactive_distance_in_voxel ) + heap_bytes( agent_grid ) + heap_bytes( agents_in_outer_voxels ); 
+	// a node of a std::map holds its key and value, and three pointers and a color 
+	out += phenotype_dt_by_type.size() * ( sizeof( std::pair<const int,double> ) + 4*sizeof(void*) ); 
+	out += underlying_mesh.memory_footprint() - sizeof( underlying_mesh ); 
+	return out; 
+}
+
+void Cell_Container::add_update_tasks( Task_Graph& graph, Simulation& simulation, double t, double phenotype_dt_ , double mechanics_dt_ , double diffusion_dt_ )
+{
+	std::vector<Cell*>& cells = *(simulation.pCells); 
+	
+	// MPI is only called from the main thread (see BioFVM/BioFVM_MPI.h) 
+	if( domain_decomposition.active )
+	{ graph.deterministic = true; }
+	
+	// The processes run on the simulation's integer clock. Callers that keep 
+	// their own time move the clock to t (rounded to the nearest tick). 
+	Multirate_Scheduler& scheduler = simulation.scheduler; 
+	scheduler.set_time( t ); 
+	int phenotype_process = scheduler.add_process( "phenotype" , phenotype_dt_ ); 
+	int mechanics_process = scheduler.add_process( "mechanics" , mechanics_dt_ ); 
+	
+	//if it is the time for running cell cycle, do it!
+	bool phenotype_is_due = false; 
+	bool all_phenotypes_are_due = true; 
+	double time_since_last_cycle = 0.0; // 0: not due
+	if( scheduler.is_due( phenotype_process ) )
 	{
-		(*all_cells)[i]->phenotype.secretion.advance( (*all_cells)[i], (*all_cells)[i]->phenotype , diffusion_dt_ );
+		time_since_last_cycle = scheduler.time_since_last_run( phenotype_process ); 
+		scheduler.mark_run( phenotype_process ); 
+		phenotype_is_due = true; 
 	}
+	else
+	{ all_phenotypes_are_due = false; }
 	
-	//if it is the time for running cell cycle, do it!
-	double time_since_last_cycle= t- last_cell_cycle_time;
-
-	static double phenotype_dt_tolerance = 0.001 * phenotype_dt_; 
-	static double mechanics_dt_tolerance = 0.001 * mechanics_dt_; 
+	// cell types with their own phenotype cadence 
+	std::map<int,double> phenotype_steps_by_type; 
+	for( auto it = phenotype_dt_by_type.begin(); it != phenotype_dt_by_type.end(); it++ )
+	{
+		int process = scheduler.add_process( "phenotype (type " + std::to_string( it->first ) + ")" , it->second ); 
+		double step = 0.0; 
+		if( scheduler.is_due( process ) )
+		{
+			step = scheduler.time_since_last_run( process ); 
+			scheduler.mark_run( process ); 
+			phenotype_is_due = true; 
+		}
+		else
+		{ all_phenotypes_are_due = false; }
+		phenotype_steps_by_type[ it->first ] = step; 
+	}
 	
-	if( fabs(time_since_last_cycle-phenotype_dt_ ) < phenotype_dt_tolerance || !initialzed)
+	// secretions and uptakes. Syncing with BioFVM is automated. 
+	// (This writes the densities at each cell's voxel, which the phenotype 
+	// functions read, so it stays a separate pass.) 
+	
+	graph.add_task( "secretion" , [&cells,diffusion_dt_]()
 	{
-		// Reset the max_radius in each voxel. It will be filled in set_total_volume
-		// It might be better if we calculate it before mechanics each time 
-		std::fill(max_cell_interactive_distance_in_voxel.begin(), max_cell_interactive_distance_in_voxel.end(), 0.0);
-		
-		if(!initialzed)
+		#pragma omp parallel for 
+		for( int i=0; i < cells.size(); i++ )
 		{
-			time_since_last_cycle = phenotype_dt_;
+			cells[i]->phenotype.secretion.advance( cells[i], cells[i]->phenotype , diffusion_dt_ );
 		}
+	} , {"cells"} , {"secretion","densities"} ); 
+	
+	if( phenotype_is_due )
+	{
+		graph.add_task( "phenotype" , [this,&cells,time_since_last_cycle,phenotype_steps_by_type,all_phenotypes_are_due]()
+		{
+			// Reset the max_radius in each voxel. It will be filled in set_total_volume
+			// It might be better if we calculate it before mechanics each time 
+			// (cells that skip this update keep their contribution, which only costs 
+			// some neighbor search) 
+			if( all_phenotypes_are_due )
+			{ std::fill(max_cell_interactive_distance_in_voxel.begin(), max_cell_interactive_distance_in_voxel.end(), 0.0); }
+			
+			// the same stages, each as a loop over the cells of a type (see PhysiCell_phenotype_batches.h) 
+			if( cell_update_options.batched_phenotype )
+			{
+				advance_phenotypes_in_batches( cells , [time_since_last_cycle,&phenotype_steps_by_type](Cell* pCell)
+				{ return phenotype_step( pCell , phenotype_steps_by_type , time_since_last_cycle ); } ); 
+				return; 
+			}
+			
+			// new as of 1.2.1 -- bundles cell phenotype parameter update, volume update, geometry update, 
+			// checking for death, and advancing the cell cycle. Not motility, though. (that's in mechanics)
+			phenotype_loop.run( cells.size() , [&cells,time_since_last_cycle,&phenotype_steps_by_type](int i)
+			{
+				double dt = phenotype_step( cells[i] , phenotype_steps_by_type , time_since_last_cycle ); 
+				if( cells[i]->is_out_of_domain == false && dt > 0.0 )
+				{
+					cells[i]->advance_bundled_phenotype_functions( dt ); 
+				}
+			} ); 
+		} , {"densities","gradients"} , {"cells"} ); // phenotype functions may read nearest_gradient 
 		
-		// new as of 1.2.1 -- bundles cell phenotype parameter update, volume update, geometry update, 
-		// checking for death, and advancing the cell cycle. Not motility, though. (that's in mechanics)
-		#pragma omp parallel for 
-		for( int i=0; i < (*all_cells).size(); i++ )
+		graph.add_task( "divisions and deaths" , [this,&cells]()
 		{
-			if( (*all_cells)[i]->is_out_of_domain == false )
+			// process divides / removes 
+			for( int i=0; i < cells_ready_to_divide.size(); i++ )
 			{
-				(*all_cells)[i]->advance_bundled_phenotype_functions( time_since_last_cycle ); 
+				cells_ready_to_divide[i]->divide();
 			}
-		}
+			for( int i=0; i < cells_ready_to_die.size(); i++ )
+			{	
+				cells_ready_to_die[i]->die();	
+			}
+			num_divisions_in_current_step+=  cells_ready_to_divide.size();
+			num_deaths_in_current_step+=  cells_ready_to_die.size();
+			total_divisions += cells_ready_to_divide.size(); 
+			total_deaths += cells_ready_to_die.size(); 
+			
+			cells_ready_to_die.clear();
+			cells_ready_to_divide.clear();
+			
+			if( cell_update_options.spatial_sort )
+			{ sort_cells_by_mechanics_voxel( cells ); }
+		} , {} , {"cells","secretion"} ); 
 		
-		// process divides / removes 
-		for( int i=0; i < cells_ready_to_divide.size(); i++ )
+		// MPI: daughter cells may have been placed in a neighbor's slab 
+		if( domain_decomposition.active )
 		{
-			cells_ready_to_divide[i]->divide();
+			graph.add_task( "cell migration (divisions)" , []()
+			{ cell_exchange.migrate_cells(); } , {} , {"cells"} ); 
 		}
-		for( int i=0; i < cells_ready_to_die.size(); i++ )
-		{	
-			cells_ready_to_die[i]->die();	
-		}
-		num_divisions_in_current_step+=  cells_ready_to_divide.size();
-		num_deaths_in_current_step+=  cells_ready_to_die.size();
 		
-		cells_ready_to_die.clear();
-		cells_ready_to_divide.clear();
 		last_cell_cycle_time= t;
 	}
 		
-	double time_since_last_mechanics= t- last_mechanics_time;
-	
-	// if( time_since_last_mechanics>= mechanics_dt || !initialzed)
-	if( fabs(time_since_last_mechanics - mechanics_dt_) < mechanics_dt_tolerance || !initialzed)
+	if( scheduler.is_due( mechanics_process ) )
 	{
-		if(!initialzed)
-		{
-			time_since_last_mechanics = mechanics_dt_;
-		}
+		double time_since_last_mechanics = scheduler.time_since_last_run( mechanics_process ); 
+		scheduler.mark_run( mechanics_process ); 
 		
 		// new February 2018 
 		// if we need gradients, compute them
-		if( default_microenvironment_options.calculate_gradients ) 
-		{ microenvironment.compute_all_gradient_vectors();  }
+		if( simulation.pMicroenvironment_options->calculate_gradients ) 
+		{
+			Microenvironment* pMicroenvironment = simulation.pMicroenvironment; 
+			graph.add_task( "gradients" , [pMicroenvironment]()
+			{ pMicroenvironment->compute_all_gradient_vectors(); } , 
+			{"densities"} , {"gradients"} ); 
+		}
 		// end of new in Feb 2018 		
 		
-		// Compute velocities
-		#pragma omp parallel for 
-		for( int i=0; i < (*all_cells).size(); i++ )
+		// MPI: the neighboring ranks' cells are only present during the velocity 
+		// update, so the separate velocity and position passes are used 
+		if( domain_decomposition.active )
+		{
+			graph.add_task( "ghost cells" , []()
+			{ cell_exchange.exchange_ghost_cells(); } , {} , {"cells"} ); 
+		}
+		
+		if( cell_update_options.fused && domain_decomposition.active == false )
 		{
+			graph.add_task( "velocities and positions" , [this,&cells,time_since_last_mechanics]()
+			{
+				// neighbors read positions while cells move, so the new positions go to 
+				// a buffer, and are committed once every velocity is known. The cost 
+				// estimates come from the neighbor counts of the last pass. 
+				next_positions.resize( 3*cells.size() ); 
+				position_is_updated.assign( cells.size() , 0 ); 
+				velocity_cost_estimates.resize( cells.size() , 1.0 ); 
+				
+				velocity_loop.run( cells.size() , velocity_cost_estimates , [this,&cells,time_since_last_mechanics](int i)
+				{
+					double cost = 1.0; 
+					if(!cells[i]->is_out_of_domain && cells[i]->is_movable && cells[i]->functions.update_velocity )
+					{
+						cost += number_of_candidate_neighbors( cells[i] ); 
+						cells[i]->functions.update_velocity( cells[i], cells[i]->phenotype, time_since_last_mechanics);
+					}
 
-			if(!(*all_cells)[i]->is_out_of_domain && (*all_cells)[i]->is_movable && (*all_cells)[i]->functions.update_velocity )
+					if( cells[i]->functions.custom_cell_rule )
+					{
+						cost += 1.0; 
+						cells[i]->functions.custom_cell_rule(cells[i], cells[i]->phenotype, time_since_last_mechanics);
+					}
+					// the partition is already made, so this only affects the next pass 
+					velocity_cost_estimates[i] = cost; 
+					
+					if(!cells[i]->is_out_of_domain && cells[i]->is_movable)
+					{
+						cells[i]->compute_next_position( time_since_last_mechanics , &(next_positions[3*i]) ); 
+						position_is_updated[i] = 1; 
+					}
+				} ); 
+				
+				position_loop.run( cells.size() , [this,&cells](int i)
+				{
+					if( position_is_updated[i] )
+					{ cells[i]->commit_position( &(next_positions[3*i]) ); }
+				} ); 
+				
+				// Update cell indices in the container (serial, as in the staged update) 
+				for( int i=0; i < cells.size(); i++ )
+				{
+					if( position_is_updated[i] && !cells[i]->is_out_of_domain && cells[i]->is_movable )
+					{ cells[i]->update_voxel_in_container(); }
+				}
+			} , {"densities","gradients"} , {"cells"} ); 
+		}
+		else
+		{
+			// Compute velocities
+			graph.add_task( "velocities" , [this,&cells,time_since_last_mechanics]()
 			{
-				// update_velocity already includes the motility update 
-				//(*all_cells)[i]->phenotype.motility.update_motility_vector( (*all_cells)[i] ,(*all_cells)[i]->phenotype , time_since_last_mechanics ); 
-				(*all_cells)[i]->functions.update_velocity( (*all_cells)[i], (*all_cells)[i]->phenotype, time_since_last_mechanics);
-			}
+				// the cost of a cell is dominated by its neighbor search, so estimate it 
+				// from the occupancy of the mechanics grid (as of the last position update) 
+				velocity_cost_estimates.resize( cells.size() ); 
+				#pragma omp parallel for 
+				for( int i=0; i < cells.size(); i++ )
+				{
+					double cost = 1.0; 
+					if(!cells[i]->is_out_of_domain && cells[i]->is_movable && cells[i]->functions.update_velocity )
+					{ cost += number_of_candidate_neighbors( cells[i] ); }
+					if( cells[i]->functions.custom_cell_rule )
+					{ cost += 1.0; }
+					velocity_cost_estimates[i] = cost; 
+				}
+			
+				velocity_loop.run( cells.size() , velocity_cost_estimates , [&cells,time_since_last_mechanics](int i)
+				{
 
-			if( (*all_cells)[i]->functions.custom_cell_rule )
+					if(!cells[i]->is_out_of_domain && cells[i]->is_movable && cells[i]->functions.update_velocity )
+					{
+						// update_velocity already includes the motility update 
+						//cells[i]->phenotype.motility.update_motility_vector( cells[i] ,cells[i]->phenotype , time_since_last_mechanics ); 
+						cells[i]->functions.update_velocity( cells[i], cells[i]->phenotype, time_since_last_mechanics);
+					}
+
+					if( cells[i]->functions.custom_cell_rule )
+					{
+						cells[i]->functions.custom_cell_rule(cells[i], cells[i]->phenotype, time_since_last_mechanics);
+					}
+				} ); 
+			} , {"densities","gradients"} , {"cells"} ); 
+			
+			if( domain_decomposition.active )
 			{
-				(*all_cells)[i]->functions.custom_cell_rule((*all_cells)[i], (*all_cells)[i]->phenotype, time_since_last_mechanics);
+				graph.add_task( "remove ghost cells" , []()
+				{ cell_exchange.remove_ghost_cells(); } , {} , {"cells"} ); 
 			}
-		}
-		// Calculate new positions
-		#pragma omp parallel for 
-		for( int i=0; i < (*all_cells).size(); i++ )
-		{
-			if(!(*all_cells)[i]->is_out_of_domain && (*all_cells)[i]->is_movable)
+		
+			// Calculate new positions
+			graph.add_task( "positions" , [this,&cells,time_since_last_mechanics]()
 			{
-				(*all_cells)[i]->update_position(time_since_last_mechanics);
+				position_loop.run( cells.size() , [&cells,time_since_last_mechanics](int i)
+				{
+					if(!cells[i]->is_out_of_domain && cells[i]->is_movable)
+					{
+						cells[i]->update_position(time_since_last_mechanics);
+					}
+				} ); 
+			
+				// When somebody reviews this code, let's add proper braces for clarity!!! 
+			
+				// Update cell indices in the container
+				for( int i=0; i < cells.size(); i++ )
+					if(!cells[i]->is_out_of_domain && cells[i]->is_movable)
+						cells[i]->update_voxel_in_container();
+			} , {} , {"cells"} );
+			
+			if( domain_decomposition.active )
+			{
+				graph.add_task( "cell migration" , []()
+				{ cell_exchange.migrate_cells(); } , {} , {"cells"} ); 
 			}
 		}
 		
-		// When somebody reviews this code, let's add proper braces for clarity!!! 
-		
-		// Update cell indices in the container
-		for( int i=0; i < (*all_cells).size(); i++ )
-			if(!(*all_cells)[i]->is_out_of_domain && (*all_cells)[i]->is_movable)
-				(*all_cells)[i]->update_voxel_in_container();
 		last_mechanics_time=t;
 	}
 	
@@ -352,6 +587,23 @@ void Cell_Container::update_all_cells(double t, double phenotype_dt_ , double me
 	return;
 }
 
+bool compare_mechanics_voxels( Cell* pCell1 , Cell* pCell2 )
+{ return pCell1->get_current_mechanics_voxel_index() < pCell2->get_current_mechanics_voxel_index(); }
+
+void Cell_Container::sort_cells_by_mechanics_voxel( std::vector<Cell*>& cells )
+{
+	if( std::is_sorted( cells.begin() , cells.end() , compare_mechanics_voxels ) )
+	{ return; }
+	
+	// stable, so that cells in the same voxel keep their order 
+	std::stable_sort( cells.begin() , cells.end() , compare_mechanics_voxels ); 
+	
+	// deletions swap with the last cell by index, so keep the indices in sync 
+	for( int i=0; i < cells.size(); i++ )
+	{ cells[i]->index = i; }
+	return; 
+}
+
 void Cell_Container::register_agent( Cell* agent )
 {
 	agent_grid[agent->get_current_mechanics_voxel_index()].push_back(agent);
@@ -398,6 +650,31 @@ bool Cell_Container::contain_any_cell(int voxel_index)
 	return agent_grid[voxel_index].size()==0?false:true;
 }
 
+int Cell_Container::number_of_candidate_neighbors( Cell* pCell )
+{
+	int voxel_index = pCell->get_current_mechanics_voxel_index(); 
+	int count = agent_grid[voxel_index].size(); 
+	int neighbor_voxels[26]; 
+	int number_of_neighbor_voxels = underlying_mesh.moore_neighborhood( voxel_index , neighbor_voxels ); 
+	for( int i=0; i < number_of_neighbor_voxels ; i++ )
+	{ count += agent_grid[ neighbor_voxels[i] ].size(); }
+	return count; 
+}
+
+void Cell_Container::display_load_balancing_statistics( std::ostream& os )
+{
+	os << "per-thread idle time in the cell updates (" 
+	   << ( load_balancing_options.enable ? "cost-balanced chunks" : "static blocks" ) << "): " << std::endl; 
+	phenotype_loop.statistics.display( os ); 
+	velocity_loop.statistics.display( os ); 
+	position_loop.statistics.display( os ); 
+	
+	phenotype_loop.statistics.reset(); 
+	velocity_loop.statistics.reset(); 
+	position_loop.statistics.reset(); 
+	return; 
+}
+
 int find_escaping_face_index(Cell* agent)
 {
 	if(agent->position[0] <= agent->get_container()->underlying_mesh.bounding_box[PhysiCell_constants::mesh_min_x_index])
@@ -433,11 +710,25 @@ void Cell_Container::flag_cell_for_removal( Cell* pCell )
 Cell_Container* create_cell_container_for_microenvironment( BioFVM::Microenvironment& m , double mechanics_voxel_size )
 {
 	Cell_Container* cell_container = new Cell_Container;
-	cell_container->initialize( m.mesh.bounding_box[0], m.mesh.bounding_box[3], 
-		m.mesh.bounding_box[1], m.mesh.bounding_box[4], 
-		m.mesh.bounding_box[2], m.mesh.bounding_box[5],  mechanics_voxel_size );
+	// the mechanics mesh follows the microenvironment's (implicit or explicit) voxel storage 
+	cell_container->underlying_mesh.implicit_voxels = m.mesh.implicit_voxels; 
+	// in 2-D, keep a single z layer, as the 2-D mechanics kernels assume 
+	double z_size = mechanics_voxel_size; 
+	if( default_microenvironment_options.simulate_2D == true )
+	{ z_size = std::max( mechanics_voxel_size , m.mesh.bounding_box[5] - m.mesh.bounding_box[2] ); }
+	if( m.decomposed )
+	{ cell_exchange.initialize( cell_container , mechanics_voxel_size ); }
+	else
+	{
+		cell_container->initialize( m.mesh.bounding_box[0], m.mesh.bounding_box[3], 
+			m.mesh.bounding_box[1], m.mesh.bounding_box[4], 
+			m.mesh.bounding_box[2], m.mesh.bounding_box[5], mechanics_voxel_size, mechanics_voxel_size, z_size );
+	}
 	m.agent_container = (Agent_Container*) cell_container; 
 	
+	if( &m == get_default_simulation().pMicroenvironment && get_default_simulation().pCell_container == NULL )
+	{ get_default_simulation().pCell_container = cell_container; }
+	
 	if( BioFVM::get_default_microenvironment() == NULL )
 	{ 
 		BioFVM::set_default_microenvironment( &m ); 
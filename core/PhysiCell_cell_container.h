@@ -69,7 +69,11 @@
 #define __PhysiCell_cell_container_h__
 
 #include <vector>
+#include <map>
 #include "PhysiCell_cell.h"
+#include "PhysiCell_simulation.h"
+#include "PhysiCell_task_graph.h"
+#include "PhysiCell_load_balancing.h"
 #include "../BioFVM/BioFVM_agent_container.h"
 #include "../BioFVM/BioFVM_mesh.h"
 #include "../BioFVM/BioFVM_microenvironment.h"
@@ -78,6 +82,30 @@ namespace PhysiCell{
 
 class Cell; 
 
+class Cell_Update_Options
+{
+ private:
+ public:
+	// true: one pass over the cells for velocities, custom rules, and positions 
+	// (double-buffered, so the results do not change). Secretion and phenotype 
+	// stay separate: secretion changes the densities that phenotype reads. 
+	bool fused; 
+	
+	// true: sort the cells by mechanics voxel after divisions and deaths, so that 
+	// chunks of consecutive cells are neighbors in space. This changes the order 
+	// in which cells draw random numbers. 
+	bool spatial_sort; 
+	
+	// true: advance the phenotypes in batches of cells of one type, a stage at a 
+	// time (see PhysiCell_phenotype_batches.h). This changes the order in which 
+	// cells draw random numbers. 
+	bool batched_phenotype; 
+	
+	Cell_Update_Options(); 
+};
+
+extern Cell_Update_Options cell_update_options; 
+
 class Cell_Container : public BioFVM::Agent_Container
 {
  private:	
@@ -86,11 +114,29 @@ class Cell_Container : public BioFVM::Agent_Container
 	int boundary_condition_for_pushed_out_agents; 	// what to do with pushed out cells
 	bool initialzed = false;
 	
+	// the per-cell loops, with their idle-time statistics 
+	Balanced_Loop phenotype_loop; 
+	Balanced_Loop velocity_loop; 
+	Balanced_Loop position_loop; 
+	std::vector<double> velocity_cost_estimates; 
+	
+	// buffers for the fused velocity and position pass 
+	std::vector<double> next_positions; 
+	std::vector<char> position_is_updated; 
+	
+	void sort_cells_by_mechanics_voxel( std::vector<Cell*>& cells ); 
+	
+	// cell types with their own phenotype time step 
+	std::map<int,double> phenotype_dt_by_type; 
+	
  public:
 	BioFVM::Cartesian_Mesh underlying_mesh;
 	std::vector<double> max_cell_interactive_distance_in_voxel;
 	int num_divisions_in_current_step;
 	int num_deaths_in_current_step;
+	// running totals since the start of the simulation (never reset) 
+	int total_divisions; 
+	int total_deaths; 
 
 	double last_diffusion_time  = 0.0; 
 	double last_cell_cycle_time = 0.0;
@@ -105,6 +151,10 @@ class Cell_Container : public BioFVM::Agent_Container
 	void update_all_cells(double t, double dt);
 	void update_all_cells(double t, double phenotype_dt, double mechanics_dt);
 	void update_all_cells(double t, double phenotype_dt, double mechanics_dt, double diffusion_dt ); 
+	void update_all_cells( Simulation& simulation, double t, double phenotype_dt, double mechanics_dt, double diffusion_dt ); 
+	// adds the stages of update_all_cells to a step's task graph. Whether phenotype 
+	// and mechanics are due is decided on the simulation's scheduler, at time t. 
+	void add_update_tasks( Task_Graph& graph, Simulation& simulation, double t, double phenotype_dt, double mechanics_dt, double diffusion_dt ); 
 
 	void register_agent( Cell* agent );
 	void add_agent_to_outer_voxel(Cell* agent);
@@ -115,6 +165,16 @@ class Cell_Container : public BioFVM::Agent_Container
 	void flag_cell_for_division( Cell* pCell ); 
 	void flag_cell_for_removal( Cell* pCell ); 
 	bool contain_any_cell(int voxel_index);
+	
+	// number of candidate neighbors in the mechanics grid, as a cost estimate 
+	int number_of_candidate_neighbors( Cell* pCell ); 
+	void display_load_balancing_statistics( std::ostream& os ); // and resets them 
+	
+	// cells of this type update their phenotype every dt, rather than every phenotype_dt 
+	void set_phenotype_dt_for_type( int type , double dt ); 
+	
+	// bytes of the container, its mechanics grid, and its buffers (not the cells) 
+	long long memory_footprint( void ); 
 };
 
 int find_escaping_face_index(Cell* agent);
@@ -66,6 +66,7 @@
 */
 
 #include "./PhysiCell_custom.h" 
+#include "../BioFVM/BioFVM_utilities.h" 
 #include <vector>
 #include <cstdio>
 #include <iostream>
@@ -129,6 +130,20 @@ Custom_Cell_Data::Custom_Cell_Data( const Custom_Cell_Data& ccd )
 	return; 
 }
 
+long long Custom_Cell_Data::memory_footprint( void )
+{
+	long long out = BioFVM::heap_bytes( name_to_index_map ) + BioFVM::heap_bytes( variables ) 
+		+ BioFVM::heap_bytes( vector_variables ); 
+	for( int i=0; i < variables.size() ; i++ )
+	{ out += BioFVM::heap_bytes( variables[i].name ) + BioFVM::heap_bytes( variables[i].units ); }
+	for( int i=0; i < vector_variables.size() ; i++ )
+	{
+		out += BioFVM::heap_bytes( vector_variables[i].name ) + BioFVM::heap_bytes( vector_variables[i].value ) 
+			+ BioFVM::heap_bytes( vector_variables[i].units ); 
+	}
+	return out; 
+}
+
 int Custom_Cell_Data::add_variable( Variable& v )
 {
 	int n = variables.size(); 
@@ -131,6 +131,8 @@ class Custom_Cell_Data
 	
 	Custom_Cell_Data(); // done 
 	Custom_Cell_Data( const Custom_Cell_Data& ccd ); 
+	
+	long long memory_footprint( void ); // the memory it holds, not counting the object 
 };
 
 }; 
@@ -0,0 +1,245 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "./PhysiCell_hardware_counters.h"
+
+#include <cstring>
+#include <cerrno>
+#include <omp.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+#endif
+
+namespace PhysiCell{
+
+Hardware_Counters hardware_counters; 
+
+#ifdef __linux__
+// the open() whose counters this thread has opened (0: none) 
+static thread_local int opened_generation = 0; 
+#endif
+
+Hardware_Counters::Hardware_Counters()
+{
+	names = { "cycles" , "instructions" , "L1D misses" , "LLC misses" , "branch misses" , 
+		"stalled cycles (frontend)" , "stalled cycles (backend)" }; 
+	available = false; 
+	reason = "not opened"; 
+	generation = 0; 
+	return; 
+}
+
+Hardware_Counters::~Hardware_Counters()
+{
+	close(); 
+	return; 
+}
+
+#ifdef __linux__
+static int open_counter( unsigned int type , unsigned long long config )
+{
+	struct perf_event_attr attributes; 
+	memset( &attributes , 0 , sizeof( attributes ) ); 
+	attributes.size = sizeof( attributes ); 
+	attributes.type = type; 
+	attributes.config = config; 
+	attributes.disabled = 1; 
+	attributes.exclude_kernel = 1; 
+	attributes.exclude_hv = 1; 
+	attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING; 
+	// the calling thread, on any CPU 
+	return syscall( __NR_perf_event_open , &attributes , 0 , -1 , -1 , 0 ); 
+}
+
+// the counters of the calling thread (the cycle counter is -1 if none could be opened) 
+static std::vector<int> open_thread_counters( int number_of_counters )
+{
+	const unsigned long long L1D_read_miss = PERF_COUNT_HW_CACHE_L1D | 
+		( PERF_COUNT_HW_CACHE_OP_READ << 8 ) | ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 ); 
+	const unsigned long long LLC_read_miss = PERF_COUNT_HW_CACHE_LL | 
+		( PERF_COUNT_HW_CACHE_OP_READ << 8 ) | ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 ); 
+	
+	std::vector<int> descriptors( number_of_counters , -1 ); 
+	descriptors[0] = open_counter( PERF_TYPE_HARDWARE , PERF_COUNT_HW_CPU_CYCLES ); 
+	if( descriptors[0] < 0 )
+	{ return descriptors; }
+	descriptors[1] = open_counter( PERF_TYPE_HARDWARE , PERF_COUNT_HW_INSTRUCTIONS ); 
+	descriptors[2] = open_counter( PERF_TYPE_HW_CACHE , L1D_read_miss ); 
+	descriptors[3] = open_counter( PERF_TYPE_HW_CACHE , LLC_read_miss ); 
+	descriptors[4] = open_counter( PERF_TYPE_HARDWARE , PERF_COUNT_HW_BRANCH_MISSES ); 
+	descriptors[5] = open_counter( PERF_TYPE_HARDWARE , PERF_COUNT_HW_STALLED_CYCLES_FRONTEND ); 
+	descriptors[6] = open_counter( PERF_TYPE_HARDWARE , PERF_COUNT_HW_STALLED_CYCLES_BACKEND ); 
+	
+	for( int i=0; i < descriptors.size() ; i++ )
+	{
+		if( descriptors[i] >= 0 )
+		{
+			ioctl( descriptors[i] , PERF_EVENT_IOC_RESET , 0 ); 
+			ioctl( descriptors[i] , PERF_EVENT_IOC_ENABLE , 0 ); 
+		}
+	}
+	return descriptors; 
+}
+#endif
+
+bool Hardware_Counters::open( void )
+{
+	if( available )
+	{ return true; }
+#ifdef __linux__
+	std::vector<int> first = open_thread_counters( names.size() ); 
+	if( first[0] < 0 )
+	{
+		reason = std::string( "perf_event_open: " ) + strerror( errno ); 
+		if( errno == EACCES || errno == EPERM )
+		{ reason += " (see /proc/sys/kernel/perf_event_paranoid)"; }
+		return false; 
+	}
+	{
+		std::lock_guard<std::mutex> lock( mutex ); 
+		descriptors.assign( 1 , first ); 
+		generation++; 
+		available = true; 
+		reason = ""; 
+	}
+	
+	// this thread's are open; now those of its OpenMP team 
+	opened_generation = generation; 
+	#pragma omp parallel
+	{ open_for_this_thread(); }
+	return true; 
+#else
+	reason = "hardware counters need Linux perf_event_open"; 
+	return false; 
+#endif
+}
+
+void Hardware_Counters::open_for_this_thread( void )
+{
+#ifdef __linux__
+	if( available == false || opened_generation == generation )
+	{ return; }
+	opened_generation = generation; 
+	
+	std::vector<int> thread_descriptors = open_thread_counters( names.size() ); 
+	if( thread_descriptors[0] < 0 )
+	{ return; }
+	std::lock_guard<std::mutex> lock( mutex ); 
+	descriptors.push_back( thread_descriptors ); 
+#endif
+	return; 
+}
+
+void Hardware_Counters::close( void )
+{
+	std::lock_guard<std::mutex> lock( mutex ); 
+#ifdef __linux__
+	for( int n=0; n < descriptors.size() ; n++ )
+	{
+		for( int i=0; i < descriptors[n].size() ; i++ )
+		{
+			if( descriptors[n][i] >= 0 )
+			{ ::close( descriptors[n][i] ); }
+		}
+	}
+#endif
+	descriptors.clear(); 
+	available = false; 
+	return; 
+}
+
+void Hardware_Counters::read( std::vector<double>& values )
+{
+	values.assign( names.size() , -1.0 ); 
+#ifdef __linux__
+	std::lock_guard<std::mutex> lock( mutex ); 
+	// the sum over the threads; a counter is -1 if the first thread does not have it 
+	for( int n=0; n < descriptors.size() ; n++ )
+	{
+		for( int i=0; i < descriptors[n].size() ; i++ )
+		{
+			// value, time enabled, time running 
+			unsigned long long data[3]; 
+			if( descriptors[n][i] < 0 || ::read( descriptors[n][i] , data , sizeof( data ) ) != sizeof( data ) )
+			{ continue; }
+			if( n > 0 && values[i] < 0.0 )
+			{ continue; }
+			if( values[i] < 0.0 )
+			{ values[i] = 0.0; }
+			if( data[2] > 0 )
+			{ values[i] += (double) data[0] * ( (double) data[1] / (double) data[2] ); }
+		}
+	}
+#endif
+	return; 
+}
+
+};
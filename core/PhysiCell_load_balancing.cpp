@@ -0,0 +1,270 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "./PhysiCell_load_balancing.h"
+#include "../BioFVM/BioFVM_trace.h"
+
+#include <omp.h>
+
+namespace PhysiCell{
+
+Load_Balancing_Options load_balancing_options; 
+
+Load_Balancing_Options::Load_Balancing_Options()
+{
+	enable = true; 
+	chunks_per_thread = 8; 
+	record_idle_time = false; 
+	return; 
+}
+
+Parallel_Loop_Statistics::Parallel_Loop_Statistics()
+{
+	name = "unnamed"; 
+	reset(); 
+	return; 
+}
+
+void Parallel_Loop_Statistics::reset( void )
+{
+	calls = 0; 
+	wall_time = 0.0; 
+	busy_time = 0.0; 
+	idle_time = 0.0; 
+	worst_imbalance = 1.0; 
+	return; 
+}
+
+void Parallel_Loop_Statistics::record( double start_time, double end_time, std::vector<double>& finish_times, int number_of_threads )
+{
+	double slowest = 0.0; 
+	double total = 0.0; 
+	for( int i=0; i < number_of_threads ; i++ )
+	{
+		double busy = finish_times[i] - start_time; 
+		total += busy; 
+		if( busy > slowest )
+		{ slowest = busy; }
+		idle_time += end_time - finish_times[i]; 
+	}
+	busy_time += total; 
+	wall_time += end_time - start_time; 
+	calls++; 
+	
+	double mean = total / (double) number_of_threads; 
+	if( mean > 0.0 && slowest / mean > worst_imbalance )
+	{ worst_imbalance = slowest / mean; }
+	return; 
+}
+
+void Parallel_Loop_Statistics::display( std::ostream& os )
+{
+	double idle_percent = 0.0; 
+	if( busy_time + idle_time > 0.0 )
+	{ idle_percent = 100.0 * idle_time / ( busy_time + idle_time ); }
+	
+	os << "\t" << name << ": " << calls << " calls, " << wall_time << " s wall, " 
+	   << idle_percent << "% of thread time idle, worst imbalance " << worst_imbalance << std::endl; 
+	return; 
+}
+
+// counters for different owners are a cache line apart 
+static const int chunk_counter_stride = 16; 
+
+static int owner_first_chunk( int owner , int team_size , int number_of_chunks )
+{ return (int) ( ( (long) owner * number_of_chunks ) / team_size ); }
+
+Balanced_Loop::Balanced_Loop( std::string name )
+{
+	statistics.name = name; 
+	return; 
+}
+
+// splits [0,n) into contiguous chunks of about equal total cost 
+void Balanced_Loop::partition( int n , std::vector<double>& costs , int number_of_chunks )
+{
+	if( number_of_chunks > n )
+	{ number_of_chunks = n; }
+	if( number_of_chunks < 1 )
+	{ number_of_chunks = 1; }
+	
+	chunk_starts.resize( number_of_chunks + 1 ); 
+	chunk_starts[0] = 0; 
+	
+	if( costs.size() != n )
+	{
+		for( int c=1; c <= number_of_chunks ; c++ )
+		{ chunk_starts[c] = (int) ( ( (long) c * n ) / number_of_chunks ); }
+		return; 
+	}
+	
+	double total = 0.0; 
+	for( int i=0; i < n ; i++ )
+	{ total += costs[i]; }
+	double target = total / (double) number_of_chunks; 
+	
+	int c = 1; 
+	double running_total = 0.0; 
+	for( int i=0; i < n && c < number_of_chunks ; i++ )
+	{
+		running_total += costs[i]; 
+		if( running_total >= c * target )
+		{
+			chunk_starts[c] = i+1; 
+			c++; 
+		}
+	}
+	// any chunks left over are empty 
+	for( ; c <= number_of_chunks ; c++ )
+	{ chunk_starts[c] = n; }
+	return; 
+}
+
+void Balanced_Loop::run( int n , std::vector<double>& costs , std::function<void(int)> body )
+{
+	int threads = omp_get_max_threads(); 
+	bool balanced = load_balancing_options.enable; 
+	if( balanced )
+	{ partition( n , costs , threads * load_balancing_options.chunks_per_thread ); }
+	else
+	{
+		std::vector<double> uniform; 
+		partition( n , uniform , threads ); 
+	}
+	int number_of_chunks = chunk_starts.size() - 1; 
+	
+	bool timing = load_balancing_options.record_idle_time; 
+	if( timing )
+	{ finish_times.assign( threads , 0.0 ); }
+	int team_size = 1; 
+	double start_time = omp_get_wtime(); 
+	
+	#pragma omp parallel 
+	{
+		// ends with this thread's share, before the barrier 
+		BIOFVM_TRACE_SCOPE( statistics.name ); 
+		if( balanced )
+		{
+			// each thread owns a contiguous run of chunks (so it keeps working on 
+			// the same cells, and their memory, from step to step). It works 
+			// through its own run first, then takes chunks from the others. 
+			#pragma omp single 
+			{
+				team_size = omp_get_num_threads(); 
+				next_chunk.assign( team_size * chunk_counter_stride , 0 ); 
+				for( int owner=0; owner < team_size ; owner++ )
+				{ next_chunk[ owner*chunk_counter_stride ] = owner_first_chunk( owner , team_size , number_of_chunks ); }
+			}
+			
+			int me = omp_get_thread_num(); 
+			for( int k=0; k < team_size ; k++ )
+			{
+				int owner = ( me + k ) % team_size; 
+				int last = owner_first_chunk( owner+1 , team_size , number_of_chunks ); 
+				while( true )
+				{
+					int c; 
+					#pragma omp atomic capture 
+					c = next_chunk[ owner*chunk_counter_stride ]++; 
+					if( c >= last )
+					{ break; }
+					for( int i=chunk_starts[c]; i < chunk_starts[c+1] ; i++ )
+					{ body(i); }
+				}
+			}
+		}
+		else
+		{
+			#pragma omp for schedule(static,1) nowait 
+			for( int c=0; c < number_of_chunks ; c++ )
+			{
+				for( int i=chunk_starts[c]; i < chunk_starts[c+1] ; i++ )
+				{ body(i); }
+			}
+		}
+		
+		if( timing )
+		{
+			finish_times[ omp_get_thread_num() ] = omp_get_wtime(); 
+			#pragma omp master 
+			{ team_size = omp_get_num_threads(); }
+		}
+	}
+	
+	if( timing )
+	{ statistics.record( start_time , omp_get_wtime() , finish_times , team_size ); }
+	return; 
+}
+
+void Balanced_Loop::run( int n , std::function<void(int)> body )
+{
+	std::vector<double> uniform; 
+	run( n , uniform , body ); 
+	return; 
+}
+
+};
@@ -0,0 +1,136 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __PhysiCell_load_balancing_h__
+#define __PhysiCell_load_balancing_h__
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <functional>
+
+namespace PhysiCell{
+
+class Load_Balancing_Options
+{
+ private:
+ public:
+	// true: per-cell loops are split into chunks of about equal estimated 
+	// cost. Each thread owns a contiguous run of chunks and steals from the 
+	// other threads when its own run is done. 
+	// false: each thread gets one contiguous block, like schedule(static). 
+	bool enable; 
+	int chunks_per_thread; 
+	
+	// record how long each thread waits for the slowest one 
+	bool record_idle_time; 
+	
+	Load_Balancing_Options(); 
+};
+
+extern Load_Balancing_Options load_balancing_options; 
+
+class Parallel_Loop_Statistics
+{
+ private:
+ public:
+	std::string name; 
+	int calls; 
+	double wall_time; // seconds 
+	double busy_time; // seconds, summed over the threads 
+	double idle_time; // seconds, summed over the threads: waiting for the slowest thread 
+	double worst_imbalance; // largest (slowest thread / mean thread) over the calls 
+	
+	Parallel_Loop_Statistics(); 
+	void record( double start_time, double end_time, std::vector<double>& finish_times, int number_of_threads ); 
+	void reset( void ); 
+	void display( std::ostream& os ); 
+};
+
+class Balanced_Loop
+{
+ private:
+	std::vector<int> chunk_starts; 
+	std::vector<double> finish_times; 
+	std::vector<int> next_chunk; // per owning thread 
+	
+	void partition( int n , std::vector<double>& costs , int number_of_chunks ); 
+	
+ public:
+	Parallel_Loop_Statistics statistics; 
+	
+	Balanced_Loop( std::string name ); 
+	
+	// runs body(i) for i in [0,n). costs[i] estimates the work for i; 
+	// leave costs empty for uniform work. 
+	void run( int n , std::vector<double>& costs , std::function<void(int)> body ); 
+	void run( int n , std::function<void(int)> body ); 
+};
+
+};
+
+#endif
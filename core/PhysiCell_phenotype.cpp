@@ -150,6 +150,14 @@ double& Cycle_Data::exit_rate(int phase_index )
 {
 	return transition_rates[phase_index][0]; 
 }
+
+long long Cycle_Data::memory_footprint( void )
+{
+	long long out = heap_bytes( inverse_index_maps ) + heap_bytes( time_units ) + heap_bytes( transition_rates ); 
+	for( int i=0; i < inverse_index_maps.size() ; i++ )
+	{ out += heap_bytes( inverse_index_maps[i] ); }
+	return out; 
+}
 	
 Cycle_Model::Cycle_Model()
 {
@@ -264,6 +272,17 @@ std::ostream& Cycle_Model::display( std::ostream& os )
 	
 	return os; 
 }
+
+long long Cycle_Model::memory_footprint( void )
+{
+	long long out = heap_bytes( inverse_index_maps ) + heap_bytes( name ) + heap_bytes( phases ) 
+		+ heap_bytes( phase_links ) + data.memory_footprint(); 
+	for( int i=0; i < inverse_index_maps.size() ; i++ )
+	{ out += heap_bytes( inverse_index_maps[i] ); }
+	for( int i=0; i < phases.size() ; i++ )
+	{ out += heap_bytes( phases[i].name ); }
+	return out; 
+}
 	
 double& Cycle_Model::transition_rate( int start_index , int end_index )
 {
@@ -1042,6 +1061,20 @@ Phenotype::Phenotype()
 	return; 
 }
 
+long long Phenotype::memory_footprint( void )
+{
+	long long out = cycle.data.memory_footprint(); 
+	out += heap_bytes( death.rates ) + heap_bytes( death.models ) + heap_bytes( death.parameters ); 
+	for( int i=0; i < death.parameters.size() ; i++ )
+	{ out += heap_bytes( death.parameters[i].time_units ); }
+	out += heap_bytes( motility.migration_bias_direction ) + heap_bytes( motility.motility_vector ); 
+	out += heap_bytes( secretion.secretion_rates ) + heap_bytes( secretion.uptake_rates ) 
+		+ heap_bytes( secretion.saturation_densities ); 
+	out += heap_bytes( molecular.internalized_total_substrates ) + heap_bytes( molecular.fraction_released_at_death ) 
+		+ heap_bytes( molecular.fraction_transferred_when_ingested ); 
+	return out; 
+}
+
 /*
 class Bools
 {
@@ -167,6 +167,8 @@ class Cycle_Data
 	double& exit_rate(int phase_index ); // This returns the first transition rate out of 
 		// phase # phase_index. It is only relevant if the phase has only one phase link 
 		// (true for many cycle models). 
+	
+	long long memory_footprint( void ); // the memory it holds, not counting the object 
 };
 
 class Cycle_Model
@@ -209,6 +211,8 @@ class Cycle_Model
 	Phase_Link& phase_link(int start_index,int end_index ); // done 
 	
 	std::ostream& display( std::ostream& os ); // done 
+	
+	long long memory_footprint( void ); // the memory it holds, not counting the object 
 };
 
 class Cycle
@@ -562,6 +566,8 @@ class Phenotype
 	
 	// make sure cycle, death, etc. are synced to the defaults. 
 	void sync_to_default_functions( void ); // done 
+	
+	long long memory_footprint( void ); // the memory it holds, not counting the object 
 };
 
 };
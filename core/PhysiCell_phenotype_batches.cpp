@@ -0,0 +1,216 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "./PhysiCell_phenotype_batches.h"
+#include "./PhysiCell_standard_models.h"
+#include "../BioFVM/BioFVM_trace.h"
+
+namespace PhysiCell{
+
+class Batch_Function_Pair
+{
+ public:
+	Per_Cell_Function per_cell_function; 
+	Batch_Cell_Function batch_function; 
+}; 
+
+static std::vector<Batch_Function_Pair> batch_functions = 
+{
+	{ standard_volume_update_function , standard_volume_update_function_batch } , 
+	{ update_cell_and_death_parameters_O2_based , update_cell_and_death_parameters_O2_based_batch } , 
+	{ wjy_update , wjy_update_batch } 
+}; 
+
+void register_batch_function( Per_Cell_Function per_cell_function , Batch_Cell_Function batch_function )
+{
+	for( int i=0; i < batch_functions.size() ; i++ )
+	{
+		if( batch_functions[i].per_cell_function == per_cell_function )
+		{
+			batch_functions[i].batch_function = batch_function; 
+			return; 
+		}
+	}
+	Batch_Function_Pair pair; 
+	pair.per_cell_function = per_cell_function; 
+	pair.batch_function = batch_function; 
+	batch_functions.push_back( pair ); 
+	return; 
+}
+
+Batch_Cell_Function find_batch_function( Per_Cell_Function per_cell_function )
+{
+	for( int i=0; i < batch_functions.size() ; i++ )
+	{
+		if( batch_functions[i].per_cell_function == per_cell_function )
+		{ return batch_functions[i].batch_function; }
+	}
+	return NULL; 
+}
+
+class Phenotype_Batch
+{
+ public:
+	int type; 
+	std::string type_name; 
+	Cell_Definition* pCD; // looked up once, when the batch is made 
+	Per_Cell_Function update_phenotype; 
+	Per_Cell_Function volume_update_function; 
+	double dt; 
+	std::vector<Cell*> cells; 
+}; 
+
+// one stage: through the batch form if there is one, or else cell by cell 
+static void run_batch_stage( Phenotype_Batch& batch , Per_Cell_Function function )
+{
+	if( function == NULL )
+	{ return; }
+	Batch_Cell_Function batch_function = find_batch_function( function ); 
+	if( batch_function )
+	{
+		batch_function( batch.cells , batch.pCD , batch.dt ); 
+		return; 
+	}
+	std::vector<Cell*>& cells = batch.cells; 
+	double dt = batch.dt; 
+	#pragma omp parallel for 
+	for( int i=0; i < cells.size() ; i++ )
+	{ function( cells[i] , cells[i]->phenotype , dt ); }
+	return; 
+}
+
+void advance_phenotypes_in_batches( std::vector<Cell*>& cells , std::function<double(Cell*)> phenotype_step )
+{
+	// group the cells, keeping their order within each group 
+	std::vector<Phenotype_Batch> batches; 
+	int last = -1; 
+	for( int i=0; i < cells.size() ; i++ )
+	{
+		Cell* pCell = cells[i]; 
+		double dt = phenotype_step( pCell ); 
+		if( pCell->is_out_of_domain == true || dt <= 0.0 )
+		{ continue; }
+		
+		// consecutive cells are often in the same group 
+		if( last < 0 || batches[last].type != pCell->type || batches[last].type_name != pCell->type_name || batches[last].dt != dt || 
+			batches[last].update_phenotype != pCell->functions.update_phenotype || 
+			batches[last].volume_update_function != pCell->functions.volume_update_function )
+		{
+			last = -1; 
+			for( int b=0; b < batches.size() ; b++ )
+			{
+				if( batches[b].type == pCell->type && batches[b].type_name == pCell->type_name && batches[b].dt == dt && 
+					batches[b].update_phenotype == pCell->functions.update_phenotype && 
+					batches[b].volume_update_function == pCell->functions.volume_update_function )
+				{ last = b; break; }
+			}
+			if( last < 0 )
+			{
+				Phenotype_Batch batch; 
+				batch.type = pCell->type; 
+				batch.type_name = pCell->type_name; 
+				batch.pCD = find_cell_definition( pCell->type_name ); 
+				batch.update_phenotype = pCell->functions.update_phenotype; 
+				batch.volume_update_function = pCell->functions.volume_update_function; 
+				batch.dt = dt; 
+				batches.push_back( batch ); 
+				last = batches.size() - 1; 
+			}
+		}
+		batches[last].cells.push_back( pCell ); 
+	}
+	
+	for( int b=0; b < batches.size() ; b++ )
+	{
+		Phenotype_Batch& batch = batches[b]; 
+		std::vector<Cell*>& batch_cells = batch.cells; 
+		double dt = batch.dt; 
+		
+		{
+			BIOFVM_TRACE_SCOPE( "phenotype batch: update" ); 
+			run_batch_stage( batch , batch.update_phenotype ); 
+		}
+		{
+			BIOFVM_TRACE_SCOPE( "phenotype batch: volume" ); 
+			run_batch_stage( batch , batch.volume_update_function ); 
+		}
+		
+		BIOFVM_TRACE_SCOPE( "phenotype batch: geometry, death and cycle" ); 
+		bool volume_changed = ( batch.volume_update_function != NULL ); 
+		#pragma omp parallel for 
+		for( int i=0; i < batch_cells.size() ; i++ )
+		{
+			// needed after every volume update (it sets the BioFVM total_volume) 
+			if( volume_changed )
+			{ batch_cells[i]->set_total_volume( batch_cells[i]->phenotype.volume.total ); }
+			batch_cells[i]->advance_geometry_death_and_cycle( dt ); 
+		}
+	}
+	return; 
+}
+
+};
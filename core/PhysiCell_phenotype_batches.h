@@ -0,0 +1,114 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __PhysiCell_phenotype_batches_h__
+#define __PhysiCell_phenotype_batches_h__
+
+#include <vector>
+#include <functional>
+
+#include "./PhysiCell_cell.h"
+
+namespace PhysiCell{
+
+/* 
+ The batched phenotype update (<cell_updates><batched_phenotype>). Rather 
+ than advance_bundled_phenotype_functions cell by cell, the cells are grouped 
+ by type, type_name (so, by cell definition), update_phenotype, 
+ volume_update_function and phenotype step (in the order of their first 
+ cell), and each stage runs as its own loop over each group: 
+	the custom phenotype update, 
+	the volume update, 
+	the geometry update, the death check and the cycle (per cell, as in 
+		Cell::advance_geometry_death_and_cycle). 
+ 
+ A per-cell function with a registered batch form (with the same effect on 
+ each cell) is called once per group through it; the others are called per 
+ cell, in a parallel loop. The standard volume update and the O2-based 
+ parameter update have batch forms. So does wjy_update, whose noise comes 
+ from counter-based draws instead (the same in distribution). 
+ 
+ Each cell goes through the same stages as before. What changes is the order 
+ across cells: every cell of a group finishes one stage before any starts the 
+ next, so functions that read other cells' phenotypes, or draw random 
+ numbers, see a different order. 
+*/
+
+typedef void (*Per_Cell_Function)( Cell* pCell, Phenotype& phenotype, double dt ); 
+// pCD is the cell definition of the batch (NULL if it is not registered) 
+typedef void (*Batch_Cell_Function)( std::vector<Cell*>& cells , Cell_Definition* pCD , double dt ); 
+
+void register_batch_function( Per_Cell_Function per_cell_function , Batch_Cell_Function batch_function ); 
+// NULL if there is none 
+Batch_Cell_Function find_batch_function( Per_Cell_Function per_cell_function ); 
+
+// cells with a step <= 0 (not due) or out of the domain are skipped 
+void advance_phenotypes_in_batches( std::vector<Cell*>& cells , std::function<double(Cell*)> phenotype_step ); 
+
+};
+
+#endif
@@ -0,0 +1,251 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "./PhysiCell_scheduler.h"
+
+#include <cmath>
+
+namespace PhysiCell{
+
+Scheduled_Process::Scheduled_Process()
+{
+	name = "unnamed"; 
+	period = 1; 
+	next_tick = 0; 
+	last_tick = -1; 
+	enabled = true; 
+	return; 
+}
+
+Multirate_Scheduler::Multirate_Scheduler()
+{
+	current_tick = 0; 
+	// 10^-5 min resolves the default time steps (0.01, 0.1, 6 min) exactly 
+	ticks_per_time_unit = 100000; 
+	return; 
+}
+
+long long Multirate_Scheduler::ticks( double duration )
+{
+	return llround( duration * ticks_per_time_unit ); 
+}
+
+double Multirate_Scheduler::time( long long tick )
+{
+	// one rounding, rather than a sum of many 
+	return (double) tick / (double) ticks_per_time_unit; 
+}
+
+long long Multirate_Scheduler::get_current_tick( void )
+{ return current_tick; }
+
+double Multirate_Scheduler::current_time( void )
+{ return time( current_tick ); }
+
+void Multirate_Scheduler::set_time( double t )
+{
+	current_tick = ticks( t ); 
+	return; 
+}
+
+int Multirate_Scheduler::find_process( std::string name )
+{
+	for( int i=0; i < processes.size(); i++ )
+	{
+		if( processes[i].name == name )
+		{ return i; }
+	}
+	return -1; 
+}
+
+int Multirate_Scheduler::add_process( std::string name , double period )
+{
+	int i = find_process( name ); 
+	if( i > -1 )
+	{
+		set_period( i , period ); 
+		return i; 
+	}
+	
+	Scheduled_Process process; 
+	process.name = name; 
+	process.next_tick = current_tick; 
+	processes.push_back( process ); 
+	
+	i = processes.size()-1; 
+	set_period( i , period ); 
+	return i; 
+}
+
+int Multirate_Scheduler::add_hook( std::string name , double period , std::function<void(double)> hook )
+{
+	int i = add_process( name , period ); 
+	processes[i].hook = hook; 
+	return i; 
+}
+
+Scheduled_Process& Multirate_Scheduler::operator[]( int i )
+{ return processes[i]; }
+
+void Multirate_Scheduler::set_period( int i , double period )
+{
+	long long period_in_ticks = ticks( period ); 
+	if( period_in_ticks == processes[i].period )
+	{ return; }
+	
+	if( period_in_ticks < 1 )
+	{
+		std::cout << "Warning: the period of " << processes[i].name << " (" << period 
+			<< ") is shorter than one tick. Using one tick." << std::endl; 
+		period_in_ticks = 1; 
+	}
+	else if( fabs( time( period_in_ticks ) - period ) > 1e-9 * period )
+	{
+		std::cout << "Warning: the period of " << processes[i].name << " (" << period 
+			<< ") is not a whole number of ticks. Using " << time( period_in_ticks ) << "." << std::endl; 
+	}
+	
+	processes[i].period = period_in_ticks; 
+	if( processes[i].last_tick > -1 )
+	{ processes[i].next_tick = processes[i].last_tick + period_in_ticks; }
+	return; 
+}
+
+double Multirate_Scheduler::period( int i )
+{ return time( processes[i].period ); }
+
+double Multirate_Scheduler::next_time( int i )
+{ return time( processes[i].next_tick ); }
+
+bool Multirate_Scheduler::is_due( int i )
+{
+	return processes[i].enabled && current_tick >= processes[i].next_tick; 
+}
+
+double Multirate_Scheduler::time_since_last_run( int i )
+{
+	if( processes[i].last_tick < 0 )
+	{ return period( i ); }
+	return time( current_tick - processes[i].last_tick ); 
+}
+
+void Multirate_Scheduler::mark_run( int i )
+{
+	processes[i].last_tick = current_tick; 
+	// keep the cadence of the schedule (e.g., saves at whole intervals), 
+	// but never schedule a run in the past 
+	processes[i].next_tick += processes[i].period; 
+	if( processes[i].next_tick <= current_tick )
+	{ processes[i].next_tick = current_tick + processes[i].period; }
+	return; 
+}
+
+void Multirate_Scheduler::advance( int i )
+{
+	mark_run( i ); 
+	current_tick = processes[i].next_tick; 
+	return; 
+}
+
+bool Multirate_Scheduler::hooks_are_due( void )
+{
+	for( int i=0; i < processes.size(); i++ )
+	{
+		if( processes[i].hook && is_due( i ) )
+		{ return true; }
+	}
+	return false; 
+}
+
+void Multirate_Scheduler::run_due_hooks( void )
+{
+	for( int i=0; i < processes.size(); i++ )
+	{
+		if( processes[i].hook && is_due( i ) )
+		{
+			processes[i].hook( current_time() ); 
+			mark_run( i ); 
+		}
+	}
+	return; 
+}
+
+void Multirate_Scheduler::display( std::ostream& os )
+{
+	os << "Scheduled processes at t = " << current_time() << " (" << current_tick << " ticks of " 
+		<< time( 1 ) << "):" << std::endl; 
+	for( int i=0; i < processes.size(); i++ )
+	{
+		os << "\t" << processes[i].name << ": every " << period( i ) << ", next at " << next_time( i ); 
+		if( processes[i].enabled == false )
+		{ os << " (disabled)"; }
+		os << std::endl; 
+	}
+	return; 
+}
+
+};
@@ -0,0 +1,151 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __PhysiCell_scheduler_h__
+#define __PhysiCell_scheduler_h__
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <functional>
+
+namespace PhysiCell{
+
+/* 
+ A Multirate_Scheduler keeps simulated time as an integer number of ticks 
+ (ticks_per_time_unit per minute), and each process (diffusion, mechanics, 
+ phenotype, saves, custom hooks) has its own period in ticks. A process is 
+ due when the clock has reached its next tick, so periods never drift, and 
+ a step is never skipped or doubled by round-off. 
+ 
+ Periods can change at any time (set_period): the next run is then one new 
+ period after the last run. A period that is not a whole number of ticks 
+ is rounded to the nearest tick, with a warning. 
+*/
+
+class Scheduled_Process
+{
+ private:
+ public:
+	std::string name; 
+	long long period; // ticks 
+	long long next_tick; 
+	long long last_tick; // -1: never run 
+	bool enabled; 
+	std::function<void(double)> hook; // optional; called with the current time 
+	
+	Scheduled_Process(); 
+}; 
+
+class Multirate_Scheduler
+{
+ private:
+	long long current_tick; 
+	std::vector<Scheduled_Process> processes; 
+	
+ public:
+	long long ticks_per_time_unit; 
+	
+	Multirate_Scheduler(); 
+	
+	long long ticks( double duration ); // nearest whole number of ticks 
+	double time( long long tick ); 
+	
+	long long get_current_tick( void ); 
+	double current_time( void ); 
+	void set_time( double t ); // rounded to the nearest tick 
+	
+	// returns the index of the process. If it exists, its period is updated. 
+	// A new process is due now. 
+	int add_process( std::string name , double period ); 
+	int add_hook( std::string name , double period , std::function<void(double)> hook ); 
+	int find_process( std::string name ); // -1 if not found 
+	Scheduled_Process& operator[]( int i ); 
+	
+	void set_period( int i , double period ); 
+	double period( int i ); 
+	double next_time( int i ); 
+	
+	bool is_due( int i ); 
+	// time since the last run (the period, if it never ran) 
+	double time_since_last_run( int i ); 
+	// records a run now, and schedules the next one a period after the 
+	// last scheduled one (at least one tick from now) 
+	void mark_run( int i ); 
+	
+	// marks process i as run, and moves the clock to its next tick 
+	void advance( int i ); 
+	
+	bool hooks_are_due( void ); 
+	void run_due_hooks( void ); 
+	
+	void display( std::ostream& os ); 
+}; 
+
+};
+
+#endif
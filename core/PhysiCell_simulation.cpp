@@ -0,0 +1,141 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "./PhysiCell_simulation.h"
+#include "./PhysiCell_cell.h"
+#include "./PhysiCell_cell_container.h"
+
+#include <chrono>
+
+namespace PhysiCell{
+
+Simulation::Simulation()
+{
+	name = "unnamed"; 
+	
+	pMicroenvironment = NULL; 
+	pMicroenvironment_options = NULL; 
+	pCell_container = NULL; 
+	pCells = NULL; 
+	pCell_defaults = NULL; 
+	
+	pSettings = NULL; 
+	pGlobals = NULL; 
+	pParameters = NULL; 
+	
+	std::random_device rd; 
+	random_seed = rd(); 
+	random_generator.seed( random_seed ); 
+	
+	return; 
+}
+
+long Simulation::seed_random( long input )
+{
+	random_generator.seed( input ); 
+	random_seed = input; 
+	return input; 
+}
+
+long Simulation::seed_random( void )
+{
+	unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
+	random_generator.seed( seed ); 
+	random_seed = seed; 
+	return seed; 
+}
+
+double Simulation::uniform_random( void )
+{
+	return std::generate_canonical<double, 10>( random_generator ); 
+}
+
+double Simulation::normal_random( double mean, double standard_deviation )
+{
+	std::normal_distribution<double> d( mean , standard_deviation ); 
+	return d( random_generator ); 
+}
+
+static Simulation create_default_simulation( void )
+{
+	Simulation simulation; 
+	simulation.name = "default"; 
+	simulation.pMicroenvironment = &BioFVM::microenvironment; 
+	simulation.pMicroenvironment_options = &BioFVM::default_microenvironment_options; 
+	simulation.pCells = (std::vector<Cell*>*) &BioFVM::all_basic_agents; 
+	simulation.pCell_defaults = &cell_defaults; 
+	return simulation; 
+}
+
+Simulation& get_default_simulation( void )
+{
+	// built on first use (thread-safe), so it can be called during static initialization 
+	static Simulation default_simulation = create_default_simulation(); 
+	return default_simulation; 
+}
+
+};
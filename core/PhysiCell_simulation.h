@@ -0,0 +1,146 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __PhysiCell_simulation_h__
+#define __PhysiCell_simulation_h__
+
+#include <random>
+#include <vector>
+#include <string>
+
+#include "../BioFVM/BioFVM.h"
+#include "./PhysiCell_scheduler.h"
+
+namespace PhysiCell{
+
+class Cell; 
+class Cell_Container; 
+class Cell_Definition; 
+
+// defined in modules/PhysiCell_settings.h 
+class PhysiCell_Settings; 
+class PhysiCell_Globals; 
+class User_Parameters; 
+
+/* 
+ A Simulation is the context that the update paths run in: the 
+ microenvironment, the cell container and cells, the default cell 
+ definition, the settings, the random number generator, and the clock 
+ (the multi-rate scheduler of its processes). 
+ 
+ A Simulation owns only its random number generator and its scheduler. 
+ The microenvironment and its options, the cell container and cells, the 
+ cell definitions, the settings, the globals and the user parameters are 
+ not owned: the pointers refer to the process-wide globals 
+ (microenvironment, all_cells, cell_defaults, PhysiCell_settings, ...), 
+ which is all that get_default_simulation binds. Moving that state into 
+ the Simulation is deferred, because cell construction and deletion, the 
+ cell definition registry and the cell and phenotype functions still use 
+ the globals directly. Until then there is one simulation per process 
+ (ensembles fork a process per run; see PhysiCell_ensemble.h). 
+ 
+ The existing global API keeps working as a thin shim over the default 
+ simulation. New code should take a Simulation& rather than reach for the 
+ globals, so that the state can move in later without API changes. 
+*/
+
+class Simulation
+{
+ private:
+ public:
+	std::string name; 
+	
+	// not owned; the default simulation points these to the globals 
+	BioFVM::Microenvironment* pMicroenvironment; 
+	BioFVM::Microenvironment_Options* pMicroenvironment_options; 
+	Cell_Container* pCell_container; 
+	std::vector<Cell*>* pCells; 
+	Cell_Definition* pCell_defaults; 
+	
+	PhysiCell_Settings* pSettings; 
+	PhysiCell_Globals* pGlobals; 
+	User_Parameters* pParameters; 
+	
+	// owned by the simulation 
+	std::mt19937 random_generator; 
+	unsigned long long random_seed; // the last seed, which also keys the counter-based streams 
+	
+	long seed_random( long input ); 
+	long seed_random( void ); // from the clock 
+	double uniform_random( void ); 
+	double normal_random( double mean, double standard_deviation ); 
+	
+	Multirate_Scheduler scheduler; 
+	
+	Simulation(); // refers to nothing; set the pointers before use 
+}; 
+
+Simulation& get_default_simulation( void ); 
+
+};
+
+#endif
@@ -571,6 +571,14 @@ void standard_volume_update_function( Cell* pCell, Phenotype& phenotype, double
 	return; 
 }
 
+void standard_update_cell_velocity( Cell* pCell, Phenotype& phenotype, double dt)
+{
+	if( default_microenvironment_options.simulate_2D == true )
+	{ return standard_update_cell_velocity<2>( pCell, phenotype, dt ); }
+	return standard_update_cell_velocity<3>( pCell, phenotype, dt ); 
+}
+
+template <int dimension> 
 void standard_update_cell_velocity( Cell* pCell, Phenotype& phenotype, double dt)
 {
 	if( pCell->functions.add_cell_basement_membrane_interactions )
@@ -585,23 +593,22 @@ void standard_update_cell_velocity( Cell* pCell, Phenotype& phenotype, double dt
 	std::vector<Cell*>::iterator end = pCell->get_container()->agent_grid[pCell->get_current_mechanics_voxel_index()].end();
 	for(neighbor = pCell->get_container()->agent_grid[pCell->get_current_mechanics_voxel_index()].begin(); neighbor != end; ++neighbor)
 	{
-		pCell->add_potentials(*neighbor);
+		pCell->add_potentials<dimension>(*neighbor);
 	}
-	std::vector<int>::iterator neighbor_voxel_index;
-	std::vector<int>::iterator neighbor_voxel_index_end = 
-		pCell->get_container()->underlying_mesh.moore_connected_voxel_indices[pCell->get_current_mechanics_voxel_index()].end();
-
-	for( neighbor_voxel_index = 
-		pCell->get_container()->underlying_mesh.moore_connected_voxel_indices[pCell->get_current_mechanics_voxel_index()].begin();
-		neighbor_voxel_index != neighbor_voxel_index_end; 
-		++neighbor_voxel_index )
+	Cartesian_Mesh& mesh = pCell->get_container()->underlying_mesh; 
+	int neighbor_voxels[ dimension == 2 ? 8 : 26 ]; 
+	int number_of_neighbor_voxels = mesh.moore_neighborhood<dimension>( pCell->get_current_mechanics_voxel_index() , neighbor_voxels ); 
+	std::vector<double> my_voxel_center = mesh.voxel_center( pCell->get_current_mechanics_voxel_index() ); 
+
+	for( int n=0; n < number_of_neighbor_voxels ; n++ )
 	{
-		if(!is_neighbor_voxel(pCell, pCell->get_container()->underlying_mesh.voxels[pCell->get_current_mechanics_voxel_index()].center, pCell->get_container()->underlying_mesh.voxels[*neighbor_voxel_index].center, *neighbor_voxel_index))
+		int neighbor_voxel_index = neighbor_voxels[n]; 
+		if(!is_neighbor_voxel<dimension>(pCell, my_voxel_center, mesh.voxel_center( neighbor_voxel_index ), neighbor_voxel_index))
 			continue;
-		end = pCell->get_container()->agent_grid[*neighbor_voxel_index].end();
-		for(neighbor = pCell->get_container()->agent_grid[*neighbor_voxel_index].begin();neighbor != end; ++neighbor)
+		end = pCell->get_container()->agent_grid[neighbor_voxel_index].end();
+		for(neighbor = pCell->get_container()->agent_grid[neighbor_voxel_index].begin();neighbor != end; ++neighbor)
 		{
-			pCell->add_potentials(*neighbor);
+			pCell->add_potentials<dimension>(*neighbor);
 		}
 	}
 
@@ -611,6 +618,9 @@ void standard_update_cell_velocity( Cell* pCell, Phenotype& phenotype, double dt
 	return; 
 }
 
+template void standard_update_cell_velocity<2>( Cell* pCell, Phenotype& phenotype, double dt); 
+template void standard_update_cell_velocity<3>( Cell* pCell, Phenotype& phenotype, double dt); 
+
 void standard_add_basement_membrane_interactions( Cell* pCell, Phenotype phenotype, double dt )
 {
 	if( pCell->functions.calculate_distance_to_membrane == NULL )
@@ -657,6 +667,8 @@ void initialize_default_cell_definition( void )
 {
 	// If the standard models have not yet been created, do so now. 
 	create_standard_cycle_and_death_models();
+	
+	register_cell_definition( cell_defaults ); 
 		
 	// set the microenvironment pointer 
 	cell_defaults.pMicroenvironment = NULL;
@@ -767,17 +779,12 @@ void wjy_update(Cell* pcell, Phenotype& phenotype, double dt) {
 	phenotype.death.rates[apoptosis_model_index] = apoptosis_rate;
 }
 
-void update_cell_and_death_parameters_O2_based( Cell* pCell, Phenotype& phenotype, double dt )
+// the phase indices and death model that update_cell_and_death_parameters_O2_based 
+// changes, set up from the first cell that calls it (assuming Ki67 basic or advanced model, 
+// or one of the others below). false if that cycle model is not supported. 
+static bool O2_based_indices( Cell* pCell, Phenotype& phenotype, int& start_phase_index_out , 
+	int& end_phase_index_out , int& necrosis_index_out , int& oxygen_substrate_index_out )
 {
-	// supported cycle models:
-		// advanced_Ki67_cycle_model= 0;
-		// basic_Ki67_cycle_model=1
-		// live_cells_cycle_model = 5; 
-	
-	if( phenotype.death.dead == true )
-	{ return; }
-	
-	// set up shortcuts to find the Q and K(1) phases (assuming Ki67 basic or advanced model)
 	static bool indices_initiated = false; 
 	static int start_phase_index; // Q_phase_index; 
 	static int end_phase_index; // K_phase_index;
@@ -840,8 +847,31 @@ void update_cell_and_death_parameters_O2_based( Cell* pCell, Phenotype& phenotyp
 		
 	}
 	
+	start_phase_index_out = start_phase_index; 
+	end_phase_index_out = end_phase_index; 
+	necrosis_index_out = necrosis_index; 
+	oxygen_substrate_index_out = oxygen_substrate_index; 
+	return indices_initiated; 
+}
+
+void update_cell_and_death_parameters_O2_based( Cell* pCell, Phenotype& phenotype, double dt )
+{
+	// supported cycle models:
+		// advanced_Ki67_cycle_model= 0;
+		// basic_Ki67_cycle_model=1
+		// live_cells_cycle_model = 5; 
+	
+	if( phenotype.death.dead == true )
+	{ return; }
+	
+	// set up shortcuts to find the Q and K(1) phases (assuming Ki67 basic or advanced model)
+	int start_phase_index; // Q_phase_index; 
+	int end_phase_index; // K_phase_index;
+	int necrosis_index; 
+	int oxygen_substrate_index; 
+	
 	// don't continue if we never "figured out" the current cycle model. 
-	if( indices_initiated == false )
+	if( O2_based_indices( pCell, phenotype, start_phase_index, end_phase_index, necrosis_index, oxygen_substrate_index ) == false )
 	{
 		return; 
 	}
@@ -887,4 +917,254 @@ void update_cell_and_death_parameters_O2_based( Cell* pCell, Phenotype& phenotyp
 	return; 
 }
 
+/* batch forms (see PhysiCell_phenotype_batches.h) */ 
+
+void standard_volume_update_function_batch( std::vector<Cell*>& cells , Cell_Definition* pCD , double dt )
+{
+	// the volumes as structures of arrays, so that the update vectorizes 
+	int n = cells.size(); 
+	std::vector<double> total( n ), fluid( n ), nuclear( n ), nuclear_solid( n ), cytoplasmic_solid( n ); 
+	std::vector<double> fluid_change_rate( n ), target_fluid_fraction( n ), nuclear_biomass_change_rate( n ); 
+	std::vector<double> target_solid_nuclear( n ), target_cytoplasmic_to_nuclear_ratio( n ); 
+	std::vector<double> cytoplasmic_biomass_change_rate( n ), calcification_rate( n ), calcified_fraction( n ); 
+	
+	#pragma omp parallel for 
+	for( int i=0; i < n ; i++ )
+	{
+		Volume& volume = cells[i]->phenotype.volume; 
+		total[i] = volume.total; 
+		fluid[i] = volume.fluid; 
+		nuclear[i] = volume.nuclear; 
+		nuclear_solid[i] = volume.nuclear_solid; 
+		cytoplasmic_solid[i] = volume.cytoplasmic_solid; 
+		fluid_change_rate[i] = volume.fluid_change_rate; 
+		target_fluid_fraction[i] = volume.target_fluid_fraction; 
+		nuclear_biomass_change_rate[i] = volume.nuclear_biomass_change_rate; 
+		target_solid_nuclear[i] = volume.target_solid_nuclear; 
+		target_cytoplasmic_to_nuclear_ratio[i] = volume.target_cytoplasmic_to_nuclear_ratio; 
+		cytoplasmic_biomass_change_rate[i] = volume.cytoplasmic_biomass_change_rate; 
+		calcification_rate[i] = volume.calcification_rate; 
+		calcified_fraction[i] = volume.calcified_fraction; 
+	}
+	
+	// the same arithmetic as standard_volume_update_function, with the clamps as selects 
+	std::vector<double> nuclear_fluid( n ), target_solid_cytoplasmic( n ); 
+	#pragma omp parallel for simd 
+	for( int i=0; i < n ; i++ )
+	{
+		double f = fluid[i] + dt * fluid_change_rate[i] * ( target_fluid_fraction[i] * total[i] - fluid[i] ); 
+		f = f < 0.0 ? 0.0 : f; 
+		double nf = ( nuclear[i] / total[i] ) * ( f ); 
+		double ns = nuclear_solid[i] + dt * nuclear_biomass_change_rate[i] * ( target_solid_nuclear[i] - nuclear_solid[i] ); 
+		ns = ns < 0.0 ? 0.0 : ns; 
+		double tsc = target_cytoplasmic_to_nuclear_ratio[i] * target_solid_nuclear[i]; 
+		double cs = cytoplasmic_solid[i] + dt * cytoplasmic_biomass_change_rate[i] * ( tsc - cytoplasmic_solid[i] ); 
+		cs = cs < 0.0 ? 0.0 : cs; 
+		
+		fluid[i] = f; 
+		nuclear_fluid[i] = nf; 
+		nuclear_solid[i] = ns; 
+		target_solid_cytoplasmic[i] = tsc; 
+		cytoplasmic_solid[i] = cs; 
+		calcified_fraction[i] = dt * calcification_rate[i] * ( 1- calcified_fraction[i] ); 
+	}
+	
+	#pragma omp parallel for 
+	for( int i=0; i < n ; i++ )
+	{
+		Phenotype& phenotype = cells[i]->phenotype; 
+		Volume& volume = phenotype.volume; 
+		volume.fluid = fluid[i]; 
+		volume.nuclear_fluid = nuclear_fluid[i]; 
+		volume.cytoplasmic_fluid = volume.fluid - volume.nuclear_fluid; 
+		volume.nuclear_solid = nuclear_solid[i]; 
+		volume.target_solid_cytoplasmic = target_solid_cytoplasmic[i]; 
+		volume.cytoplasmic_solid = cytoplasmic_solid[i]; 
+		volume.solid = volume.nuclear_solid + volume.cytoplasmic_solid; 
+		volume.nuclear = volume.nuclear_solid + volume.nuclear_fluid; 
+		volume.cytoplasmic = volume.cytoplasmic_solid + volume.cytoplasmic_fluid; 
+		volume.calcified_fraction = calcified_fraction[i]; 
+		volume.total = volume.cytoplasmic + volume.nuclear; 
+		volume.fluid_fraction = volume.fluid / ( 1e-16 + volume.total ); 
+		
+		phenotype.geometry.update( cells[i] , phenotype , dt ); 
+	}
+	return; 
+}
+
+void update_cell_and_death_parameters_O2_based_batch( std::vector<Cell*>& cells , Cell_Definition* pCD , double dt )
+{
+	int n = cells.size(); 
+	if( n == 0 )
+	{ return; }
+	int start_phase_index; 
+	int end_phase_index; 
+	int necrosis_index; 
+	int oxygen_substrate_index; 
+	
+	// the same set-up as in the per-cell function, from the first live cell 
+	int first_live = 0; 
+	while( first_live < n && cells[first_live]->phenotype.death.dead == true )
+	{ first_live++; }
+	if( first_live == n || O2_based_indices( cells[first_live] , cells[first_live]->phenotype , 
+		start_phase_index, end_phase_index, necrosis_index, oxygen_substrate_index ) == false )
+	{ return; }
+	
+	std::vector<double> pO2( n ), proliferation_threshold( n ), proliferation_saturation( n ), reference_rate( n ); 
+	std::vector<double> necrosis_threshold( n ), necrosis_max( n ), max_necrosis_rate( n ); 
+	
+	#pragma omp parallel for 
+	for( int i=0; i < n ; i++ )
+	{
+		Cell* pCell = cells[i]; 
+		pO2[i] = (pCell->nearest_density_vector())[oxygen_substrate_index]; 
+		proliferation_threshold[i] = pCell->parameters.o2_proliferation_threshold; 
+		proliferation_saturation[i] = pCell->parameters.o2_proliferation_saturation; 
+		reference_rate[i] = pCell->parameters.pReference_live_phenotype->cycle.data.transition_rate(start_phase_index,end_phase_index); 
+		necrosis_threshold[i] = pCell->parameters.o2_necrosis_threshold; 
+		necrosis_max[i] = pCell->parameters.o2_necrosis_max; 
+		max_necrosis_rate[i] = pCell->parameters.max_necrosis_rate; 
+	}
+	
+	// the linear interpolations of the per-cell function, with the cases as selects 
+	std::vector<double> transition_rate( n ), necrosis_rate( n ); 
+	#pragma omp parallel for simd 
+	for( int i=0; i < n ; i++ )
+	{
+		double multiplier = ( pO2[i] - proliferation_threshold[i] ) 
+			/ ( proliferation_saturation[i] - proliferation_threshold[i] ); 
+		multiplier = pO2[i] < proliferation_saturation[i] ? multiplier : 1.0; 
+		multiplier = pO2[i] < proliferation_threshold[i] ? 0.0 : multiplier; 
+		transition_rate[i] = multiplier * reference_rate[i]; 
+		
+		multiplier = ( necrosis_threshold[i] - pO2[i] ) / ( necrosis_threshold[i] - necrosis_max[i] ); 
+		multiplier = pO2[i] < necrosis_threshold[i] ? multiplier : 0.0; 
+		multiplier = pO2[i] < necrosis_max[i] ? 1.0 : multiplier; 
+		necrosis_rate[i] = multiplier * max_necrosis_rate[i]; 
+	}
+	
+	#pragma omp parallel for 
+	for( int i=0; i < n ; i++ )
+	{
+		Phenotype& phenotype = cells[i]->phenotype; 
+		if( phenotype.death.dead == true )
+		{ continue; }
+		phenotype.cycle.data.transition_rate(start_phase_index,end_phase_index) = transition_rate[i]; 
+		phenotype.death.rates[necrosis_index] = necrosis_rate[i]; 
+	}
+	return; 
+}
+
+// a custom variable by name, or false if the data do not have it (find_variable_index 
+// returns 0 for unknown names) 
+static bool wjy_custom_value( Custom_Cell_Data& data , std::string name , double& value )
+{
+	int index = data.find_variable_index( name ); 
+	if( index >= (int) data.variables.size() || data.variables[index].name != name )
+	{ return false; }
+	value = data[index]; 
+	return true; 
+}
+
+void wjy_update_batch( std::vector<Cell*>& cells , Cell_Definition* pCD , double dt )
+{
+	update_cell_and_death_parameters_O2_based_batch( cells , pCD , dt ); 
+	int n = cells.size(); 
+	if( n == 0 )
+	{ return; }
+	
+	// the parameters are those of the batch's cell definition, read once per batch 
+	// rather than once per cell (or the first cell's, if the definition is not registered) 
+	static const std::vector<std::string> parameter_names = { "wjy_beta" , "wjy_alpha" , "wjy_gamma" , 
+		"wjy_rengp" , "wjy_rengpp" , "wjy_rengpf" , "wjy_gmi" , "wjy_gme" , "wjy_rea" , "wjy_ria" }; 
+	std::vector<double> parameters( parameter_names.size() , 0.0 ); 
+	for( int k=0; k < parameter_names.size() ; k++ )
+	{
+		if( pCD == NULL || wjy_custom_value( pCD->custom_data , parameter_names[k] , parameters[k] ) == false )
+		{ wjy_custom_value( cells[0]->custom_data , parameter_names[k] , parameters[k] ); }
+	}
+	const double beta = parameters[0]; 
+	const double alpha = parameters[1]; 
+	const double gamma = parameters[2]; 
+	const double rengp = parameters[3]; 
+	const double rengpp = parameters[4]; 
+	const double rengpf = parameters[5]; 
+	const double gmi = parameters[6]; 
+	const double gme = parameters[7]; 
+	const double rea = parameters[8]; 
+	const double ria = parameters[9]; 
+	
+	int pi_index = cells[0]->custom_data.find_variable_index( "pi" ); 
+	int pe_index = cells[0]->custom_data.find_variable_index( "pe" ); 
+	int pf_index = cells[0]->custom_data.find_variable_index( "pf" ); 
+	
+	// wjy_update only keeps pi and pe every 6000 diffusion steps, so they only need 
+	// computing then. Its normal draws come from the cell's counter-based stream 
+	// (see PhysiCell_utilities.h), the 7 of a step at counters 8*step, ..., so that 
+	// the loop below vectorizes and does not depend on the order of the cells. 
+	unsigned long long time_cycles = (unsigned long long)(PhysiCell_globals.current_time / diffusion_dt); 
+	if( time_cycles % 6000 == 0 )
+	{
+		std::vector<double> pi( n ), pe( n ), pf( n ); 
+		std::vector<unsigned long long> keys( n ); 
+		
+		#pragma omp parallel for 
+		for( int i=0; i < n ; i++ )
+		{
+			Cell* pCell = cells[i]; 
+			pi[i] = pCell->custom_data[pi_index]; 
+			pe[i] = pCell->custom_data[pe_index]; 
+			pf[i] = pCell->custom_data[pf_index]; 
+			keys[i] = counter_based_key( pCell->ID ); 
+		}
+		
+		// the same arithmetic as wjy_update, with the clamps as selects 
+		const unsigned long long counter = 8 * time_cycles; 
+		#pragma omp parallel for simd 
+		for( int i=0; i < n ; i++ )
+		{
+			double fi = -( beta * rengp - alpha * rengpf * pf[i] ); 
+			double fe = -( gamma * pe[i] * rengpp - alpha * rengpf * pf[i] ); 
+			double p_i = pi[i] + fi * diffusion_dt / gmi * ( 1 + ria * counter_based_normal( keys[i] , counter ) ); 
+			double p_e = pe[i] + fe * diffusion_dt / gme * ( 1 + rea * counter_based_normal( keys[i] , counter+1 ) ); 
+			
+			double clamped = 0.9 * ( 1 - fabs( counter_based_normal( keys[i] , counter+2 ) / 10 ) ); 
+			p_i = p_i > 0.9 ? clamped : p_i; 
+			clamped = 0.9 * ( 1 - fabs( counter_based_normal( keys[i] , counter+3 ) / 10 ) ); 
+			p_e = p_e > 0.9 ? clamped : p_e; 
+			clamped = 0.1 * ( 1 + fabs( counter_based_normal( keys[i] , counter+4 ) / 10 ) ); 
+			p_i = p_i < 0.1 ? clamped : p_i; 
+			clamped = fabs( counter_based_normal( keys[i] , counter+5 ) / 10 ); 
+			p_e = p_e < 0 ? clamped : p_e; 
+			
+			double scale = 0.9 * ( 1 - fabs( counter_based_normal( keys[i] , counter+6 ) / 10 ) ) / ( p_i + p_e ); 
+			scale = p_i + p_e > 0.9 ? scale : 1.0; 
+			pi[i] = p_i * scale; 
+			pe[i] = p_e * scale; 
+		}
+		
+		#pragma omp parallel for 
+		for( int i=0; i < n ; i++ )
+		{
+			Cell* pCell = cells[i]; 
+			pCell->custom_data[pi_index] = pi[i]; 
+			pCell->custom_data[pe_index] = pe[i]; 
+			pCell->custom_data[pf_index] = 1 - pi[i] - pe[i]; 
+		}
+	}
+	
+	// the transition rate from pf, and apoptosis, as in wjy_update 
+	int apoptosis_model_index = cells[0]->phenotype.death.find_death_model_index( "Apoptosis" ); 
+	#pragma omp parallel for 
+	for( int i=0; i < n ; i++ )
+	{
+		Phenotype& phenotype = cells[i]->phenotype; 
+		int neg_index = phenotype.cycle.model().find_phase_index( PhysiCell_constants::Ki67_negative );
+		int ppre_index = phenotype.cycle.model().find_phase_index( PhysiCell_constants::Ki67_positive_premitotic );
+		phenotype.cycle.data.transition_rate(neg_index, ppre_index) *= cells[i]->custom_data[pf_index] * 3; 
+		phenotype.death.rates[apoptosis_model_index] = 1000000; 
+	}
+	return; 
+}
+
 };
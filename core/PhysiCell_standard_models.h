@@ -74,6 +74,8 @@
 namespace PhysiCell
 {
 
+class Cell_Definition; 
+
 // standard cycle models: 
 
 extern Cycle_Model Ki67_advanced, Ki67_basic, live, flow_cytometry_cycle_model, flow_cytometry_separated_cycle_model, cycling_quiescent; 
@@ -104,10 +106,15 @@ bool standard_necrosis_arrest_function( Cell* pCell, Phenotype& phenotype, doubl
 // standard volume functions 
 
 void standard_volume_update_function( Cell* pCell, Phenotype& phenotype, double dt ); // done 
+// the same over a batch of cells (see PhysiCell_phenotype_batches.h) 
+void standard_volume_update_function_batch( std::vector<Cell*>& cells , Cell_Definition* pCD , double dt ); 
 
 // standard mechanics functions 
 
 void standard_update_cell_velocity( Cell* pCell, Phenotype& phenotype, double dt); // done 
+// the same with the stencil and vector math fixed at compile time: dimension 2 (8 Moore 
+// neighbors, x and y only) or 3; the untemplated form picks one from use_2D 
+template <int dimension> void standard_update_cell_velocity( Cell* pCell, Phenotype& phenotype, double dt); 
 void standard_add_basement_membrane_interactions( Cell* pCell, Phenotype phenotype, double dt );
 
 // other standard functions 
@@ -117,10 +124,14 @@ void up_orientation( Cell* pCell, Phenotype& phenotype, double dt ); // done
 
 // Wjy defined update func.
 void wjy_update( Cell* pCell, Phenotype& phenotype, double dt ); 
+// the same over a batch of cells, with counter-based normal draws: statistically, 
+// not bitwise, the same as wjy_update 
+void wjy_update_batch( std::vector<Cell*>& cells , Cell_Definition* pCD , double dt ); 
 
 // standard o2-based phenotype changes 
 
 void update_cell_and_death_parameters_O2_based( Cell* pCell, Phenotype& phenotype, double dt ); 
+void update_cell_and_death_parameters_O2_based_batch( std::vector<Cell*>& cells , Cell_Definition* pCD , double dt ); 
 
 // create standard models 
 
@@ -0,0 +1,449 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "./PhysiCell_task_graph.h"
+#include "./PhysiCell_hardware_counters.h"
+#include "../BioFVM/BioFVM_trace.h"
+
+#include <algorithm>
+#include <omp.h>
+
+namespace PhysiCell{
+
+Task_Timing task_timing; 
+
+Task_Timing::Task_Timing()
+{
+	enabled = false; 
+	record_counters = false; 
+	return; 
+}
+
+// called with the lock held 
+int Task_Timing::index( std::string name )
+{
+	int n = std::find( names.begin() , names.end() , name ) - names.begin(); 
+	if( n == names.size() )
+	{
+		names.push_back( name ); 
+		seconds.push_back( 0.0 ); 
+		runs.push_back( 0 ); 
+		counts.push_back( std::vector<double>( hardware_counters.names.size() , 0.0 ) ); 
+	}
+	return n; 
+}
+
+void Task_Timing::add( std::string name , double elapsed_seconds )
+{
+	std::lock_guard<std::mutex> lock( mutex ); 
+	int n = index( name ); 
+	seconds[n] += elapsed_seconds; 
+	runs[n]++; 
+	return; 
+}
+
+void Task_Timing::add( std::string name , double elapsed_seconds , std::vector<double>& counter_changes )
+{
+	std::lock_guard<std::mutex> lock( mutex ); 
+	int n = index( name ); 
+	seconds[n] += elapsed_seconds; 
+	runs[n]++; 
+	for( int i=0; i < counter_changes.size() ; i++ )
+	{
+		// -1 stays -1: the counter is not available 
+		if( counter_changes[i] < 0.0 || counts[n][i] < 0.0 )
+		{ counts[n][i] = -1.0; }
+		else
+		{ counts[n][i] += counter_changes[i]; }
+	}
+	return; 
+}
+
+void Task_Timing::display( std::ostream& os )
+{
+	std::lock_guard<std::mutex> lock( mutex ); 
+	os << "task wall times (cumulative): " << std::endl; 
+	for( int n=0; n < names.size() ; n++ )
+	{ os << "\t" << names[n] << ": " << seconds[n] << " s (" << runs[n] << " runs)" << std::endl; }
+	if( record_counters == false )
+	{ return; }
+	
+	// cycles, instructions, L1D and LLC misses, branch misses, stalled cycles (frontend, backend) 
+	os << "task hardware counters (cumulative, all threads): " << std::endl; 
+	for( int n=0; n < names.size() ; n++ )
+	{
+		std::vector<double>& c = counts[n]; 
+		os << "\t" << names[n] << ": " << c[0] << " cycles"; 
+		if( c[1] >= 0.0 )
+		{
+			os << ", " << c[1] << " instructions"; 
+			if( c[0] > 0.0 )
+			{ os << " (IPC " << c[1] / c[0] << ")"; }
+		}
+		// the misses, also per thousand instructions 
+		for( int i=2; i <= 4 ; i++ )
+		{
+			if( c[i] < 0.0 )
+			{ continue; }
+			os << ", " << c[i] << " " << hardware_counters.names[i]; 
+			if( c[1] > 0.0 )
+			{ os << " (" << 1000.0 * c[i] / c[1] << " MPKI)"; }
+		}
+		// the stalls, as a share of the cycles 
+		for( int i=5; i <= 6 ; i++ )
+		{
+			if( c[i] < 0.0 || c[0] <= 0.0 )
+			{ continue; }
+			os << ", " << hardware_counters.names[i] << " " << 100.0 * c[i] / c[0] << "%"; 
+		}
+		os << std::endl; 
+	}
+	return; 
+}
+
+void Task_Timing::reset( void )
+{
+	std::lock_guard<std::mutex> lock( mutex ); 
+	names.clear(); 
+	seconds.clear(); 
+	runs.clear(); 
+	counts.clear(); 
+	return; 
+}
+
+Task_Graph::Task_Graph()
+{
+	running_tasks = 0; 
+	completed_tasks = 0; 
+	threads_available = 1; 
+	shutting_down = false; 
+	first_exception = nullptr; 
+	
+	deterministic = false; 
+	max_concurrent_tasks = 0; 
+	return; 
+}
+
+Task_Graph::~Task_Graph()
+{
+	{
+		std::lock_guard<std::mutex> lock( mutex ); 
+		shutting_down = true; 
+	}
+	state_changed.notify_all(); 
+	for( int i=0; i < workers.size() ; i++ )
+	{ workers[i].join(); }
+	return; 
+}
+
+void Task_Graph::add_dependency( int before, int after )
+{
+	if( before == after )
+	{ return; }
+	
+	std::vector<int>& successors = tasks[before].successors; 
+	if( std::find( successors.begin(), successors.end(), after ) != successors.end() )
+	{ return; }
+	
+	successors.push_back( after ); 
+	tasks[after].number_of_predecessors++; 
+	return; 
+}
+
+int Task_Graph::add_task( std::string name, std::function<void(void)> work, 
+	std::vector<std::string> reads , std::vector<std::string> writes )
+{
+	int n = tasks.size(); 
+	
+	Task task; 
+	task.name = name; 
+	task.work = work; 
+	task.number_of_predecessors = 0; 
+	task.predecessors_remaining = 0; 
+	tasks.push_back( task ); 
+	
+	// read after write 
+	for( int i=0; i < reads.size() ; i++ )
+	{
+		std::map<std::string,int>::iterator search = last_writer.find( reads[i] ); 
+		if( search != last_writer.end() )
+		{ add_dependency( search->second , n ); }
+		readers_since_last_write[ reads[i] ].push_back( n ); 
+	}
+	
+	// write after write, and write after read 
+	for( int i=0; i < writes.size() ; i++ )
+	{
+		std::map<std::string,int>::iterator search = last_writer.find( writes[i] ); 
+		if( search != last_writer.end() )
+		{ add_dependency( search->second , n ); }
+		
+		std::vector<int>& readers = readers_since_last_write[ writes[i] ]; 
+		for( int j=0; j < readers.size() ; j++ )
+		{ add_dependency( readers[j] , n ); }
+		readers.clear(); 
+		
+		last_writer[ writes[i] ] = n; 
+	}
+	
+	return n; 
+}
+
+void Task_Graph::clear( void )
+{
+	tasks.clear(); 
+	last_writer.clear(); 
+	readers_since_last_write.clear(); 
+	return; 
+}
+
+int Task_Graph::size( void )
+{ return tasks.size(); }
+
+void Task_Graph::display( std::ostream& os )
+{
+	os << "Task graph (" << tasks.size() << " tasks, " 
+	   << ( deterministic ? "deterministic" : "concurrent" ) << "): " << std::endl; 
+	for( int n=0; n < tasks.size() ; n++ )
+	{
+		os << "\t" << n << ": " << tasks[n].name; 
+		if( tasks[n].successors.size() > 0 )
+		{
+			os << " -> "; 
+			for( int i=0; i < tasks[n].successors.size() ; i++ )
+			{
+				if( i > 0 )
+				{ os << ", "; }
+				os << tasks[tasks[n].successors[i]].name; 
+			}
+		}
+		os << std::endl; 
+	}
+	return; 
+}
+
+void Task_Graph::start_workers( int number_of_workers )
+{
+	while( workers.size() < number_of_workers )
+	{ workers.push_back( std::thread( &Task_Graph::worker_loop , this ) ); }
+	return; 
+}
+
+void Task_Graph::worker_loop( void )
+{
+	std::unique_lock<std::mutex> lock( mutex ); 
+	while( true )
+	{
+		state_changed.wait( lock , [this]{ return shutting_down || ready_tasks.size() > 0; } ); 
+		if( shutting_down )
+		{ return; }
+		run_next_ready_task( lock ); 
+	}
+	return; 
+}
+
+void Task_Graph::run_task( int n )
+{
+	BIOFVM_TRACE_SCOPE( tasks[n].name ); 
+	if( task_timing.enabled == false )
+	{
+		tasks[n].work(); 
+		return; 
+	}
+	if( task_timing.record_counters == false )
+	{
+		double start = omp_get_wtime(); 
+		tasks[n].work(); 
+		task_timing.add( tasks[n].name , omp_get_wtime() - start ); 
+		return; 
+	}
+	// the threads that will run the task's parallel loops (a worker's OpenMP 
+	// team is its own) need their counters too 
+	#pragma omp parallel 
+	{ hardware_counters.open_for_this_thread(); }
+	
+	std::vector<double> before; 
+	std::vector<double> after; 
+	hardware_counters.read( before ); 
+	double start = omp_get_wtime(); 
+	tasks[n].work(); 
+	double elapsed = omp_get_wtime() - start; 
+	hardware_counters.read( after ); 
+	for( int i=0; i < after.size() ; i++ )
+	{
+		if( after[i] >= 0.0 )
+		{ after[i] -= before[i]; }
+	}
+	task_timing.add( tasks[n].name , elapsed , after ); 
+	return; 
+}
+
+// called with the lock held; returns with the lock held 
+void Task_Graph::run_next_ready_task( std::unique_lock<std::mutex>& lock )
+{
+	// ready_tasks is kept sorted, so the task added first starts first 
+	int n = ready_tasks.front(); 
+	ready_tasks.erase( ready_tasks.begin() ); 
+	running_tasks++; 
+	
+	// split the OpenMP threads between the tasks that are running or about to 
+	int sharing = running_tasks + ready_tasks.size(); 
+	if( sharing > workers.size() + 1 )
+	{ sharing = workers.size() + 1; }
+	int threads = threads_available / sharing; 
+	if( threads < 1 )
+	{ threads = 1; }
+	
+	// after a task has thrown, the others are only drained, not run 
+	bool skip = ( first_exception != nullptr ); 
+	lock.unlock(); 
+	std::exception_ptr exception = nullptr; 
+	if( skip == false )
+	{
+		omp_set_num_threads( threads ); 
+		try
+		{ run_task( n ); }
+		catch( ... )
+		{ exception = std::current_exception(); }
+	}
+	lock.lock(); 
+	if( exception != nullptr && first_exception == nullptr )
+	{ first_exception = exception; }
+	
+	running_tasks--; 
+	completed_tasks++; 
+	for( int i=0; i < tasks[n].successors.size() ; i++ )
+	{
+		int m = tasks[n].successors[i]; 
+		tasks[m].predecessors_remaining--; 
+		if( tasks[m].predecessors_remaining == 0 )
+		{ ready_tasks.insert( std::upper_bound( ready_tasks.begin(), ready_tasks.end(), m ) , m ); }
+	}
+	lock.unlock(); 
+	state_changed.notify_all(); 
+	lock.lock(); 
+	return; 
+}
+
+void Task_Graph::run( void )
+{
+	if( tasks.size() == 0 )
+	{ return; }
+	
+	int threads = omp_get_max_threads(); 
+	int concurrency = threads; 
+	if( max_concurrent_tasks > 0 && max_concurrent_tasks < concurrency )
+	{ concurrency = max_concurrent_tasks; }
+	if( concurrency > tasks.size() )
+	{ concurrency = tasks.size(); }
+	
+	// tasks are only ever added after their predecessors, so the order 
+	// they were added in is a topological order 
+	if( deterministic || concurrency < 2 )
+	{
+		for( int n=0; n < tasks.size() ; n++ )
+		{ run_task( n ); }
+		return; 
+	}
+	
+	std::unique_lock<std::mutex> lock( mutex ); 
+	start_workers( concurrency - 1 ); 
+	
+	threads_available = threads; 
+	running_tasks = 0; 
+	completed_tasks = 0; 
+	first_exception = nullptr; 
+	ready_tasks.clear(); 
+	for( int n=0; n < tasks.size() ; n++ )
+	{
+		tasks[n].predecessors_remaining = tasks[n].number_of_predecessors; 
+		if( tasks[n].predecessors_remaining == 0 )
+		{ ready_tasks.push_back( n ); }
+	}
+	lock.unlock(); 
+	state_changed.notify_all(); 
+	lock.lock(); 
+	
+	// the calling thread works too, until the whole graph is done 
+	while( completed_tasks < tasks.size() )
+	{
+		if( ready_tasks.size() > 0 )
+		{ run_next_ready_task( lock ); }
+		else
+		{ state_changed.wait( lock ); }
+	}
+	std::exception_ptr exception = first_exception; 
+	first_exception = nullptr; 
+	lock.unlock(); 
+	
+	omp_set_num_threads( threads ); 
+	if( exception != nullptr )
+	{ std::rethrow_exception( exception ); }
+	return; 
+}
+
+};
@@ -0,0 +1,197 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __PhysiCell_task_graph_h__
+#define __PhysiCell_task_graph_h__
+
+#include <vector>
+#include <string>
+#include <map>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+namespace PhysiCell{
+
+/* 
+ A Task_Graph expresses one simulation step as a DAG of tasks. Each task 
+ declares the named resources it reads and writes ("densities", "cells", 
+ "secretion", "gradients", "output", ...), and the graph adds the 
+ read-after-write, write-after-read, and write-after-write edges between 
+ tasks in the order they were added. Extra edges can be added by hand. 
+ 
+ run() executes the graph on a small persistent pool: independent tasks 
+ run at the same time, and the OpenMP threads are split between the tasks 
+ that are running, so each task's own parallel loops still use the node. 
+ When two or more tasks are ready, the one added first starts first. 
+ 
+ In deterministic mode (or with one OpenMP thread), run() executes the 
+ tasks one at a time in the order they were added. That order is always a 
+ valid schedule, and it is the order of the sequential main loop, so it 
+ can be used to validate the concurrent schedule. 
+ 
+ If a task throws, the tasks that have not started yet are skipped, and 
+ run() rethrows the (first) exception on the calling thread once the 
+ running tasks have finished. 
+*/
+
+class Task_Graph
+{
+ private:
+	class Task
+	{
+	 public:
+		std::string name; 
+		std::function<void(void)> work; 
+		std::vector<int> successors; 
+		int number_of_predecessors; 
+		int predecessors_remaining; 
+	}; 
+	std::vector<Task> tasks; 
+	
+	// used to derive the edges as tasks are added 
+	std::map<std::string,int> last_writer; 
+	std::map<std::string,std::vector<int> > readers_since_last_write; 
+	
+	// the persistent pool 
+	std::vector<std::thread> workers; 
+	std::mutex mutex; 
+	std::condition_variable state_changed; 
+	std::vector<int> ready_tasks; 
+	int running_tasks; 
+	int completed_tasks; 
+	int threads_available; 
+	bool shutting_down; 
+	std::exception_ptr first_exception; // from a task, to rethrow from run() 
+	
+	void start_workers( int number_of_workers ); 
+	void worker_loop( void ); 
+	void run_next_ready_task( std::unique_lock<std::mutex>& lock ); 
+	void run_task( int n ); 
+	
+ public:
+	bool deterministic; 
+	int max_concurrent_tasks; // 0: one per OpenMP thread 
+	
+	Task_Graph(); 
+	~Task_Graph(); 
+	
+	int add_task( std::string name, std::function<void(void)> work, 
+		std::vector<std::string> reads , std::vector<std::string> writes ); 
+	void add_dependency( int before, int after ); 
+	
+	void run( void ); 
+	void clear( void ); // remove the tasks, but keep the pool 
+	
+	int size( void ); 
+	void display( std::ostream& os ); 
+};
+
+/* 
+ The cumulative wall time of the tasks, by name, over every Task_Graph that 
+ runs (off by default; <parallel><task_graph><record_task_times>). Concurrent 
+ tasks overlap, so the times can add up to more than the run time. 
+ 
+ With record_counters (<record_task_counters>, which also records the times), 
+ the change in the process's hardware counters over each task is added up 
+ too (see PhysiCell_hardware_counters.h). The counters are summed over all 
+ the threads (those of the main OpenMP team, and of each worker's), so 
+ they are only attributed to the right task in deterministic mode, when the 
+ tasks run one at a time. 
+*/
+
+class Task_Timing
+{
+ private:
+	std::mutex mutex; 
+	std::vector<std::string> names; // in the order they first ran 
+	std::vector<double> seconds; 
+	std::vector<long> runs; 
+	std::vector<std::vector<double> > counts; // by task, as in Hardware_Counters::names 
+	
+	int index( std::string name ); // adds the name if it is new 
+	
+ public:
+	bool enabled; 
+	bool record_counters; 
+	
+	Task_Timing(); 
+	
+	void add( std::string name , double elapsed_seconds ); 
+	void add( std::string name , double elapsed_seconds , std::vector<double>& counter_changes ); 
+	void display( std::ostream& os ); 
+	void reset( void ); 
+};
+
+extern Task_Timing task_timing; 
+
+};
+
+#endif
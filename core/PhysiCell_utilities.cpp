@@ -75,33 +75,22 @@
 
 namespace PhysiCell{
 
-std::random_device rd;
-std::mt19937 gen(rd());
+// the random number generator belongs to the default simulation 
 
 long SeedRandom( long input )
-{
-	gen.seed(input);
-	return input;
-}
-
+{ return get_default_simulation().seed_random( input ); }
 
 long SeedRandom( void )
-{ 
-	unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-	gen.seed(seed);
-	return seed;
-}
+{ return get_default_simulation().seed_random(); }
 
 double UniformRandom()
-{
-	return std::generate_canonical<double, 10>(gen);
-}
+{ return get_default_simulation().uniform_random(); }
 
 double NormalRandom( double mean, double standard_deviation )
-{
-	std::normal_distribution<> d(mean,standard_deviation);
-	return d(gen); 
-}
+{ return get_default_simulation().normal_random( mean , standard_deviation ); }
+
+unsigned long long counter_based_key( unsigned long long stream )
+{ return counter_based_mix( get_default_simulation().random_seed ) ^ counter_based_mix( stream * 0xD1B54A32D192ED03ULL + 1 ); }
 
 // Squared distance between two points
 // This is already in BioFVM_vector as: 
@@ -94,6 +94,41 @@ void add_software_citation( std::string name , std::string version, std::string
 
 int choose_event( std::vector<double>& probabilities ); 
 
+/* 
+ Counter-based random numbers: each is a hash of a key (such as a cell ID, 
+ mixed with the seed of the simulation; see counter_based_key) and a counter 
+ (such as the step and the draw within it). There is no generator state, so 
+ loops can draw them in any order, on any thread, and in vector lanes, with 
+ the same results. The hash is two rounds of the SplitMix64 finalizer. 
+*/
+
+inline unsigned long long counter_based_mix( unsigned long long z )
+{
+	z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL; 
+	z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL; 
+	return z ^ ( z >> 31 ); 
+}
+
+// the key of a stream (for instance, of a cell) in the default simulation 
+unsigned long long counter_based_key( unsigned long long stream ); 
+
+// uniform in (0,1) 
+inline double counter_based_uniform( unsigned long long key , unsigned long long counter )
+{
+	unsigned long long bits = counter_based_mix( key ^ counter_based_mix( counter + 0x9E3779B97F4A7C15ULL ) ); 
+	return ( ( bits >> 11 ) + 0.5 ) * ( 1.0 / 9007199254740992.0 ); 
+}
+
+// standard normal (Box-Muller): draw 2i and 2i+1 of a stream are the pair from 
+// uniforms 2i and 2i+1 
+inline double counter_based_normal( unsigned long long key , unsigned long long counter )
+{
+	unsigned long long pair = counter & ~1ULL; 
+	double radius = sqrt( -2.0 * log( counter_based_uniform( key , pair ) ) ); 
+	double angle = 6.283185307179586 * counter_based_uniform( key , pair + 1 ); 
+	return radius * ( ( counter & 1ULL ) ? sin( angle ) : cos( angle ) ); 
+}
+
 };
 
 #endif
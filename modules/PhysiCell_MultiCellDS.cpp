@@ -78,6 +78,9 @@ void add_PhysiCell_cells_to_open_xml_pugi( pugi::xml_document& xml_dom, std::str
 	if( BioFVM::save_cell_data == false )
 	{ return; }
 	
+	// the labels follow cell #0 (or the default cell, on an MPI rank without cells) 
+	Custom_Cell_Data& reference_custom_data = (*all_cells).size() > 0 ? (*all_cells)[0]->custom_data : cell_defaults.custom_data; 
+	
 	pugi::xml_node root = xml_dom.child("MultiCellDS") ; 
 	pugi::xml_node node = root.child( "cellular_information" ); 
 	root = node; 
@@ -363,11 +366,11 @@ void add_PhysiCell_cells_to_open_xml_pugi( pugi::xml_document& xml_dom, std::str
 			node_temp1 = node_temp1.parent(); 
 			index += size; 			
 			// custom variables 
-			for( int i=0; i < (*all_cells)[0]->custom_data.variables.size(); i++ )
+			for( int i=0; i < reference_custom_data.variables.size(); i++ )
 			{
 				size = 1; 
 				char szTemp [1024]; 
-				strcpy( szTemp, (*all_cells)[0]->custom_data.variables[i].name.c_str() ); 
+				strcpy( szTemp, reference_custom_data.variables[i].name.c_str() ); 
 				node_temp1 = node_temp1.append_child( "label" );
 				node_temp1.append_child( pugi::node_pcdata ).set_value( szTemp ); 
 				attrib = node_temp1.append_attribute( "index" ); 
@@ -378,11 +381,11 @@ void add_PhysiCell_cells_to_open_xml_pugi( pugi::xml_document& xml_dom, std::str
 				index += size; 			
 			}
 			// custom vector variables 
-			for( int i=0; i < (*all_cells)[0]->custom_data.vector_variables.size(); i++ )
+			for( int i=0; i < reference_custom_data.vector_variables.size(); i++ )
 			{
-				size = (*all_cells)[0]->custom_data.vector_variables[i].value.size(); 
+				size = reference_custom_data.vector_variables[i].value.size(); 
 ;				char szTemp [1024]; 
-				strcpy( szTemp, (*all_cells)[0]->custom_data.vector_variables[i].name.c_str() ); 
+				strcpy( szTemp, reference_custom_data.vector_variables[i].name.c_str() ); 
 				node_temp1 = node_temp1.append_child( "label" );
 				node_temp1.append_child( pugi::node_pcdata ).set_value( szTemp ); 
 				attrib = node_temp1.append_attribute( "index" ); 
@@ -440,15 +443,20 @@ void add_PhysiCell_cells_to_open_xml_pugi( pugi::xml_document& xml_dom, std::str
 		// figure out size of custom data. for now, 
 		// assume all the cells have teh same custom data as 
 		// cell #0
-		int custom_data_size = (*all_cells)[0]->custom_data.variables.size();  
-		for( int i=0; i < (*all_cells)[0]->custom_data.vector_variables.size(); i++ )
+		int custom_data_size = reference_custom_data.variables.size();  
+		for( int i=0; i < reference_custom_data.vector_variables.size(); i++ )
 		{
-			custom_data_size += (*all_cells)[0]->custom_data.vector_variables[i].value.size(); 
+			custom_data_size += reference_custom_data.vector_variables[i].value.size(); 
 		}
 		size_of_each_datum += custom_data_size; 
 		
 
-		FILE* fp = write_matlab_header( size_of_each_datum, number_of_data_entries,  filename, "cells" );  
+		// MPI: this rank's columns go to a scratch stream first (see BioFVM_MPI.h) 
+		FILE* fp; 
+		if( domain_decomposition.active )
+		{ fp = domain_decomposition.open_matlab_columns(); }
+		else
+		{ fp = write_matlab_header( size_of_each_datum, number_of_data_entries,  filename, "cells" ); }
 		if( fp == NULL )
 		{ 
 			std::cout << std::endl << "Error: Failed to open " << filename << " for MAT writing." << std::endl << std::endl; 
@@ -536,8 +544,10 @@ void add_PhysiCell_cells_to_open_xml_pugi( pugi::xml_document& xml_dom, std::str
 			
 		}
 
-		fclose( fp ); 
-		
+		if( domain_decomposition.active )
+		{ domain_decomposition.close_matlab_columns( fp , filename , "cells" , size_of_each_datum ); }
+		else
+		{ fclose( fp ); }
 		
 		return; 
 	}
@@ -642,6 +652,9 @@ void add_PhysiCell_to_open_xml_pugi( pugi::xml_document& xml_dom , std::string f
 
 void save_PhysiCell_to_MultiCellDS_xml_pugi( std::string filename_base , Microenvironment& M , double current_simulation_time)
 {
+	// (this save's own interval goes in the next trace) 
+	BIOFVM_TRACE_SCOPE( "save_PhysiCell_to_MultiCellDS" ); 
+	
 	// start with a standard BioFVM save
 	add_BioFVM_to_open_xml_pugi( BioFVM::biofvm_doc , filename_base , current_simulation_time , M ); 
 	
@@ -653,7 +666,11 @@ void save_PhysiCell_to_MultiCellDS_xml_pugi( std::string filename_base , Microen
 	
 	char filename[1024]; 
 	sprintf( filename , "%s.xml" , filename_base.c_str() ); 
-	BioFVM::biofvm_doc.save_file( filename );
+	if( domain_decomposition.rank == 0 )
+	{ BioFVM::biofvm_doc.save_file( filename ); }
+	
+	// the threads' timelines since the last save (with "make TRACE=1") 
+	write_trace( filename_base + "_trace.json" ); 
 	
 	return; 
 }
@@ -66,6 +66,11 @@
 */
 
 #include "./PhysiCell_POV.h" 
+#include "./PhysiCell_raster.h" 
+
+#include <sstream>
+#include <omp.h>
+
 using namespace BioFVM; 
 	
 Clipping_Plane::Clipping_Plane()
@@ -185,9 +190,75 @@ POV_Options::POV_Options()
 	
 	clipping_planes.resize( 0 ); 
 	
+	frustum_culling = true; 
+	
 	return; 
 }
 
+bool POV_Options::is_in_view( std::vector<double>& center, double radius )
+{
+	// POV-Ray's default perspective camera has a unit direction vector, so the 
+	// half-width and half-height of the view at unit depth are |right|/2 and |up|/2 
+	double forward [3]; 
+	double vertical [3]; 
+	double horizontal [3]; 
+	double displacement [3]; 
+	
+	for( int i=0; i < 3 ; i++ )
+	{ forward[i] = camera_look_at[i] - camera_position[i]; }
+	double length = sqrt( forward[0]*forward[0] + forward[1]*forward[1] + forward[2]*forward[2] ) + 1e-16; 
+	for( int i=0; i < 3 ; i++ )
+	{ forward[i] /= length; }
+	
+	// the sky vector, made orthogonal to the viewing direction 
+	double sky_dot_forward = camera_sky[0]*forward[0] + camera_sky[1]*forward[1] + camera_sky[2]*forward[2]; 
+	for( int i=0; i < 3 ; i++ )
+	{ vertical[i] = camera_sky[i] - sky_dot_forward*forward[i]; }
+	length = sqrt( vertical[0]*vertical[0] + vertical[1]*vertical[1] + vertical[2]*vertical[2] ) + 1e-16; 
+	for( int i=0; i < 3 ; i++ )
+	{ vertical[i] /= length; }
+	
+	horizontal[0] = forward[1]*vertical[2] - forward[2]*vertical[1]; 
+	horizontal[1] = forward[2]*vertical[0] - forward[0]*vertical[2]; 
+	horizontal[2] = forward[0]*vertical[1] - forward[1]*vertical[0]; 
+	
+	for( int i=0; i < 3 ; i++ )
+	{ displacement[i] = center[i] - camera_position[i]; }
+	
+	double depth = displacement[0]*forward[0] + displacement[1]*forward[1] + displacement[2]*forward[2]; 
+	if( depth < -radius )
+	{ return false; }
+	
+	double tangents[2] = { 0.5*norm( camera_right ) , 0.5*norm( camera_up ) }; 
+	double offsets[2] = { 
+		fabs( displacement[0]*horizontal[0] + displacement[1]*horizontal[1] + displacement[2]*horizontal[2] ) , 
+		fabs( displacement[0]*vertical[0] + displacement[1]*vertical[1] + displacement[2]*vertical[2] ) }; 
+	for( int i=0; i < 2 ; i++ )
+	{
+		// distance from the sphere center to the side plane of the frustum 
+		if( ( offsets[i] - depth*tangents[i] ) / sqrt( 1.0 + tangents[i]*tangents[i] ) > radius )
+		{ return false; }
+	}
+	return true; 
+}
+
+int POV_Options::clipping_status( std::vector<double>& center, double radius )
+{
+	if( clipping_planes.size() == 0 )
+	{ return 1; }
+	
+	int status = 0; 
+	for( unsigned int i=0; i < clipping_planes.size() ; i++ )
+	{
+		double distance = clipping_planes[i].signed_distance_to_plane( center ); 
+		if( distance <= -radius && status == 0 )
+		{ status = 1; }
+		if( distance > -radius && distance <= radius )
+		{ status = 2; }
+	}
+	return status; 
+}
+
 POV_Options default_POV_options; 
 
 void Write_POV_start( POV_Options& options , std::ostream& os )
@@ -227,18 +298,161 @@ void Write_POV_start( std::ostream& os )
 }
 
 void Write_POV_sphere( std::ostream& os, std::vector<double>& center, double radius, std::vector<double>& pigment, std::vector<double>& finish )
+{
+	Write_POV_sphere( os, center, radius, pigment, finish, default_POV_options.no_shadow, default_POV_options.no_reflection ); 
+	return;
+}
+
+void Write_POV_sphere( std::ostream& os, std::vector<double>& center, double radius, std::vector<double>& pigment, std::vector<double>& finish, 
+	bool no_shadow, bool no_reflection )
 {
 	os 	<< "sphere" << std::endl << "{" << std::endl 
 		<< " <" << center[0] << "," << center[1] << "," << center[2] << ">, " << radius 
 		<< " pigment {color rgbf<" << pigment[0] << "," << pigment[1] << "," << pigment[2] << "," << pigment[3] << ">}" << std::endl
 		<< " finish {ambient " << finish[0] << " diffuse " << finish[1] << " specular " << finish[2] << "}" << std::endl;
 		
-		if( default_POV_options.no_shadow )
+		if( no_shadow )
 		{ os << " no_shadow "; }
-		if( default_POV_options.no_reflection )
+		if( no_reflection )
 		{ os << " no_reflection "; }
 	os 	<< "}" << std::endl; 
 	return;
 }
 
+void Write_POV_clipped_sphere( std::ostream& os, POV_Options& options, std::vector<double>& center, double radius, 
+	std::vector<double>& pigment, std::vector<double>& finish, double plane_offset, bool no_shadow )
+{
+	int status = options.clipping_status( center, radius + plane_offset ); 
+	if( status == 0 )
+	{ return; }
+	
+	if( status == 2 )
+	{
+		// the cut faces take the color of the sphere 
+		os << "intersection{ " << std::endl << "union{ " << std::endl; 
+		for( unsigned int i=0; i < options.clipping_planes.size() ; i++ )
+		{
+			os	<< "plane{<" << options.clipping_planes[i].coefficients[0] << "," 
+				<< options.clipping_planes[i].coefficients[1] << "," 
+				<< options.clipping_planes[i].coefficients[2] << ">, " 
+				<< options.clipping_planes[i].coefficients[3] + plane_offset << std::endl 
+				<< " pigment {color rgbf<" << pigment[0] << "," << pigment[1] << "," << pigment[2] << "," << pigment[3] << ">}" << std::endl
+				<< " finish {ambient " << finish[0] << " diffuse " << finish[1] << " specular " << finish[2] << "} }" << std::endl;
+		}
+		os << "}" << std::endl; 
+	}
+	
+	Write_POV_sphere( os, center, radius, pigment, finish, no_shadow, options.no_reflection ); 
+	
+	if( status == 2 )
+	{ os << "}" << std::endl; }
+	return; 
+}
+
+namespace PhysiCell{
+
+void POV_plot( std::string filename , POV_Options& options, std::vector<std::string> (*cell_coloring_function)(Cell*) )
+{
+	BIOFVM_TRACE_SCOPE( "POV_plot" ); 
+	std::ofstream os( filename , std::ios::out );
+	if( os.fail() )
+	{ 
+		std::cout << std::endl << "Error: Failed to open " << filename << " for POV writing." << std::endl << std::endl; 
+
+		std::cout << std::endl << "Error: We're not writing data like we expect. " << std::endl
+		<< "Check to make sure your save directory exists. " << std::endl << std::endl
+		<< "I'm going to exit with a crash code of -1 now until " << std::endl 
+		<< "you fix your directory. Sorry!" << std::endl << std::endl; 
+		exit(-1); 
+	} 
+	
+	Write_POV_start( options, os ); 
+	
+	int number_of_cells = all_cells->size(); 
+	
+	// cull in parallel 
+	
+	std::vector<char> visible( number_of_cells , 1 ); 
+	#pragma omp parallel for 
+	for( int i=0; i < number_of_cells ; i++ )
+	{
+		Cell* pC = (*all_cells)[i]; 
+		double radius = pC->phenotype.geometry.radius; 
+		if( options.clipping_status( pC->position , radius ) == 0 || 
+			( options.frustum_culling && !options.is_in_view( pC->position , radius ) ) )
+		{ visible[i] = 0; }
+	}
+	
+	// the coloring functions return static storage, so color the survivors serially. 
+	// pigments: cytoplasm rgb, nucleus rgb; a negative red channel means "none" 
+	
+	std::vector<double> pigments( 6*number_of_cells , -1.0 ); 
+	std::vector<std::string> Colors; 
+	unsigned char rgb [3]; 
+	for( int i=0; i < number_of_cells ; i++ )
+	{
+		if( !visible[i] )
+		{ continue; }
+		Colors = cell_coloring_function( (*all_cells)[i] ); 
+		for( int k=0; k < 2 ; k++ )
+		{
+			if( parse_rgb_string( Colors[2*k] , rgb ) )
+			{
+				for( int m=0; m < 3 ; m++ )
+				{ pigments[6*i+3*k+m] = rgb[m] / 255.0; }
+			}
+		}
+	}
+	
+	// format into per-thread buffers. A static schedule hands each thread one 
+	// contiguous block of cells, so concatenating the buffers in thread order 
+	// reproduces the serial output. 
+	
+	std::vector<std::string> buffers( omp_get_max_threads() ); 
+	#pragma omp parallel 
+	{
+		std::ostringstream buffer; 
+		std::vector<double> pigment( 4 , 0.0 ); 
+		std::vector<double> finish = {0.05,1,0.1}; 
+		
+		#pragma omp for schedule(static)
+		for( int i=0; i < number_of_cells ; i++ )
+		{
+			if( !visible[i] )
+			{ continue; }
+			Cell* pC = (*all_cells)[i]; 
+			
+			if( pigments[6*i] >= 0.0 )
+			{
+				pigment[0] = pigments[6*i]; 
+				pigment[1] = pigments[6*i+1]; 
+				pigment[2] = pigments[6*i+2]; 
+				Write_POV_clipped_sphere( buffer, options, pC->position, pC->phenotype.geometry.radius, pigment, finish, 0.0, options.no_shadow ); 
+			}
+			
+			// offset the nuclear clipping a tiny bit to keep the cytoplasm 
+			// and nucleus from blending into each other 
+			if( pigments[6*i+3] >= 0.0 )
+			{
+				pigment[0] = pigments[6*i+3]; 
+				pigment[1] = pigments[6*i+4]; 
+				pigment[2] = pigments[6*i+5]; 
+				Write_POV_clipped_sphere( buffer, options, pC->position, pC->phenotype.geometry.nuclear_radius, pigment, finish, 0.1, true ); 
+			}
+		}
+		buffers[ omp_get_thread_num() ] = buffer.str(); 
+	}
+	
+	for( unsigned int n=0; n < buffers.size() ; n++ )
+	{ os << buffers[n]; }
+	os.close(); 
+	
+	return; 
+}
+
+void POV_plot( std::string filename , std::vector<std::string> (*cell_coloring_function)(Cell*) )
+{ return POV_plot( filename, default_POV_options, cell_coloring_function ); }
+
+};
+
 					
@@ -76,6 +76,7 @@
 #define _PhysiCell_POV_h_
 
 #include "../BioFVM/BioFVM_vector.h" 
+#include "../core/PhysiCell.h" 
 
 class Clipping_Plane
 {
@@ -127,8 +128,17 @@ class POV_Options
 	
 	std::vector<Clipping_Plane> clipping_planes; 
 	
+	// skip spheres that are entirely outside the camera's field of view. 
+	// (Such spheres can still cast shadows into the view, so turn this off 
+	// for renders that must match an unculled scene exactly.) 
+	bool frustum_culling; 
+	
 	// distance from center of domain, angle from x-axis, angle from z-axis 
 	void set_camera_from_spherical_location( double distance, double theta, double phi ); // done 
+	
+	bool is_in_view( std::vector<double>& center, double radius ); 
+	// 0: entirely in front of all the clipping planes (not drawn), 1: drawn as-is, 2: cut by the planes 
+	int clipping_status( std::vector<double>& center, double radius ); 
 };
 
 extern POV_Options default_POV_options; 
@@ -139,5 +149,21 @@ void Write_POV_start( std::ostream& os );
 // pigment: [r,g,b,f], where they vary from 0 to 1. I suggest f = 0. 
 // finish: [ambient,diffuse,specular]
 void Write_POV_sphere( std::ostream& os, std::vector<double>& center, double radius, std::vector<double>& pigment, std::vector<double>& finish );
+void Write_POV_sphere( std::ostream& os, std::vector<double>& center, double radius, std::vector<double>& pigment, std::vector<double>& finish, 
+	bool no_shadow, bool no_reflection ); 
+
+// a sphere, cut away by the clipping planes if clipping_status is 2 
+void Write_POV_clipped_sphere( std::ostream& os, POV_Options& options, std::vector<double>& center, double radius, 
+	std::vector<double>& pigment, std::vector<double>& finish, double plane_offset, bool no_shadow ); 
+
+namespace PhysiCell{
+
+// Writes all the cells (cytoplasm and nucleus, colored by the usual pathology coloring 
+// functions) as a complete POV-Ray scene. Cells are culled and formatted in parallel, 
+// one buffer per thread, and the buffers are written in cell order. 
+void POV_plot( std::string filename , POV_Options& options, std::vector<std::string> (*cell_coloring_function)(Cell*) ); 
+void POV_plot( std::string filename , std::vector<std::string> (*cell_coloring_function)(Cell*) ); 
+
+};
 					
 #endif
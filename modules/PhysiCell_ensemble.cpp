@@ -0,0 +1,417 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "./PhysiCell_ensemble.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <sstream>
+#include <omp.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace PhysiCell{
+
+Ensemble_Specification::Ensemble_Specification()
+{
+	folder = "./output/ensemble"; 
+	threads_per_run = 1; 
+	concurrent_runs = 0; 
+	
+	seeds.resize( 0 ); 
+	keys.resize( 0 ); 
+	values.resize( 0 ); 
+	
+	return; 
+}
+
+int Ensemble_Specification::number_of_runs( void )
+{
+	int runs = ( seeds.size() > 0 ) ? seeds.size() : 1; 
+	for( unsigned int i=0 ; i < values.size() ; i++ )
+	{ runs *= values[i].size(); }
+	return runs; 
+}
+
+bool Ensemble_Specification::read( std::string filename )
+{
+	std::ifstream file( filename.c_str() ); 
+	if( file.fail() )
+	{
+		std::cout << "Error: could not open ensemble specification " << filename << "!" << std::endl; 
+		return false; 
+	}
+	
+	std::string line; 
+	int replicates = 0; 
+	while( std::getline( file , line ) )
+	{
+		size_t comment = line.find( '#' ); 
+		if( comment != std::string::npos )
+		{ line.erase( comment ); }
+		
+		std::istringstream stream( line ); 
+		std::string key; 
+		if( !( stream >> key ) )
+		{ continue; }
+		
+		std::vector<std::string> entries; 
+		std::string entry; 
+		while( stream >> entry )
+		{ entries.push_back( entry ); }
+		if( entries.size() == 0 )
+		{
+			std::cout << "Error: no value given for " << key << " in " << filename << "!" << std::endl; 
+			return false; 
+		}
+		
+		if( key == "folder" )
+		{ folder = entries[0]; }
+		else if( key == "threads_per_run" )
+		{ threads_per_run = atoi( entries[0].c_str() ); }
+		else if( key == "concurrent_runs" )
+		{ concurrent_runs = atoi( entries[0].c_str() ); }
+		else if( key == "replicates" )
+		{ replicates = atoi( entries[0].c_str() ); }
+		else if( key == "seeds" )
+		{
+			for( unsigned int i=0 ; i < entries.size() ; i++ )
+			{ seeds.push_back( atoi( entries[i].c_str() ) ); }
+		}
+		else
+		{
+			keys.push_back( key ); 
+			values.push_back( entries ); 
+		}
+	}
+	
+	if( seeds.size() == 0 )
+	{
+		for( int i=0 ; i < replicates ; i++ )
+		{ seeds.push_back( i ); }
+	}
+	if( threads_per_run < 1 )
+	{ threads_per_run = 1; }
+	
+	return true; 
+}
+
+#ifndef _WIN32
+
+// the first XML element named part, for each part of a dotted path 
+static pugi::xml_node find_ensemble_node( pugi::xml_node root , std::string key )
+{
+	pugi::xml_node node = root; 
+	std::istringstream stream( key ); 
+	std::string part; 
+	while( node && std::getline( stream , part , '.' ) )
+	{
+		node = node.find_node( [&part]( pugi::xml_node n ) { return part == n.name(); } ); 
+	}
+	return node; 
+}
+
+static void make_ensemble_folder( std::string path )
+{
+	for( size_t i=1 ; i <= path.size() ; i++ )
+	{
+		if( i == path.size() || path[i] == '/' )
+		{ mkdir( path.substr( 0 , i ).c_str() , 0755 ); }
+	}
+	return; 
+}
+
+static std::string ensemble_run_folder( Ensemble_Specification& spec , int run )
+{
+	char name[32]; 
+	sprintf( name , "/run%04d" , run ); 
+	return spec.folder + name; 
+}
+
+// axis value indices and seed index of a run: seeds vary fastest, then 
+// the last axis, ..., then the first axis 
+static void decode_ensemble_run( Ensemble_Specification& spec , int run , std::vector<int>& choices , int& seed_index )
+{
+	int number_of_seeds = ( spec.seeds.size() > 0 ) ? spec.seeds.size() : 1; 
+	seed_index = run % number_of_seeds; 
+	run /= number_of_seeds; 
+	
+	choices.assign( spec.keys.size() , 0 ); 
+	for( int i = spec.keys.size()-1 ; i >= 0 ; i-- )
+	{
+		choices[i] = run % spec.values[i].size(); 
+		run /= spec.values[i].size(); 
+	}
+	return; 
+}
+
+static void pin_to_ensemble_slot( int slot , int threads_per_run )
+{
+#ifdef __linux__
+	cpu_set_t available; 
+	if( sched_getaffinity( 0 , sizeof(cpu_set_t) , &available ) != 0 )
+	{ return; }
+	
+	std::vector<int> cpus; 
+	for( int c=0 ; c < CPU_SETSIZE ; c++ )
+	{
+		if( CPU_ISSET( c , &available ) )
+		{ cpus.push_back( c ); }
+	}
+	if( cpus.size() == 0 )
+	{ return; }
+	
+	cpu_set_t mine; 
+	CPU_ZERO( &mine ); 
+	for( int j=0 ; j < threads_per_run ; j++ )
+	{ CPU_SET( cpus[ ( slot*threads_per_run + j ) % cpus.size() ] , &mine ); }
+	sched_setaffinity( 0 , sizeof(cpu_set_t) , &mine ); 
+#endif
+	return; 
+}
+
+static int available_ensemble_cores( void )
+{
+#ifdef __linux__
+	cpu_set_t available; 
+	if( sched_getaffinity( 0 , sizeof(cpu_set_t) , &available ) == 0 )
+	{ return CPU_COUNT( &available ); }
+#endif
+	long cores = sysconf( _SC_NPROCESSORS_ONLN ); 
+	return ( cores > 0 ) ? cores : 1; 
+}
+
+bool run_ensemble( std::string specification_filename , std::string base_config_filename )
+{
+	Ensemble_Specification spec; 
+	if( !spec.read( specification_filename ) )
+	{ exit(-1); }
+	
+	// parse the base configuration once, into the configuration DOM; each run edits 
+	// its own copy-on-write copy and reads its settings from it without parsing again 
+	pugi::xml_parse_result result = physicell_config_doc.load_file( base_config_filename.c_str() ); 
+	if( result.status != pugi::xml_parse_status::status_ok )
+	{
+		std::cout << "Error loading " << base_config_filename << "!" << std::endl; 
+		exit(-1); 
+	}
+	physicell_config_root = physicell_config_doc.child( "PhysiCell_settings" ); 
+	physicell_config_dom_initialized = true; 
+	pugi::xml_node root = physicell_config_root; 
+	
+	for( unsigned int i=0 ; i < spec.keys.size() ; i++ )
+	{
+		if( !find_ensemble_node( root , spec.keys[i] ) )
+		{
+			std::cout << "Error: ensemble key " << spec.keys[i] << " is not in " << base_config_filename << "!" << std::endl; 
+			exit(-1); 
+		}
+	}
+	pugi::xml_node seed_node = find_ensemble_node( root , "random_seed" ); 
+	if( spec.seeds.size() > 0 && !seed_node )
+	{ std::cout << "Warning: " << base_config_filename << " has no random_seed; replicates will differ only by time seeding." << std::endl; }
+	
+	// shared read-only setup 
+	create_standard_cycle_and_death_models(); 
+	
+	int number_of_runs = spec.number_of_runs(); 
+	int concurrent_runs = spec.concurrent_runs; 
+	if( concurrent_runs <= 0 )
+	{ concurrent_runs = available_ensemble_cores() / spec.threads_per_run; }
+	if( concurrent_runs < 1 )
+	{ concurrent_runs = 1; }
+	if( concurrent_runs > number_of_runs )
+	{ concurrent_runs = number_of_runs; }
+	
+	// the run table 
+	make_ensemble_folder( spec.folder ); 
+	std::ofstream table( ( spec.folder + "/runs.csv" ).c_str() ); 
+	table << "run,folder,seed"; 
+	for( unsigned int i=0 ; i < spec.keys.size() ; i++ )
+	{ table << "," << spec.keys[i]; }
+	table << "\n"; 
+	for( int run=0 ; run < number_of_runs ; run++ )
+	{
+		std::vector<int> choices; 
+		int seed_index; 
+		decode_ensemble_run( spec , run , choices , seed_index ); 
+		table << run << "," << ensemble_run_folder( spec , run ) << ","; 
+		if( spec.seeds.size() > 0 )
+		{ table << spec.seeds[seed_index]; }
+		for( unsigned int i=0 ; i < spec.keys.size() ; i++ )
+		{ table << "," << spec.values[i][ choices[i] ]; }
+		table << "\n"; 
+	}
+	table.close(); 
+	
+	std::cout << "Ensemble: " << number_of_runs << " runs, " << concurrent_runs << " at a time with " 
+		<< spec.threads_per_run << " threads each." << std::endl; 
+	
+	std::vector<pid_t> slot_pids( concurrent_runs , 0 ); 
+	std::vector<int> slot_runs( concurrent_runs , -1 ); 
+	int next_run = 0; 
+	int running = 0; 
+	int failures = 0; 
+	
+	while( next_run < number_of_runs || running > 0 )
+	{
+		for( int slot=0 ; slot < concurrent_runs && next_run < number_of_runs ; slot++ )
+		{
+			if( slot_pids[slot] != 0 )
+			{ continue; }
+			
+			int run = next_run; 
+			std::string run_folder = ensemble_run_folder( spec , run ); 
+			make_ensemble_folder( run_folder ); 
+			
+			std::cout.flush(); 
+			fflush( stdout ); 
+			pid_t pid = fork(); 
+			if( pid < 0 )
+			{
+				std::cout << "Error: could not start ensemble run " << run << "!" << std::endl; 
+				exit(-1); 
+			}
+			
+			if( pid == 0 )
+			{
+				// this is the run: configure it and hand it back to main 
+				pin_to_ensemble_slot( slot , spec.threads_per_run ); 
+				
+				std::vector<int> choices; 
+				int seed_index; 
+				decode_ensemble_run( spec , run , choices , seed_index ); 
+				for( unsigned int i=0 ; i < spec.keys.size() ; i++ )
+				{ find_ensemble_node( root , spec.keys[i] ).text().set( spec.values[i][ choices[i] ].c_str() ); }
+				if( spec.seeds.size() > 0 && seed_node )
+				{ seed_node.text().set( spec.seeds[seed_index] ); }
+				root.child( "parallel" ).child( "omp_num_threads" ).text().set( spec.threads_per_run ); 
+				root.child( "save" ).child( "folder" ).text().set( run_folder.c_str() ); 
+				
+				// a record of the run's configuration 
+				std::string config_filename = run_folder + "/config.xml"; 
+				physicell_config_doc.save_file( config_filename.c_str() ); 
+				
+				if( freopen( ( run_folder + "/output.log" ).c_str() , "w" , stdout ) == NULL )
+				{ std::cout << "Warning: could not redirect the output of run " << run << std::endl; }
+				
+				return read_PhysiCell_config_dom( config_filename ); 
+			}
+			
+			slot_pids[slot] = pid; 
+			slot_runs[slot] = run; 
+			running++; 
+			next_run++; 
+			std::cout << "Ensemble: started run " << run << " in " << run_folder << std::endl; 
+		}
+		
+		int status = 0; 
+		pid_t done = wait( &status ); 
+		if( done < 0 )
+		{ break; }
+		for( int slot=0 ; slot < concurrent_runs ; slot++ )
+		{
+			if( slot_pids[slot] != done )
+			{ continue; }
+			
+			bool success = WIFEXITED( status ) && WEXITSTATUS( status ) == 0; 
+			if( !success )
+			{ failures++; }
+			std::cout << "Ensemble: run " << slot_runs[slot] << ( success ? " finished" : " FAILED" ) << std::endl; 
+			slot_pids[slot] = 0; 
+			slot_runs[slot] = -1; 
+			running--; 
+		}
+	}
+	
+	std::cout << "Ensemble: " << number_of_runs - failures << " of " << number_of_runs << " runs finished." << std::endl; 
+	exit( failures > 0 ? -1 : 0 ); 
+	return false; 
+}
+
+#else
+
+bool run_ensemble( std::string specification_filename , std::string base_config_filename )
+{
+	std::cout << "Error: ensembles need fork(), which this platform does not provide." << std::endl; 
+	exit(-1); 
+	return false; 
+}
+
+#endif
+
+};
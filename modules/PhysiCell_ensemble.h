@@ -0,0 +1,132 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __PhysiCell_ensemble_h__
+#define __PhysiCell_ensemble_h__
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../core/PhysiCell.h"
+#include "./PhysiCell_settings.h"
+
+namespace PhysiCell{
+
+/* 
+ In-process ensembles: one binary runs a whole parameter sweep with 
+ replicates. The parent process parses the base configuration and builds 
+ the standard cycle and death models once, then forks one process per run, 
+ so the runs share that setup copy-on-write. At most concurrent_runs runs 
+ go at once, each with threads_per_run OpenMP threads pinned to its own 
+ cores (on Linux), so the node is never oversubscribed. 
+ 
+ Sweep specification (one entry per line, # starts a comment): 
+ 
+   folder           output/sweep   runs write to folder/run0000, folder/run0001, ... 
+   threads_per_run  2 
+   concurrent_runs  0              0: as many as fit on the available cores 
+   replicates       3              seeds 0, 1, 2 (or list them: seeds 11 12 13) 
+   <key> v1 v2 ...                 a sweep axis. key is the first XML element with 
+                                   that name, or a dotted path such as SVG.enable 
+ 
+ Runs take every combination of the axes (first axis slowest) for every 
+ seed. Each run fills the axis values, random_seed, omp_num_threads and 
+ save folder into its copy of the parsed configuration, reads its settings 
+ from that (without parsing again), saves it as config.xml for the record, 
+ and writes its console output to output.log. folder/runs.csv lists the 
+ runs and their values. 
+*/
+
+class Ensemble_Specification
+{
+ private:
+ public:
+	std::string folder; 
+	int threads_per_run; 
+	int concurrent_runs; 
+	
+	std::vector<int> seeds; 
+	std::vector<std::string> keys; 
+	std::vector< std::vector<std::string> > values; // one list per key 
+	
+	int number_of_runs( void ); 
+	bool read( std::string filename ); 
+	
+	Ensemble_Specification(); 
+}; 
+
+// Runs the ensemble described in specification_filename. The parent process 
+// waits for all runs and then exits; the call only returns in the forked 
+// runs, with that run's configuration loaded (as load_PhysiCell_config_file, but 
+// from the parent's parsed configuration, edited in place). 
+bool run_ensemble( std::string specification_filename , std::string base_config_filename ); 
+
+};
+
+#endif
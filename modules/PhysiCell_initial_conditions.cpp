@@ -0,0 +1,809 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "./PhysiCell_initial_conditions.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <omp.h>
+
+namespace PhysiCell{
+
+static const int cell_list_block_bytes = 1 << 24; // CSV bytes per read 
+static const int cell_list_block_records = 1 << 18; // binary records per read 
+static const char cell_list_magic[8] = "PCCELLS"; 
+static const int cell_list_version = 1; 
+
+Cell_List::Cell_List()
+{
+	clear(); 
+	return; 
+}
+
+int Cell_List::size( void )
+{ return types.size(); }
+
+void Cell_List::clear( void )
+{
+	type_labels.clear(); 
+	custom_data_names.clear(); 
+	positions.clear(); 
+	types.clear(); 
+	volumes.clear(); 
+	custom_data.clear(); 
+	return; 
+}
+
+// the registered cell definition (see register_cell_definition) a type label 
+// names: by name, or else by type number if the label is a whole number 
+static Cell_Definition* find_cell_list_definition( std::string label )
+{
+	Cell_Definition* pCD = find_cell_definition( label ); 
+	if( pCD != NULL )
+	{ return pCD; }
+	
+	char* end; 
+	long type_number = strtol( label.c_str() , &end , 10 ); 
+	if( label.size() > 0 && *end == '\0' )
+	{ return find_cell_definition( (int) type_number ); }
+	return NULL; 
+}
+
+// the index of a custom variable, or -1 if the data do not have it 
+// (find_variable_index returns 0 for unknown names) 
+static int find_custom_variable_index( Custom_Cell_Data& data , std::string name )
+{
+	int index = data.find_variable_index( name ); 
+	if( index >= (int) data.variables.size() || data.variables[index].name != name )
+	{ return -1; }
+	return index; 
+}
+
+/* CSV reading */ 
+
+// cells parsed by one thread, with its own type label table 
+class Cell_List_Chunk
+{
+ public:
+	Cell_List cells; 
+	std::unordered_map<std::string,int> label_indices; 
+	int bad_lines; 
+	
+	Cell_List_Chunk()
+	{ bad_lines = 0; }
+}; 
+
+static void trim_field( const char*& start, const char*& end )
+{
+	while( start < end && ( *start == ' ' || *start == '\t' || *start == '"' ) )
+	{ start++; }
+	while( end > start && ( end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '"' ) )
+	{ end--; }
+	return; 
+}
+
+// split a line (without its newline) at commas 
+static void split_line( const char* start, const char* end, std::vector<const char*>& field_starts, std::vector<const char*>& field_ends )
+{
+	field_starts.clear(); 
+	field_ends.clear(); 
+	const char* p = start; 
+	while( true )
+	{
+		const char* q = p; 
+		while( q < end && *q != ',' )
+		{ q++; }
+		const char* fs = p; 
+		const char* fe = q; 
+		trim_field( fs , fe ); 
+		field_starts.push_back( fs ); 
+		field_ends.push_back( fe ); 
+		if( q >= end )
+		{ break; }
+		p = q+1; 
+	}
+	return; 
+}
+
+// returns false if the field is not entirely a number; empty fields give NaN 
+static bool parse_number( const char* start, const char* end, double& value )
+{
+	if( start == end )
+	{
+		value = std::numeric_limits<double>::quiet_NaN(); 
+		return true; 
+	}
+	char* stop; 
+	value = strtod( start , &stop ); 
+	return ( stop == end ); 
+}
+
+static bool is_blank_or_comment( const char* start, const char* end )
+{
+	while( start < end && ( *start == ' ' || *start == '\t' || *start == '\r' ) )
+	{ start++; }
+	return ( start == end || *start == '#' ); 
+}
+
+static void parse_csv_lines( const char* start, const char* end, int number_of_custom, Cell_List_Chunk& chunk )
+{
+	std::vector<const char*> fs; 
+	std::vector<const char*> fe; 
+	double values[3]; 
+	
+	const char* line = start; 
+	while( line < end )
+	{
+		const char* line_end = (const char*) memchr( line , '\n' , end - line ); 
+		if( line_end == NULL )
+		{ line_end = end; }
+		
+		if( !is_blank_or_comment( line , line_end ) )
+		{
+			split_line( line , line_end , fs , fe ); 
+			bool ok = ( fs.size() >= 4 ); 
+			for( int i=0 ; ok && i < 3 ; i++ )
+			{ ok = parse_number( fs[i] , fe[i] , values[i] ) && !std::isnan( values[i] ); }
+			double volume = -1.0; 
+			if( ok && fs.size() > 4 )
+			{ ok = parse_number( fs[4] , fe[4] , volume ); }
+			
+			if( ok )
+			{
+				std::string label( fs[3] , fe[3] ); 
+				std::unordered_map<std::string,int>::iterator it = chunk.label_indices.find( label ); 
+				int type_index; 
+				if( it == chunk.label_indices.end() )
+				{
+					type_index = chunk.cells.type_labels.size(); 
+					chunk.label_indices[label] = type_index; 
+					chunk.cells.type_labels.push_back( label ); 
+				}
+				else
+				{ type_index = it->second; }
+				
+				chunk.cells.positions.push_back( values[0] ); 
+				chunk.cells.positions.push_back( values[1] ); 
+				chunk.cells.positions.push_back( values[2] ); 
+				chunk.cells.types.push_back( type_index ); 
+				chunk.cells.volumes.push_back( volume ); 
+				for( int j=0 ; j < number_of_custom ; j++ )
+				{
+					double value = std::numeric_limits<double>::quiet_NaN(); 
+					if( 5+j < (int) fs.size() && !parse_number( fs[5+j] , fe[5+j] , value ) )
+					{ value = std::numeric_limits<double>::quiet_NaN(); }
+					chunk.cells.custom_data.push_back( value ); 
+				}
+			}
+			else
+			{ chunk.bad_lines++; }
+		}
+		line = line_end + 1; 
+	}
+	return; 
+}
+
+// append a thread's cells, translating its type labels to the list's 
+static void merge_chunk( Cell_List_Chunk& chunk, Cell_List& list, std::unordered_map<std::string,int>& label_indices )
+{
+	std::vector<int> translation( chunk.cells.type_labels.size() ); 
+	for( unsigned int i=0 ; i < translation.size() ; i++ )
+	{
+		std::string& label = chunk.cells.type_labels[i]; 
+		std::unordered_map<std::string,int>::iterator it = label_indices.find( label ); 
+		if( it == label_indices.end() )
+		{
+			translation[i] = list.type_labels.size(); 
+			label_indices[label] = translation[i]; 
+			list.type_labels.push_back( label ); 
+		}
+		else
+		{ translation[i] = it->second; }
+	}
+	
+	list.positions.insert( list.positions.end() , chunk.cells.positions.begin() , chunk.cells.positions.end() ); 
+	list.volumes.insert( list.volumes.end() , chunk.cells.volumes.begin() , chunk.cells.volumes.end() ); 
+	list.custom_data.insert( list.custom_data.end() , chunk.cells.custom_data.begin() , chunk.cells.custom_data.end() ); 
+	for( unsigned int i=0 ; i < chunk.cells.types.size() ; i++ )
+	{ list.types.push_back( translation[ chunk.cells.types[i] ] ); }
+	
+	return; 
+}
+
+bool read_cell_list_csv( std::string filename , Cell_List& list )
+{
+	list.clear(); 
+	
+	std::ifstream file( filename.c_str() , std::ios::in | std::ios::binary ); 
+	if( file.fail() )
+	{
+		std::cout << "Error: could not open cell list " << filename << "!" << std::endl; 
+		return false; 
+	}
+	
+	std::unordered_map<std::string,int> label_indices; 
+	std::vector<char> block; 
+	std::string carry; // incomplete last line of the previous block 
+	bool looking_for_header = true; 
+	int number_of_custom = 0; 
+	int bad_lines = 0; 
+	int number_of_chunks = omp_get_max_threads(); 
+	std::vector<Cell_List_Chunk> chunks( number_of_chunks ); 
+	
+	while( file.good() )
+	{
+		block.assign( carry.begin() , carry.end() ); 
+		block.resize( carry.size() + cell_list_block_bytes ); 
+		file.read( block.data() + carry.size() , cell_list_block_bytes ); 
+		long long n = carry.size() + file.gcount(); 
+		block.resize( n ); 
+		
+		// keep the incomplete last line for the next block 
+		if( file.good() )
+		{
+			long long last = n-1; 
+			while( last >= 0 && block[last] != '\n' )
+			{ last--; }
+			carry.assign( block.begin() + last + 1 , block.end() ); 
+			n = last+1; 
+		}
+		else
+		{ carry.clear(); }
+		block.resize( n ); 
+		block.push_back( '\0' ); // strtod must stop at the end of the block 
+		
+		const char* data = block.data(); 
+		long long first = 0; 
+		
+		// the first non-comment line is a header if it does not start with a number 
+		while( looking_for_header && first < n )
+		{
+			const char* line_end = (const char*) memchr( data + first , '\n' , n - first ); 
+			if( line_end == NULL )
+			{ line_end = data + n; }
+			if( is_blank_or_comment( data + first , line_end ) )
+			{
+				first = line_end - data + 1; 
+				continue; 
+			}
+			looking_for_header = false; 
+			
+			std::vector<const char*> fs; 
+			std::vector<const char*> fe; 
+			split_line( data + first , line_end , fs , fe ); 
+			double value; 
+			if( !parse_number( fs[0] , fe[0] , value ) || std::isnan( value ) )
+			{
+				for( unsigned int j=5 ; j < fs.size() ; j++ )
+				{ list.custom_data_names.push_back( std::string( fs[j] , fe[j] ) ); }
+				number_of_custom = list.custom_data_names.size(); 
+				first = line_end - data + 1; 
+			}
+		}
+		if( first >= n )
+		{ continue; }
+		
+		// split the block into chunks at line boundaries 
+		std::vector<long long> starts( number_of_chunks + 1 , n ); 
+		starts[0] = first; 
+		for( int c=1 ; c < number_of_chunks ; c++ )
+		{
+			long long s = first + ( (n - first) * c ) / number_of_chunks; 
+			if( s < starts[c-1] )
+			{ s = starts[c-1]; }
+			while( s < n && s > first && data[s-1] != '\n' )
+			{ s++; }
+			starts[c] = s; 
+		}
+		
+		#pragma omp parallel for schedule(static,1)
+		for( int c=0 ; c < number_of_chunks ; c++ )
+		{
+			chunks[c].cells.clear(); 
+			chunks[c].label_indices.clear(); 
+			chunks[c].bad_lines = 0; 
+			parse_csv_lines( data + starts[c] , data + starts[c+1] , number_of_custom , chunks[c] ); 
+		}
+		
+		for( int c=0 ; c < number_of_chunks ; c++ )
+		{
+			merge_chunk( chunks[c] , list , label_indices ); 
+			bad_lines += chunks[c].bad_lines; 
+		}
+	}
+	
+	if( bad_lines > 0 )
+	{ std::cout << "Warning: skipped " << bad_lines << " malformed lines in " << filename << std::endl; }
+	
+	return true; 
+}
+
+/* binary reading */ 
+
+static bool read_binary_string( std::ifstream& file, std::string& value )
+{
+	int length = 0; 
+	file.read( (char*) &length , sizeof(int) ); 
+	if( !file.good() || length < 0 )
+	{ return false; }
+	value.resize( length ); 
+	if( length > 0 )
+	{ file.read( &value[0] , length ); }
+	return file.good(); 
+}
+
+bool read_cell_list_binary( std::string filename , Cell_List& list )
+{
+	list.clear(); 
+	
+	std::ifstream file( filename.c_str() , std::ios::in | std::ios::binary ); 
+	if( file.fail() )
+	{
+		std::cout << "Error: could not open cell list " << filename << "!" << std::endl; 
+		return false; 
+	}
+	
+	char magic[8]; 
+	int version = 0; 
+	file.read( magic , 8 ); 
+	file.read( (char*) &version , sizeof(int) ); 
+	if( !file.good() || memcmp( magic , cell_list_magic , 8 ) != 0 || version != cell_list_version )
+	{
+		std::cout << "Error: " << filename << " is not a version " << cell_list_version << " binary cell list!" << std::endl; 
+		return false; 
+	}
+	
+	int number_of_labels = 0; 
+	file.read( (char*) &number_of_labels , sizeof(int) ); 
+	list.type_labels.resize( number_of_labels > 0 ? number_of_labels : 0 ); 
+	bool ok = file.good(); 
+	for( int i=0 ; ok && i < number_of_labels ; i++ )
+	{ ok = read_binary_string( file , list.type_labels[i] ); }
+	
+	int number_of_custom = 0; 
+	file.read( (char*) &number_of_custom , sizeof(int) ); 
+	ok = ok && file.good() && number_of_custom >= 0; 
+	if( ok )
+	{ list.custom_data_names.resize( number_of_custom ); }
+	for( int j=0 ; ok && j < number_of_custom ; j++ )
+	{ ok = read_binary_string( file , list.custom_data_names[j] ); }
+	
+	long long number_of_cells = 0; 
+	file.read( (char*) &number_of_cells , sizeof(long long) ); 
+	if( !ok || !file.good() || number_of_cells < 0 )
+	{
+		std::cout << "Error: could not read the header of " << filename << "!" << std::endl; 
+		list.clear(); 
+		return false; 
+	}
+	
+	list.positions.resize( 3*number_of_cells ); 
+	list.types.resize( number_of_cells ); 
+	list.volumes.resize( number_of_cells ); 
+	list.custom_data.resize( number_of_custom*number_of_cells ); 
+	
+	int record_size = 3*sizeof(double) + sizeof(int) + sizeof(double) + number_of_custom*sizeof(double); 
+	std::vector<char> block; 
+	int bad_types = 0; 
+	
+	for( long long offset = 0 ; offset < number_of_cells ; offset += cell_list_block_records )
+	{
+		long long count = number_of_cells - offset; 
+		if( count > cell_list_block_records )
+		{ count = cell_list_block_records; }
+		
+		block.resize( count*record_size ); 
+		file.read( block.data() , count*record_size ); 
+		if( file.gcount() != count*record_size )
+		{
+			std::cout << "Error: " << filename << " ends after " << offset + file.gcount()/record_size 
+				<< " of " << number_of_cells << " cells!" << std::endl; 
+			list.clear(); 
+			return false; 
+		}
+		
+		#pragma omp parallel for reduction(+:bad_types)
+		for( long long k=0 ; k < count ; k++ )
+		{
+			const char* record = block.data() + k*record_size; 
+			long long i = offset + k; 
+			
+			memcpy( &(list.positions[3*i]) , record , 3*sizeof(double) ); 
+			record += 3*sizeof(double); 
+			memcpy( &(list.types[i]) , record , sizeof(int) ); 
+			record += sizeof(int); 
+			memcpy( &(list.volumes[i]) , record , sizeof(double) ); 
+			record += sizeof(double); 
+			if( number_of_custom > 0 )
+			{ memcpy( &(list.custom_data[number_of_custom*i]) , record , number_of_custom*sizeof(double) ); }
+			
+			if( list.types[i] < 0 || list.types[i] >= number_of_labels )
+			{ bad_types++; }
+		}
+	}
+	
+	if( bad_types > 0 )
+	{
+		std::cout << "Error: " << bad_types << " cells in " << filename << " have an invalid type index!" << std::endl; 
+		list.clear(); 
+		return false; 
+	}
+	
+	return true; 
+}
+
+static bool is_binary_cell_list( std::string filename )
+{
+	return ( filename.size() >= 4 && filename.compare( filename.size()-4 , 4 , ".bin" ) == 0 ); 
+}
+
+bool read_cell_list( std::string filename , Cell_List& list )
+{
+	if( is_binary_cell_list( filename ) )
+	{ return read_cell_list_binary( filename , list ); }
+	return read_cell_list_csv( filename , list ); 
+}
+
+/* writing */ 
+
+// scalar custom variables of the first cell, and each cell's index for each 
+static void get_cell_list_columns( std::vector<std::string>& names, std::vector< std::vector<int> >& indices )
+{
+	names.clear(); 
+	indices.assign( all_cells->size() , std::vector<int>( 0 ) ); 
+	if( all_cells->size() == 0 )
+	{ return; }
+	
+	Custom_Cell_Data& first = (*all_cells)[0]->custom_data; 
+	for( unsigned int j=0 ; j < first.variables.size() ; j++ )
+	{ names.push_back( first.variables[j].name ); }
+	
+	#pragma omp parallel for 
+	for( int i=0 ; i < (int) all_cells->size() ; i++ )
+	{
+		Custom_Cell_Data& data = (*all_cells)[i]->custom_data; 
+		indices[i].resize( names.size() ); 
+		for( unsigned int j=0 ; j < names.size() ; j++ )
+		{
+			if( j < data.variables.size() && data.variables[j].name == names[j] )
+			{ indices[i][j] = j; }
+			else
+			{ indices[i][j] = find_custom_variable_index( data , names[j] ); }
+		}
+	}
+	return; 
+}
+
+void write_cell_list_csv( std::string filename )
+{
+	std::ofstream file( filename.c_str() , std::ios::out | std::ios::binary ); 
+	if( file.fail() )
+	{
+		std::cout << "Error: could not open file " << filename << " for cell list output!" << std::endl; 
+		return; 
+	}
+	
+	std::vector<std::string> names; 
+	std::vector< std::vector<int> > indices; 
+	get_cell_list_columns( names , indices ); 
+	
+	file << "x,y,z,type,volume"; 
+	for( unsigned int j=0 ; j < names.size() ; j++ )
+	{ file << "," << names[j]; }
+	file << "\n"; 
+	
+	// format in per-thread buffers, then write them in thread order 
+	std::vector<std::string> buffers( omp_get_max_threads() ); 
+	int number_of_cells = all_cells->size(); 
+	
+	#pragma omp parallel 
+	{
+		std::string buffer; 
+		char number[32]; 
+		#pragma omp for schedule(static)
+		for( int i=0 ; i < number_of_cells ; i++ )
+		{
+			Cell* pC = (*all_cells)[i]; 
+			for( int k=0 ; k < 3 ; k++ )
+			{
+				snprintf( number , 32 , "%.10g," , pC->position[k] ); 
+				buffer += number; 
+			}
+			buffer += pC->type_name; 
+			snprintf( number , 32 , ",%.10g" , pC->phenotype.volume.total ); 
+			buffer += number; 
+			for( unsigned int j=0 ; j < names.size() ; j++ )
+			{
+				buffer += ","; 
+				if( indices[i][j] >= 0 )
+				{
+					snprintf( number , 32 , "%.10g" , pC->custom_data[ indices[i][j] ] ); 
+					buffer += number; 
+				}
+			}
+			buffer += "\n"; 
+		}
+		buffers[ omp_get_thread_num() ].swap( buffer ); 
+	}
+	
+	for( unsigned int t=0 ; t < buffers.size() ; t++ )
+	{ file.write( buffers[t].data() , buffers[t].size() ); }
+	
+	file.close(); 
+	return; 
+}
+
+static void write_binary_string( std::ofstream& file, std::string& value )
+{
+	int length = value.size(); 
+	file.write( (char*) &length , sizeof(int) ); 
+	file.write( value.data() , length ); 
+	return; 
+}
+
+void write_cell_list_binary( std::string filename )
+{
+	std::ofstream file( filename.c_str() , std::ios::out | std::ios::binary ); 
+	if( file.fail() )
+	{
+		std::cout << "Error: could not open file " << filename << " for cell list output!" << std::endl; 
+		return; 
+	}
+	
+	std::vector<std::string> names; 
+	std::vector< std::vector<int> > indices; 
+	get_cell_list_columns( names , indices ); 
+	
+	// type labels in order of first appearance 
+	int number_of_cells = all_cells->size(); 
+	std::vector<std::string> labels; 
+	std::unordered_map<std::string,int> label_indices; 
+	std::vector<int> types( number_of_cells ); 
+	for( int i=0 ; i < number_of_cells ; i++ )
+	{
+		std::string& label = (*all_cells)[i]->type_name; 
+		std::unordered_map<std::string,int>::iterator it = label_indices.find( label ); 
+		if( it == label_indices.end() )
+		{
+			types[i] = labels.size(); 
+			label_indices[label] = types[i]; 
+			labels.push_back( label ); 
+		}
+		else
+		{ types[i] = it->second; }
+	}
+	
+	int number_of_labels = labels.size(); 
+	int number_of_custom = names.size(); 
+	long long total = number_of_cells; 
+	file.write( cell_list_magic , 8 ); 
+	file.write( (char*) &cell_list_version , sizeof(int) ); 
+	file.write( (char*) &number_of_labels , sizeof(int) ); 
+	for( int i=0 ; i < number_of_labels ; i++ )
+	{ write_binary_string( file , labels[i] ); }
+	file.write( (char*) &number_of_custom , sizeof(int) ); 
+	for( int j=0 ; j < number_of_custom ; j++ )
+	{ write_binary_string( file , names[j] ); }
+	file.write( (char*) &total , sizeof(long long) ); 
+	
+	int record_size = 3*sizeof(double) + sizeof(int) + sizeof(double) + number_of_custom*sizeof(double); 
+	std::vector<char> block; 
+	double missing = std::numeric_limits<double>::quiet_NaN(); 
+	
+	for( int offset = 0 ; offset < number_of_cells ; offset += cell_list_block_records )
+	{
+		int count = number_of_cells - offset; 
+		if( count > cell_list_block_records )
+		{ count = cell_list_block_records; }
+		block.resize( (long long) count*record_size ); 
+		
+		#pragma omp parallel for 
+		for( int k=0 ; k < count ; k++ )
+		{
+			int i = offset + k; 
+			Cell* pC = (*all_cells)[i]; 
+			char* record = block.data() + (long long) k*record_size; 
+			
+			memcpy( record , pC->position.data() , 3*sizeof(double) ); 
+			record += 3*sizeof(double); 
+			memcpy( record , &(types[i]) , sizeof(int) ); 
+			record += sizeof(int); 
+			memcpy( record , &(pC->phenotype.volume.total) , sizeof(double) ); 
+			record += sizeof(double); 
+			for( int j=0 ; j < number_of_custom ; j++ )
+			{
+				double* pValue = ( indices[i][j] >= 0 ) ? &( pC->custom_data[ indices[i][j] ] ) : &missing; 
+				memcpy( record , pValue , sizeof(double) ); 
+				record += sizeof(double); 
+			}
+		}
+		
+		file.write( block.data() , block.size() ); 
+	}
+	
+	file.close(); 
+	return; 
+}
+
+void write_cell_list( std::string filename )
+{
+	BIOFVM_TRACE_SCOPE( "write_cell_list" ); 
+	if( is_binary_cell_list( filename ) )
+	{ write_cell_list_binary( filename ); }
+	else
+	{ write_cell_list_csv( filename ); }
+	return; 
+}
+
+/* creating the cells */ 
+
+std::vector<Cell*> create_cells( Cell_List& list )
+{
+	int number_of_cells = list.size(); 
+	int number_of_labels = list.type_labels.size(); 
+	int number_of_custom = list.custom_data_names.size(); 
+	std::vector<Cell*> output( number_of_cells , NULL ); 
+	
+	std::vector<Cell_Definition*> definitions( number_of_labels , NULL ); 
+	for( int n=0 ; n < number_of_labels ; n++ )
+	{
+		definitions[n] = find_cell_list_definition( list.type_labels[n] ); 
+		if( definitions[n] == NULL )
+		{
+			std::cout << "Error: no cell definition matches cell type " << list.type_labels[n] 
+				<< " in the cell list! Register it with register_cell_definition." << std::endl; 
+			exit(-1); 
+		}
+	}
+	
+	// one create_cells call per type, keeping file order within each type 
+	std::vector< std::vector<int> > members( number_of_labels ); 
+	for( int i=0 ; i < number_of_cells ; i++ )
+	{ members[ list.types[i] ].push_back( i ); }
+	
+	for( int n=0 ; n < number_of_labels ; n++ )
+	{
+		int count = members[n].size(); 
+		if( count == 0 )
+		{ continue; }
+		Cell_Definition& cd = *definitions[n]; 
+		
+		// custom columns this definition knows about 
+		Cell_Batch_Overrides overrides; 
+		std::vector<int> columns; 
+		std::vector<int> indices; 
+		for( int j=0 ; j < number_of_custom ; j++ )
+		{
+			int index = find_custom_variable_index( cd.custom_data , list.custom_data_names[j] ); 
+			if( index < 0 )
+			{
+				std::cout << "Warning: cell definition " << cd.name << " has no custom variable " 
+					<< list.custom_data_names[j] << "; ignoring that column for its cells." << std::endl; 
+				continue; 
+			}
+			columns.push_back( j ); 
+			indices.push_back( index ); 
+			overrides.custom_data_names.push_back( list.custom_data_names[j] ); 
+		}
+		
+		std::vector< std::vector<double> > positions( count , std::vector<double>( 3 , 0.0 ) ); 
+		overrides.volumes.resize( count ); 
+		if( columns.size() > 0 )
+		{ overrides.custom_data_values.assign( count , std::vector<double>( columns.size() , 0.0 ) ); }
+		
+		#pragma omp parallel for 
+		for( int k=0 ; k < count ; k++ )
+		{
+			int i = members[n][k]; 
+			positions[k][0] = list.positions[3*i]; 
+			positions[k][1] = list.positions[3*i+1]; 
+			positions[k][2] = list.positions[3*i+2]; 
+			
+			double volume = list.volumes[i]; 
+			overrides.volumes[k] = ( volume > 0 ) ? volume : cd.phenotype.volume.total; 
+			
+			for( unsigned int c=0 ; c < columns.size() ; c++ )
+			{
+				double value = list.custom_data[ number_of_custom*i + columns[c] ]; 
+				overrides.custom_data_values[k][c] = std::isnan( value ) ? cd.custom_data.variables[ indices[c] ].value : value; 
+			}
+		}
+		
+		// skip the (serial) volume updates if every cell has the default volume 
+		bool default_volumes = true; 
+		for( int k=0 ; default_volumes && k < count ; k++ )
+		{ default_volumes = ( overrides.volumes[k] == cd.phenotype.volume.total ); }
+		if( default_volumes )
+		{ overrides.volumes.clear(); }
+		
+		std::vector<Cell*> cells = create_cells( cd , positions , overrides ); 
+		for( int k=0 ; k < count ; k++ )
+		{ output[ members[n][k] ] = cells[k]; }
+	}
+	
+	return output; 
+}
+
+std::vector<Cell*> load_cells( std::string filename )
+{
+	Cell_List list; 
+	if( !read_cell_list( filename , list ) )
+	{
+		std::cout << "Error: could not load cells from " << filename << "!" << std::endl; 
+		exit(-1); 
+	}
+	
+	std::vector<Cell*> output = create_cells( list ); 
+	std::cout << "Loaded " << output.size() << " cells from " << filename << std::endl; 
+	return output; 
+}
+
+};
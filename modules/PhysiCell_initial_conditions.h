@@ -0,0 +1,140 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __PhysiCell_initial_conditions_h__
+#define __PhysiCell_initial_conditions_h__
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../core/PhysiCell.h"
+
+namespace PhysiCell{
+
+/* 
+ Precomputed initial cell populations (e.g., a previous run's final state, 
+ or cells segmented from imaging), loaded into the bulk creation path 
+ (create_cells). 
+ 
+ CSV:    an optional header line, then one cell per line: 
+ 
+            x,y,z,type,volume,custom_1,custom_2,... 
+ 
+         The header names the custom data columns (without a header there 
+         are none). type is the name or type number of a registered 
+         Cell_Definition (see register_cell_definition). An empty 
+         or non-positive volume, or an empty custom value, means "use the 
+         cell definition's value". Lines starting with # are ignored. 
+ 
+ binary: (native endianness) 
+         char[8]  "PCCELLS" 
+         int      version (1) 
+         int      number of type labels, then for each: int length, chars 
+         int      number of custom columns, then for each: int length, chars 
+         long long number of cells 
+         records: double x,y,z; int type label index; double volume; double custom[] 
+                  (36 + 8*number of custom columns bytes per cell; NaN custom 
+                  values mean "use the cell definition's value") 
+ 
+ Files are read in fixed-size blocks, and each block is parsed in parallel. 
+*/
+
+class Cell_List
+{
+ private:
+ public:
+	std::vector<std::string> type_labels; // distinct type names (or numbers) 
+	std::vector<std::string> custom_data_names; 
+	
+	std::vector<double> positions; // x,y,z per cell 
+	std::vector<int> types; // index into type_labels 
+	std::vector<double> volumes; 
+	std::vector<double> custom_data; // row-major: custom_data_names.size() values per cell 
+	
+	int size( void ); 
+	void clear( void ); 
+	
+	Cell_List(); 
+}; 
+
+bool read_cell_list_csv( std::string filename , Cell_List& list ); 
+bool read_cell_list_binary( std::string filename , Cell_List& list ); 
+bool read_cell_list( std::string filename , Cell_List& list ); // .bin files are binary, all others CSV 
+
+// write all_cells in the same layouts (scalar custom data of the first cell) 
+void write_cell_list_csv( std::string filename ); 
+void write_cell_list_binary( std::string filename ); 
+void write_cell_list( std::string filename ); 
+
+std::vector<Cell*> create_cells( Cell_List& list ); 
+std::vector<Cell*> load_cells( std::string filename ); // read_cell_list + create_cells 
+
+};
+
+#endif
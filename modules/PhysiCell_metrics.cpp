@@ -0,0 +1,316 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "./PhysiCell_metrics.h"
+
+#include <cmath>
+#include <limits>
+
+namespace PhysiCell{
+
+PhysiCell_metrics_options_struct PhysiCell_metrics_options;
+
+Metrics_Snapshot::Metrics_Snapshot()
+{
+	time = 0.0; 
+	total_cells = 0; 
+	total_births = 0; 
+	total_deaths = 0; 
+	centroid.assign( 3 , 0.0 ); 
+	return; 
+}
+
+void compute_metrics( double t, Microenvironment& M, Metrics_Snapshot& snapshot )
+{
+	snapshot.time = t; 
+	snapshot.total_cells = all_cells->size(); 
+	
+	Cell_Container* pContainer = (Cell_Container*) M.agent_container; 
+	snapshot.total_births = pContainer->total_divisions; 
+	snapshot.total_deaths = pContainer->total_deaths; 
+	
+	snapshot.cells_per_type.clear(); 
+	snapshot.cells_per_phase.clear(); 
+	
+	// counts and centroid: each thread tallies privately, then merges 
+	
+	double cx = 0.0; 
+	double cy = 0.0; 
+	double cz = 0.0; 
+	int number_of_cells = all_cells->size(); 
+	
+	#pragma omp parallel reduction(+:cx,cy,cz)
+	{
+		std::map<int,int> type_counts; 
+		std::map<int,int> phase_counts; 
+		std::map<int,std::string> phase_names; 
+		
+		#pragma omp for 
+		for( int i=0 ; i < number_of_cells ; i++ )
+		{
+			Cell* pC = (*all_cells)[i]; 
+			cx += pC->position[0]; 
+			cy += pC->position[1]; 
+			cz += pC->position[2]; 
+			
+			type_counts[ pC->type ]++; 
+			if( pC->phenotype.cycle.pCycle_Model )
+			{
+				Phase& phase = pC->phenotype.cycle.current_phase(); 
+				if( phase_counts[ phase.code ]++ == 0 )
+				{ phase_names[ phase.code ] = phase.name; }
+			}
+		}
+		
+		#pragma omp critical(compute_metrics_merge)
+		{
+			for( std::map<int,int>::iterator it = type_counts.begin() ; it != type_counts.end() ; ++it )
+			{ snapshot.cells_per_type[ it->first ] += it->second; }
+			for( std::map<int,int>::iterator it = phase_counts.begin() ; it != phase_counts.end() ; ++it )
+			{ snapshot.cells_per_phase[ it->first ] += it->second; }
+			snapshot.phase_names.insert( phase_names.begin() , phase_names.end() ); 
+		}
+	}
+	
+	snapshot.centroid.assign( 3 , 0.0 ); 
+	if( number_of_cells > 0 )
+	{
+		snapshot.centroid[0] = cx / (double) number_of_cells; 
+		snapshot.centroid[1] = cy / (double) number_of_cells; 
+		snapshot.centroid[2] = cz / (double) number_of_cells; 
+	}
+	
+	// radial profile about the centroid 
+	
+	snapshot.radial_density.clear(); 
+	if( PhysiCell_metrics_options.compute_radial_profile == true && PhysiCell_metrics_options.radial_bins > 0 )
+	{
+		int bins = PhysiCell_metrics_options.radial_bins; 
+		double bin_width = PhysiCell_metrics_options.radial_bin_width; 
+		bool is_2D = default_microenvironment_options.simulate_2D; 
+		std::vector<double> counts( bins , 0.0 ); 
+		
+		#pragma omp parallel 
+		{
+			std::vector<double> private_counts( bins , 0.0 ); 
+			#pragma omp for 
+			for( int i=0 ; i < number_of_cells ; i++ )
+			{
+				Cell* pC = (*all_cells)[i]; 
+				double dx = pC->position[0] - snapshot.centroid[0]; 
+				double dy = pC->position[1] - snapshot.centroid[1]; 
+				double dz = is_2D ? 0.0 : pC->position[2] - snapshot.centroid[2]; 
+				int n = (int) floor( sqrt( dx*dx + dy*dy + dz*dz ) / bin_width ); 
+				if( n < bins )
+				{ private_counts[n] += 1.0; }
+			}
+			#pragma omp critical(compute_metrics_merge)
+			{ counts += private_counts; }
+		}
+		
+		snapshot.radial_density.resize( bins ); 
+		for( int n=0 ; n < bins ; n++ )
+		{
+			double r0 = n*bin_width; 
+			double r1 = r0 + bin_width; 
+			double measure = is_2D ? PhysiCell_constants::pi*( r1*r1 - r0*r0 ) 
+				: 4.0/3.0*PhysiCell_constants::pi*( r1*r1*r1 - r0*r0*r0 ); 
+			snapshot.radial_density[n] = counts[n] / measure; 
+		}
+	}
+	
+	// substrate statistics (volume-weighted mean) 
+	
+	int number_of_densities = M.number_of_densities(); 
+	snapshot.substrate_min.clear(); 
+	snapshot.substrate_max.clear(); 
+	snapshot.substrate_mean.clear(); 
+	if( PhysiCell_metrics_options.compute_substrate_statistics == true )
+	{
+		int number_of_voxels = M.number_of_voxels(); 
+		for( int k=0 ; k < number_of_densities ; k++ )
+		{
+			double min_value = std::numeric_limits<double>::max(); 
+			double max_value = -std::numeric_limits<double>::max(); 
+			double total = 0.0; 
+			double total_volume = 0.0; 
+			
+			#pragma omp parallel for reduction(min:min_value) reduction(max:max_value) reduction(+:total,total_volume)
+			for( int n=0 ; n < number_of_voxels ; n++ )
+			{
+				double value = M.density_vector(n)[k]; 
+				double volume = M.mesh.voxel_volume( n ); 
+				if( value < min_value )
+				{ min_value = value; }
+				if( value > max_value )
+				{ max_value = value; }
+				total += value*volume; 
+				total_volume += volume; 
+			}
+			
+			snapshot.substrate_min.push_back( min_value ); 
+			snapshot.substrate_max.push_back( max_value ); 
+			snapshot.substrate_mean.push_back( total / ( total_volume + 1e-300 ) ); 
+		}
+	}
+	
+	return; 
+}
+
+/* the metrics stream */ 
+
+static std::ofstream metrics_file; 
+static Metrics_Snapshot metrics_snapshot; 
+static int metrics_last_total_births = 0; 
+static int metrics_last_total_deaths = 0; 
+
+static void write_metrics_record( double t, int quantity, int key, std::string label, double value )
+{
+	if( PhysiCell_metrics_options.binary == true )
+	{
+		metrics_file.write( (char*) &t , sizeof(double) ); 
+		metrics_file.write( (char*) &quantity , sizeof(int) ); 
+		metrics_file.write( (char*) &key , sizeof(int) ); 
+		metrics_file.write( (char*) &value , sizeof(double) ); 
+		return; 
+	}
+	
+	static const char* quantity_names[9] = { "cells", "births", "deaths", "cells_of_type", "cells_in_phase", 
+		"radial_density", "substrate_min", "substrate_max", "substrate_mean" }; 
+	metrics_file << t << "," << quantity_names[quantity] << "," << label << "," << value << "\n"; 
+	return; 
+}
+
+bool open_metrics_stream( std::string filename )
+{
+	if( PhysiCell_metrics_options.binary == true )
+	{ metrics_file.open( filename.c_str() , std::ios::out | std::ios::binary ); }
+	else
+	{ metrics_file.open( filename.c_str() , std::ios::out ); }
+	
+	if( metrics_file.fail() )
+	{
+		std::cout << "Error: could not open file " << filename << " for metrics output!" << std::endl; 
+		return false; 
+	}
+	
+	if( PhysiCell_metrics_options.binary == false )
+	{
+		metrics_file.precision( 10 ); 
+		metrics_file << "time,quantity,label,value\n"; 
+	}
+	
+	metrics_last_total_births = 0; 
+	metrics_last_total_deaths = 0; 
+	return true; 
+}
+
+void write_metrics( double t, Microenvironment& M )
+{
+	BIOFVM_TRACE_SCOPE( "write_metrics" ); 
+	if( !metrics_file.is_open() )
+	{ return; }
+	
+	compute_metrics( t , M , metrics_snapshot ); 
+	Metrics_Snapshot& S = metrics_snapshot; 
+	
+	write_metrics_record( t, metric_total_cells, 0, "all", S.total_cells ); 
+	write_metrics_record( t, metric_births, 0, "all", S.total_births - metrics_last_total_births ); 
+	write_metrics_record( t, metric_deaths, 0, "all", S.total_deaths - metrics_last_total_deaths ); 
+	metrics_last_total_births = S.total_births; 
+	metrics_last_total_deaths = S.total_deaths; 
+	
+	for( std::map<int,int>::iterator it = S.cells_per_type.begin() ; it != S.cells_per_type.end() ; ++it )
+	{ write_metrics_record( t, metric_cells_of_type, it->first, std::to_string( it->first ), it->second ); }
+	for( std::map<int,int>::iterator it = S.cells_per_phase.begin() ; it != S.cells_per_phase.end() ; ++it )
+	{ write_metrics_record( t, metric_cells_in_phase, it->first, S.phase_names[it->first], it->second ); }
+	
+	for( unsigned int n=0 ; n < S.radial_density.size() ; n++ )
+	{
+		std::string label = std::to_string( (int) round( (n+0.5)*PhysiCell_metrics_options.radial_bin_width ) ); 
+		write_metrics_record( t, metric_radial_density, n, label, S.radial_density[n] ); 
+	}
+	
+	for( unsigned int k=0 ; k < S.substrate_mean.size() ; k++ )
+	{
+		write_metrics_record( t, metric_substrate_min, k, M.density_names[k], S.substrate_min[k] ); 
+		write_metrics_record( t, metric_substrate_max, k, M.density_names[k], S.substrate_max[k] ); 
+		write_metrics_record( t, metric_substrate_mean, k, M.density_names[k], S.substrate_mean[k] ); 
+	}
+	
+	metrics_file.flush(); 
+	return; 
+}
+
+void close_metrics_stream( void )
+{
+	if( metrics_file.is_open() )
+	{ metrics_file.close(); }
+	return; 
+}
+
+};
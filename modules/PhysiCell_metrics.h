@@ -0,0 +1,151 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __PhysiCell_metrics_h__
+#define __PhysiCell_metrics_h__
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "../core/PhysiCell.h"
+
+namespace PhysiCell{
+
+/* 
+ In-situ summary metrics, computed directly from the live simulation state 
+ (no copies of the microenvironment or the cells) and appended to a time 
+ series. Each record is (time, quantity, key, value): 
+ 
+ CSV:    time,quantity,label,value     (one line per record) 
+ binary: double time, int quantity, int key, double value   (24 bytes per record, native endianness) 
+
+ key is the cell type, the cycle phase code, the radial bin, or the substrate index. 
+ The births and deaths records count those since the previous record, the 
+ differences of the running totals in Metrics_Snapshot (total_births and 
+ total_deaths, which count from the start of the simulation). 
+*/
+
+enum PhysiCell_metric_quantity { 
+	metric_total_cells = 0, 
+	metric_births = 1, 
+	metric_deaths = 2, 
+	metric_cells_of_type = 3, 
+	metric_cells_in_phase = 4, 
+	metric_radial_density = 5, 
+	metric_substrate_min = 6, 
+	metric_substrate_max = 7, 
+	metric_substrate_mean = 8 }; 
+
+struct PhysiCell_metrics_options_struct {
+	bool binary = false; 
+	
+	// radial cell density profile about the cell centroid (cells per cubic micron, 
+	// or per square micron in 2-D) 
+	bool compute_radial_profile = true; 
+	double radial_bin_width = 20.0; 
+	int radial_bins = 25; 
+	
+	bool compute_substrate_statistics = true; 
+}; 
+
+extern PhysiCell_metrics_options_struct PhysiCell_metrics_options;
+
+class Metrics_Snapshot
+{
+ private:
+ public:
+	double time; 
+	int total_cells; 
+	int total_births; // since the start of the simulation 
+	int total_deaths; // since the start of the simulation 
+
+	std::map<int,int> cells_per_type; 
+	std::map<int,int> cells_per_phase; // keyed by phase code 
+	std::map<int,std::string> phase_names; 
+	
+	std::vector<double> centroid; 
+	std::vector<double> radial_density; 
+	
+	std::vector<double> substrate_min; 
+	std::vector<double> substrate_max; 
+	std::vector<double> substrate_mean; 
+	
+	Metrics_Snapshot(); 
+}; 
+
+void compute_metrics( double t, Microenvironment& M, Metrics_Snapshot& snapshot ); 
+
+bool open_metrics_stream( std::string filename ); 
+void write_metrics( double t, Microenvironment& M ); 
+void close_metrics_stream( void ); 
+
+};
+
+#endif
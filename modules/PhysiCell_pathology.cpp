@@ -363,6 +363,7 @@ std::string formatted_minutes_to_DDHHMM( double minutes )
 
 void SVG_plot( std::string filename , Microenvironment& M, double z_slice , double time, std::vector<std::string> (*cell_coloring_function)(Cell*) )
 {
+	BIOFVM_TRACE_SCOPE( "SVG_plot" ); 
 	double X_lower = M.mesh.bounding_box[0];
 	double X_upper = M.mesh.bounding_box[3];
  
@@ -0,0 +1,685 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include "./PhysiCell_raster.h"
+
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+
+namespace PhysiCell{
+
+PhysiCell_raster_options_struct PhysiCell_raster_options;
+
+Raster_Image::Raster_Image()
+{
+	width = 0; 
+	height = 0; 
+	pixels.resize( 0 ); 
+	return; 
+}
+
+void Raster_Image::resize( int new_width, int new_height, std::vector<unsigned char>& color )
+{
+	width = new_width; 
+	height = new_height; 
+	pixels.resize( 3*width*height ); 
+	
+	#pragma omp parallel for 
+	for( int n=0 ; n < width*height ; n++ )
+	{
+		pixels[3*n] = color[0]; 
+		pixels[3*n+1] = color[1]; 
+		pixels[3*n+2] = color[2]; 
+	}
+	return; 
+}
+
+unsigned char* Raster_Image::pixel( int i, int j )
+{ return &( pixels[ 3*(j*width+i) ] ); }
+
+bool Raster_Image::write_PPM( std::string filename )
+{
+	FILE* fp = fopen( filename.c_str() , "wb" ); 
+	if( !fp )
+	{
+		std::cout << "Error: could not open file " << filename << " for PPM writing!" << std::endl; 
+		return false; 
+	}
+	fprintf( fp , "P6\n%d %d\n255\n" , width, height ); 
+	fwrite( (char*) pixels.data() , sizeof(unsigned char) , pixels.size() , fp ); 
+	fclose( fp ); 
+	return true; 
+}
+
+/* minimal PNG (zlib / deflate) encoder */ 
+
+static unsigned int PNG_crc32( const unsigned char* data, size_t length, unsigned int crc )
+{
+	static std::vector<unsigned int> table; 
+	#pragma omp critical(PNG_crc32_table)
+	{
+		if( table.size() == 0 )
+		{
+			table.resize( 256 ); 
+			for( unsigned int n=0 ; n < 256 ; n++ )
+			{
+				unsigned int c = n; 
+				for( int k=0 ; k < 8 ; k++ )
+				{
+					if( c & 1 )
+					{ c = 0xEDB88320u ^ (c >> 1); }
+					else
+					{ c = c >> 1; }
+				}
+				table[n] = c; 
+			}
+		}
+	}
+	
+	crc = crc ^ 0xFFFFFFFFu; 
+	for( size_t n=0 ; n < length ; n++ )
+	{ crc = table[ (crc ^ data[n]) & 0xFF ] ^ (crc >> 8); }
+	return crc ^ 0xFFFFFFFFu; 
+}
+
+static unsigned int PNG_adler32( const std::vector<unsigned char>& data )
+{
+	unsigned int a = 1; 
+	unsigned int b = 0; 
+	for( size_t n=0 ; n < data.size() ; n++ )
+	{
+		a = (a + data[n]) % 65521; 
+		b = (b + a) % 65521; 
+	}
+	return (b << 16) | a; 
+}
+
+static void PNG_push_uint32( std::vector<unsigned char>& out, unsigned int value )
+{
+	out.push_back( (value >> 24) & 0xFF ); 
+	out.push_back( (value >> 16) & 0xFF ); 
+	out.push_back( (value >> 8) & 0xFF ); 
+	out.push_back( value & 0xFF ); 
+	return; 
+}
+
+static void PNG_write_chunk( FILE* fp, const char* type, std::vector<unsigned char>& data )
+{
+	std::vector<unsigned char> buffer; 
+	buffer.reserve( data.size() + 12 ); 
+	PNG_push_uint32( buffer, data.size() ); 
+	buffer.insert( buffer.end() , type , type+4 ); 
+	buffer.insert( buffer.end() , data.begin() , data.end() ); 
+	PNG_push_uint32( buffer, PNG_crc32( buffer.data()+4 , data.size()+4 , 0 ) ); 
+	fwrite( (char*) buffer.data() , sizeof(unsigned char) , buffer.size() , fp ); 
+	return; 
+}
+
+class Deflate_Bit_Writer
+{
+ public:
+	std::vector<unsigned char>* pOut; 
+	unsigned int bit_buffer; 
+	int bit_count; 
+	
+	Deflate_Bit_Writer( std::vector<unsigned char>& out )
+	{ pOut = &out; bit_buffer = 0; bit_count = 0; }
+	
+	// deflate packs values starting with the least significant bit 
+	void write_bits( unsigned int value, int bits )
+	{
+		bit_buffer |= ( value << bit_count ); 
+		bit_count += bits; 
+		while( bit_count >= 8 )
+		{
+			pOut->push_back( bit_buffer & 0xFF ); 
+			bit_buffer >>= 8; 
+			bit_count -= 8; 
+		}
+		return; 
+	}
+	
+	// ... but Huffman codes starting with the most significant bit 
+	void write_code( unsigned int code, int bits )
+	{
+		unsigned int reversed = 0; 
+		for( int k=0 ; k < bits ; k++ )
+		{ reversed |= ( (code >> k) & 1 ) << (bits-1-k); }
+		write_bits( reversed, bits ); 
+		return; 
+	}
+	
+	void write_literal( unsigned int symbol )
+	{
+		if( symbol < 144 )
+		{ write_code( 0x30 + symbol , 8 ); return; }
+		if( symbol < 256 )
+		{ write_code( 0x190 + symbol - 144 , 9 ); return; }
+		if( symbol < 280 )
+		{ write_code( symbol - 256 , 7 ); return; }
+		write_code( 0xC0 + symbol - 280 , 8 ); 
+		return; 
+	}
+	
+	void flush( void )
+	{
+		if( bit_count > 0 )
+		{ pOut->push_back( bit_buffer & 0xFF ); }
+		bit_buffer = 0; 
+		bit_count = 0; 
+		return; 
+	}
+}; 
+
+static void deflate_stored( const std::vector<unsigned char>& data, std::vector<unsigned char>& out )
+{
+	size_t n = 0; 
+	do
+	{
+		size_t block_size = data.size() - n; 
+		if( block_size > 65535 )
+		{ block_size = 65535; }
+		bool final_block = ( n + block_size == data.size() ); 
+		
+		out.push_back( final_block ? 1 : 0 ); 
+		out.push_back( block_size & 0xFF ); 
+		out.push_back( (block_size >> 8) & 0xFF ); 
+		out.push_back( ~block_size & 0xFF ); 
+		out.push_back( (~block_size >> 8) & 0xFF ); 
+		out.insert( out.end() , data.begin()+n , data.begin()+n+block_size ); 
+		n += block_size; 
+	}
+	while( n < data.size() ); 
+	return; 
+}
+
+// A single fixed-Huffman block. Matches are only searched at two distances: 
+// the previous pixel and the pixel directly above, which captures the flat 
+// discs and backgrounds that make up a snapshot. 
+static void deflate_fixed( const std::vector<unsigned char>& data, std::vector<unsigned char>& out, 
+	unsigned int pixel_distance, unsigned int row_distance )
+{
+	static const unsigned int length_base[29] = {3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258}; 
+	static const unsigned int length_extra[29] = {0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0}; 
+	static const unsigned int distance_base[30] = {1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577}; 
+	static const unsigned int distance_extra[30] = {0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13}; 
+
+	Deflate_Bit_Writer writer( out ); 
+	writer.write_bits( 1 , 1 ); // final block 
+	writer.write_bits( 1 , 2 ); // fixed Huffman codes 
+
+	unsigned int candidates[2] = { pixel_distance , row_distance }; 
+	size_t size = data.size(); 
+	size_t n = 0; 
+	while( n < size )
+	{
+		unsigned int best_length = 0; 
+		unsigned int best_distance = 0; 
+		for( int c=0 ; c < 2 ; c++ )
+		{
+			unsigned int d = candidates[c]; 
+			if( d == 0 || d > 32768 || d > n )
+			{ continue; }
+			unsigned int length = 0; 
+			while( length < 258 && n+length < size && data[n+length] == data[n+length-d] )
+			{ length++; }
+			if( length > best_length )
+			{ best_length = length; best_distance = d; }
+		}
+		
+		if( best_length < 3 )
+		{
+			writer.write_literal( data[n] ); 
+			n++; 
+			continue; 
+		}
+		
+		int code = 28; 
+		while( length_base[code] > best_length )
+		{ code--; }
+		writer.write_literal( 257 + code ); 
+		writer.write_bits( best_length - length_base[code] , length_extra[code] ); 
+		
+		code = 29; 
+		while( distance_base[code] > best_distance )
+		{ code--; }
+		writer.write_code( code , 5 ); 
+		writer.write_bits( best_distance - distance_base[code] , distance_extra[code] ); 
+		
+		n += best_length; 
+	}
+	writer.write_literal( 256 ); // end of block 
+	writer.flush(); 
+	return; 
+}
+
+bool Raster_Image::write_PNG( std::string filename , int compression )
+{
+	FILE* fp = fopen( filename.c_str() , "wb" ); 
+	if( !fp )
+	{
+		std::cout << "Error: could not open file " << filename << " for PNG writing!" << std::endl; 
+		return false; 
+	}
+	
+	// scanlines, each prefixed by filter type 0 (none) 
+	int row_size = 3*width + 1; 
+	std::vector<unsigned char> scanlines( row_size * height ); 
+	#pragma omp parallel for 
+	for( int j=0 ; j < height ; j++ )
+	{
+		scanlines[ j*row_size ] = 0; 
+		memcpy( &(scanlines[ j*row_size + 1 ]) , &(pixels[ 3*j*width ]) , 3*width ); 
+	}
+	
+	std::vector<unsigned char> zlib_data; 
+	zlib_data.push_back( 0x78 ); 
+	zlib_data.push_back( 0x01 ); 
+	if( compression == 0 )
+	{ deflate_stored( scanlines , zlib_data ); }
+	else
+	{ deflate_fixed( scanlines , zlib_data , 3 , row_size ); }
+	PNG_push_uint32( zlib_data , PNG_adler32( scanlines ) ); 
+	
+	static const unsigned char signature[8] = {137,80,78,71,13,10,26,10}; 
+	fwrite( (char*) signature , sizeof(unsigned char) , 8 , fp ); 
+	
+	std::vector<unsigned char> header; 
+	PNG_push_uint32( header , width ); 
+	PNG_push_uint32( header , height ); 
+	header.push_back( 8 ); // bit depth 
+	header.push_back( 2 ); // truecolor RGB 
+	header.push_back( 0 ); // deflate 
+	header.push_back( 0 ); // adaptive filtering 
+	header.push_back( 0 ); // no interlace 
+	PNG_write_chunk( fp , "IHDR" , header ); 
+	PNG_write_chunk( fp , "IDAT" , zlib_data ); 
+	std::vector<unsigned char> empty; 
+	PNG_write_chunk( fp , "IEND" , empty ); 
+	
+	fclose( fp ); 
+	return true; 
+}
+
+bool parse_rgb_string( std::string& input , unsigned char* output )
+{
+	int R, G, B; 
+	if( sscanf( input.c_str() , " rgb ( %d , %d , %d )" , &R, &G, &B ) != 3 )
+	{ return false; }
+	output[0] = (unsigned char) std::max( 0 , std::min( 255, R ) ); 
+	output[1] = (unsigned char) std::max( 0 , std::min( 255, G ) ); 
+	output[2] = (unsigned char) std::max( 0 , std::min( 255, B ) ); 
+	return true; 
+}
+
+void raster_colormap( double value, double min_value, double max_value, unsigned char* output )
+{
+	static const double stops[5][3] = { {0,0,255}, {0,255,255}, {0,255,0}, {255,255,0}, {255,0,0} }; 
+	
+	double s = 0.0; 
+	if( max_value > min_value )
+	{ s = (value - min_value) / (max_value - min_value); }
+	if( s < 0.0 || s != s )
+	{ s = 0.0; }
+	if( s > 1.0 )
+	{ s = 1.0; }
+	
+	s *= 4.0; 
+	int n = (int) s; 
+	if( n > 3 )
+	{ n = 3; }
+	s -= n; 
+	for( int k=0 ; k < 3 ; k++ )
+	{ output[k] = (unsigned char) round( (1.0-s)*stops[n][k] + s*stops[n+1][k] ); }
+	return; 
+}
+
+struct Raster_Disc
+{
+	double x; // pixel coordinates 
+	double y; 
+	double radius_squared; 
+	double inner_radius_squared; 
+	int row_min; 
+	int row_max; 
+	bool has_fill; 
+	bool has_outline; 
+	unsigned char fill[3]; 
+	unsigned char outline[3]; 
+}; 
+
+static void add_raster_disc( std::vector<Raster_Disc>& discs, double x, double y, double radius, double outline_thickness, 
+	std::string& fill_color, std::string& outline_color, int height )
+{
+	Raster_Disc disc; 
+	disc.x = x; 
+	disc.y = y; 
+	disc.radius_squared = radius*radius; 
+	double inner_radius = radius - outline_thickness; 
+	if( inner_radius < 0.0 )
+	{ inner_radius = 0.0; }
+	disc.inner_radius_squared = inner_radius*inner_radius; 
+	disc.has_fill = parse_rgb_string( fill_color , disc.fill ); 
+	disc.has_outline = parse_rgb_string( outline_color , disc.outline ); 
+	if( !disc.has_fill && !disc.has_outline )
+	{ return; }
+	
+	disc.row_min = (int) floor( y - radius ); 
+	disc.row_max = (int) ceil( y + radius ); 
+	if( disc.row_min < 0 )
+	{ disc.row_min = 0; }
+	if( disc.row_max > height-1 )
+	{ disc.row_max = height-1; }
+	if( disc.row_min > disc.row_max )
+	{ return; }
+	
+	discs.push_back( disc ); 
+	return; 
+}
+
+void raster_plot( Raster_Image& image, Microenvironment& M, double z_slice, std::vector<std::string> (*cell_coloring_function)(Cell*) )
+{
+	double X_lower = M.mesh.bounding_box[0];
+	double X_upper = M.mesh.bounding_box[3];
+	double Y_lower = M.mesh.bounding_box[1]; 
+	double Y_upper = M.mesh.bounding_box[4]; 
+
+	double plot_width = X_upper - X_lower; 
+	double plot_height = Y_upper - Y_lower; 
+	
+	int width = PhysiCell_raster_options.width; 
+	double pixel_size = plot_width / (double) width; 
+	int height = (int) ceil( plot_height / pixel_size ); 
+	
+	image.resize( width, height, PhysiCell_raster_options.background_color ); 
+	
+	// substrate heat map (one nearest-voxel lookup per pixel) 
+	
+	if( PhysiCell_raster_options.plot_substrate == true && 
+		PhysiCell_raster_options.substrate_index >= 0 && 
+		PhysiCell_raster_options.substrate_index < M.number_of_densities() )
+	{
+		int n = PhysiCell_raster_options.substrate_index; 
+		std::vector<double> position = { X_lower, Y_lower, z_slice }; 
+		unsigned int k = M.mesh.nearest_cartesian_indices( position )[2]; 
+		
+		std::vector<unsigned int> column_voxel( width ); 
+		for( int i=0 ; i < width ; i++ )
+		{
+			position[0] = X_lower + (i+0.5)*pixel_size; 
+			column_voxel[i] = M.mesh.nearest_cartesian_indices( position )[0]; 
+		}
+		
+		#pragma omp parallel for 
+		for( int j=0 ; j < height ; j++ )
+		{
+			std::vector<double> row_position = { X_lower, Y_upper - (j+0.5)*pixel_size, z_slice }; 
+			unsigned int voxel_j = M.mesh.nearest_cartesian_indices( row_position )[1]; 
+			for( int i=0 ; i < width ; i++ )
+			{
+				int voxel = M.mesh.voxel_index( column_voxel[i], voxel_j , k ); 
+				raster_colormap( M.density_vector(voxel)[n] , PhysiCell_raster_options.substrate_min , 
+					PhysiCell_raster_options.substrate_max, image.pixel(i,j) ); 
+			}
+		}
+	}
+	
+	// gather the discs. The coloring functions return static storage, so this is serial. 
+	
+	std::vector<Raster_Disc> discs; 
+	discs.reserve( 2*all_cells->size() ); 
+	double outline_thickness = PhysiCell_raster_options.outline_thickness / pixel_size; 
+	if( outline_thickness < 1.0 )
+	{ outline_thickness = 1.0; }
+	
+	std::vector<std::string> Colors; 
+	for( unsigned int i=0 ; i < all_cells->size() ; i++ )
+	{
+		Cell* pC = (*all_cells)[i]; 
+		double r = pC->phenotype.geometry.radius; 
+		double rn = pC->phenotype.geometry.nuclear_radius; 
+		double z = fabs( (pC->position)[2] - z_slice ); 
+		if( z >= r )
+		{ continue; }
+		
+		Colors = cell_coloring_function( pC ); 
+		
+		double x = ( (pC->position)[0] - X_lower ) / pixel_size; 
+		double y = ( Y_upper - (pC->position)[1] ) / pixel_size; 
+		
+		add_raster_disc( discs, x, y, sqrt( r*r - z*z ) / pixel_size , outline_thickness, Colors[0], Colors[1], height ); 
+		if( z < rn && PhysiCell_raster_options.plot_nuclei == true )
+		{ add_raster_disc( discs, x, y, sqrt( rn*rn - z*z ) / pixel_size , outline_thickness, Colors[2], Colors[3], height ); }
+	}
+	
+	// bin the discs into bands of rows so that each thread owns its pixels, 
+	// then paint each band in the original order (same stacking as SVG_plot) 
+	
+	int band_height = 16; 
+	int number_of_bands = (height + band_height - 1) / band_height; 
+	std::vector< std::vector<int> > bands( number_of_bands ); 
+	for( unsigned int d=0 ; d < discs.size() ; d++ )
+	{
+		for( int b = discs[d].row_min / band_height ; b <= discs[d].row_max / band_height ; b++ )
+		{ bands[b].push_back( d ); }
+	}
+	
+	#pragma omp parallel for schedule(dynamic)
+	for( int b=0 ; b < number_of_bands ; b++ )
+	{
+		int band_start = b*band_height; 
+		int band_end = std::min( band_start + band_height , height ) - 1; 
+		for( unsigned int m=0 ; m < bands[b].size() ; m++ )
+		{
+			Raster_Disc& disc = discs[ bands[b][m] ]; 
+			int j_start = std::max( band_start , disc.row_min ); 
+			int j_end = std::min( band_end , disc.row_max ); 
+			for( int j=j_start ; j <= j_end ; j++ )
+			{
+				double dy = (j+0.5) - disc.y; 
+				double half_width_squared = disc.radius_squared - dy*dy; 
+				if( half_width_squared < 0.0 )
+				{ continue; }
+				double half_width = sqrt( half_width_squared ); 
+				int i_start = std::max( 0 , (int) ceil( disc.x - half_width - 0.5 ) ); 
+				int i_end = std::min( width-1 , (int) floor( disc.x + half_width - 0.5 ) ); 
+				for( int i=i_start ; i <= i_end ; i++ )
+				{
+					double dx = (i+0.5) - disc.x; 
+					double distance_squared = dx*dx + dy*dy; 
+					unsigned char* color = NULL; 
+					if( distance_squared > disc.inner_radius_squared && disc.has_outline )
+					{ color = disc.outline; }
+					else if( disc.has_fill )
+					{ color = disc.fill; }
+					if( color )
+					{ memcpy( image.pixel(i,j) , color , 3 ); }
+				}
+			}
+		}
+	}
+	
+	// draw a scale bar 
+	
+	if( PhysiCell_raster_options.plot_length_bar == true )
+	{
+		int bar_margin = (int) round( 0.025 * height ); 
+		int bar_height = std::max( 1 , (int) round( 0.01 * height ) ); 
+		int bar_width = (int) round( PhysiCell_raster_options.length_bar / pixel_size ); 
+		for( int j = height - bar_margin - bar_height ; j < height - bar_margin ; j++ )
+		{
+			for( int i = width - bar_margin - bar_width ; i < width - bar_margin ; i++ )
+			{
+				if( i >= 0 && j >= 0 )
+				{ memset( image.pixel(i,j) , 0 , 3 ); }
+			}
+		}
+	}
+	
+	return; 
+}
+
+// 5x7 glyphs, one row per entry, the leftmost pixel in bit 4 
+static const char raster_font_characters[] = "0123456789Cadeghimnorstuy:,.-"; 
+static const unsigned char raster_font[][7] = {
+	{0x0E,0x11,0x13,0x15,0x19,0x11,0x0E}, {0x04,0x0C,0x04,0x04,0x04,0x04,0x0E}, 
+	{0x0E,0x11,0x01,0x02,0x04,0x08,0x1F}, {0x1F,0x02,0x04,0x02,0x01,0x11,0x0E}, 
+	{0x02,0x06,0x0A,0x12,0x1F,0x02,0x02}, {0x1F,0x10,0x1E,0x01,0x01,0x11,0x0E}, 
+	{0x06,0x08,0x10,0x1E,0x11,0x11,0x0E}, {0x1F,0x01,0x02,0x04,0x08,0x08,0x08}, 
+	{0x0E,0x11,0x11,0x0E,0x11,0x11,0x0E}, {0x0E,0x11,0x11,0x0F,0x01,0x02,0x0C}, 
+	{0x0E,0x11,0x10,0x10,0x10,0x11,0x0E}, // C 
+	{0x00,0x00,0x0E,0x01,0x0F,0x11,0x0F}, {0x01,0x01,0x0D,0x13,0x11,0x11,0x0F}, // a d 
+	{0x00,0x00,0x0E,0x11,0x1F,0x10,0x0E}, {0x00,0x0F,0x11,0x11,0x0F,0x01,0x0E}, // e g 
+	{0x10,0x10,0x16,0x19,0x11,0x11,0x11}, {0x04,0x00,0x0C,0x04,0x04,0x04,0x0E}, // h i 
+	{0x00,0x00,0x1A,0x15,0x15,0x11,0x11}, {0x00,0x00,0x16,0x19,0x11,0x11,0x11}, // m n 
+	{0x00,0x00,0x0E,0x11,0x11,0x11,0x0E}, {0x00,0x00,0x16,0x19,0x10,0x10,0x10}, // o r 
+	{0x00,0x00,0x0E,0x10,0x0E,0x01,0x1E}, {0x08,0x08,0x1C,0x08,0x08,0x09,0x06}, // s t 
+	{0x00,0x00,0x11,0x11,0x11,0x13,0x0D}, {0x00,0x00,0x11,0x11,0x0F,0x01,0x0E}, // u y 
+	{0x00,0x0C,0x0C,0x00,0x0C,0x0C,0x00}, {0x00,0x00,0x00,0x00,0x0C,0x04,0x08}, // : , 
+	{0x00,0x00,0x00,0x00,0x00,0x0C,0x0C}, {0x00,0x00,0x00,0x1F,0x00,0x00,0x00}  // . - 
+}; 
+
+void raster_text( Raster_Image& image, int i, int j, int scale, std::string text, unsigned char* color )
+{
+	for( unsigned int c=0 ; c < text.size() ; c++ )
+	{
+		const char* found = strchr( raster_font_characters , text[c] ); 
+		if( text[c] == '\0' || found == NULL )
+		{ continue; } // spaces, and characters without glyphs, are left blank 
+		const unsigned char* glyph = raster_font[ found - raster_font_characters ]; 
+		
+		int left = i + 6*scale*c; 
+		for( int row=0 ; row < 7*scale ; row++ )
+		{
+			for( int column=0 ; column < 5*scale ; column++ )
+			{
+				int x = left + column; 
+				int y = j + row; 
+				if( ( glyph[row/scale] >> ( 4 - column/scale ) ) & 1 && 
+					x >= 0 && x < image.width && y >= 0 && y < image.height )
+				{ memcpy( image.pixel(x,y) , color , 3 ); }
+			}
+		}
+	}
+	return; 
+}
+
+// the two lines at the top of SVG_plot, on a box of the background color 
+static void raster_time_label( Raster_Image& image, double time )
+{
+	std::string time_label = "Current time: " + std::string( formatted_minutes_to_DDHHMM( time ).c_str() ); 
+	char agents_label[64]; 
+	snprintf( agents_label , 64 , "%u agents" , (unsigned int) all_cells->size() ); 
+	int characters = std::max( time_label.size() , strlen( agents_label ) ); 
+	
+	// the font size of SVG_plot (2.5% of the plot height), or smaller if the label would not fit 
+	int scale = (int) round( 0.025 * image.height / 7.0 ); 
+	scale = std::max( 1 , std::min( scale , image.width / ( 6*characters + 4 ) ) ); 
+	int margin = 2*scale; 
+	
+	int box_width = 2*margin + 6*scale*characters; 
+	int box_height = 3*margin + 14*scale; 
+	for( int j=0 ; j < std::min( box_height , image.height ) ; j++ )
+	{
+		for( int i=0 ; i < std::min( box_width , image.width ) ; i++ )
+		{ memcpy( image.pixel(i,j) , PhysiCell_raster_options.background_color.data() , 3 ); }
+	}
+	
+	unsigned char black[3] = {0,0,0}; 
+	raster_text( image, margin, margin, scale, time_label, black ); 
+	raster_text( image, margin, 2*margin + 7*scale, scale, agents_label, black ); 
+	return; 
+}
+
+void raster_plot( std::string filename , Microenvironment& M, double z_slice , double time, std::vector<std::string> (*cell_coloring_function)(Cell*) )
+{
+	BIOFVM_TRACE_SCOPE( "raster_plot" ); 
+	static Raster_Image image; 
+	raster_plot( image, M, z_slice, cell_coloring_function ); 
+	if( PhysiCell_raster_options.plot_time_label == true )
+	{ raster_time_label( image, time ); }
+	
+	bool success = false; 
+	size_t extension = filename.find_last_of( '.' ); 
+	if( extension != std::string::npos && filename.substr( extension ) == ".ppm" )
+	{ success = image.write_PPM( filename ); }
+	else
+	{ success = image.write_PNG( filename , PhysiCell_raster_options.PNG_compression ); }
+	
+	if( !success )
+	{
+		std::cout << std::endl << "Error: We're not writing data like we expect. " << std::endl
+		<< "Check to make sure your save directory exists. " << std::endl << std::endl
+		<< "I'm going to exit with a crash code of -1 now until " << std::endl 
+		<< "you fix your directory. Sorry!" << std::endl << std::endl; 
+		exit(-1); 
+	}
+	return; 
+}
+
+};
@@ -0,0 +1,141 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#ifndef __PhysiCell_raster_h__
+#define __PhysiCell_raster_h__
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../core/PhysiCell.h"
+#include "./PhysiCell_pathology.h"
+
+namespace PhysiCell{
+
+struct PhysiCell_raster_options_struct {
+	int width = 800; // in pixels; the height follows the aspect ratio of the domain 
+	
+	bool plot_nuclei = true; 
+	double outline_thickness = 0.5; // in space units, as in SVG_plot 
+	
+	// optional substrate heat map drawn underneath the cells 
+	bool plot_substrate = false; 
+	int substrate_index = 0; 
+	double substrate_min = 0.0; 
+	double substrate_max = 1.0; 
+	
+	// 0: stored (uncompressed) deflate blocks; 1: fixed-Huffman deflate with run matching 
+	int PNG_compression = 1; 
+	
+	std::vector<unsigned char> background_color = {255,255,255}; 
+	bool plot_length_bar = true; 
+	double length_bar = 100; 
+	
+	// the time and agent count, as at the top of SVG_plot (drawn over the top left) 
+	bool plot_time_label = true; 
+}; 
+
+extern PhysiCell_raster_options_struct PhysiCell_raster_options;
+
+class Raster_Image
+{
+ private:
+ public:
+	int width; 
+	int height; 
+	std::vector<unsigned char> pixels; // RGB, row-major, row 0 at the top 
+	
+	Raster_Image(); 
+	void resize( int new_width, int new_height, std::vector<unsigned char>& color ); 
+	
+	unsigned char* pixel( int i, int j ); 
+	
+	bool write_PPM( std::string filename ); 
+	bool write_PNG( std::string filename , int compression ); 
+}; 
+
+// converts "rgb(R,G,B)" to {R,G,B}. Returns false for "none" or anything it can't parse. 
+bool parse_rgb_string( std::string& input , unsigned char* output ); 
+
+// linear blue-cyan-green-yellow-red map of value in [min_value,max_value]
+void raster_colormap( double value, double min_value, double max_value, unsigned char* output ); 
+
+// draws the same z-slice as SVG_plot into a pixel buffer 
+void raster_plot( Raster_Image& image, Microenvironment& M, double z_slice, std::vector<std::string> (*cell_coloring_function)(Cell*) ); 
+
+// draws text in a 5x7 pixel font, each font pixel scale x scale image pixels, with its 
+// top left corner at (i,j). Covers digits, the letters of the time label, and " .,:-" 
+void raster_text( Raster_Image& image, int i, int j, int scale, std::string text, unsigned char* color ); 
+
+// render (with the time label) and save; the file format is chosen by extension (.ppm or .png) 
+void raster_plot( std::string filename , Microenvironment& M, double z_slice , double time, std::vector<std::string> (*cell_coloring_function)(Cell*) ); 
+
+};
+
+#endif
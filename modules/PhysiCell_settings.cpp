@@ -66,6 +66,10 @@
 */
  
 #include "./PhysiCell_settings.h"
+#include "../core/PhysiCell_simulation.h"
+#include "../core/PhysiCell_load_balancing.h"
+#include "../core/PhysiCell_cell_container.h"
+#include "../core/PhysiCell_hardware_counters.h"
 
 using namespace BioFVM; 
 
@@ -92,6 +96,11 @@ bool load_PhysiCell_config_file( std::string filename )
 	physicell_config_root = physicell_config_doc.child("PhysiCell_settings");
 	physicell_config_dom_initialized = true; 
 	
+	return read_PhysiCell_config_dom( filename ); 
+}
+
+bool read_PhysiCell_config_dom( std::string filename )
+{
 	PhysiCell_settings.read_from_pugixml(); 
 	
 	// now read the microenvironment (optional) 
@@ -128,9 +137,30 @@ PhysiCell_Settings::PhysiCell_Settings()
 	SVG_save_interval = 60; 
 	enable_SVG_saves = true; 
 	
+	raster_save_interval = 60; 
+	enable_raster_saves = false; 
+	raster_format = "png"; 
+	
+	metrics_save_interval = 60; 
+	enable_metrics_saves = false; 
+	metrics_format = "csv"; 
+	
+	POV_save_interval = 60; 
+	enable_POV_saves = false; 
+	
+	enable_memory_report = false; 
+	
+	// initial conditions 
+	enable_initial_cell_list = false; 
+	initial_cell_list_filename = "./config/cells.csv"; 
+	
 	// parallel options 
 	
 	omp_num_threads = 4; 
+	task_graph_deterministic = false; 
+	task_graph_max_concurrent_tasks = 0; 
+	thread_pinning = "none"; 
+	NUMA_place_cells = false; 
 	 
 	return; 
 }
@@ -192,6 +222,39 @@ void PhysiCell_Settings::read_from_pugixml( void )
 	enable_SVG_saves = xml_get_bool_value( node , "enable" ); 
 	node = node.parent(); 
 	
+	// raster (PNG/PPM) snapshots are optional 
+	search_result = xml_find_node( node , "raster" ); 
+	if( search_result )
+	{
+		raster_save_interval = xml_get_double_value( search_result , "interval" );
+		enable_raster_saves = xml_get_bool_value( search_result , "enable" ); 
+		if( xml_find_node( search_result , "format" ) )
+		{ raster_format = xml_get_string_value( search_result , "format" ); }
+	}
+	
+	// in-situ metrics time series (optional) 
+	search_result = xml_find_node( node , "metrics" ); 
+	if( search_result )
+	{
+		metrics_save_interval = xml_get_double_value( search_result , "interval" );
+		enable_metrics_saves = xml_get_bool_value( search_result , "enable" ); 
+		if( xml_find_node( search_result , "format" ) )
+		{ metrics_format = xml_get_string_value( search_result , "format" ); }
+	}
+	
+	// POV-Ray scenes (optional) 
+	search_result = xml_find_node( node , "POV" ); 
+	if( search_result )
+	{
+		POV_save_interval = xml_get_double_value( search_result , "interval" );
+		enable_POV_saves = xml_get_bool_value( search_result , "enable" ); 
+	}
+	
+	// memory by subsystem, with each status (optional) 
+	search_result = xml_find_node( node , "memory_report" ); 
+	if( search_result )
+	{ enable_memory_report = xml_get_bool_value( search_result , "enable" ); }
+	
 	node = xml_find_node( node , "legacy_data" ); 
 	enable_legacy_saves = xml_get_bool_value( node , "enable" );
 	node = node.parent(); 
@@ -201,8 +264,77 @@ void PhysiCell_Settings::read_from_pugixml( void )
 	node = xml_find_node( physicell_config_root , "parallel" ); 		
 	omp_num_threads = xml_get_int_value( node, "omp_num_threads" ); 
 	
+	search_result = xml_find_node( node , "task_graph" ); 
+	if( search_result )
+	{
+		task_graph_deterministic = xml_get_bool_value( search_result , "deterministic" ); 
+		if( xml_find_node( search_result , "max_concurrent_tasks" ) )
+		{ task_graph_max_concurrent_tasks = xml_get_int_value( search_result , "max_concurrent_tasks" ); }
+		if( xml_find_node( search_result , "record_task_times" ) )
+		{ task_timing.enabled = xml_get_bool_value( search_result , "record_task_times" ); }
+		// before the first parallel region, so that the counters follow all the threads 
+		if( xml_find_node( search_result , "record_task_counters" ) && 
+			xml_get_bool_value( search_result , "record_task_counters" ) )
+		{
+			if( hardware_counters.open() )
+			{
+				task_timing.enabled = true; 
+				task_timing.record_counters = true; 
+			}
+			else
+			{
+				std::cout << "Warning: hardware counters are unavailable (" << hardware_counters.reason 
+					<< "); recording the task wall times only." << std::endl; 
+				task_timing.enabled = true; 
+			}
+		}
+	}
+	
+	search_result = xml_find_node( node , "NUMA" ); 
+	if( search_result )
+	{
+		if( xml_find_node( search_result , "thread_pinning" ) )
+		{ thread_pinning = xml_get_string_value( search_result , "thread_pinning" ); }
+		if( xml_find_node( search_result , "place_cells" ) )
+		{ NUMA_place_cells = xml_get_bool_value( search_result , "place_cells" ); }
+	}
+	
+	search_result = xml_find_node( node , "load_balancing" ); 
+	if( search_result )
+	{
+		load_balancing_options.enable = xml_get_bool_value( search_result , "enable" ); 
+		if( xml_find_node( search_result , "chunks_per_thread" ) )
+		{ load_balancing_options.chunks_per_thread = xml_get_int_value( search_result , "chunks_per_thread" ); }
+		if( xml_find_node( search_result , "record_idle_time" ) )
+		{ load_balancing_options.record_idle_time = xml_get_bool_value( search_result , "record_idle_time" ); }
+	}
+	
+	search_result = xml_find_node( node , "cell_updates" ); 
+	if( search_result )
+	{
+		if( xml_find_node( search_result , "fused" ) )
+		{ cell_update_options.fused = xml_get_bool_value( search_result , "fused" ); }
+		if( xml_find_node( search_result , "spatial_sort" ) )
+		{ cell_update_options.spatial_sort = xml_get_bool_value( search_result , "spatial_sort" ); }
+		if( xml_find_node( search_result , "batched_phenotype" ) )
+		{ cell_update_options.batched_phenotype = xml_get_bool_value( search_result , "batched_phenotype" ); }
+	}
+	
 	node = node.parent(); 
 	
+	// initial cell list (optional) 
+	
+	search_result = xml_find_node( physicell_config_root , "initial_conditions" ); 
+	if( search_result )
+	{
+		search_result = xml_find_node( search_result , "cell_list" ); 
+		if( search_result )
+		{
+			enable_initial_cell_list = xml_get_bool_value( search_result , "enable" ); 
+			initial_cell_list_filename = xml_get_string_value( search_result , "filename" ); 
+		}
+	}
+	
 	// domain options 
 	
 	node = xml_find_node( physicell_config_root , "domain" );
@@ -241,6 +373,17 @@ void PhysiCell_Settings::read_from_pugixml( void )
 
 PhysiCell_Globals PhysiCell_globals; 
 
+// the default simulation refers to the settings globals 
+static bool bind_default_simulation_settings( void )
+{
+	Simulation& simulation = get_default_simulation(); 
+	simulation.pSettings = &PhysiCell_settings; 
+	simulation.pGlobals = &PhysiCell_globals; 
+	simulation.pParameters = &parameters; 
+	return true; 
+}
+static bool default_simulation_settings_bound = bind_default_simulation_settings(); 
+
 /* parameters functions */ 
 
 template <class T>
@@ -604,6 +747,22 @@ bool setup_microenvironment_from_XML( pugi::xml_node root_node )
 			xml_get_double_value( node1, "diffusion_coefficient" ); 
 		microenvironment.decay_rates[i] = 
 			xml_get_double_value( node1, "decay_rate" ); 
+		
+		// optional: this substrate's own time step and solver 
+		node1 = xml_find_node( node, "time_stepping" ); 
+		if( node1 )
+		{
+			int step_multiple = 1; 
+			bool adaptive = false; 
+			std::string solver_type = "LOD"; 
+			if( xml_find_node( node1 , "step_multiple" ) )
+			{ step_multiple = xml_get_int_value( node1 , "step_multiple" ); }
+			if( xml_find_node( node1 , "adaptive" ) )
+			{ adaptive = xml_get_bool_value( node1 , "adaptive" ); }
+			if( xml_find_node( node1 , "solver" ) )
+			{ solver_type = xml_get_string_value( node1 , "solver" ); }
+			microenvironment.set_substrate_time_stepping( i , step_multiple , adaptive , solver_type ); 
+		}
 			
 		// now, get the initial value  
 		node1 = xml_find_node( node, "initial_condition" ); 
@@ -654,6 +813,22 @@ bool setup_microenvironment_from_XML( pugi::xml_node root_node )
 	default_microenvironment_options.track_internalized_substrates_in_each_agent 
 		= xml_get_bool_value( node, "track_internalized_substrates_in_each_agent" ); 
 	
+	// implicit (matrix-free) mesh? 
+	if( xml_find_node( node , "implicit_mesh" ) )
+	{ default_microenvironment_options.implicit_mesh = xml_get_bool_value( node , "implicit_mesh" ); }
+	
+	// limits for the adaptive substrate time steps 
+	if( xml_find_node( node , "diffusion_step_tolerance" ) )
+	{ microenvironment.diffusion_step_tolerance = xml_get_double_value( node , "diffusion_step_tolerance" ); }
+	if( xml_find_node( node , "max_diffusion_step_multiple" ) )
+	{ microenvironment.max_diffusion_step_multiple = xml_get_int_value( node , "max_diffusion_step_multiple" ); }
+	
+	// convergence of the "steady" substrate solves 
+	if( xml_find_node( node , "steady_state_tolerance" ) )
+	{ microenvironment.steady_state_tolerance = xml_get_double_value( node , "steady_state_tolerance" ); }
+	if( xml_find_node( node , "steady_state_max_cycles" ) )
+	{ microenvironment.steady_state_max_cycles = xml_get_int_value( node , "steady_state_max_cycles" ); }
+	
 	// not yet supported : read initial conditions 
 	/*
 	// read in initial conditions from an external file 
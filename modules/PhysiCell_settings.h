@@ -86,9 +86,15 @@ using namespace BioFVM;
 
 namespace PhysiCell{
  	
+extern bool physicell_config_dom_initialized; 
+extern pugi::xml_document physicell_config_doc; 
 extern pugi::xml_node physicell_config_root; 
 
 bool load_PhysiCell_config_file( std::string filename );
+// the second half of load_PhysiCell_config_file: reads the settings, the microenvironment 
+// and the user parameters from physicell_config_root, which is already parsed (and may 
+// have been edited). filename is only used in messages. 
+bool read_PhysiCell_config_dom( std::string filename ); 
 
 class PhysiCell_Settings
 {
@@ -103,6 +109,10 @@ class PhysiCell_Settings
  
 	// parallel options 
 	int omp_num_threads = 2; 
+	bool task_graph_deterministic = false; // run each step's tasks one at a time, in order 
+	int task_graph_max_concurrent_tasks = 0; // 0: no limit beyond omp_num_threads 
+	std::string thread_pinning = "none"; // none, compact, or scatter 
+	bool NUMA_place_cells = false; // move each thread's cells to its NUMA node 
 	
 	// save options
 	std::string folder = "."; 
@@ -114,6 +124,23 @@ class PhysiCell_Settings
 	double SVG_save_interval = 60; 
 	bool enable_SVG_saves = true; 
 	
+	double raster_save_interval = 60; 
+	bool enable_raster_saves = false; 
+	std::string raster_format = "png"; 
+	
+	double metrics_save_interval = 60; 
+	bool enable_metrics_saves = false; 
+	std::string metrics_format = "csv"; 
+	
+	double POV_save_interval = 60; 
+	bool enable_POV_saves = false; 
+	
+	bool enable_memory_report = false; 
+	
+	// initial conditions 
+	bool enable_initial_cell_list = false; 
+	std::string initial_cell_list_filename = "./config/cells.csv"; 
+	
 	PhysiCell_Settings();
 	
 	void read_from_pugixml( void ); 
@@ -126,8 +153,13 @@ class PhysiCell_Globals
 	double current_time = 0.0; 
 	double next_full_save_time = 0.0; 
 	double next_SVG_save_time = 0.0; 
+	double next_raster_save_time = 0.0; 
+	double next_metrics_save_time = 0.0; 
+	double next_POV_save_time = 0.0; 
 	int full_output_index = 0; 
 	int SVG_output_index = 0; 
+	int raster_output_index = 0; 
+	int POV_output_index = 0; 
 };
 
 template <class T> 
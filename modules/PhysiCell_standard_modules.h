@@ -73,8 +73,13 @@
 
 #include "./PhysiCell_SVG.h"
 #include "./PhysiCell_pathology.h"
+#include "./PhysiCell_raster.h"
+#include "./PhysiCell_POV.h"
 #include "./PhysiCell_MultiCellDS.h"
 #include "./PhysiCell_various_outputs.h"
+#include "./PhysiCell_metrics.h"
+#include "./PhysiCell_initial_conditions.h"
+#include "./PhysiCell_ensemble.h"
 
 #include "./PhysiCell_pugixml.h"
 #include "./PhysiCell_settings.h" 
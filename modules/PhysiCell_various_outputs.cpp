@@ -72,7 +72,7 @@
 
 namespace PhysiCell{
 
-int writePov(std::vector<Cell*> all_cells, double timepoint, double scale)
+int writePov(std::vector<Cell*>& all_cells, double timepoint, double scale)
 {
 	std::string filename; 
 	filename.resize( 1024 ); 
@@ -116,7 +116,7 @@ int writePov(std::vector<Cell*> all_cells, double timepoint, double scale)
 	return 0;
 }
 
-int writeCellReport(std::vector<Cell*> all_cells, double timepoint)
+int writeCellReport(std::vector<Cell*>& all_cells, double timepoint)
 {
 	std::string filename; 
 	filename.resize( 1024 ); 
@@ -147,7 +147,8 @@ void display_simulation_status( std::ostream& os )
 		PhysiCell_settings.max_time << " " << 
 		PhysiCell_settings.time_units << ")" << std::endl; 
 		
-	os << "total agents: " << all_cells->size() << std::endl; 
+	// over all ranks, in MPI mode 
+	os << "total agents: " << BioFVM::domain_decomposition.global_sum( all_cells->size() ) << std::endl; 
 	
 	os << "interval wall time: ";
 	BioFVM::TOC();
@@ -160,10 +161,89 @@ void display_simulation_status( std::ostream& os )
 	BioFVM::display_stopwatch_value( os , BioFVM::runtime_stopwatch_value() ); 
 	os << std::endl << std::endl; 
 	
+	Cell_Container* pContainer = get_default_simulation().pCell_container; 
+	if( load_balancing_options.record_idle_time == true && pContainer != NULL )
+	{
+		pContainer->display_load_balancing_statistics( os ); 
+		os << std::endl; 
+	}
+	
+	if( task_timing.enabled == true )
+	{
+		task_timing.display( os ); 
+		os << std::endl; 
+	}
+	
+	if( PhysiCell_settings.enable_memory_report == true )
+	{
+		display_memory_report( os ); 
+		os << std::endl; 
+	}
+	
 	return;
 }
 
-void log_output(double t, int output_index, Microenvironment microenvironment, std::ofstream& report_file)
+void display_memory_report( std::ostream& os )
+{
+	static bool csv_started = false; 
+	
+	long long cell_bytes = all_cells->capacity() * sizeof( Cell* ); 
+	#pragma omp parallel for reduction(+:cell_bytes) 
+	for( int i=0; i < all_cells->size() ; i++ )
+	{ cell_bytes += (*all_cells)[i]->memory_footprint(); }
+	
+	Microenvironment* pMicroenvironment = get_default_microenvironment(); 
+	Cell_Container* pContainer = get_default_simulation().pCell_container; 
+	
+	std::vector<std::string> names = { "cells" , "densities" , "gradients" , "solver buffers" , 
+		"microenvironment mesh" , "mechanics grid" , "pugixml (in use)" , "pugixml (peak)" }; 
+	std::vector<std::string> csv_names = { "cells" , "densities" , "gradients" , "solver_buffers" , 
+		"microenvironment_mesh" , "mechanics_grid" , "pugixml" , "pugixml_peak" }; 
+	std::vector<long long> bytes = { cell_bytes , 0 , 0 , 0 , 0 , 0 , 
+		BioFVM::pugixml_bytes_in_use() , BioFVM::pugixml_peak_bytes() }; 
+	if( pMicroenvironment != NULL )
+	{
+		bytes[1] = pMicroenvironment->density_memory_footprint(); 
+		bytes[2] = pMicroenvironment->gradient_memory_footprint(); 
+		bytes[3] = pMicroenvironment->solver_memory_footprint(); 
+		bytes[4] = pMicroenvironment->mesh.memory_footprint(); 
+	}
+	if( pContainer != NULL )
+	{ bytes[5] = pContainer->memory_footprint(); }
+	
+	long long RSS = BioFVM::current_RSS_bytes(); 
+	long long peak_RSS = BioFVM::peak_RSS_bytes(); 
+	
+	const double MiB = 1024.0 * 1024.0; 
+	os << "memory (MiB): resident " << RSS / MiB << " (peak " << peak_RSS / MiB << ")" << std::endl; 
+	for( int i=0; i < names.size() ; i++ )
+	{ os << "\t" << names[i] << ": " << bytes[i] / MiB << std::endl; }
+	
+	if( BioFVM::domain_decomposition.rank != 0 )
+	{ return; }
+	std::string filename = PhysiCell_settings.folder + "/memory.csv"; 
+	std::ofstream csv( filename.c_str() , csv_started ? std::ios::app : std::ios::out ); 
+	if( !csv )
+	{
+		std::cout << "Warning: could not write " << filename << "." << std::endl; 
+		return; 
+	}
+	if( csv_started == false )
+	{
+		csv << "time,resident_bytes,peak_resident_bytes"; 
+		for( int i=0; i < csv_names.size() ; i++ )
+		{ csv << "," << csv_names[i]; }
+		csv << std::endl; 
+		csv_started = true; 
+	}
+	csv << PhysiCell_globals.current_time << "," << RSS << "," << peak_RSS; 
+	for( int i=0; i < bytes.size() ; i++ )
+	{ csv << "," << bytes[i]; }
+	csv << std::endl; 
+	return; 
+}
+
+void log_output(double t, int output_index, Microenvironment& microenvironment, std::ofstream& report_file)
 {
 	double scale=1000;
 	int num_new_cells= 0;
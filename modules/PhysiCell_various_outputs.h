@@ -81,11 +81,14 @@
 
 namespace PhysiCell{
 
-int writePov(std::vector<Cell*> all_cells, double timepoint, double scale);
-int writeCellReport(std::vector<Cell*> all_cells, double timepoint);
+int writePov(std::vector<Cell*>& all_cells, double timepoint, double scale);
+int writeCellReport(std::vector<Cell*>& all_cells, double timepoint);
 
 void display_simulation_status( std::ostream& os ); 
-void log_output(double t, int output_index, Microenvironment microenvironment, std::ofstream& report_file);
+// the resident memory, and the bytes held by each subsystem (on this rank); also 
+// appends them to <folder>/memory.csv. Part of the status when <memory_report> is enabled. 
+void display_memory_report( std::ostream& os ); 
+void log_output(double t, int output_index, Microenvironment& microenvironment, std::ofstream& report_file);
 	
 };
 
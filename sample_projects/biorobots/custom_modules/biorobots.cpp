@@ -206,6 +206,10 @@ void create_cell_types( void )
 	worker_cell.functions.custom_cell_rule = extra_elastic_attachment_mechanics; 
 	worker_cell.functions.update_migration_bias = worker_cell_motility;
 	
+	register_cell_definition( director_cell ); 
+	register_cell_definition( cargo_cell ); 
+	register_cell_definition( worker_cell ); 
+	
 	return; 
 }
 
@@ -125,6 +125,8 @@ void create_cargo_cell_type( void )
 	cargo_cell.custom_data[ "repair rate" ] = 0.0;  
 	cargo_cell.custom_data[ "drug death rate" ] = 0.0;  
 
+	register_cell_definition( cargo_cell ); 
+	
 	return;
 }	
 
@@ -185,6 +187,8 @@ void create_worker_cell_type( void )
 	worker_cell.custom_data[ "repair rate" ] = 0.0;  
 	worker_cell.custom_data[ "drug death rate" ] = 0.0;  
 	
+	register_cell_definition( worker_cell ); 
+	
 	return; 
 }
 
@@ -130,6 +130,8 @@ void create_immune_cell_type( void )
 	immune_cell.custom_data[ "attachment rate" ] = 
 		parameters.doubles("immune_attachment_rate"); // 1.0/5.0; // how long it wants to wander before attaching	
 	
+	register_cell_definition( immune_cell ); 
+	
 	return; 
 }
 
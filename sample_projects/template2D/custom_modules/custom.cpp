@@ -163,6 +163,8 @@ void create_cell_types( void )
 	motile_cell.phenotype.cycle.data.transition_rate(G0G1_index,S_index) *= 
 		parameters.doubles( "motile_cell_relative_cycle_entry_rate" ); // 0.1; 
 	
+	register_cell_definition( motile_cell ); 
+	
 	return; 
 }
 
@@ -184,6 +184,8 @@ void create_cell_types( void )
 	macrophage.phenotype.secretion.uptake_rates[virus_index] = 
 		parameters.doubles("viral_internalization_rate"); 
 
+	register_cell_definition( macrophage ); 
+	
 	return; 
 }
 
@@ -364,19 +366,18 @@ std::vector<Cell*> get_possible_neighbors( Cell* pCell )
 	for( neighbor = pCell->get_container()->agent_grid[pCell->get_current_mechanics_voxel_index()].begin(); neighbor != end; ++neighbor)
 	{ neighbors.push_back( *neighbor ); }
 
-	std::vector<int>::iterator neighbor_voxel_index;
-	std::vector<int>::iterator neighbor_voxel_index_end = 
-		pCell->get_container()->underlying_mesh.moore_connected_voxel_indices[pCell->get_current_mechanics_voxel_index()].end();
+	Cartesian_Mesh& mesh = pCell->get_container()->underlying_mesh; 
+	int neighbor_voxels[26]; 
+	int number_of_neighbor_voxels = mesh.moore_neighborhood( pCell->get_current_mechanics_voxel_index() , neighbor_voxels ); 
+	std::vector<double> my_voxel_center = mesh.voxel_center( pCell->get_current_mechanics_voxel_index() ); 
 
-	for( neighbor_voxel_index = 
-		pCell->get_container()->underlying_mesh.moore_connected_voxel_indices[pCell->get_current_mechanics_voxel_index()].begin();
-		neighbor_voxel_index != neighbor_voxel_index_end; 
-		++neighbor_voxel_index )
+	for( int n=0; n < number_of_neighbor_voxels ; n++ )
 	{
-		if(!is_neighbor_voxel(pCell, pCell->get_container()->underlying_mesh.voxels[pCell->get_current_mechanics_voxel_index()].center, pCell->get_container()->underlying_mesh.voxels[*neighbor_voxel_index].center, *neighbor_voxel_index))
+		int neighbor_voxel_index = neighbor_voxels[n]; 
+		if(!is_neighbor_voxel(pCell, my_voxel_center, mesh.voxel_center( neighbor_voxel_index ), neighbor_voxel_index))
 			continue;
-		end = pCell->get_container()->agent_grid[*neighbor_voxel_index].end();
-		for(neighbor = pCell->get_container()->agent_grid[*neighbor_voxel_index].begin();neighbor != end; ++neighbor)
+		end = pCell->get_container()->agent_grid[neighbor_voxel_index].end();
+		for(neighbor = pCell->get_container()->agent_grid[neighbor_voxel_index].begin();neighbor != end; ++neighbor)
 		{ neighbors.push_back( *neighbor ); }
 	}
 	
@@ -493,7 +494,8 @@ std::vector<double> integrate_total_substrates( void )
 	for( unsigned int n = 0; n < microenvironment.number_of_voxels() ; n++ )
 	{
 		// out = out + microenvironment(n) * dV(n) 
-		axpy( &out , microenvironment.mesh.voxels[n].volume , microenvironment(n) ); 
+		double volume = microenvironment.mesh.voxel_volume( n ); 
+		axpy( &out , volume , microenvironment(n) ); 
 	}
 
 	// inte
@@ -85,18 +85,44 @@ using namespace PhysiCell;
 
 int main( int argc, char* argv[] )
 {
+	// MPI setup (inactive unless built with "make MPI=1" and run on 2+ ranks) 
+	domain_decomposition.initialize( &argc , &argv ); 
+	
 	// load and parse settings file(s)
 	
 	bool XML_status = false; 
-	if( argc > 1 )
+	if( argc > 2 && std::string( argv[1] ) == "--ensemble" )
+	{
+		// run a sweep: only the forked runs come back from run_ensemble 
+		std::string base_config = ( argc > 3 ) ? argv[3] : "./config/PhysiCell_settings.xml"; 
+		XML_status = run_ensemble( argv[2] , base_config ); 
+	}
+	else if( argc > 1 )
 	{ XML_status = load_PhysiCell_config_file( argv[1] ); }
 	else
 	{ XML_status = load_PhysiCell_config_file( "./config/PhysiCell_settings.xml" ); }
 	if( !XML_status )
 	{ exit(-1); }
 	
+	if( domain_decomposition.active )
+	{
+		// these outputs read all the cells on one rank 
+		std::cout << "Warning: the SVG, POV, raster, metrics, and legacy outputs are off in MPI mode." << std::endl; 
+		PhysiCell_settings.enable_SVG_saves = false; 
+		PhysiCell_settings.enable_POV_saves = false; 
+		PhysiCell_settings.enable_raster_saves = false; 
+		PhysiCell_settings.enable_metrics_saves = false; 
+		PhysiCell_settings.enable_legacy_saves = false; 
+	}
+	
 	// OpenMP setup
 	omp_set_num_threads(PhysiCell_settings.omp_num_threads);
+	if( PhysiCell_settings.thread_pinning != "none" )
+	{
+		if( !pin_OpenMP_threads( PhysiCell_settings.thread_pinning ) )
+		{ exit(-1); }
+		display_thread_placement( std::cout ); 
+	}
 	
 	// time setup 
 	std::string time_units = "min"; 
@@ -111,6 +137,9 @@ int main( int argc, char* argv[] )
 	double mechanics_voxel_size = 30; 
 	Cell_Container* cell_container = create_cell_container_for_microenvironment( microenvironment, mechanics_voxel_size );
 	
+	// the simulation context; the default one refers to the globals above 
+	Simulation& simulation = get_default_simulation(); 
+	
 	/* Users typically start modifying here. START USERMODS */ 
 	
 	create_cell_types();
@@ -119,6 +148,9 @@ int main( int argc, char* argv[] )
 
 	/* Users typically stop modifying here. END USERMODS */ 
 	
+	if( PhysiCell_settings.NUMA_place_cells == true )
+	{ place_cells_on_thread_nodes( *all_cells ); }
+	
 	// set MultiCellDS save options 
 
 	set_save_biofvm_mesh_as_matlab( true ); 
@@ -141,8 +173,11 @@ int main( int argc, char* argv[] )
 	
 	std::vector<std::string> (*cell_coloring_function)(Cell*) = my_coloring_function; 
 	
-	sprintf( filename , "%s/initial.svg" , PhysiCell_settings.folder.c_str() ); 
-	SVG_plot( filename , microenvironment, 0.0 , PhysiCell_globals.current_time, cell_coloring_function );
+	if( domain_decomposition.active == false )
+	{
+		sprintf( filename , "%s/initial.svg" , PhysiCell_settings.folder.c_str() ); 
+		SVG_plot( filename , microenvironment, 0.0 , PhysiCell_globals.current_time, cell_coloring_function );
+	}
 	
 	display_citations(); 
 	
@@ -160,63 +195,177 @@ int main( int argc, char* argv[] )
 		report_file<<"simulated time\tnum cells\tnum division\tnum death\twall time"<<std::endl;
 	}
 	
+	if( PhysiCell_settings.enable_metrics_saves == true )
+	{
+		PhysiCell_metrics_options.binary = ( PhysiCell_settings.metrics_format == "binary" ); 
+		if( PhysiCell_metrics_options.binary == true )
+		{ sprintf( filename , "%s/metrics.bin" , PhysiCell_settings.folder.c_str() ); }
+		else
+		{ sprintf( filename , "%s/metrics.csv" , PhysiCell_settings.folder.c_str() ); }
+		open_metrics_stream( filename ); 
+	}
+	
 	// main loop 
 	
 	try 
 	{		
-		while( PhysiCell_globals.current_time < PhysiCell_settings.max_time + 0.1*diffusion_dt )
+		// each step is a task graph (see core/PhysiCell_task_graph.h): the outputs 
+		// read the state at the current time, then the microenvironment and the 
+		// cells are updated. The outputs that read substrates come first, so the 
+		// others can overlap the diffusion solve. 
+		
+		Task_Graph step; 
+		// (in MPI mode, the communication stays on the main thread) 
+		step.deterministic = PhysiCell_settings.task_graph_deterministic || domain_decomposition.active; 
+		step.max_concurrent_tasks = PhysiCell_settings.task_graph_max_concurrent_tasks; 
+		
+		// the clock: integer ticks, with a period for each process (see 
+		// core/PhysiCell_scheduler.h). Each step is one diffusion step. 
+		Multirate_Scheduler& scheduler = simulation.scheduler; 
+		scheduler.set_time( PhysiCell_globals.current_time ); 
+		int diffusion_process = scheduler.add_process( "diffusion" , diffusion_dt ); 
+		int full_save_process = scheduler.add_process( "full save" , PhysiCell_settings.full_save_interval ); 
+		int metrics_process = scheduler.add_process( "metrics" , PhysiCell_settings.metrics_save_interval ); 
+		int raster_process = scheduler.add_process( "raster" , PhysiCell_settings.raster_save_interval ); 
+		int SVG_process = scheduler.add_process( "SVG" , PhysiCell_settings.SVG_save_interval ); 
+		int POV_process = scheduler.add_process( "POV" , PhysiCell_settings.POV_save_interval ); 
+		
+		while( scheduler.get_current_tick() <= scheduler.ticks( PhysiCell_settings.max_time ) )
 		{
+			step.clear(); 
+			PhysiCell_globals.current_time = scheduler.current_time(); 
+			// dt can change during the run 
+			scheduler.set_period( diffusion_process , diffusion_dt ); 
+			
 			// save data if it's time. 
-			if( fabs( PhysiCell_globals.current_time - PhysiCell_globals.next_full_save_time ) < 0.01 * diffusion_dt )
+			if( scheduler.is_due( full_save_process ) )
 			{
-				display_simulation_status( std::cout ); 
-				if( PhysiCell_settings.enable_legacy_saves == true )
-				{	
-					log_output( PhysiCell_globals.current_time , PhysiCell_globals.full_output_index, microenvironment, report_file);
-				}
+				scheduler.mark_run( full_save_process ); 
+				step.add_task( "full save" , [&]()
+				{
+					display_simulation_status( std::cout ); 
+					if( PhysiCell_settings.enable_legacy_saves == true )
+					{	
+						log_output( PhysiCell_globals.current_time , PhysiCell_globals.full_output_index, microenvironment, report_file);
+					}
+					
+					if( PhysiCell_settings.enable_full_saves == true )
+					{	
+						char filename[1024]; 
+						sprintf( filename , "%s/output%08u" , PhysiCell_settings.folder.c_str(),  PhysiCell_globals.full_output_index ); 
+						
+						save_PhysiCell_to_MultiCellDS_xml_pugi( filename , microenvironment , PhysiCell_globals.current_time ); 
+					}
+					
+					PhysiCell_globals.full_output_index++; 
+				} , {"densities","cells","secretion"} , {"output"} ); 
 				
-				if( PhysiCell_settings.enable_full_saves == true )
+				if( PhysiCell_settings.NUMA_place_cells == true )
+				{
+					// new cells (divisions) are allocated by the main thread 
+					step.add_task( "cell placement" , [&]()
+					{ place_cells_on_thread_nodes( *all_cells ); } , {"cells"} , {} ); 
+				}
+			}
+			
+			// append to the metrics time series if it's time 
+			if( scheduler.is_due( metrics_process ) )
+			{
+				scheduler.mark_run( metrics_process ); 
+				if( PhysiCell_settings.enable_metrics_saves == true )
+				{
+					step.add_task( "metrics" , [&]()
+					{
+						write_metrics( PhysiCell_globals.current_time , microenvironment ); 
+					} , {"densities","cells"} , {"output"} ); 
+				}
+			}
+			
+			// save raster (PNG/PPM) snapshot if it's time
+			if( scheduler.is_due( raster_process ) )
+			{
+				scheduler.mark_run( raster_process ); 
+				if( PhysiCell_settings.enable_raster_saves == true )
 				{	
-					sprintf( filename , "%s/output%08u" , PhysiCell_settings.folder.c_str(),  PhysiCell_globals.full_output_index ); 
-					
-					save_PhysiCell_to_MultiCellDS_xml_pugi( filename , microenvironment , PhysiCell_globals.current_time ); 
+					step.add_task( "raster" , [&]()
+					{
+						char filename[1024]; 
+						sprintf( filename , "%s/snapshot%08u.%s" , PhysiCell_settings.folder.c_str() , PhysiCell_globals.raster_output_index , 
+							PhysiCell_settings.raster_format.c_str() ); 
+						raster_plot( filename , microenvironment, 0.0 , PhysiCell_globals.current_time, cell_coloring_function );
+						
+						PhysiCell_globals.raster_output_index++; 
+					} , {"densities","cells"} , {"output"} ); 
 				}
-				
-				PhysiCell_globals.full_output_index++; 
-				PhysiCell_globals.next_full_save_time += PhysiCell_settings.full_save_interval;
 			}
 			
 			// save SVG plot if it's time
-			if( fabs( PhysiCell_globals.current_time - PhysiCell_globals.next_SVG_save_time  ) < 0.01 * diffusion_dt )
+			bool SVG_is_due = scheduler.is_due( SVG_process ); 
+			if( SVG_is_due )
 			{
+				scheduler.mark_run( SVG_process ); 
 				if( PhysiCell_settings.enable_SVG_saves == true )
 				{	
-					sprintf( filename , "%s/snapshot%08u.svg" , PhysiCell_settings.folder.c_str() , PhysiCell_globals.SVG_output_index ); 
-					SVG_plot( filename , microenvironment, 0.0 , PhysiCell_globals.current_time, cell_coloring_function );
-					
-					PhysiCell_globals.SVG_output_index++; 
-					PhysiCell_globals.next_SVG_save_time  += PhysiCell_settings.SVG_save_interval;
+					step.add_task( "SVG" , [&]()
+					{
+						char filename[1024]; 
+						sprintf( filename , "%s/snapshot%08u.svg" , PhysiCell_settings.folder.c_str() , PhysiCell_globals.SVG_output_index ); 
+						SVG_plot( filename , microenvironment, 0.0 , PhysiCell_globals.current_time, cell_coloring_function );
+						
+						PhysiCell_globals.SVG_output_index++; 
+					} , {"cells"} , {"output"} ); 
 				}
 			}
-			if( fabs( PhysiCell_globals.current_time - PhysiCell_globals.next_SVG_save_time  ) < 0.01 * diffusion_dt ) {
-				Cell* pC = NULL;
-				for (int i = 0; i < (*all_cells).size(); i++) {
-					pC = (*all_cells)[i];
-					std::cout << pC->ID << ": " << pC->phenotype.cycle.current_phase().name << std::endl;
+			
+			if( SVG_is_due ) {
+				step.add_task( "cell phases" , [&]()
+				{
+					Cell* pC = NULL;
+					for (int i = 0; i < (*all_cells).size(); i++) {
+						pC = (*all_cells)[i];
+						std::cout << pC->ID << ": " << pC->phenotype.cycle.current_phase().name << std::endl;
+					}
+				} , {"cells"} , {"output"} ); 
+			}
+			
+			// save POV-Ray scene if it's time
+			if( scheduler.is_due( POV_process ) )
+			{
+				scheduler.mark_run( POV_process ); 
+				if( PhysiCell_settings.enable_POV_saves == true )
+				{	
+					step.add_task( "POV" , [&]()
+					{
+						char filename[1024]; 
+						sprintf( filename , "%s/snapshot%08u.pov" , PhysiCell_settings.folder.c_str() , PhysiCell_globals.POV_output_index ); 
+						POV_plot( filename , cell_coloring_function );
+						
+						PhysiCell_globals.POV_output_index++; 
+					} , {"cells"} , {"output"} ); 
 				}
 			}
 
 			// update the microenvironment
-			microenvironment.simulate_diffusion_decay( diffusion_dt );
+			double diffusion_step = scheduler.period( diffusion_process ); 
+			step.add_task( "diffusion" , [diffusion_step]()
+			{ microenvironment.simulate_diffusion_decay( diffusion_step ); } , 
+			{"cells","secretion"} , {"densities"} ); 
 			
 			// run PhysiCell 
-			((Cell_Container *)microenvironment.agent_container)->update_all_cells( PhysiCell_globals.current_time );
+			simulation.pCell_container->add_update_tasks( step, simulation, PhysiCell_globals.current_time, phenotype_dt, mechanics_dt, diffusion_step );
 			
 			/*
 			  Custom add-ons could potentially go here. 
+			  (Or register them as hooks: scheduler.add_hook( name, period, function ).) 
 			*/
 			
-			PhysiCell_globals.current_time += diffusion_dt;
+			step.run(); 
+			
+			// custom hooks that are due, after the step's tasks 
+			scheduler.run_due_hooks(); 
+			
+			scheduler.advance( diffusion_process ); 
+			PhysiCell_globals.current_time = scheduler.current_time(); 
 		}
 		
 		if( PhysiCell_settings.enable_legacy_saves == true )
@@ -224,6 +373,7 @@ int main( int argc, char* argv[] )
 			log_output(PhysiCell_globals.current_time, PhysiCell_globals.full_output_index, microenvironment, report_file);
 			report_file.close();
 		}
+		close_metrics_stream(); 
 	}
 	catch( const std::exception& e )
 	{ // reference to the base of a polymorphic object
@@ -235,13 +385,22 @@ int main( int argc, char* argv[] )
 	sprintf( filename , "%s/final" , PhysiCell_settings.folder.c_str() ); 
 	save_PhysiCell_to_MultiCellDS_xml_pugi( filename , microenvironment , PhysiCell_globals.current_time ); 
 	
-	sprintf( filename , "%s/final.svg" , PhysiCell_settings.folder.c_str() ); 
-	SVG_plot( filename , microenvironment, 0.0 , PhysiCell_globals.current_time, cell_coloring_function );
+	if( domain_decomposition.active == false )
+	{
+		sprintf( filename , "%s/final.svg" , PhysiCell_settings.folder.c_str() ); 
+		SVG_plot( filename , microenvironment, 0.0 , PhysiCell_globals.current_time, cell_coloring_function );
+		
+		// the final cells, in a form that <initial_conditions> can load 
+		sprintf( filename , "%s/final_cell_list.bin" , PhysiCell_settings.folder.c_str() ); 
+		write_cell_list( filename ); 
+	}
 	
 	// timer 
 	
 	std::cout << std::endl << "Total simulation runtime: " << std::endl; 
 	BioFVM::display_stopwatch_value( std::cout , BioFVM::runtime_stopwatch_value() ); 
+	
+	domain_decomposition.finalize(); 
 
 	return 0; 
 }
@@ -181,6 +181,8 @@ void create_cell_types( void )
 	//motile_cell.phenotype.cycle.data.transition_rate(G0G1_index,S_index) *= 
 	//	parameters.doubles( "motile_cell_relative_cycle_entry_rate" ); // 0.1; 
 	
+	register_cell_definition( motile_cell ); 
+	
 	return; 
 }
 
@@ -260,13 +262,9 @@ class cord {
 	cord(int i, int j, int k) : x(i), y(j), z(k){}
 };
 
-void change_for_ini_cell(Cell* pNew) {
-	// change pi pe.
-	int pi_index = pNew->custom_data.find_variable_index("pi");
-	int pe_index = pNew->custom_data.find_variable_index("pe");
-	int pf_index = pNew->custom_data.find_variable_index("pf");
-	double pi = parameters.doubles("pi_ini") * (1 + 0.5 * NormalRandom(0, 1)); 
-	double pe = parameters.doubles("pe_ini") * (1 + 0.5 * NormalRandom(0, 1)); 
+void draw_initial_pi_pe(double& pi, double& pe) {
+	pi = parameters.doubles("pi_ini") * (1 + 0.5 * NormalRandom(0, 1)); 
+	pe = parameters.doubles("pe_ini") * (1 + 0.5 * NormalRandom(0, 1)); 
 
 	if (pi > 1) {
 		pi = 1 - fabs(NormalRandom(0, 1) / 100);
@@ -286,6 +284,15 @@ void change_for_ini_cell(Cell* pNew) {
 		pi = pi_new;
 		pe = pe_new;
 	}
+}
+
+void change_for_ini_cell(Cell* pNew) {
+	// change pi pe.
+	int pi_index = pNew->custom_data.find_variable_index("pi");
+	int pe_index = pNew->custom_data.find_variable_index("pe");
+	int pf_index = pNew->custom_data.find_variable_index("pf");
+	double pi, pe; 
+	draw_initial_pi_pe(pi, pe);
 
 	pNew->custom_data[pi_index] = pi;
 	pNew->custom_data[pe_index] = pe;
@@ -294,9 +301,18 @@ void change_for_ini_cell(Cell* pNew) {
 
 void setup_tissue( void )
 {
+	// load a precomputed population if the XML gives one 
+	if( PhysiCell_settings.enable_initial_cell_list == true )
+	{
+		load_cells( PhysiCell_settings.initial_cell_list_filename ); 
+		return; 
+	}
+	
 	// create some cells near the origin
 	
-	Cell* pC;
+	std::vector< std::vector<double> > positions; 
+	Cell_Batch_Overrides overrides; 
+	overrides.custom_data_names = { "pi", "pe", "pf" }; 
         
 	int sample_num = parameters.ints("sample_num");
 	int radius = parameters.ints("radius");
@@ -313,12 +329,16 @@ void setup_tissue( void )
 	for (int id : index) {
 		cord c = T[id];
 		if (c.x * c.x + c.y * c.y  + c.z * c.z> radius * radius * radius) { continue; }
-		pC = create_cell(); 
-		change_for_ini_cell(pC);
-		pC->assign_position( (double) c.x, (double) c.y, (double) c.z );
+		// draw pi/pe serially so the random stream matches the cell order 
+		double pi, pe; 
+		draw_initial_pi_pe(pi, pe);
+		positions.push_back( { (double) c.x, (double) c.y, (double) c.z } );
+		overrides.custom_data_values.push_back( { pi, pe, 1 - pi - pe } );
 		count++;
 		if (count > sample_num) { break; }
 	}
+	// build and register all cells in one pass 
+	create_cells( cell_defaults, positions, overrides );
 
 	return; 
 }
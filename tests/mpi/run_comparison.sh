@@ -0,0 +1,75 @@
+#!/bin/bash
+# Builds each project with and without MPI (make MPI=1) in scratch copies of the 
+# tree, and runs it 
+#   without MPI, 
+#   with MPI on one rank: the final cells must be bitwise the same, and 
+#   with MPI on RANKS ranks: the final microenvironment must match to round-off 
+#     and the number of agents exactly (compared with compare_precision). 
+#
+# usage: ./run_comparison.sh [max time in min] [ranks] [project ...]
+#   projects are the Makefile project targets whose main() sets up the 
+#   decomposition (wjy-3D, wjy-2D) 
+# set MPI_WORK to choose the scratch directory (default /tmp/physicell_mpi)
+
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+WORK=${MPI_WORK:-/tmp/physicell_mpi}
+MAX_TIME=${1:-60}
+RANKS=${2:-4}
+shift 2
+PROJECTS=${@:-wjy-3D wjy-2D}
+
+command -v mpirun > /dev/null || { echo "Error: mpirun not found"; exit 2; }
+LAUNCH="mpirun"
+# Open MPI refuses to run as root, and more ranks than cores, unless asked 
+mpirun --version 2>&1 | grep -q "Open MPI" && LAUNCH="mpirun --allow-run-as-root --oversubscribe"
+
+make -C "$ROOT/tests/precision" > /dev/null || exit 2
+COMPARE="$ROOT/tests/precision/compare_precision"
+
+prepare() # project, MPI (0 or 1), destination 
+{
+	rm -rf "$3" && mkdir -p "$3"
+	(cd "$ROOT" && tar cf - --exclude=./.git --exclude=./output --exclude=./tests --exclude='*.o' .) | (cd "$3" && tar xf -)
+	cd "$3"
+	make "$1" > /dev/null
+	# fixed seeds and one thread per rank 
+	sed -i 's/srand( *( *int *) *time( *0 *) *)/srand(0)/; s/SeedRandom();/SeedRandom(0);/' main.cpp custom_modules/*.cpp 2> /dev/null
+	sed -i -e "s|<max_time units=\"min\">[^<]*</max_time>|<max_time units=\"min\">$MAX_TIME</max_time>|" \
+		-e "s|<omp_num_threads>[0-9]*|<omp_num_threads>1|" -e "s|<deterministic>false|<deterministic>true|" config/PhysiCell_settings.xml
+	make -j4 MPI="$2" > build.log 2>&1 || { echo "Error: $1 (MPI=$2) did not build; see $3/build.log"; return 1; }
+	return 0
+}
+
+run() # directory, output folder, launcher 
+{
+	cd "$1"
+	PROGRAM=$(grep -m1 "^PROGRAM_NAME" Makefile | sed 's/.*:= *//' | tr -d '\r ')
+	sed -i "s|<folder>[^<]*</folder>|<folder>$2</folder>|" config/PhysiCell_settings.xml
+	rm -rf "$2" && mkdir -p "$2"
+	$3 ./$PROGRAM > "$2.log" 2>&1 || { echo "Error: $1 ($2) did not run; see $1/$2.log"; return 1; }
+	return 0
+}
+
+FAILED=""
+for project in $PROJECTS; do
+	echo "=== $project ($MAX_TIME min, $RANKS ranks)"
+	ok=1
+	(prepare "$project" 0 "$WORK/$project-serial" && run "$WORK/$project-serial" output "") || ok=0
+	(prepare "$project" 1 "$WORK/$project-mpi" && run "$WORK/$project-mpi" output1 "$LAUNCH -np 1" \
+		&& run "$WORK/$project-mpi" output$RANKS "$LAUNCH -np $RANKS") || ok=0
+	if [ $ok == 1 ]; then
+		if cmp -s "$WORK/$project-serial/output/final_cell_list.bin" "$WORK/$project-mpi/output1/final_cell_list.bin"; then
+			echo "  one rank: final cells bitwise identical PASS"
+		else
+			echo "  one rank: final cells differ FAIL"; ok=0
+		fi
+		"$COMPARE" "$WORK/$project-mpi/output1" "$WORK/$project-mpi/output$RANKS" 1e-12 1e-12 0 || ok=0
+	fi
+	[ $ok == 1 ] || FAILED="$FAILED $project"
+done
+
+if [ -n "$FAILED" ]; then
+	echo "FAILED:$FAILED"
+	exit 1
+fi
+echo "all projects PASS"
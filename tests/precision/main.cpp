@@ -0,0 +1,182 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include "BioFVM_matlab.h" 
+
+// Compares the final state of a single-precision run against a double-precision 
+// reference run of the same project. Both output folders must have been written 
+// with the same mesh and the same substrates. 
+// 
+// usage: compare_precision <double output folder> <single output folder> 
+//            [density tolerance] [total tolerance] [cell count tolerance]
+
+struct Tolerances
+{
+    double density;     // max |difference| relative to the reference max |density| 
+    double total;       // relative difference of the integrated substrate totals 
+    double cell_count;  // relative difference of the final number of agents 
+};
+
+bool relative_check( std::string label, double reference, double value, double difference, double tolerance )
+{
+    double scale = fabs( reference ) > 1e-300 ? fabs( reference ) : 1.0; 
+    double relative = difference / scale; 
+    bool passed = relative <= tolerance; 
+
+    std::cout << "  " << label << ": reference " << reference << " single " << value 
+        << " relative difference " << relative << " (tolerance " << tolerance << ") " 
+        << ( passed ? "PASS" : "FAIL" ) << std::endl;
+    return passed; 
+}
+
+bool compare_microenvironment( std::string reference_file, std::string test_file, Tolerances& tolerances )
+{
+    std::vector< std::vector<double> > reference = BioFVM::read_matlab( reference_file ); 
+    std::vector< std::vector<double> > test = BioFVM::read_matlab( test_file ); 
+
+    // rows are x, y, z, voxel volume, then one row per substrate 
+    if( reference.size() < 5 || reference.size() != test.size() || reference[0].size() != test[0].size() )
+    {
+        std::cout << "Error: " << reference_file << " and " << test_file 
+            << " do not describe the same mesh and substrates!" << std::endl; 
+        return false; 
+    }
+
+    bool passed = true; 
+    for( unsigned int row = 4; row < reference.size(); row++ )
+    {
+        double max_reference = 0.0; 
+        double max_difference = 0.0; 
+        double reference_total = 0.0; 
+        double test_total = 0.0; 
+        for( unsigned int n = 0; n < reference[row].size(); n++ )
+        {
+            max_reference = std::max( max_reference, fabs( reference[row][n] ) ); 
+            max_difference = std::max( max_difference, fabs( test[row][n] - reference[row][n] ) ); 
+            reference_total += reference[3][n] * reference[row][n]; 
+            test_total += reference[3][n] * test[row][n]; 
+        }
+
+        std::cout << " substrate " << row - 4 << std::endl; 
+        passed &= relative_check( "max density" , max_reference , max_reference + max_difference , 
+            max_difference , tolerances.density ); 
+        passed &= relative_check( "total" , reference_total , test_total , 
+            fabs( test_total - reference_total ) , tolerances.total ); 
+    }
+    return passed; 
+}
+
+bool compare_cells( std::string reference_file, std::string test_file, Tolerances& tolerances )
+{
+    // one column per agent 
+    std::vector< std::vector<double> > reference = BioFVM::read_matlab( reference_file ); 
+    std::vector< std::vector<double> > test = BioFVM::read_matlab( test_file ); 
+
+    double reference_count = reference.size() > 0 ? reference[0].size() : 0; 
+    double test_count = test.size() > 0 ? test[0].size() : 0; 
+
+    std::cout << " cells" << std::endl; 
+    return relative_check( "number of agents" , reference_count , test_count , 
+        fabs( test_count - reference_count ) , tolerances.cell_count ); 
+}
+
+int main( int argc, char* argv[] )
+{
+    if( argc < 3 )
+    {
+        std::cout << "usage: " << argv[0] << " <double output folder> <single output folder> " 
+            << "[density tolerance] [total tolerance] [cell count tolerance]" << std::endl; 
+        return 2; 
+    }
+
+    std::string reference_folder = argv[1]; 
+    std::string test_folder = argv[2]; 
+
+    // float storage keeps ~7 digits per step; these defaults leave room for the 
+    // rounding to accumulate over a short run and to perturb the agents a little 
+    Tolerances tolerances; 
+    tolerances.density = argc > 3 ? strtod( argv[3] , NULL ) : 1e-3; 
+    tolerances.total = argc > 4 ? strtod( argv[4] , NULL ) : 1e-4; 
+    tolerances.cell_count = argc > 5 ? strtod( argv[5] , NULL ) : 0.05; 
+
+    std::cout << ">>>>>>>>>  Precision comparison: " << reference_folder << " vs. " << test_folder << std::endl;
+
+    bool passed = compare_microenvironment( reference_folder + "/final_microenvironment0.mat" , 
+        test_folder + "/final_microenvironment0.mat" , tolerances ); 
+    passed &= compare_cells( reference_folder + "/final_cells_physicell.mat" , 
+        test_folder + "/final_cells_physicell.mat" , tolerances ); 
+
+    std::cout << ( passed ? "PASS" : "FAIL" ) << std::endl; 
+    return passed ? 0 : 1; 
+}
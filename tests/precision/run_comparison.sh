@@ -0,0 +1,66 @@
+#!/bin/bash
+# Builds each project twice (PRECISION=double and PRECISION=single) in scratch 
+# copies of the tree, runs both for a short simulated time, and compares the 
+# final microenvironments and agent counts with compare_precision. 
+#
+# usage: ./run_comparison.sh [max time in min] [project ...]
+#   projects are the Makefile project targets (wjy-2D, heterogeneity-sample, ...) 
+#   or "conservation" for unit_tests/substrate_internalization 
+# set PRECISION_WORK to choose the scratch directory (default /tmp/physicell_precision)
+
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+WORK=${PRECISION_WORK:-/tmp/physicell_precision}
+MAX_TIME=${1:-60}
+shift
+PROJECTS=${@:-conservation wjy-2D wjy-3D template2D template3D biorobots-sample cancer-biorobots-sample heterogeneity-sample cancer-immune-sample virus-macrophage-sample}
+
+make -C "$ROOT/tests/precision" > /dev/null || exit 2
+COMPARE="$ROOT/tests/precision/compare_precision"
+
+prepare() # project, precision, destination 
+{
+	rm -rf "$3" && mkdir -p "$3"
+	(cd "$ROOT" && tar cf - --exclude=./.git --exclude=./output --exclude=./tests --exclude='*.o' .) | (cd "$3" && tar xf -)
+	cd "$3"
+	if [ "$1" == "conservation" ]; then
+		cp unit_tests/substrate_internalization/custom_modules/custom.h custom_modules/
+		cp unit_tests/substrate_internalization/custom_modules/custom.cpp custom_modules/custom-unit-substrate-conservation.cpp
+		cp unit_tests/substrate_internalization/unit_test_conservation.cpp .
+		cp unit_tests/substrate_internalization/config/* config/
+		cp unit_tests/substrate_internalization/Makefile-unit-test-conservation Makefile
+	else
+		make "$1" > /dev/null
+	fi
+	# fixed seeds and one thread, so the two builds differ only in the storage precision 
+	sed -i 's/srand( *( *int *) *time( *0 *) *)/srand(0)/; s/SeedRandom();/SeedRandom(0);/' main.cpp custom_modules/*.cpp 2> /dev/null
+	sed -i -e "s|<max_time units=\"min\">[^<]*</max_time>|<max_time units=\"min\">$MAX_TIME</max_time>|" \
+		-e "s|<omp_num_threads>[0-9]*|<omp_num_threads>1|" -e "s|<deterministic>false|<deterministic>true|" config/PhysiCell_settings.xml
+	mkdir -p output
+	make -j4 PRECISION="$2" > build.log 2>&1 || { echo "Error: $1 ($2) did not build; see $3/build.log"; return 1; }
+	PROGRAM=$(grep -m1 "^PROGRAM_NAME" Makefile | sed 's/.*:= *//' | tr -d '\r ')
+	./$PROGRAM > run.log 2>&1 || { echo "Error: $1 ($2) did not run; see $3/run.log"; return 1; }
+	return 0
+}
+
+FAILED=""
+for project in $PROJECTS; do
+	echo "=== $project ($MAX_TIME min)"
+	ok=1
+	for precision in double single; do
+		(prepare "$project" "$precision" "$WORK/$project-$precision") || ok=0
+	done
+	if [ $ok == 1 ]; then
+		for precision in double single; do
+			# the conservation test reports the totals including the internalized substrates 
+			grep "Total substrates" "$WORK/$project-$precision/run.log" | sed -n '1p;$p' | sed "s/^/  $precision: /"
+		done
+		"$COMPARE" "$WORK/$project-double/output" "$WORK/$project-single/output" || ok=0
+	fi
+	[ $ok == 1 ] || FAILED="$FAILED $project"
+done
+
+if [ -n "$FAILED" ]; then
+	echo "FAILED:$FAILED"
+	exit 1
+fi
+echo "all projects PASS"
@@ -0,0 +1,263 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "BioFVM_matlab.h" 
+
+// State-level invariants of a saved run, for comparing runs of the same model 
+// at different thread counts (see run_scaling.sh): the number of agents, the 
+// integrated total of each substrate, and the agent positions. 
+// 
+// usage: state_invariants <output folder> 
+//            prints the invariants of <output folder>/final* 
+//        state_invariants <reference folder> <test folder> 
+//            [cell count tolerance] [total tolerance] [position tolerance] 
+//            compares them; with a position tolerance of 0, the positions 
+//            must be bitwise identical (same checksum) 
+
+struct Invariants
+{
+    bool valid; 
+    double agents; 
+    std::vector<double> totals;   // one per substrate 
+    double centroid[3]; 
+    double rms_radius;            // about the centroid 
+    unsigned long long checksum;  // of (ID, x, y, z) in ID order 
+}; 
+
+// FNV-1a over the bytes of the value 
+void add_to_checksum( unsigned long long& checksum, double value )
+{
+    unsigned char bytes[sizeof(double)]; 
+    memcpy( bytes , &value , sizeof(double) ); 
+    for( unsigned int i = 0; i < sizeof(double); i++ )
+    {
+        checksum ^= bytes[i]; 
+        checksum *= 1099511628211ULL; 
+    }
+    return; 
+}
+
+Invariants measure( std::string folder )
+{
+    Invariants out; 
+    out.valid = false; 
+
+    // rows are x, y, z, voxel volume, then one row per substrate 
+    std::vector< std::vector<double> > voxels = BioFVM::read_matlab( folder + "/final_microenvironment0.mat" ); 
+    // one column per agent; rows 0-3 are the ID and the position 
+    std::vector< std::vector<double> > cells = BioFVM::read_matlab( folder + "/final_cells_physicell.mat" ); 
+    if( voxels.size() < 5 || cells.size() < 4 )
+    {
+        std::cout << "Error: " << folder << " has no final microenvironment and cells!" << std::endl; 
+        return out; 
+    }
+
+    for( unsigned int row = 4; row < voxels.size(); row++ )
+    {
+        double total = 0.0; 
+        for( unsigned int n = 0; n < voxels[row].size(); n++ )
+        { total += voxels[3][n] * voxels[row][n]; }
+        out.totals.push_back( total ); 
+    }
+
+    unsigned int count = cells[0].size(); 
+    out.agents = count; 
+
+    // the agents are saved in container order, which may depend on the threads 
+    std::vector<unsigned int> order( count ); 
+    for( unsigned int n = 0; n < count; n++ )
+    { order[n] = n; }
+    std::sort( order.begin() , order.end() , 
+        [&cells]( unsigned int a, unsigned int b ) { return cells[0][a] < cells[0][b]; } ); 
+
+    out.checksum = 14695981039346656037ULL; 
+    for( int i = 0; i < 3; i++ )
+    { out.centroid[i] = 0.0; }
+    for( unsigned int k = 0; k < count; k++ )
+    {
+        unsigned int n = order[k]; 
+        for( int i = 0; i < 4; i++ )
+        { add_to_checksum( out.checksum , cells[i][n] ); }
+        for( int i = 0; i < 3; i++ )
+        { out.centroid[i] += cells[i+1][n]; }
+    }
+    for( int i = 0; i < 3 && count > 0; i++ )
+    { out.centroid[i] /= count; }
+
+    out.rms_radius = 0.0; 
+    for( unsigned int n = 0; n < count; n++ )
+    {
+        for( int i = 0; i < 3; i++ )
+        {
+            double d = cells[i+1][n] - out.centroid[i]; 
+            out.rms_radius += d * d; 
+        }
+    }
+    out.rms_radius = count > 0 ? sqrt( out.rms_radius / count ) : 0.0; 
+
+    out.valid = true; 
+    return out; 
+}
+
+void display( Invariants& invariants, std::string label )
+{
+    std::cout << label << " agents " << invariants.agents; 
+    for( unsigned int k = 0; k < invariants.totals.size(); k++ )
+    { std::cout << " total" << k << " " << invariants.totals[k]; }
+    std::cout << " centroid " << invariants.centroid[0] << " " << invariants.centroid[1] << " " 
+        << invariants.centroid[2] << " rms_radius " << invariants.rms_radius 
+        << " checksum " << std::hex << std::setw(16) << std::setfill('0') << invariants.checksum 
+        << std::dec << std::setfill(' ') << std::endl; 
+    return; 
+}
+
+bool relative_check( std::string label, double reference, double value, double tolerance )
+{
+    double scale = fabs( reference ) > 1e-300 ? fabs( reference ) : 1.0; 
+    double relative = fabs( value - reference ) / scale; 
+    bool passed = relative <= tolerance; 
+
+    std::cout << "  " << label << ": reference " << reference << " test " << value 
+        << " relative difference " << relative << " (tolerance " << tolerance << ") " 
+        << ( passed ? "PASS" : "FAIL" ) << std::endl;
+    return passed; 
+}
+
+int main( int argc, char* argv[] )
+{
+    std::cout << std::setprecision( 12 ); 
+    if( argc == 2 )
+    {
+        Invariants invariants = measure( argv[1] ); 
+        if( invariants.valid == false )
+        { return 2; }
+        display( invariants , argv[1] ); 
+        return 0; 
+    }
+    if( argc < 3 )
+    {
+        std::cout << "usage: " << argv[0] << " <output folder>" << std::endl 
+            << "       " << argv[0] << " <reference folder> <test folder> " 
+            << "[cell count tol] [total tol] [position tol]" << std::endl; 
+        return 2; 
+    }
+
+    Invariants reference = measure( argv[1] ); 
+    Invariants test = measure( argv[2] ); 
+    if( reference.valid == false || test.valid == false )
+    { return 2; }
+    if( reference.totals.size() != test.totals.size() )
+    {
+        std::cout << "Error: " << argv[1] << " and " << argv[2] << " do not have the same substrates!" << std::endl; 
+        return 2; 
+    }
+
+    // the defaults expect bitwise reproducible runs 
+    double count_tolerance = argc > 3 ? strtod( argv[3] , NULL ) : 0.0; 
+    double total_tolerance = argc > 4 ? strtod( argv[4] , NULL ) : 0.0; 
+    double position_tolerance = argc > 5 ? strtod( argv[5] , NULL ) : 0.0; 
+
+    bool passed = relative_check( "number of agents" , reference.agents , test.agents , count_tolerance ); 
+    for( unsigned int k = 0; k < reference.totals.size(); k++ )
+    {
+        std::string label = "total of substrate " + std::to_string( k ); 
+        passed &= relative_check( label , reference.totals[k] , test.totals[k] , total_tolerance ); 
+    }
+    if( position_tolerance > 0.0 )
+    {
+        // the centroid relative to the spread of the agents 
+        double scale = std::max( reference.rms_radius , 1e-300 ); 
+        double shift = 0.0; 
+        for( int i = 0; i < 3; i++ )
+        { shift += ( test.centroid[i] - reference.centroid[i] ) * ( test.centroid[i] - reference.centroid[i] ); }
+        shift = sqrt( shift ) / scale; 
+        bool centroid_passed = shift <= position_tolerance; 
+        std::cout << "  centroid shift: " << shift << " rms radii (tolerance " << position_tolerance << ") " 
+            << ( centroid_passed ? "PASS" : "FAIL" ) << std::endl; 
+        passed &= centroid_passed; 
+        passed &= relative_check( "rms radius" , reference.rms_radius , test.rms_radius , position_tolerance ); 
+    }
+    else
+    {
+        bool checksum_passed = ( reference.checksum == test.checksum ); 
+        std::cout << "  position checksum: reference " << std::hex << reference.checksum << " test " << test.checksum 
+            << std::dec << " " << ( checksum_passed ? "PASS" : "FAIL" ) << std::endl; 
+        passed &= checksum_passed; 
+    }
+
+    std::cout << ( passed ? "PASS" : "FAIL" ) << std::endl; 
+    return passed ? 0 : 1; 
+}
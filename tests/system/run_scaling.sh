@@ -0,0 +1,183 @@
+#!/bin/bash
+# Strong and weak scaling, and determinism, of the standard projects. Each
+# project is built in a scratch copy of the tree with a fixed seed, and run for
+# a short simulated time at each problem size and at 1, 2, 4, ... threads, with
+# the task graph in deterministic mode and recording the wall time of each
+# task (<record_task_times>). For each run it reports
+#   the wall time, speedup and parallel efficiency against one thread,
+#   the cumulative wall time of each phase (task); "other" is the rest of the
+#     run (diffusion, outputs and setup in the projects whose main() runs them
+#     outside the task graph), and
+#   the state invariants of the final step (state_invariants): the number of
+#     agents, the total of each substrate, and the agent positions.
+# A second one-thread run must reproduce the first bitwise. The runs at more
+# threads are compared with the one-thread run within INVARIANT_TOLERANCES
+# ("<cell count> <substrate total> <position>", default "0.05 0.01 0.05"), as
+# models that draw random numbers in parallel loops draw them in a different
+# order with more threads; set it to "0 0 0" for models that should be bitwise
+# reproducible at any thread count.
+#
+# usage: ./run_scaling.sh [max time in min] [max threads] [sizes] [project ...]
+#   sizes are comma-separated multipliers of the initial number of cells
+#     (default 1,4); with sizes equal to thread counts, the weak scaling
+#     efficiency T(1 thread, size 1) / T(p threads, size p) is reported as well
+#   projects are heterogeneity, cancer_immune, biorobots and wjy-3D (default all)
+# set SCALING_WORK to choose the scratch directory (default /tmp/physicell_scaling);
+# the timings are also written to $SCALING_WORK/scaling.csv
+
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+WORK=${SCALING_WORK:-/tmp/physicell_scaling}
+MAX_TIME=${1:-60}
+MAX_THREADS=${2:-$(nproc)}
+SIZES=$(echo "${3:-1,4}" | tr ',' ' ')
+shift $(( $# < 3 ? $# : 3 ))
+PROJECTS=${@:-heterogeneity cancer_immune biorobots wjy-3D}
+TOLERANCES=${INVARIANT_TOLERANCES:-0.05 0.01 0.05}
+
+make -C "$ROOT/tests/system" > /dev/null || exit 2
+INVARIANTS="$ROOT/tests/system/state_invariants"
+
+THREADS=""
+for (( t=1; t < MAX_THREADS; t*=2 )); do THREADS="$THREADS $t"; done
+THREADS="$THREADS $MAX_THREADS"
+
+# the Makefile target, and the user parameters that set the initial number of
+# cells, each with the power of the size multiplier it scales with
+target()
+{
+	case "$1" in
+		heterogeneity) echo "heterogeneity-sample" ;;
+		cancer_immune) echo "cancer-immune-sample" ;;
+		biorobots) echo "biorobots-sample" ;;
+		*) echo "$1" ;;
+	esac
+}
+
+size_parameters()
+{
+	case "$1" in
+		heterogeneity) echo "tumor_radius:0.5" ;; # 2-D disc
+		cancer_immune) echo "tumor_radius:0.333333" ;; # 3-D ball
+		biorobots) echo "number_of_cargo_clusters:1 number_of_workers:1 number_of_directors:1" ;;
+		wjy-3D) echo "sample_num:1" ;;
+	esac
+}
+
+prepare() # project, size, destination
+{
+	rm -rf "$3" && mkdir -p "$3"
+	(cd "$ROOT" && tar cf - --exclude=./.git --exclude=./output --exclude=./tests --exclude='*.o' .) | (cd "$3" && tar xf -)
+	cd "$3"
+	make "$(target "$1")" > /dev/null || { echo "Error: no project $1"; return 1; }
+	CONFIG=config/PhysiCell_settings.xml
+	# fixed seeds; saves (and the status with the task times) only at the start and the end
+	sed -i 's/srand( *( *int *) *time( *0 *) *)/srand(0)/; s/SeedRandom();/SeedRandom(0);/' main.cpp custom_modules/*.cpp 2> /dev/null
+	sed -i -e "s|<max_time units=\"min\">[^<]*</max_time>|<max_time units=\"min\">$MAX_TIME</max_time>|" \
+		-e "s|<interval units=\"min\">[^<]*</interval>|<interval units=\"min\">$MAX_TIME</interval>|" $CONFIG
+	if grep -q "<task_graph>" $CONFIG; then
+		sed -i -e "s|<deterministic>false|<deterministic>true|" -e "s|<record_task_times>false|<record_task_times>true|" $CONFIG
+	else
+		sed -i "s|</parallel>|\t<task_graph><deterministic>true</deterministic><record_task_times>true</record_task_times></task_graph>\n\t</parallel>|" $CONFIG
+	fi
+	for parameter in $(size_parameters "$1"); do
+		name=${parameter%%:*}
+		power=${parameter##*:}
+		value=$(sed -n "s|.*<$name [^>]*>\([^<]*\)</$name>.*|\1|p" $CONFIG | head -1)
+		scaled=$(awk -v v="$value" -v s="$2" -v p="$power" -v name="$name" \
+			'BEGIN{ x = v * s^p; if( name ~ /number|num/ ) { x = int( x + 0.5 ) } print x }')
+		sed -i "s|\(<$name [^>]*>\)[^<]*</|\1$scaled</|" $CONFIG
+	done
+	make -j4 > build.log 2>&1 || { echo "Error: $1 did not build; see $3/build.log"; return 1; }
+	return 0
+}
+
+run() # directory, output folder, threads; prints the wall time in seconds
+{
+	cd "$1"
+	PROGRAM=$(grep -m1 "^PROGRAM_NAME" Makefile | sed 's/.*:= *//' | tr -d '\r ')
+	sed -i -e "s|<folder>[^<]*</folder>|<folder>$2</folder>|" \
+		-e "s|<omp_num_threads>[0-9]*|<omp_num_threads>$3|" config/PhysiCell_settings.xml
+	rm -rf "$2" && mkdir -p "$2"
+	start=$(date +%s.%N)
+	./$PROGRAM > "$2.log" 2>&1 || { echo "Error: $1 ($2) did not run; see $1/$2.log" >&2; return 1; }
+	end=$(date +%s.%N)
+	awk -v a="$start" -v b="$end" 'BEGIN{ printf "%.3f" , b - a }'
+	return 0
+}
+
+# the cumulative task times of the last status in the log, as "name seconds" lines
+phase_times() # log
+{
+	awk '/^task wall times/ { n = 0; delete names; next }
+		/^\t[^:]*: [0-9.e+-]* s \(/ { sub( /^\t/ , "" ); split( $0 , parts , ": " ); split( parts[2] , t , " " );
+			names[++n] = parts[1]; seconds[n] = t[1] }
+		END { for( i=1; i <= n; i++ ) { gsub( / /, "_" , names[i] ); print names[i] , seconds[i] } }' "$1"
+}
+
+mkdir -p "$WORK"
+CSV="$WORK/scaling.csv"
+echo "project,size,threads,phase,seconds" > "$CSV"
+
+FAILED=""
+for project in $PROJECTS; do
+	declare -A WALL=()
+	ok=1
+	for size in $SIZES; do
+		echo "=== $project (size x$size, $MAX_TIME min)"
+		DIR="$WORK/$project-x$size"
+		(prepare "$project" "$size" "$DIR") || { ok=0; continue; }
+		printf "  %8s %10s %8s %10s\n" threads "wall (s)" speedup efficiency
+		for threads in $THREADS; do
+			wall=$(run "$DIR" "output$threads" "$threads") || { ok=0; continue; }
+			WALL[$size,$threads]=$wall
+			awk -v t="$threads" -v w="$wall" -v w1="${WALL[$size,1]}" \
+				'BEGIN{ printf "  %8d %10.3f %8.2f %9.1f%%\n" , t , w , w1/w , 100*w1/(w*t) }'
+			echo "$project,$size,$threads,total,$wall" >> "$CSV"
+			phase_times "$DIR/output$threads.log" | awk -v p="$project" -v s="$size" -v t="$threads" -v w="$wall" \
+				'{ print p "," s "," t "," $1 "," $2; sum += $2 } END { print p "," s "," t ",other," ( w - sum > 0 ? w - sum : 0 ) }' >> "$CSV"
+		done
+
+		# the phases, one column per thread count
+		printf "  %-32s" "phase (s)"; for threads in $THREADS; do printf " %10s" "$threads"; done; echo
+		grep "^$project,$size," "$CSV" | grep -v ",total," | awk -F, -v order="$THREADS" \
+			'{ if( !( $4 in seen ) ) { seen[$4] = 1; names[++n] = $4 } s[$4 "," $3] = $5 }
+			END { k = split( order , t , " " ); for( i=1; i <= n; i++ ) { printf "  %-32s" , names[i];
+				for( j=1; j <= k; j++ ) { printf " %10.3f" , s[names[i] "," t[j]] } printf "\n" } }'
+
+		# determinism: one thread twice, bitwise; more threads, within the tolerances
+		[ -d "$DIR/output1" ] || continue
+		"$INVARIANTS" "$DIR/output1" | sed "s|^$DIR/||; s/^/  /"
+		run "$DIR" output1-repeat 1 > /dev/null || { ok=0; continue; }
+		if "$INVARIANTS" "$DIR/output1" "$DIR/output1-repeat" > "$DIR/repeat.log"; then
+			echo "  one thread, repeated: bitwise identical PASS"
+		else
+			echo "  one thread, repeated: differs FAIL (see $DIR/repeat.log)"; ok=0
+		fi
+		for threads in $THREADS; do
+			[ "$threads" == 1 ] && continue
+			[ -d "$DIR/output$threads" ] || continue
+			if "$INVARIANTS" "$DIR/output1" "$DIR/output$threads" $TOLERANCES > "$DIR/invariants$threads.log"; then
+				echo "  $threads threads vs. one: invariants PASS"
+			else
+				echo "  $threads threads vs. one: invariants FAIL (see $DIR/invariants$threads.log)"; ok=0
+			fi
+		done
+	done
+
+	# weak scaling, where a size matches a thread count
+	for threads in $THREADS; do
+		if [ -n "${WALL[1,1]}" ] && [ -n "${WALL[$threads,$threads]}" ] && [ "$threads" != 1 ]; then
+			awk -v t="$threads" -v w1="${WALL[1,1]}" -v w="${WALL[$threads,$threads]}" \
+				'BEGIN{ printf "  weak scaling, %d threads at size x%d: efficiency %.1f%%\n" , t , t , 100*w1/w }'
+		fi
+	done
+	[ $ok == 1 ] || FAILED="$FAILED $project"
+	unset WALL
+done
+
+echo "timings: $CSV"
+if [ -n "$FAILED" ]; then
+	echo "FAILED:$FAILED"
+	exit 1
+fi
+echo "all projects PASS"
@@ -0,0 +1,508 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <cstdlib>
+#include <omp.h>
+#include <sys/stat.h>
+
+#include "../../core/PhysiCell.h"
+#include "../../modules/PhysiCell_standard_modules.h" 
+
+#include "kernel_benchmarks.h"
+
+using namespace BioFVM; 
+using namespace PhysiCell; 
+
+namespace{
+
+struct Fixture
+{
+    int dimension = 3;
+    int cells = 10000;
+    int mesh = 50;          // voxels per side 
+    int substrates = 2;
+    bool implicit_mesh = false;
+    int seed = 0;
+    double cell_spacing = 15.0;    // microns between lattice sites (the default cells overlap a little) 
+};
+
+struct Options
+{
+    std::vector<int> threads;
+    int repetitions = 3;
+    std::vector<std::string> kernels;
+    std::string output = "./timing_output";
+    std::string json;
+    std::string label;
+};
+
+struct Result
+{
+    std::string kernel;
+    int threads;
+    double seconds;
+    long cells;     // work items, 0 if not per cell 
+    long voxels;    // 0 if not per voxel 
+    double speedup;
+    double efficiency;
+};
+
+std::vector<int> parse_int_list( std::string text )
+{
+    std::vector<int> values;
+    std::stringstream stream( text );
+    std::string item;
+    while (std::getline( stream, item, ',' ))
+    { if (item.size() > 0) values.push_back( atoi( item.c_str() ) ); }
+    return values;
+}
+
+std::vector<std::string> parse_string_list( std::string text )
+{
+    std::vector<std::string> values;
+    std::stringstream stream( text );
+    std::string item;
+    while (std::getline( stream, item, ',' ))
+    { if (item.size() > 0) values.push_back( item ); }
+    return values;
+}
+
+// the N lattice sites nearest the center of a k^d lattice (k = ceil(N^(1/d))), in 
+// lattice order, each moved by up to a quarter spacing. Same seed, same tissue. 
+std::vector< std::vector<double> > tissue_positions( Fixture& f, double& width )
+{
+    int k = (int) ceil( pow( (double) f.cells, 1.0/f.dimension ) - 1e-9 );
+    long sites = (f.dimension == 3) ? (long) k*k*k : (long) k*k;
+    width = k * f.cell_spacing;
+
+    std::vector<long> order( sites );
+    std::vector<double> distance( sites );
+    double center = 0.5*(k-1);
+    for (long n=0; n<sites; n++)
+    {
+        order[n] = n;
+        double x = n % k - center;
+        double y = (n / k) % k - center;
+        double z = (f.dimension == 3) ? n / ((long) k*k) - center : 0.0;
+        distance[n] = x*x + y*y + z*z;
+    }
+    std::nth_element( order.begin(), order.begin() + f.cells - 1, order.end(), 
+        [&distance](long a, long b) { return distance[a] < distance[b] || (distance[a] == distance[b] && a < b); } );
+    order.resize( f.cells );
+    std::sort( order.begin(), order.end() );
+
+    std::mt19937 generator( f.seed );
+    std::uniform_real_distribution<double> jitter( -0.25*f.cell_spacing, 0.25*f.cell_spacing );
+    std::vector< std::vector<double> > positions( f.cells, std::vector<double>( 3, 0.0 ) );
+    for (int i=0; i<f.cells; i++)
+    {
+        long n = order[i];
+        positions[i][0] = (n % k - center) * f.cell_spacing + jitter( generator );
+        positions[i][1] = ((n / k) % k - center) * f.cell_spacing + jitter( generator );
+        if (f.dimension == 3)
+        { positions[i][2] = (n / ((long) k*k) - center) * f.cell_spacing + jitter( generator ); }
+    }
+    return positions;
+}
+
+void build_fixture( Fixture& f )
+{
+    double width;
+    std::vector< std::vector<double> > positions = tissue_positions( f, width );
+
+    // the tissue, with a margin of a tenth of its width on each side 
+    double half = 0.6 * width;
+    double dx = 2.0*half / f.mesh;
+    default_microenvironment_options.simulate_2D = (f.dimension == 2);
+    default_microenvironment_options.X_range = { -half, half };
+    default_microenvironment_options.Y_range = { -half, half };
+    default_microenvironment_options.Z_range = { -half, half };
+    default_microenvironment_options.dx = dx;
+    default_microenvironment_options.dy = dx;
+    default_microenvironment_options.dz = dx;
+    default_microenvironment_options.calculate_gradients = true;
+    default_microenvironment_options.implicit_mesh = f.implicit_mesh;
+    default_microenvironment_options.outer_Dirichlet_conditions = true;
+
+    // oxygen, then signals with slower diffusion 
+    microenvironment.set_density( 0, "oxygen", "mmHg", 1e5, 0.1 );
+    for (int i=1; i<f.substrates; i++)
+    { microenvironment.add_density( "signal" + std::to_string(i), "dimensionless", 1e3, 0.01 ); }
+    default_microenvironment_options.use_oxygen_as_first_field = false;
+    default_microenvironment_options.Dirichlet_condition_vector.assign( f.substrates, 0.0 );
+    default_microenvironment_options.Dirichlet_condition_vector[0] = 38.0;
+    default_microenvironment_options.Dirichlet_activation_vector.assign( f.substrates, true );
+    default_microenvironment_options.initial_condition_vector.assign( f.substrates, 0.0 );
+    default_microenvironment_options.initial_condition_vector[0] = 38.0;
+    initialize_microenvironment();
+
+    double mechanics_voxel_size = 30;
+    create_cell_container_for_microenvironment( microenvironment, mechanics_voxel_size );
+
+    // default cells that take up oxygen and secrete the signals, and do nothing else 
+    SeedRandom( f.seed );
+    initialize_default_cell_definition();
+    cell_defaults.phenotype.secretion.sync_to_microenvironment( &microenvironment );
+    cell_defaults.phenotype.secretion.uptake_rates[0] = 10.0;
+    for (int i=1; i<f.substrates; i++)
+    {
+        cell_defaults.phenotype.secretion.secretion_rates[i] = 1.0;
+        cell_defaults.phenotype.secretion.saturation_densities[i] = 1.0;
+    }
+    cell_defaults.functions.update_phenotype = NULL;
+    cell_defaults.functions.custom_cell_rule = NULL;
+
+    create_cells( cell_defaults, positions );
+    return;
+}
+
+double seconds_of( std::function<void()>& kernel )
+{
+    double start = omp_get_wtime();
+    kernel();
+    return omp_get_wtime() - start;
+}
+
+bool selected( Options& options, std::string kernel )
+{
+    if (options.kernels.size() == 0) return true;
+    return std::find( options.kernels.begin(), options.kernels.end(), kernel ) != options.kernels.end();
+}
+
+void write_json( Options& options, Fixture& f, std::vector<Result>& results )
+{
+    std::ofstream file( options.json.c_str() );
+    if (!file)
+    {
+        std::cout << "Error: could not open " << options.json << std::endl;
+        return;
+    }
+    file << "[" << std::endl;
+    for (int i=0; i<results.size(); i++)
+    {
+        Result& r = results[i];
+        file << "{\"label\": \"" << options.label << "\", \"kernel\": \"" << r.kernel << "\", \"dimension\": " << f.dimension 
+            << ", \"cells\": " << f.cells << ", \"mesh\": " << f.mesh << ", \"voxels\": " << microenvironment.number_of_voxels() 
+            << ", \"substrates\": " << f.substrates << ", \"implicit_mesh\": " << (f.implicit_mesh ? "true" : "false") 
+            << ", \"threads\": " << r.threads << ", \"repetitions\": " << options.repetitions << ", \"seconds\": " << r.seconds;
+        if (r.cells > 0) file << ", \"ns_per_cell\": " << 1e9*r.seconds/r.cells;
+        if (r.voxels > 0) file << ", \"ns_per_voxel\": " << 1e9*r.seconds/r.voxels;
+        file << ", \"speedup\": " << r.speedup << ", \"efficiency\": " << r.efficiency << "}" 
+            << ((i+1 < results.size()) ? "," : "") << std::endl;
+    }
+    file << "]" << std::endl;
+    std::cout << "wrote " << results.size() << " results to " << options.json << std::endl;
+    return;
+}
+
+// the value after "key": in a one-line JSON record 
+std::string json_field( std::string& line, std::string key )
+{
+    size_t start = line.find( "\"" + key + "\":" );
+    if (start == std::string::npos) return "";
+    start = line.find_first_not_of( " \"", start + key.size() + 3 );
+    size_t end = line.find_first_of( ",}\"", start );
+    return line.substr( start, end - start );
+}
+
+std::vector<std::string> read_json_records( std::string filename )
+{
+    std::vector<std::string> records;
+    std::ifstream file( filename.c_str() );
+    if (!file)
+    { std::cout << "Error: could not open " << filename << std::endl; }
+    std::string line;
+    while (std::getline( file, line ))
+    { if (line.find( "\"kernel\"" ) != std::string::npos) records.push_back( line ); }
+    return records;
+}
+
+std::string record_key( std::string& record )
+{
+    return json_field( record, "kernel" ) + " " + json_field( record, "dimension" ) + "D, " + json_field( record, "cells" ) 
+        + " cells, " + json_field( record, "voxels" ) + " voxels, " + json_field( record, "threads" ) + " threads";
+}
+
+};
+
+int time_kernels( int argc, char* argv[] )
+{
+    std::cout << "--------------  " << __FUNCTION__ << " -------------- " << std::endl;
+
+    Fixture f;
+    Options options;
+    for (int i=2; i<argc; i++)
+    {
+        std::string arg = argv[i];
+        std::string value = (i+1 < argc) ? argv[i+1] : "";
+        if (arg == "--dimension") { f.dimension = atoi( value.c_str() ); i++; }
+        else if (arg == "--cells") { f.cells = atoi( value.c_str() ); i++; }
+        else if (arg == "--mesh") { f.mesh = atoi( value.c_str() ); i++; }
+        else if (arg == "--substrates") { f.substrates = std::max( 1, atoi( value.c_str() ) ); i++; }
+        else if (arg == "--seed") { f.seed = atoi( value.c_str() ); i++; }
+        else if (arg == "--implicit_mesh") { f.implicit_mesh = true; }
+        else if (arg == "--threads") { options.threads = parse_int_list( value ); i++; }
+        else if (arg == "--repetitions") { options.repetitions = std::max( 1, atoi( value.c_str() ) ); i++; }
+        else if (arg == "--kernels") { options.kernels = parse_string_list( value ); i++; }
+        else if (arg == "--output") { options.output = value; i++; }
+        else if (arg == "--json") { options.json = value; i++; }
+        else if (arg == "--label") { options.label = value; i++; }
+        else
+        {
+            std::cout << "Error: unknown option " << arg << std::endl;
+            return 0;
+        }
+    }
+    if (f.dimension != 2 && f.dimension != 3)
+    {
+        std::cout << "Error: the dimension must be 2 or 3" << std::endl;
+        return 0;
+    }
+    // 1, 2, 4, ... up to the available threads (and that number itself) 
+    if (options.threads.size() == 0)
+    {
+        int max_threads = omp_get_max_threads();
+        for (int t=1; t<max_threads; t*=2)
+        { options.threads.push_back( t ); }
+        options.threads.push_back( max_threads );
+    }
+
+    double start = omp_get_wtime();
+    build_fixture( f );
+    long N = (*all_cells).size();
+    long V = microenvironment.number_of_voxels();
+    std::cout << f.dimension << "-D fixture: " << N << " cells, " << V << " voxels (" << f.mesh << " per side" 
+        << (f.implicit_mesh ? ", implicit" : "") << "), " << f.substrates << " substrates, seed " << f.seed 
+        << ", built in " << omp_get_wtime() - start << " s" << std::endl;
+    mkdir( options.output.c_str(), 0755 );
+
+    double mechanics_dt = 0.1;
+    double diffusion_dt = 0.01;
+    long burst = N / 10;
+
+    // setup and teardown (if any) run around each kernel, untimed 
+    struct Kernel { std::string name; long cells; long voxels; std::function<void()> run; 
+        std::function<void()> setup; std::function<void()> teardown; };
+    std::vector<Kernel> kernels;
+    kernels.push_back( { "velocity", N, 0, [&]()
+    {
+        #pragma omp parallel for 
+        for (int i=0; i<(*all_cells).size(); i++)
+        {
+            Cell* pCell = (*all_cells)[i];
+            pCell->functions.update_velocity( pCell, pCell->phenotype, mechanics_dt );
+        }
+    } } );
+    kernels.push_back( { "position", N, 0, [&]()
+    {
+        #pragma omp parallel for 
+        for (int i=0; i<(*all_cells).size(); i++)
+        { (*all_cells)[i]->update_position( mechanics_dt ); }
+        for (int i=0; i<(*all_cells).size(); i++)
+        { (*all_cells)[i]->update_voxel_in_container(); }
+    } } );
+    kernels.push_back( { "sources_and_sinks", N, 0, [&]()
+    { microenvironment.simulate_cell_sources_and_sinks( diffusion_dt ); } } );
+    kernels.push_back( { "LOD", 0, V, [&]()
+    { microenvironment.diffusion_decay_solver( microenvironment, diffusion_dt ); } } );
+    kernels.push_back( { "LOD_steady", 0, V, [&]()
+    { microenvironment.diffusion_decay_solver( microenvironment, diffusion_dt ); }, 
+    [&]() { microenvironment.set_substrate_time_stepping( 0, 1, false, "steady" ); }, 
+    [&]() { microenvironment.set_substrate_time_stepping( 0, 1, false, "LOD" ); } } );
+    kernels.push_back( { "gradients", 0, V, [&]()
+    { microenvironment.compute_all_gradient_vectors(); } } );
+    // every tenth cell divides; then as many of the newest cells die, so the 
+    // fixture is the same size for the next kernel 
+    kernels.push_back( { "divide_burst", burst, 0, [&]()
+    {
+        for (long i=0; i<burst; i++)
+        { (*all_cells)[10*i]->divide(); }
+    } } );
+    kernels.push_back( { "death_burst", burst, 0, [&]()
+    {
+        for (long i=0; i<burst; i++)
+        { (*all_cells)[ (*all_cells).size()-1 ]->die(); }
+    } } );
+    set_save_biofvm_mesh_as_matlab( true );
+    set_save_biofvm_data_as_matlab( true );
+    set_save_biofvm_cell_data( true );
+    set_save_biofvm_cell_data_as_custom_matlab( true );
+    std::string base = options.output + "/benchmark";
+    kernels.push_back( { "MultiCellDS", N, V, [&]()
+    { save_PhysiCell_to_MultiCellDS_xml_pugi( base, microenvironment, 0.0 ); } } );
+    kernels.push_back( { "SVG", N, 0, [&]()
+    { SVG_plot( base + ".svg", microenvironment, 0.0, 0.0, simple_cell_coloring ); } } );
+    kernels.push_back( { "raster", N, 0, [&]()
+    { raster_plot( base + ".png", microenvironment, 0.0, 0.0, simple_cell_coloring ); } } );
+    kernels.push_back( { "POV", N, 0, [&]()
+    { POV_plot( base + ".pov", simple_cell_coloring ); } } );
+    kernels.push_back( { "cell_list", N, 0, [&]()
+    { write_cell_list( base + "_cell_list.bin" ); } } );
+    kernels.push_back( { "metrics", N, V, [&]()
+    { write_metrics( 0.0, microenvironment ); }, 
+    [&]() { open_metrics_stream( base + "_metrics.csv" ); }, 
+    [&]() { close_metrics_stream(); } } );
+
+    std::vector<Result> results;
+    std::cout << std::endl << "kernel              threads     seconds     ns/cell    ns/voxel  speedup  efficiency" << std::endl;
+    for (int k=0; k<kernels.size(); k++)
+    {
+        Kernel& kernel = kernels[k];
+        // the bursts run in pairs, so the fixture keeps its size 
+        if (kernel.name == "death_burst") continue;
+        if (!selected( options, kernel.name ) && !(kernel.name == "divide_burst" && selected( options, "death_burst" ))) continue;
+        std::vector<Kernel*> group( 1, &kernel );
+        if (kernel.name == "divide_burst") group.push_back( &kernels[k+1] );
+
+        if (kernel.setup) kernel.setup();
+        for (int t=0; t<options.threads.size(); t++)
+        {
+            omp_set_num_threads( options.threads[t] );
+            std::vector<double> best( group.size(), 1e300 );
+            for (int r=0; r<options.repetitions; r++)
+            {
+                for (int g=0; g<group.size(); g++)
+                { best[g] = std::min( best[g], seconds_of( group[g]->run ) ); }
+            }
+            for (int g=0; g<group.size(); g++)
+            {
+                Result result = { group[g]->name, options.threads[t], best[g], group[g]->cells, group[g]->voxels, 1.0, 1.0 };
+                // relative to the first thread count of this kernel 
+                for (int i=results.size()-1; i>=0; i--)
+                {
+                    if (results[i].kernel == result.kernel && results[i].threads == options.threads[0])
+                    {
+                        result.speedup = results[i].seconds / result.seconds;
+                        result.efficiency = result.speedup * options.threads[0] / result.threads;
+                        break;
+                    }
+                }
+                results.push_back( result );
+
+                char per_cell[64] = "-";
+                char per_voxel[64] = "-";
+                if (result.cells > 0) sprintf( per_cell, "%.4g", 1e9*result.seconds/result.cells );
+                if (result.voxels > 0) sprintf( per_voxel, "%.4g", 1e9*result.seconds/result.voxels );
+                char line[1024];
+                sprintf( line, "%-18s %8d %11.4g %11s %11s %8.2f %11.2f", result.kernel.c_str(), result.threads, result.seconds, 
+                    per_cell, per_voxel, result.speedup, result.efficiency );
+                std::cout << line << std::endl;
+            }
+        }
+        if (kernel.teardown) kernel.teardown();
+    }
+
+    if (options.json.size() > 0)
+    { write_json( options, f, results ); }
+    return 1;
+}
+
+int compare_kernel_timings( int argc, char* argv[] )
+{
+    std::cout << "--------------  " << __FUNCTION__ << " -------------- " << std::endl;
+    if (argc < 4)
+    {
+        std::cout << "usage: " << argv[0] << " compare <baseline json> <new json> [tolerance]" << std::endl;
+        return -1;
+    }
+    double tolerance = (argc > 4) ? strtod( argv[4], NULL ) : 0.1;
+    std::vector<std::string> baseline = read_json_records( argv[2] );
+    std::vector<std::string> latest = read_json_records( argv[3] );
+
+    int slower = 0;
+    int compared = 0;
+    for (int i=0; i<latest.size(); i++)
+    {
+        std::string key = record_key( latest[i] );
+        for (int j=0; j<baseline.size(); j++)
+        {
+            if (record_key( baseline[j] ) != key) continue;
+            double before = strtod( json_field( baseline[j], "seconds" ).c_str(), NULL );
+            double after = strtod( json_field( latest[i], "seconds" ).c_str(), NULL );
+            double ratio = after / before;
+            bool regression = ratio > 1.0 + tolerance;
+            char line[1024];
+            sprintf( line, "%-60s %11.4g -> %11.4g s  x%6.3f %s", key.c_str(), before, after, ratio, 
+                regression ? "SLOWER" : ((ratio < 1.0 - tolerance) ? "faster" : "") );
+            std::cout << line << std::endl;
+            compared++;
+            if (regression) slower++;
+            break;
+        }
+    }
+    std::cout << compared << " kernels compared, " << slower << " slower by more than " << 100*tolerance << "%" << std::endl;
+    return slower;
+}
@@ -69,9 +69,13 @@
 #include <string>
 #include <random>
 #include <chrono>
+#include <omp.h>
 
 #include "PhysiCell_standard_models.h" 
 #include "PhysiCell_cell.h" 
+#include "PhysiCell_NUMA.h" 
+
+#include "kernel_benchmarks.h"
 
 //using namespace PhysiCell;   // bad practice
 
@@ -130,10 +134,101 @@ int time_custom_vars1()
     return 1;
 }
 
-int main()
+// STREAM-style triad a = b + s*c, best of several passes, in GB/s 
+double triad_bandwidth( double* a, double* b, double* c, long n )
+{
+    double best = 0.0;
+    for (int pass=0; pass<5; pass++)
+    {
+        double start = omp_get_wtime();
+        #pragma omp parallel for 
+        for (long i=0; i<n; i++)
+        { a[i] = b[i] + 3.0*c[i]; }
+        double GB_per_s = 3.0 * n * sizeof(double) / 1e9 / (omp_get_wtime() - start);
+        if (GB_per_s > best) best = GB_per_s;
+    }
+    return best;
+}
+
+// sweep the densities in the solvers' partitioning (z-slabs), best of several passes, in GB/s 
+double density_sweep_bandwidth( BioFVM::Microenvironment& M )
+{
+    int partitions = M.number_of_voxel_partitions();
+    int length = M.voxel_partition_length();
+    double best = 0.0;
+    for (int pass=0; pass<5; pass++)
+    {
+        double start = omp_get_wtime();
+        #pragma omp parallel for 
+        for (int p=0; p<partitions; p++)
+        {
+            for (int n=p*length; n<(p+1)*length; n++)
+            {
+                std::vector<BioFVM::real_t>& density = M.density_vector(n);
+                for (int k=0; k<density.size(); k++)
+                { density[k] = 0.999*density[k] + 0.001; }
+            }
+        }
+        double GB_per_s = 2.0 * M.number_of_voxels() * M.number_of_densities() * sizeof(BioFVM::real_t) / 1e9 / (omp_get_wtime() - start);
+        if (GB_per_s > best) best = GB_per_s;
+    }
+    return best;
+}
+
+int time_memory_bandwidth()
+{
+    std::cout << "--------------  " << __FUNCTION__ << " -------------- " << std::endl;
+    PhysiCell::display_thread_placement( std::cout );
+
+    long n = 1 << 24;
+    double* a = new double[n];
+    double* b = new double[n];
+    double* c = new double[n];
+
+    // every page touched by the main thread first
+    for (long i=0; i<n; i++)
+    { a[i] = 0.0; b[i] = 1.0; c[i] = 2.0; }
+    std::cout << "triad, main-thread first touch: " << triad_bandwidth(a,b,c,n) << " GB/s" << std::endl;
+    delete [] a; delete [] b; delete [] c;
+
+    // each page touched first by the thread that uses it
+    a = new double[n]; b = new double[n]; c = new double[n];
+    #pragma omp parallel for 
+    for (long i=0; i<n; i++)
+    { a[i] = 0.0; b[i] = 1.0; c[i] = 2.0; }
+    std::cout << "triad, parallel first touch:    " << triad_bandwidth(a,b,c,n) << " GB/s" << std::endl;
+    delete [] a; delete [] b; delete [] c;
+
+    // the substrate data, before and after first_touch_voxel_data
+    BioFVM::Microenvironment M;
+    M.resize_space( 0.0, 1000.0, 0.0, 1000.0, 0.0, 1000.0, 10.0, 10.0, 10.0 );
+    M.resize_densities( 4 );
+    std::cout << "density sweep, " << M.number_of_voxels() << " voxels, main-thread allocation: " 
+        << density_sweep_bandwidth(M) << " GB/s, " 
+        << 100.0*PhysiCell::fraction_of_voxel_data_on_thread_nodes(M) << "% of voxels on their thread's node" << std::endl;
+    M.first_touch_voxel_data();
+    std::cout << "density sweep, " << M.number_of_voxels() << " voxels, first touch:          " 
+        << density_sweep_bandwidth(M) << " GB/s, " 
+        << 100.0*PhysiCell::fraction_of_voxel_data_on_thread_nodes(M) << "% of voxels on their thread's node" << std::endl;
+
+    return 1;
+}
+
+int main( int argc, char* argv[] )
 {
     std::cout << ">>>>>>>>>  Timing tests" << std::endl;
-    time_custom_vars1();
+
+    // run the named tests, or all of them
+    std::string test = ( argc > 1 ) ? argv[1] : "all";
+    // the kernel benchmarks build their own fixture, so they run on their own 
+    if (test == "kernels")
+    { return time_kernels( argc, argv ); }
+    if (test == "compare")
+    { return ( compare_kernel_timings( argc, argv ) == 0 ) ? 0 : 1; }
+    if (test == "all" || test == "custom_vars")
+    { time_custom_vars1(); }
+    if (test == "all" || test == "bandwidth")
+    { time_memory_bandwidth(); }
 
     return 1;
 }
@@ -0,0 +1,51 @@
+#!/bin/bash
+# Runs the kernel benchmarks (./time_tests kernels) on a set of standard fixtures, 
+# one JSON file per fixture, or compares two such sets. 
+#
+# usage: ./run_kernel_benchmarks.sh <small|medium|large|all> [results folder] [threads, e.g. 1,2,4,8]
+#        ./run_kernel_benchmarks.sh compare <baseline folder> <new folder> [tolerance]
+#   small:  10k cells, 50^3 (and 50^2) voxels 
+#   medium: 500k cells, 200^3 (and 200^2) voxels 
+#   large:  5M cells, 400^3 (and 400^2) voxels (tens of GB in 3-D) 
+# the results folder defaults to kernel_results/<git commit> 
+
+cd "$(dirname "$0")"
+
+if [ "$1" == "compare" ]; then
+	status=0
+	for baseline in "$2"/*.json; do
+		fixture=$(basename "$baseline")
+		[ -f "$3/$fixture" ] || { echo "Warning: $3/$fixture not found"; continue; }
+		echo "=== $fixture"
+		./time_tests compare "$baseline" "$3/$fixture" ${4:-0.1} | grep -v "^>>>\|^----" 
+		[ ${PIPESTATUS[0]} == 0 ] || status=1
+	done
+	exit $status
+fi
+
+make > /dev/null || exit 2
+PRESET=${1:-small}
+LABEL=$(git rev-parse --short HEAD 2> /dev/null || echo unknown)
+RESULTS=${2:-kernel_results/$LABEL}
+THREADS=${3:+--threads $3}
+mkdir -p "$RESULTS"
+
+case $PRESET in
+	small) FIXTURES="10000:50" ;;
+	medium) FIXTURES="500000:200" ;;
+	large) FIXTURES="5000000:400" ;;
+	all) FIXTURES="10000:50 500000:200 5000000:400" ;;
+	*) echo "Error: unknown preset $PRESET"; exit 2 ;;
+esac
+
+for fixture in $FIXTURES; do
+	cells=${fixture%:*}
+	mesh=${fixture#*:}
+	for dimension in 3 2; do
+		name="${dimension}D_${cells}_cells_${mesh}_mesh"
+		echo "=== $name"
+		./time_tests kernels --dimension $dimension --cells $cells --mesh $mesh $THREADS --label "$LABEL" \
+			--output "$RESULTS/output" --json "$RESULTS/$name.json" | grep -A1000 "^kernel " 
+	done
+done
+rm -rf "$RESULTS/output"
@@ -69,6 +69,14 @@
 #include <string>
 #include "PhysiCell_standard_models.h" 
 #include "PhysiCell_cell.h" 
+#include "PhysiCell_scheduler.h" 
+#include "PhysiCell_task_graph.h" 
+#include "PhysiCell_phenotype_batches.h" 
+#include "PhysiCell_utilities.h" 
+#include "../../modules/PhysiCell_settings.h" 
+#include <algorithm>
+#include <stdexcept>
+#include <omp.h>
 
 //using namespace PhysiCell;   // bad practice
 
@@ -96,10 +104,351 @@ int custom_vars1()
     return 1;
 }
 
+// an exception from a task on a worker thread comes back out of run() 
+int task_graph1()
+{
+    std::cout << "--------------  " << __FUNCTION__ << " -------------- " << std::endl;
+    int saved_threads = omp_get_max_threads(); 
+    omp_set_num_threads( 4 ); 
+
+    PhysiCell::Task_Graph graph; 
+    std::vector<int> ran( 4 , 0 ); 
+    graph.add_task( "a" , [&ran]() { ran[0] = 1; } , {} , {"a"} ); 
+    graph.add_task( "throws" , [&ran]() { ran[1] = 1; throw std::runtime_error( "task failed" ); } , {} , {"b"} ); 
+    graph.add_task( "c" , [&ran]() { ran[2] = 1; } , {} , {"c"} ); 
+    graph.add_task( "after" , [&ran]() { ran[3] = 1; } , {"a","b","c"} , {"d"} ); 
+
+    std::string message = "none"; 
+    try
+    { graph.run(); }
+    catch( const std::exception& e )
+    { message = e.what(); }
+    std::cout << "caught: " << message << " (expected task failed), dependent task ran: " << ran[3] 
+        << " (expected 0)" << std::endl;
+
+    // the graph still runs afterwards 
+    graph.clear(); 
+    int runs = 0; 
+    graph.add_task( "again" , [&runs]() { runs++; } , {} , {"a"} ); 
+    graph.add_task( "again too" , [&runs]() { runs++; } , {} , {"b"} ); 
+    graph.run(); 
+    std::cout << "tasks run afterwards: " << runs << " (expected 2)" << std::endl;
+
+    omp_set_num_threads( saved_threads ); 
+    return message == "task failed" && ran[3] == 0 && runs == 2; 
+}
+
+int scheduler1()
+{
+    std::cout << "--------------  " << __FUNCTION__ << " -------------- " << std::endl;
+    PhysiCell::Multirate_Scheduler scheduler; 
+    int diffusion = scheduler.add_process( "diffusion" , 0.01 ); 
+    int mechanics = scheduler.add_process( "mechanics" , 0.1 ); 
+    int phenotype = scheduler.add_process( "phenotype" , 6.0 ); 
+    int hook_runs = 0; 
+    bool hook_on_time = true; 
+    scheduler.add_hook( "hourly" , 60.0 , [&hook_runs,&hook_on_time](double t) 
+    {
+        if( t != 60.0 * hook_runs )
+        { hook_on_time = false; }
+        hook_runs++; 
+    } ); 
+
+    // 30 days of diffusion steps: summing 0.01 in floating point drifts by far more than 0.01*0.01 
+    int mechanics_runs = 0; 
+    int phenotype_runs = 0; 
+    bool exact_steps = true; 
+    while( scheduler.current_time() < 30*24*60 )
+    {
+        if( scheduler.is_due( mechanics ) )
+        { mechanics_runs++; scheduler.mark_run( mechanics ); }
+        if( scheduler.is_due( phenotype ) )
+        {
+            if( phenotype_runs > 0 && scheduler.time_since_last_run( phenotype ) != 6.0 )
+            { exact_steps = false; }
+            phenotype_runs++; 
+            scheduler.mark_run( phenotype ); 
+        }
+        scheduler.run_due_hooks(); 
+        scheduler.advance( diffusion ); 
+    }
+    std::cout << "mechanics runs: " << mechanics_runs << " (expected 432000)" << std::endl;
+    std::cout << "phenotype runs: " << phenotype_runs << " (expected 7200), exact steps: " << exact_steps << std::endl;
+    std::cout << "hook runs: " << hook_runs << " (expected 720), on time: " << hook_on_time << std::endl;
+
+    // a period change takes effect from the last run 
+    scheduler.set_period( phenotype , 3.0 ); 
+    std::cout << "next phenotype after the change: " << scheduler.next_time( phenotype ) 
+        << " (expected " << 30*24*60 - 3.0 << ")" << std::endl;
+
+    return mechanics_runs == 432000 && phenotype_runs == 7200 && exact_steps && hook_runs == 720 && hook_on_time; 
+}
+
+// the batch forms of the standard functions against the per-cell ones, on the same cells 
+int phenotype_batches1()
+{
+    std::cout << "--------------  " << __FUNCTION__ << " -------------- " << std::endl;
+    BioFVM::Microenvironment M; 
+    M.set_density( 0 , "oxygen" , "mmHg" ); 
+    M.resize_space_uniform( 0 , 200 , 0 , 200 , 0 , 200 , 20 ); 
+    for( int n=0; n < M.number_of_voxels() ; n++ )
+    { M.density_vector( n )[0] = ( n % 50 ) * 0.8; } // across the proliferation and necrosis thresholds 
+    BioFVM::set_default_microenvironment( &M ); 
+
+    int number_of_cells = 500; 
+    std::vector<PhysiCell::Cell*> per_cell( number_of_cells ); 
+    std::vector<PhysiCell::Cell*> batch( number_of_cells ); 
+    for( int i=0; i < number_of_cells ; i++ )
+    {
+        for( int copy=0; copy < 2 ; copy++ )
+        {
+            PhysiCell::Cell* pCell = new PhysiCell::Cell; 
+            pCell->position = { 199.0 * ( i % 7 ) / 6.0 , 199.0 * ( i % 11 ) / 10.0 , 199.0 * ( i % 13 ) / 12.0 }; 
+            pCell->update_voxel_index(); 
+            PhysiCell::Volume& volume = pCell->phenotype.volume; 
+            volume.fluid *= 0.5 + ( i % 17 ) / 16.0; 
+            volume.nuclear_solid *= 0.2 + ( i % 5 ) / 2.0; 
+            volume.cytoplasmic_solid *= 0.3 + ( i % 3 ); 
+            volume.target_solid_nuclear *= 0.5 + ( i % 19 ) / 9.0; 
+            volume.calcification_rate = ( i % 4 ) * 0.001; 
+            pCell->phenotype.death.dead = ( i % 23 == 0 ); 
+            ( copy == 0 ? per_cell : batch )[i] = pCell; 
+        }
+    }
+
+    double dt = 6.0; 
+    for( int i=0; i < number_of_cells ; i++ )
+    {
+        PhysiCell::update_cell_and_death_parameters_O2_based( per_cell[i] , per_cell[i]->phenotype , dt ); 
+        PhysiCell::standard_volume_update_function( per_cell[i] , per_cell[i]->phenotype , dt ); 
+    }
+    PhysiCell::find_batch_function( PhysiCell::update_cell_and_death_parameters_O2_based )( batch , NULL , dt ); 
+    PhysiCell::find_batch_function( PhysiCell::standard_volume_update_function )( batch , NULL , dt ); 
+
+    // the batch loops may contract to fused multiply-adds differently 
+    double largest_difference = 0.0; 
+    for( int i=0; i < number_of_cells ; i++ )
+    {
+        PhysiCell::Phenotype& a = per_cell[i]->phenotype; 
+        PhysiCell::Phenotype& b = batch[i]->phenotype; 
+        std::vector<double> values_a = { a.volume.total , a.volume.fluid , a.volume.nuclear , a.volume.cytoplasmic , 
+            a.volume.solid , a.volume.calcified_fraction , a.volume.fluid_fraction , a.geometry.radius , a.geometry.surface_area }; 
+        std::vector<double> values_b = { b.volume.total , b.volume.fluid , b.volume.nuclear , b.volume.cytoplasmic , 
+            b.volume.solid , b.volume.calcified_fraction , b.volume.fluid_fraction , b.geometry.radius , b.geometry.surface_area }; 
+        values_a.insert( values_a.end() , a.death.rates.begin() , a.death.rates.end() ); 
+        values_b.insert( values_b.end() , b.death.rates.begin() , b.death.rates.end() ); 
+        for( int j=0; j < a.cycle.data.transition_rates.size() ; j++ )
+        {
+            values_a.insert( values_a.end() , a.cycle.data.transition_rates[j].begin() , a.cycle.data.transition_rates[j].end() ); 
+            values_b.insert( values_b.end() , b.cycle.data.transition_rates[j].begin() , b.cycle.data.transition_rates[j].end() ); 
+        }
+        for( int j=0; j < values_a.size() ; j++ )
+        {
+            double difference = fabs( values_a[j] - values_b[j] ) / ( 1e-300 + fabs( values_a[j] ) + fabs( values_b[j] ) ); 
+            if( difference > largest_difference )
+            { largest_difference = difference; }
+        }
+    }
+    std::cout << "largest relative difference, batch vs. per-cell: " << largest_difference << " (expected < 1e-12)" << std::endl;
+
+    for( int i=0; i < number_of_cells ; i++ )
+    { delete per_cell[i]; delete batch[i]; }
+    BioFVM::set_default_microenvironment( NULL ); 
+    return largest_difference < 1e-12; 
+}
+
+// the two-sample Kolmogorov-Smirnov statistic 
+double ks_statistic( std::vector<double> a , std::vector<double> b )
+{
+    std::sort( a.begin() , a.end() ); 
+    std::sort( b.begin() , b.end() ); 
+    int i = 0; 
+    int j = 0; 
+    double largest = 0.0; 
+    while( i < a.size() && j < b.size() )
+    {
+        double x = std::min( a[i] , b[j] ); 
+        while( i < a.size() && a[i] <= x )
+        { i++; }
+        while( j < b.size() && b[j] <= x )
+        { j++; }
+        largest = std::max( largest , fabs( (double) i / a.size() - (double) j / b.size() ) ); 
+    }
+    return largest; 
+}
+
+int wjy_batches1()
+{
+    std::cout << "--------------  " << __FUNCTION__ << " -------------- " << std::endl;
+    BioFVM::Microenvironment M; 
+    M.set_density( 0 , "oxygen" , "mmHg" ); 
+    M.resize_space_uniform( 0 , 200 , 0 , 200 , 0 , 200 , 20 ); 
+    for( int n=0; n < M.number_of_voxels() ; n++ )
+    { M.density_vector( n )[0] = 38.0; } 
+    BioFVM::set_default_microenvironment( &M ); 
+
+    // a longer step, so that the noise and the clamps matter 
+    double saved_diffusion_dt = PhysiCell::diffusion_dt; 
+    PhysiCell::diffusion_dt = 0.5; 
+    PhysiCell::PhysiCell_globals.current_time = 0.0; // a step at which pi and pe are kept 
+
+    std::vector<std::string> names = { "wjy_beta" , "wjy_alpha" , "wjy_gamma" , "wjy_rengp" , "wjy_rengpp" , 
+        "wjy_rengpf" , "wjy_gmi" , "wjy_gme" , "wjy_rea" , "wjy_ria" , "wjy_energy" }; 
+    std::vector<double> values = { 1 , 2 , 2 , 0.6 , -0.8 , -0.2 , 2 , 2 , 1 , 1 , 5 }; 
+
+    int number_of_cells = 20000; 
+    std::vector<PhysiCell::Cell*> per_cell( number_of_cells ); 
+    std::vector<PhysiCell::Cell*> batch( number_of_cells ); 
+    for( int i=0; i < number_of_cells ; i++ )
+    {
+        // initial fractions across [0,1], some past the clamps 
+        double pi = 0.05 + 0.9 * ( i % 37 ) / 36.0; 
+        double pe = ( 1.0 - pi ) * ( i % 23 ) / 22.0; 
+        for( int copy=0; copy < 2 ; copy++ )
+        {
+            PhysiCell::Cell* pCell = new PhysiCell::Cell; 
+            pCell->position = { 100.0 , 100.0 , 100.0 }; 
+            pCell->update_voxel_index(); 
+            for( int k=0; k < names.size() ; k++ )
+            { pCell->custom_data.add_variable( names[k] , "dimensionless" , values[k] ); }
+            pCell->custom_data.add_variable( "pi" , "dimensionless" , pi ); 
+            pCell->custom_data.add_variable( "pe" , "dimensionless" , pe ); 
+            pCell->custom_data.add_variable( "pf" , "dimensionless" , 1 - pi - pe ); 
+            ( copy == 0 ? per_cell : batch )[i] = pCell; 
+        }
+    }
+
+    double dt = 6.0; 
+    PhysiCell::SeedRandom( 0 ); 
+    for( int i=0; i < number_of_cells ; i++ )
+    { PhysiCell::wjy_update( per_cell[i] , per_cell[i]->phenotype , dt ); }
+    PhysiCell::find_batch_function( PhysiCell::wjy_update )( batch , NULL , dt ); // the first cell's parameters 
+
+    // the draws differ, so compare the distributions of pi, pe and pf 
+    bool passed = true; 
+    std::vector<std::string> fractions = { "pi" , "pe" , "pf" }; 
+    for( int k=0; k < fractions.size() ; k++ )
+    {
+        int index = per_cell[0]->custom_data.find_variable_index( fractions[k] ); 
+        std::vector<double> a( number_of_cells ); 
+        std::vector<double> b( number_of_cells ); 
+        double mean_a = 0.0; 
+        double mean_b = 0.0; 
+        for( int i=0; i < number_of_cells ; i++ )
+        {
+            a[i] = per_cell[i]->custom_data[index]; 
+            b[i] = batch[i]->custom_data[index]; 
+            mean_a += a[i] / number_of_cells; 
+            mean_b += b[i] / number_of_cells; 
+        }
+        double variance_a = 0.0; 
+        double variance_b = 0.0; 
+        for( int i=0; i < number_of_cells ; i++ )
+        {
+            variance_a += ( a[i] - mean_a ) * ( a[i] - mean_a ) / number_of_cells; 
+            variance_b += ( b[i] - mean_b ) * ( b[i] - mean_b ) / number_of_cells; 
+        }
+        double ks = ks_statistic( a , b ); 
+        std::cout << fractions[k] << ": mean " << mean_a << " vs. " << mean_b << ", sd " << sqrt( variance_a ) 
+            << " vs. " << sqrt( variance_b ) << ", KS statistic " << ks << " (expected < 0.025)" << std::endl; 
+        passed = passed && ks < 0.025 && fabs( mean_a - mean_b ) < 0.01; 
+    }
+
+    // the rates do not depend on the draws 
+    double largest_difference = 0.0; 
+    for( int i=0; i < number_of_cells ; i++ )
+    {
+        PhysiCell::Phenotype& a = per_cell[i]->phenotype; 
+        PhysiCell::Phenotype& b = batch[i]->phenotype; 
+        int apoptosis_index = a.death.find_death_model_index( "Apoptosis" ); 
+        largest_difference = std::max( largest_difference , fabs( a.death.rates[apoptosis_index] - b.death.rates[apoptosis_index] ) ); 
+    }
+    std::cout << "largest difference in the apoptosis rates: " << largest_difference << " (expected 0)" << std::endl;
+
+    for( int i=0; i < number_of_cells ; i++ )
+    { delete per_cell[i]; delete batch[i]; }
+    PhysiCell::diffusion_dt = saved_diffusion_dt; 
+    BioFVM::set_default_microenvironment( NULL ); 
+    return passed && largest_difference == 0.0; 
+}
+
+// two more registered definitions of the type of cell_defaults: each batch reads its own 
+// definition's parameters, not those of the first one of the type, nor the first cell's 
+int wjy_batches2()
+{
+    std::cout << "--------------  " << __FUNCTION__ << " -------------- " << std::endl;
+    BioFVM::Microenvironment M; 
+    M.set_density( 0 , "oxygen" , "mmHg" ); 
+    M.resize_space_uniform( 0 , 200 , 0 , 200 , 0 , 200 , 20 ); 
+    for( int n=0; n < M.number_of_voxels() ; n++ )
+    { M.density_vector( n )[0] = 38.0; } 
+    BioFVM::set_default_microenvironment( &M ); 
+
+    double saved_diffusion_dt = PhysiCell::diffusion_dt; 
+    PhysiCell::diffusion_dt = 0.5; 
+    PhysiCell::PhysiCell_globals.current_time = 0.0; 
+
+    // no noise (wjy_ria = wjy_rea = 0), so pi after a step is 0.3 - wjy_beta * wjy_rengp * 0.5 
+    std::vector<std::string> names = { "wjy_beta" , "wjy_alpha" , "wjy_gamma" , "wjy_rengp" , "wjy_rengpp" , 
+        "wjy_rengpf" , "wjy_gmi" , "wjy_gme" , "wjy_rea" , "wjy_ria" , "pi" , "pe" , "pf" }; 
+    std::vector<double> values = { 0 , 0 , 0 , 0.1 , 0 , 0 , 1 , 1 , 0 , 0 , 0.3 , 0.3 , 0.4 }; 
+    // copies of cell_defaults (type 0, with its cycle and death models) 
+    PhysiCell::Cell_Definition first( PhysiCell::cell_defaults ); 
+    PhysiCell::Cell_Definition second( PhysiCell::cell_defaults ); 
+    first.name = "first"; 
+    second.name = "second"; 
+    for( int k=0; k < names.size() ; k++ )
+    {
+        first.custom_data.add_variable( names[k] , "dimensionless" , values[k] ); 
+        second.custom_data.add_variable( names[k] , "dimensionless" , values[k] ); 
+    }
+    second.custom_data[ "wjy_beta" ] = 1.0; 
+    PhysiCell::register_cell_definition( first ); 
+    PhysiCell::register_cell_definition( second ); 
+
+    int number_of_cells = 100; 
+    std::vector<PhysiCell::Cell*> cells( number_of_cells ); 
+    for( int i=0; i < number_of_cells ; i++ )
+    {
+        PhysiCell::Cell* pCell = new PhysiCell::Cell; 
+        pCell->convert_to_cell_definition( i % 3 == 0 ? second : first ); 
+        pCell->position = { 100.0 , 100.0 , 100.0 }; 
+        pCell->update_voxel_index(); 
+        pCell->functions.update_phenotype = PhysiCell::wjy_update; 
+        pCell->functions.volume_update_function = NULL; 
+        pCell->custom_data[ "wjy_beta" ] = 5.0; // not read: the definitions are registered 
+        cells[i] = pCell; 
+    }
+
+    PhysiCell::advance_phenotypes_in_batches( cells , [](PhysiCell::Cell*){ return 0.1; } ); 
+
+    double largest_difference = 0.0; 
+    for( int i=0; i < number_of_cells ; i++ )
+    {
+        double expected = ( i % 3 == 0 ) ? 0.25 : 0.3; 
+        largest_difference = std::max( largest_difference , fabs( cells[i]->custom_data[ "pi" ] - expected ) ); 
+    }
+    std::cout << "largest difference from each definition's pi: " << largest_difference << " (expected < 1e-12)" << std::endl;
+
+    for( int i=0; i < number_of_cells ; i++ )
+    { delete cells[i]; }
+    PhysiCell::cell_definitions_by_index.erase( std::remove_if( PhysiCell::cell_definitions_by_index.begin() , 
+        PhysiCell::cell_definitions_by_index.end() , [&](PhysiCell::Cell_Definition* pCD){ return pCD == &first || pCD == &second; } ) , 
+        PhysiCell::cell_definitions_by_index.end() ); 
+    PhysiCell::diffusion_dt = saved_diffusion_dt; 
+    BioFVM::set_default_microenvironment( NULL ); 
+    return largest_difference < 1e-12; 
+}
+
 int main()
 {
     std::cout << ">>>>>>>>>  Unit tests" << std::endl;
     custom_vars1();
+    task_graph1();
+    scheduler1();
+    phenotype_batches1();
+    wjy_batches1();
+    wjy_batches2();
 
     return 1;
 }
\ No newline at end of file
@@ -190,6 +190,8 @@ void create_cell_types( void )
 	motile_cell.phenotype.cycle.data.transition_rate(G0G1_index,S_index) *= 
 		parameters.doubles( "motile_cell_relative_cycle_entry_rate" ); // 0.1; 
 	
+	register_cell_definition( motile_cell ); 
+	
 	return; 
 }
 
@@ -253,7 +255,7 @@ void setup_microenvironment( void )
 	// now, let's set all the substrates to the bc_vector value 
 	for( unsigned int n=0; n < microenvironment.number_of_voxels() ; n++ )
 	{
-		microenvironment(n) = bc_vector; 
+		microenvironment(n).assign( bc_vector.begin() , bc_vector.end() ); 
 	}	
 	
 	return; 
@@ -309,14 +311,15 @@ std::vector<double> integrate_total_substrates( void )
 	for( unsigned int n = 0; n < microenvironment.number_of_voxels() ; n++ )
 	{
 		// out = out + microenvironment(n) * dV(n) 
-		axpy( &out , microenvironment.mesh.voxels[n].volume , microenvironment(n) ); 
+		double volume = microenvironment.mesh.voxel_volume( n ); 
+		axpy( &out , volume , microenvironment(n) ); 
 	}
 
 	// inte
 	for( unsigned int n=0; n < (*all_cells).size(); n++ )
 	{
 		Cell* pC = (*all_cells)[n];
-		out += pC->phenotype.molecular.internalized_substrates;
+		out += pC->phenotype.molecular.internalized_total_substrates;
 	}
 	
 	return out; 